@@ -35,6 +35,10 @@ namespace carla {
   /// buffer is retrieved from a BufferPool, the memory is automatically pushed
   /// back to the pool on destruction.
   ///
+  /// A buffer can also be a view over memory it does not own, see
+  /// Buffer(std::shared_ptr<value_type>, size_type). Growing a view allocates
+  /// memory of its own and releases the view.
+  ///
   /// @warning Creating a buffer bigger than max_size() is undefined.
   class Buffer {
 
@@ -98,12 +102,23 @@ namespace carla {
           return static_cast<size_type>(size);
         } ()) {}
 
+    /// Create a view over @a size bytes of memory owned by someone else. The
+    /// memory is released by the deleter of @a view once the buffer, and any
+    /// buffer moved from it, no longer uses it. Views never return to a pool.
+    explicit Buffer(std::shared_ptr<value_type> view, size_type size)
+      : _size(size),
+        _capacity(size),
+        _view(std::move(view)) {
+      DEBUG_ASSERT((_view != nullptr) || (size == 0u));
+    }
+
     Buffer(const Buffer &) = delete;
 
     Buffer(Buffer &&rhs) noexcept
       : _parent_pool(std::move(rhs._parent_pool)),
         _size(rhs._size),
         _capacity(rhs._capacity),
+        _view(std::move(rhs._view)),
         _data(rhs.pop()) {}
 
     ~Buffer() {
@@ -126,6 +141,7 @@ namespace carla {
       _parent_pool = std::move(rhs._parent_pool);
       _size = rhs._size;
       _capacity = rhs._capacity;
+      _view = std::move(rhs._view);
       _data = rhs.pop();
       return *this;
     }
@@ -140,24 +156,29 @@ namespace carla {
 
     /// Access the byte at position @a i.
     const value_type &operator[](size_t i) const {
-      return _data[i];
+      return data()[i];
     }
 
     /// Access the byte at position @a i.
     value_type &operator[](size_t i) {
-      return _data[i];
+      return data()[i];
     }
 
     /// Direct access to the allocated memory or nullptr if no memory is
     /// allocated.
     const value_type *data() const noexcept {
-      return _data.get();
+      return _view != nullptr ? _view.get() : _data.get();
     }
 
     /// Direct access to the allocated memory or nullptr if no memory is
     /// allocated.
     value_type *data() noexcept {
-      return _data.get();
+      return _view != nullptr ? _view.get() : _data.get();
+    }
+
+    /// Whether this buffer is a view over memory it does not own.
+    bool is_view() const noexcept {
+      return _view != nullptr;
     }
 
     /// Make a boost::asio::buffer from this buffer.
@@ -212,7 +233,7 @@ namespace carla {
   public:
 
     const_iterator cbegin() const noexcept {
-      return _data.get();
+      return data();
     }
 
     const_iterator begin() const noexcept {
@@ -220,7 +241,7 @@ namespace carla {
     }
 
     iterator begin() noexcept {
-      return _data.get();
+      return data();
     }
 
     const_iterator cend() const noexcept {
@@ -250,6 +271,7 @@ namespace carla {
       if (_capacity < size) {
         log_debug("allocating buffer of", size, "bytes");
         _data = std::make_unique<value_type[]>(size);
+        _view = nullptr;
         _capacity = size;
       }
       _size = size;
@@ -268,18 +290,20 @@ namespace carla {
     void resize(uint64_t size) {
       if(_capacity < size) {
         std::unique_ptr<value_type[]> data = std::move(_data);
-        uint64_t old_size = size;
+        std::shared_ptr<value_type> view = std::move(_view);
+        uint64_t old_size = _size;
         reset(size);
-        copy_from(data.get(), static_cast<size_type>(old_size));
+        copy_from(view != nullptr ? view.get() : data.get(), static_cast<size_type>(old_size));
       }
       _size = static_cast<size_type>(size);
     }
 
     /// Release the contents of this buffer and set its size and capacity to
-    /// zero.
+    /// zero. A view releases the memory it points to and returns nullptr.
     std::unique_ptr<value_type[]> pop() noexcept {
       _size = 0u;
       _capacity = 0u;
+      _view = nullptr;
       return std::move(_data);
     }
 
@@ -365,6 +389,9 @@ namespace carla {
 
     size_type _capacity = 0u;
 
+    /// Memory not owned by this buffer, if any, used instead of _data.
+    std::shared_ptr<value_type> _view = nullptr;
+
     std::unique_ptr<value_type[]> _data = nullptr;
   };
 
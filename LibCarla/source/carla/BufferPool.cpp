@@ -0,0 +1,135 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/BufferPool.h"
+
+#include "carla/Debug.h"
+
+#include <algorithm>
+
+namespace carla {
+
+  constexpr size_t BufferPool::default_max_bytes;
+  constexpr size_t BufferPool::min_size_class;
+  constexpr size_t BufferPool::number_of_size_classes;
+
+  BufferPool::BufferPool(const size_t max_bytes)
+    : _max_bytes(max_bytes) {
+    _queues.reserve(number_of_size_classes);
+    for (auto i = 0u; i < number_of_size_classes; ++i) {
+      // No blocks preallocated, most pools only use one or two size classes.
+      _queues.emplace_back(0u);
+    }
+  }
+
+  Buffer BufferPool::Pop(const size_type size) {
+    const auto size_class = GetSizeClassOfRequest(size);
+    _last_size_class = size_class;
+    Buffer item;
+    if (TryPop(size_class, item)) {
+      ++_hits;
+    } else {
+      ++_misses;
+      const auto bits = size_class + min_size_class;
+      if (bits < 8u * sizeof(size_type)) {
+        item.reset(static_cast<size_type>(size_type(1u) << bits));
+      }
+    }
+    item.reset(size);
+    return Adopt(std::move(item));
+  }
+
+  Buffer BufferPool::Pop() {
+    Buffer item;
+    bool found = TryPop(_last_size_class, item);
+    for (auto i = 0u; (i < number_of_size_classes) && !found; ++i) {
+      found = TryPop(i, item);
+    }
+    if (found) {
+      ++_hits;
+    } else {
+      ++_misses;
+    }
+    return Adopt(std::move(item));
+  }
+
+  void BufferPool::SetMaxBytes(const size_t max_bytes) {
+    _max_bytes = max_bytes;
+    Trim(max_bytes);
+  }
+
+  void BufferPool::Trim(const size_t max_bytes) {
+    for (auto i = number_of_size_classes; (i > 0u) && (_bytes_held > max_bytes); --i) {
+      Buffer item;
+      while ((_bytes_held > max_bytes) && TryPop(i - 1u, item)) {
+        // Let the memory go instead of returning here.
+        item._parent_pool.reset();
+        item.clear();
+        ++_trimmed;
+      }
+    }
+  }
+
+  BufferPool::Statistics BufferPool::GetStatistics() const {
+    Statistics statistics;
+    statistics.hits = _hits;
+    statistics.misses = _misses;
+    statistics.trimmed = _trimmed;
+    statistics.buffers_held = _buffers_held;
+    statistics.bytes_held = _bytes_held;
+    return statistics;
+  }
+
+  size_t BufferPool::GetSizeClassOfRequest(const size_type size) {
+    auto bits = min_size_class;
+    while ((bits < 8u * sizeof(size_type)) && ((uint64_t(1u) << bits) < size)) {
+      ++bits;
+    }
+    return bits - min_size_class;
+  }
+
+  size_t BufferPool::GetSizeClassOfCapacity(const size_type capacity) {
+    DEBUG_ASSERT(capacity > 0u);
+    auto bits = 0u;
+    while ((capacity >> (bits + 1u)) != 0u) {
+      ++bits;
+    }
+    return bits < min_size_class ? 0u : bits - min_size_class;
+  }
+
+  void BufferPool::Push(Buffer &&buffer) {
+    const size_type capacity = buffer.capacity();
+    // Reserve the bytes first so concurrent pushes cannot exceed the limit.
+    if (_bytes_held.fetch_add(capacity) + capacity > _max_bytes) {
+      _bytes_held -= capacity;
+      ++_trimmed;
+      // The buffer is not moved, its memory is deleted by its destructor.
+      return;
+    }
+    ++_buffers_held;
+    _queues[GetSizeClassOfCapacity(capacity)].enqueue(std::move(buffer));
+  }
+
+  bool BufferPool::TryPop(const size_t size_class, Buffer &buffer) {
+    DEBUG_ASSERT(size_class < number_of_size_classes);
+    if (!_queues[size_class].try_dequeue(buffer)) {
+      return false;
+    }
+    --_buffers_held;
+    _bytes_held -= buffer.capacity();
+    return true;
+  }
+
+  Buffer BufferPool::Adopt(Buffer &&buffer) {
+#if __cplusplus >= 201703L // C++17
+    buffer._parent_pool = weak_from_this();
+#else
+    buffer._parent_pool = shared_from_this();
+#endif
+    return std::move(buffer);
+  }
+
+} // namespace carla
@@ -17,44 +17,114 @@
 #  pragma clang diagnostic pop
 #endif
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 namespace carla {
 
   /// A pool of Buffer. Buffers popped from this pool automatically return to
   /// the pool on destruction so the allocated memory can be reused.
   ///
-  /// @warning Buffers adjust their size only by growing, they never shrink
-  /// unless explicitly cleared. The allocated memory is only deleted when this
-  /// pool is destroyed.
+  /// Buffers are kept in power-of-two size classes, so a small buffer is never
+  /// grown to hold a big message and a big buffer is not used for a small one.
+  /// The memory held by the pool is capped, buffers returned to a full pool
+  /// are deleted.
+  ///
+  /// Each size class is a lock-free queue with a sub-queue per pushing thread,
+  /// so threads returning buffers do not contend with each other.
   class BufferPool : public std::enable_shared_from_this<BufferPool> {
   public:
 
-    BufferPool() = default;
+    using size_type = Buffer::size_type;
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}
+    /// Default maximum number of bytes held by a pool.
+    static constexpr size_t default_max_bytes = 256u * 1024u * 1024u;
 
-    /// Pop a Buffer from the queue, creates a new one if the queue is empty.
-    Buffer Pop() {
-      Buffer item;
-      _queue.try_dequeue(item); // we don't care if it fails.
-#if __cplusplus >= 201703L // C++17
-      item._parent_pool = weak_from_this();
-#else
-      item._parent_pool = shared_from_this();
-#endif
-      return item;
+    struct Statistics {
+
+      /// Buffers popped that were reused.
+      size_t hits = 0u;
+
+      /// Buffers popped that had to be created.
+      size_t misses = 0u;
+
+      /// Buffers deleted instead of returned to the pool because it was full,
+      /// or removed by Trim.
+      size_t trimmed = 0u;
+
+      /// Buffers currently held by the pool.
+      size_t buffers_held = 0u;
+
+      /// Bytes currently held by the pool.
+      size_t bytes_held = 0u;
+    };
+
+    explicit BufferPool(size_t max_bytes = default_max_bytes);
+
+    /// Pop a Buffer with capacity for at least @a size bytes and its size set
+    /// to @a size. Creates a new one if the matching size class is empty, with
+    /// its capacity rounded up to the size class.
+    Buffer Pop(size_type size);
+
+    /// Pop a Buffer of unknown size, creates a new empty one if the pool is
+    /// empty. Prefers the size class used last, a stream usually sends
+    /// messages of the same size.
+    Buffer Pop();
+
+    /// Set the maximum number of bytes held by the pool, and trim the pool
+    /// down to it.
+    void SetMaxBytes(size_t max_bytes);
+
+    size_t GetMaxBytes() const {
+      return _max_bytes;
     }
 
+    /// Delete held buffers, starting by the biggest ones, until the pool holds
+    /// at most @a max_bytes bytes.
+    void Trim(size_t max_bytes = 0u);
+
+    Statistics GetStatistics() const;
+
   private:
 
     friend class Buffer;
 
-    void Push(Buffer &&buffer) {
-      _queue.enqueue(std::move(buffer));
-    }
+    /// Smallest size class, 64 bytes.
+    static constexpr size_t min_size_class = 6u;
+
+    /// One size class per power of two up to the maximum size of a Buffer.
+    static constexpr size_t number_of_size_classes = 8u * sizeof(size_type) - min_size_class + 1u;
+
+    /// Size class of a request of @a size bytes, every buffer in this class
+    /// has enough capacity.
+    static size_t GetSizeClassOfRequest(size_type size);
+
+    /// Size class of a buffer of @a capacity bytes.
+    static size_t GetSizeClassOfCapacity(size_type capacity);
+
+    void Push(Buffer &&buffer);
+
+    bool TryPop(size_t size_class, Buffer &buffer);
+
+    Buffer Adopt(Buffer &&buffer);
+
+    /// One queue per size class, their blocks are allocated on demand.
+    std::vector<moodycamel::ConcurrentQueue<Buffer>> _queues;
+
+    std::atomic_size_t _max_bytes;
+
+    std::atomic_size_t _last_size_class{0u};
+
+    std::atomic_size_t _hits{0u};
+
+    std::atomic_size_t _misses{0u};
+
+    std::atomic_size_t _trimmed{0u};
+
+    std::atomic_size_t _buffers_held{0u};
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;
+    std::atomic_size_t _bytes_held{0u};
   };
 
 } // namespace carla
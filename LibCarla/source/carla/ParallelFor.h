@@ -0,0 +1,76 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/ThreadGroup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace carla {
+
+  /// Number of threads to use by default in ParallelFor, one per core.
+  inline size_t GetDefaultNumberOfThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  /// Call @a function(begin, end) for consecutive chunks of at most
+  /// @a chunk_size indices covering [0, size), from @a number_of_threads
+  /// threads, the calling one included. Chunks are taken in order as the
+  /// threads become free, so uneven work is balanced.
+  ///
+  /// Blocks until every chunk is done. If a call throws, the remaining chunks
+  /// are skipped and the first exception is rethrown in the calling thread.
+  template <typename FunctionT>
+  void ParallelFor(
+      const size_t size,
+      const size_t chunk_size,
+      size_t number_of_threads,
+      FunctionT &&function) {
+    const size_t step = std::max<size_t>(1u, chunk_size);
+    const size_t number_of_chunks = (size + step - 1u) / step;
+    number_of_threads = std::max<size_t>(1u, std::min(number_of_threads, number_of_chunks));
+
+    std::atomic_size_t next_chunk{0u};
+    std::atomic_bool failed{false};
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+
+    auto run = [&]() {
+      for (;;) {
+        const size_t chunk = next_chunk.fetch_add(1u);
+        if ((chunk >= number_of_chunks) || failed.load()) {
+          return;
+        }
+        const size_t begin = chunk * step;
+        try {
+          function(begin, std::min(begin + step, size));
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(exception_mutex);
+          if (exception == nullptr) {
+            exception = std::current_exception();
+          }
+          failed = true;
+        }
+      }
+    };
+
+    {
+      ThreadGroup workers;
+      workers.CreateThreads(number_of_threads - 1u, run);
+      run();
+    }
+
+    if (exception != nullptr) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+} // namespace carla
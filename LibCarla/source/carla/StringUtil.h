@@ -62,6 +62,11 @@ namespace carla {
       return boost::algorithm::trim_copy(str);
     }
 
+    template <typename SequenceT, typename Range1T, typename Range2T>
+    static void ReplaceAll(SequenceT &str, const Range1T &search, const Range2T &format) {
+      boost::algorithm::replace_all(str, search, format);
+    }
+
     template<typename Container, typename Range1T, typename Range2T>
     static void Split(Container &destination, const Range1T &str, const Range2T &separators) {
       boost::split(destination, str, boost::is_any_of(separators));
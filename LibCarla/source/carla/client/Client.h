@@ -25,10 +25,14 @@ namespace client {
     /// @param port TCP port to connect with the simulator.
     /// @param worker_threads number of asynchronous threads to use, or 0 to use
     ///        all available hardware concurrency.
+    /// @param multiplexed_streaming whether to receive the sensor streams of
+    ///        the simulator through a single connection instead of one per
+    ///        stream.
     explicit Client(
         const std::string &host,
         uint16_t port,
-        size_t worker_threads = 0u);
+        size_t worker_threads = 0u,
+        bool multiplexed_streaming = false);
 
     /// Set a timeout for networking operations. If set, any networking
     /// operation taking longer than @a timeout throws rpc::timeout.
@@ -161,9 +165,10 @@ namespace client {
   inline Client::Client(
       const std::string &host,
       uint16_t port,
-      size_t worker_threads)
+      size_t worker_threads,
+      bool multiplexed_streaming)
     : _simulator(
-        new detail::Simulator(host, port, worker_threads),
+        new detail::Simulator(host, port, worker_threads, false, multiplexed_streaming),
         PythonUtil::ReleaseGILDeleter()) {}
 
 } // namespace client
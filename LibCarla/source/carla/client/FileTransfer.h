@@ -26,6 +26,9 @@ namespace client {
 
     static const std::string& GetFilesBaseFolder();
 
+    /// Returns the path of @a path inside the cache folder of this version.
+    static std::string GetFullPath(const std::string &path);
+
     static bool FileExists(std::string file);
 
     static bool WriteFile(std::string path, std::vector<uint8_t> content);
@@ -6,13 +6,23 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/FileSystem.h"
+#include "carla/Logging.h"
+#include "carla/client/FileTransfer.h"
 #include "carla/client/Junction.h"
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDriveParser.h"
 #include "carla/road/Map.h"
+#include "carla/road/MapCache.h"
 #include "carla/road/RoadTypes.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 
+#include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <fstream>
+#include <iomanip>
 #include <sstream>
 
 namespace carla {
@@ -27,15 +37,81 @@ namespace client {
     return std::move(*map);
   }
 
+  /// Path of the snapshot of the map in the file cache of the client, named
+  /// after the hash of the OpenDRIVE.
+  static std::string GetMapCachePath(const std::string &opendrive_contents) {
+    std::ostringstream name;
+    name << "MapCache/" << std::hex << std::setw(16) << std::setfill('0')
+         << road::MapCache::Hash(opendrive_contents) << ".bin";
+    return FileTransfer::GetFullPath(name.str());
+  }
+
+  static boost::optional<road::Map> LoadMapFromCache(
+      const std::string &opendrive_contents,
+      const std::string &path) {
+    namespace bip = boost::interprocess;
+    if (!boost::filesystem::exists(path)) {
+      return {};
+    }
+    try {
+      bip::file_mapping file(path.c_str(), bip::read_only);
+      bip::mapped_region region(file, bip::read_only);
+      road::MapCache cache(static_cast<const uint8_t *>(region.get_address()), region.get_size());
+      if (cache.IsCacheOf(opendrive_contents)) {
+        return opendrive::OpenDriveParser::Load(opendrive_contents, cache);
+      }
+    } catch (const bip::interprocess_exception &e) {
+      log_warning("could not map the map cache", path, ":", e.what());
+    }
+    return {};
+  }
+
+  /// The snapshot is written to a temporary file and then renamed, so
+  /// clients starting at the same time never read a partial snapshot.
+  static void SaveMapCache(
+      const road::Map &map,
+      const std::string &opendrive_contents,
+      std::string path) {
+    try {
+      FileSystem::ValidateFilePath(path);
+      const auto temp_path = path + boost::filesystem::unique_path(".%%%%%%%%.tmp").string();
+      bool success;
+      {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        success = road::MapCache::Write(map, opendrive_contents, out);
+      }
+      if (success) {
+        boost::filesystem::rename(temp_path, path);
+      } else {
+        boost::filesystem::remove(temp_path);
+        log_warning("could not write the map cache", path);
+      }
+    } catch (const std::exception &e) {
+      log_warning("could not save the map cache", path, ":", e.what());
+    }
+  }
+
+  static road::Map MakeMapWithCache(const std::string &opendrive_contents) {
+    const auto path = GetMapCachePath(opendrive_contents);
+    auto map = LoadMapFromCache(opendrive_contents, path);
+    if (map.has_value()) {
+      return std::move(*map);
+    }
+    auto new_map = MakeMap(opendrive_contents);
+    SaveMapCache(new_map, opendrive_contents, path);
+    return new_map;
+  }
+
   Map::Map(rpc::MapInfo description, std::string xodr_content)
     : _description(std::move(description)),
-      _map(MakeMap(xodr_content)){
+      _map(MakeMapWithCache(xodr_content)){
     open_drive_file = xodr_content;
   }
   Map::Map(std::string name, std::string xodr_content)
-    : Map(rpc::MapInfo{
+    : _description(rpc::MapInfo{
     std::move(name),
-    std::vector<geom::Transform>{}}, xodr_content) {
+    std::vector<geom::Transform>{}}),
+      _map(MakeMap(xodr_content)) {
     open_drive_file = xodr_content;
   }
 
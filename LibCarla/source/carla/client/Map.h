@@ -29,6 +29,8 @@ namespace client {
       private NonCopyable {
   public:
 
+    /// Map of the simulation. Saves a snapshot of the map in the file cache
+    /// of the client the first time, later clients load the map from it.
     explicit Map(rpc::MapInfo description, std::string xodr_content);
 
     explicit Map(std::string name, std::string xodr_content);
@@ -0,0 +1,148 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/SensorDataWriter.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cstdio>
+#include <exception>
+#include <thread>
+
+namespace carla {
+namespace client {
+
+  SensorDataWriter::SensorDataWriter(
+      size_t worker_threads,
+      size_t max_queued_writes,
+      bool drop_when_full)
+    : _max_queued_writes(max_queued_writes > 0u ? max_queued_writes : 1u),
+      _drop_when_full(drop_when_full) {
+    if (worker_threads == 0u) {
+      worker_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _workers.CreateThreads(worker_threads, [this]() { Run(); });
+  }
+
+  SensorDataWriter::~SensorDataWriter() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _write_queued.notify_all();
+    _workers.JoinAll();
+  }
+
+  bool SensorDataWriter::Post(WriteFunction write) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_queue.size() >= _max_queued_writes) {
+      if (_drop_when_full) {
+        ++_statistics.dropped;
+        return false;
+      }
+      _write_done.wait(lock, [this]() { return _queue.size() < _max_queued_writes; });
+    }
+    _queue.emplace_back(std::move(write));
+    _statistics.queued = _queue.size();
+    lock.unlock();
+    _write_queued.notify_one();
+    return true;
+  }
+
+  void SensorDataWriter::Flush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _write_done.wait(lock, [this]() {
+      return _queue.empty() && (_statistics.in_progress == 0u);
+    });
+  }
+
+  bool SensorDataWriter::Flush(time_duration timeout) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _write_done.wait_for(lock, timeout.to_chrono(), [this]() {
+      return _queue.empty() && (_statistics.in_progress == 0u);
+    });
+  }
+
+  size_t SensorDataWriter::GetBacklog() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size() + _statistics.in_progress;
+  }
+
+  SensorDataWriter::Statistics SensorDataWriter::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _statistics;
+  }
+
+  std::string SensorDataWriter::MakePath(
+      const std::string &pattern,
+      const size_t frame,
+      const double timestamp) {
+    char frame_str[32u];
+    std::snprintf(frame_str, sizeof(frame_str), "%08zu", frame);
+    char timestamp_str[32u];
+    std::snprintf(timestamp_str, sizeof(timestamp_str), "%.6f", timestamp);
+    std::string path = pattern;
+    StringUtil::ReplaceAll(path, "{frame}", frame_str);
+    StringUtil::ReplaceAll(path, "{timestamp}", timestamp_str);
+    return path;
+  }
+
+  size_t SensorDataWriter::WriteRaw(std::string &path, const void *data, const size_t size) {
+    FileSystem::ValidateFilePath(path, ".raw");
+    std::ofstream out(path, std::ios::binary);
+    out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    if (!out) {
+      throw_exception(std::runtime_error("failed to write " + path));
+    }
+    return size;
+  }
+
+  size_t SensorDataWriter::GetFileSize(const std::string &path) {
+    return static_cast<size_t>(boost::filesystem::file_size(path));
+  }
+
+  void SensorDataWriter::Run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+      _write_queued.wait(lock, [this]() { return _stop || !_queue.empty(); });
+      if (_queue.empty()) {
+        // Stopped, and every queued write is done.
+        return;
+      }
+      auto write = std::move(_queue.front());
+      _queue.pop_front();
+      _statistics.queued = _queue.size();
+      ++_statistics.in_progress;
+      lock.unlock();
+
+      size_t bytes = 0u;
+      bool failed = false;
+      try {
+        bytes = write();
+      } catch (const std::exception &e) {
+        log_error("sensor data writer:", e.what());
+        failed = true;
+      }
+      // Release the sensor data before reporting the write as done.
+      write = nullptr;
+
+      lock.lock();
+      --_statistics.in_progress;
+      if (failed) {
+        ++_statistics.failed;
+      } else {
+        ++_statistics.written;
+        _statistics.written_bytes += bytes;
+      }
+      _write_done.notify_all();
+    }
+  }
+
+} // namespace client
+} // namespace carla
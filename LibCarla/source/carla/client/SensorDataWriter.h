@@ -0,0 +1,182 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/FileSystem.h"
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/StringUtil.h"
+#include "carla/ThreadGroup.h"
+#include "carla/Time.h"
+#include "carla/image/ImageIO.h"
+#include "carla/image/ImageView.h"
+#include "carla/pointcloud/PointCloudIO.h"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace carla {
+namespace client {
+
+  /// Saves sensor data to disk in background threads, so the thread that
+  /// receives the data, usually a sensor callback, does not wait for the
+  /// encoding and the file system.
+  ///
+  /// The data is not copied, the writer holds a reference to it until it is
+  /// written. It must not be modified in the meantime.
+  ///
+  /// File names are made from a pattern where "{frame}" is replaced by the
+  /// frame of the data, padded to 8 digits, and "{timestamp}" by its
+  /// timestamp, e.g. "_out/front_camera/{frame}.png".
+  class SensorDataWriter : private NonCopyable {
+  public:
+
+    struct Statistics {
+
+      /// Writes waiting for a worker.
+      size_t queued = 0u;
+
+      /// Writes being done by a worker.
+      size_t in_progress = 0u;
+
+      /// Files written.
+      size_t written = 0u;
+
+      /// Bytes written.
+      size_t written_bytes = 0u;
+
+      /// Writes discarded because the queue was full.
+      size_t dropped = 0u;
+
+      /// Writes that threw an exception.
+      size_t failed = 0u;
+    };
+
+    /// Writes a file and returns the number of bytes written.
+    using WriteFunction = std::function<size_t()>;
+
+    /// @param worker_threads number of threads writing, if 0 one per core.
+    /// @param max_queued_writes maximum number of writes waiting for a worker.
+    /// @param drop_when_full if the queue is full discard new writes instead
+    ///   of blocking the caller until there is room.
+    explicit SensorDataWriter(
+        size_t worker_threads = 0u,
+        size_t max_queued_writes = 256u,
+        bool drop_when_full = false);
+
+    /// Finishes the queued writes and joins the worker threads.
+    ~SensorDataWriter();
+
+    /// Save @a image converted with @a converter. The format is deduced from
+    /// the extension, ".png", ".jpeg" or ".tiff" if supported, or ".raw" for
+    /// the pixels as they are in memory; PNG by default.
+    ///
+    /// @return whether the write was queued.
+    template <typename ImageT, typename ColorConverterT>
+    bool SaveImage(SharedPtr<ImageT> image, const std::string &pattern, ColorConverterT converter) {
+      auto path = MakePath(pattern, image->GetFrame(), image->GetTimestamp());
+      return Post([image=std::move(image), path=std::move(path), converter]() mutable -> size_t {
+        if (StringUtil::EndsWith(path, ".raw")) {
+          return WriteRaw(path, image->data(), image->size() * sizeof(typename ImageT::pixel_type));
+        }
+        auto view = image::ImageView::MakeView(*image);
+        path = image::ImageIO::WriteView(
+            std::move(path),
+            image::ImageView::MakeColorConvertedView(view, converter));
+        return GetFileSize(path);
+      });
+    }
+
+    /// Save @a image without color conversion.
+    template <typename ImageT>
+    bool SaveImage(SharedPtr<ImageT> image, const std::string &pattern) {
+      auto path = MakePath(pattern, image->GetFrame(), image->GetTimestamp());
+      return Post([image=std::move(image), path=std::move(path)]() mutable -> size_t {
+        if (StringUtil::EndsWith(path, ".raw")) {
+          return WriteRaw(path, image->data(), image->size() * sizeof(typename ImageT::pixel_type));
+        }
+        path = image::ImageIO::WriteView(std::move(path), image::ImageView::MakeView(*image));
+        return GetFileSize(path);
+      });
+    }
+
+    /// Save the points of @a data, a lidar or semantic lidar measurement, in
+    /// @a format.
+    ///
+    /// @return whether the write was queued.
+    template <typename PointCloudT>
+    bool SavePointCloud(
+        SharedPtr<PointCloudT> data,
+        const std::string &pattern,
+        pointcloud::PointCloudFormat format = pointcloud::PointCloudFormat::PlyBinary) {
+      auto path = MakePath(pattern, data->GetFrame(), data->GetTimestamp());
+      return Post([data=std::move(data), path=std::move(path), format]() mutable -> size_t {
+        using pointcloud::PointCloudIO;
+        path = (format == pointcloud::PointCloudFormat::PlyAscii) ?
+            PointCloudIO::SaveToDisk(std::move(path), data->begin(), data->end()) :
+            PointCloudIO::SaveToDisk(std::move(path), data->begin(), data->end(), format);
+        return GetFileSize(path);
+      });
+    }
+
+    /// Queue @a write. If the queue is full blocks until there is room, or
+    /// discards it if the writer drops when full.
+    ///
+    /// @return whether the write was queued.
+    bool Post(WriteFunction write);
+
+    /// Block until every write queued so far is done.
+    void Flush();
+
+    /// Block until every write queued so far is done, or @a timeout elapses.
+    ///
+    /// @return whether every write is done.
+    bool Flush(time_duration timeout);
+
+    /// Number of writes queued or in progress.
+    size_t GetBacklog() const;
+
+    Statistics GetStatistics() const;
+
+    /// File name for data of @a frame at @a timestamp following @a pattern.
+    static std::string MakePath(const std::string &pattern, size_t frame, double timestamp);
+
+  private:
+
+    static size_t WriteRaw(std::string &path, const void *data, size_t size);
+
+    static size_t GetFileSize(const std::string &path);
+
+    void Run();
+
+    const size_t _max_queued_writes;
+
+    const bool _drop_when_full;
+
+    mutable std::mutex _mutex;
+
+    /// Notified when a write is queued or the writer stops.
+    std::condition_variable _write_queued;
+
+    /// Notified when a write is done.
+    std::condition_variable _write_done;
+
+    std::deque<WriteFunction> _queue;
+
+    bool _stop = false;
+
+    Statistics _statistics;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace client
+} // namespace carla
@@ -10,6 +10,7 @@
 #include "carla/Version.h"
 #include "carla/client/FileTransfer.h"
 #include "carla/client/TimeoutException.h"
+#include "carla/profiler/Tracer.h"
 #include "carla/rpc/ActorDescription.h"
 #include "carla/rpc/BoneTransformDataIn.h"
 #include "carla/rpc/Client.h"
@@ -46,10 +47,14 @@ namespace detail {
   class Client::Pimpl {
   public:
 
-    Pimpl(const std::string &host, uint16_t port, size_t worker_threads)
+    Pimpl(const std::string &host, uint16_t port, size_t worker_threads, bool multiplexed_streaming)
       : endpoint(host + ":" + std::to_string(port)),
         rpc_client(host, port),
-        streaming_client(host) {
+        streaming_client(
+            host,
+            multiplexed_streaming ?
+                streaming::TransportMode::Multiplexed :
+                streaming::TransportMode::PerStream) {
       rpc_client.set_timeout(5000u);
       streaming_client.AsyncRun(
           worker_threads > 0u ? worker_threads : std::thread::hardware_concurrency());
@@ -66,6 +71,7 @@ namespace detail {
 
     template <typename T, typename ... Args>
     auto CallAndWait(const std::string &function, Args && ... args) {
+      CARLA_TRACE_SCOPE(rpc, call_and_wait);
       auto object = RawCall(function, std::forward<Args>(args) ...);
       using R = typename carla::rpc::Response<T>;
       auto response = object.template as<R>();
@@ -101,8 +107,9 @@ namespace detail {
   Client::Client(
       const std::string &host,
       const uint16_t port,
-      const size_t worker_threads)
-    : _pimpl(std::make_unique<Pimpl>(host, port, worker_threads)) {}
+      const size_t worker_threads,
+      const bool multiplexed_streaming)
+    : _pimpl(std::make_unique<Pimpl>(host, port, worker_threads, multiplexed_streaming)) {}
 
   bool Client::IsTrafficManagerRunning(uint16_t port) const {
     return _pimpl->CallAndWait<bool>("is_traffic_manager_running", port);
@@ -70,7 +70,8 @@ namespace detail {
     explicit Client(
         const std::string &host,
         uint16_t port,
-        size_t worker_threads = 0u);
+        size_t worker_threads = 0u,
+        bool multiplexed_streaming = false);
 
     ~Client();
 
@@ -9,6 +9,7 @@
 #include "carla/Logging.h"
 #include "carla/client/detail/Client.h"
 #include "carla/client/detail/WalkerNavigation.h"
+#include "carla/profiler/Tracer.h"
 #include "carla/sensor/Deserializer.h"
 #include "carla/trafficmanager/TrafficManager.h"
 
@@ -53,12 +54,27 @@ using namespace std::chrono_literals;
   void Episode::Listen() {
     std::weak_ptr<Episode> weak = shared_from_this();
     _client.SubscribeToStream(_token, [weak](auto buffer) {
+      CARLA_TRACE_SCOPE(client, episode_listen);
       auto self = weak.lock();
       if (self != nullptr) {
 
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
-        auto next = std::make_shared<const EpisodeState>(CastData(*data));
+        auto &raw_state = CastData(*data);
         auto prev = self->GetState();
+        std::shared_ptr<const EpisodeState> next;
+        if (!raw_state.IsDelta()) {
+          next = std::make_shared<const EpisodeState>(
+              boost::static_pointer_cast<const sensor::data::RawEpisodeState>(data));
+        } else if (prev->CanApplyDelta(raw_state)) {
+          next = std::make_shared<const EpisodeState>(raw_state, *prev);
+        } else {
+          // We joined in the middle of a delta sequence, or missed the
+          // message this delta was encoded against. Patching it would leave
+          // out the actors that did not change, wait for the next keyframe.
+          log_debug("episode state delta for frame", raw_state.GetFrame(),
+                    "does not apply to frame", prev->GetFrame(), ", waiting for a keyframe");
+          return;
+        }
 
         // TODO: Update how the map change is detected
         bool HasMapChanged = next->HasMapChanged();
@@ -6,11 +6,31 @@
 
 #include "carla/client/detail/EpisodeState.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace client {
 namespace detail {
 
-  EpisodeState::EpisodeState(const sensor::data::RawEpisodeState &state)
+  EpisodeState::EpisodeState(SharedPtr<const sensor::data::RawEpisodeState> state)
+    : _episode_id(state->GetEpisodeId()),
+      _timestamp(
+          state->GetFrame(),
+          state->GetGameTimeStamp(),
+          state->GetDeltaSeconds(),
+          state->GetPlatformTimeStamp()),
+      _map_origin(state->GetMapOrigin()),
+      _simulation_state(state->GetSimulationState()),
+      _has_keyframe(true),
+      _raw_state(std::move(state)),
+      _actors(_raw_state->begin()),
+      _number_of_actors(_raw_state->size()) {
+    DEBUG_ASSERT(!_raw_state->IsDelta());
+  }
+
+  EpisodeState::EpisodeState(
+      const sensor::data::RawEpisodeState &state,
+      const EpisodeState &previous)
     : _episode_id(state.GetEpisodeId()),
       _timestamp(
           state.GetFrame(),
@@ -18,22 +38,78 @@ namespace detail {
           state.GetDeltaSeconds(),
           state.GetPlatformTimeStamp()),
       _map_origin(state.GetMapOrigin()),
-      _simulation_state(state.GetSimulationState()) {
-    _actors.reserve(state.size());
+      _simulation_state(state.GetSimulationState()),
+      _has_keyframe(previous._has_keyframe) {
+    DEBUG_ASSERT(state.IsDelta());
+
+    // Deltas are small, sort them and merge them with the previous actors so
+    // the result is already sorted by id.
+    std::vector<const ActorDynamicState *> delta;
+    delta.reserve(state.size());
     for (auto &&actor : state) {
-      DEBUG_ONLY(auto result = )
-      _actors.emplace(
-          actor.id,
-          ActorSnapshot{
-              actor.id,
-              actor.actor_state,
-              actor.transform,
-              actor.velocity,
-              actor.angular_velocity,
-              actor.acceleration,
-              actor.state});
-      DEBUG_ASSERT(result.second);
+      delta.emplace_back(&actor);
+    }
+    std::sort(delta.begin(), delta.end(), [](auto *lhs, auto *rhs) { return lhs->id < rhs->id; });
+
+    previous.BuildIndexIfMissing();
+    _patched_actors.reserve(previous.size() + delta.size());
+    size_t i = 0u;
+    auto it = delta.begin();
+    while (i < previous.size() || it != delta.end()) {
+      if (it == delta.end() || (i < previous.size() && previous.GetSorted(i).id < (*it)->id)) {
+        _patched_actors.emplace_back(previous.GetSorted(i));
+        ++i;
+        continue;
+      }
+      if (i < previous.size() && previous.GetSorted(i).id == (*it)->id) {
+        ++i;
+      }
+      if ((*it)->actor_state != rpc::ActorState::Invalid) {
+        _patched_actors.emplace_back(**it);
+      }
+      ++it;
+    }
+
+    _actors = _patched_actors.data();
+    _number_of_actors = _patched_actors.size();
+    std::call_once(_index_flag, [this]() { _is_sorted = true; });
+  }
+
+  void EpisodeState::BuildIndex() const {
+    _is_sorted = std::is_sorted(_actors, _actors + _number_of_actors, [](auto &lhs, auto &rhs) {
+      return lhs.id < rhs.id;
+    });
+    if (!_is_sorted) {
+      _sorted_positions.resize(_number_of_actors);
+      for (size_t i = 0u; i < _number_of_actors; ++i) {
+        _sorted_positions[i] = static_cast<uint32_t>(i);
+      }
+      std::sort(_sorted_positions.begin(), _sorted_positions.end(), [this](auto lhs, auto rhs) {
+        return _actors[lhs].id < _actors[rhs].id;
+      });
+    }
+  }
+
+  void EpisodeState::BuildIndexIfMissing() const {
+    std::call_once(_index_flag, [this]() { BuildIndex(); });
+  }
+
+  const sensor::data::ActorDynamicState *EpisodeState::Find(ActorId id) const {
+    BuildIndexIfMissing();
+    size_t first = 0u;
+    size_t last = _number_of_actors;
+    while (first < last) {
+      const size_t middle = first + (last - first) / 2u;
+      const ActorDynamicState &actor = GetSorted(middle);
+      if (actor.id == id) {
+        return &actor;
+      } else if (actor.id < id) {
+        first = middle + 1u;
+      } else {
+        last = middle;
+      }
     }
+    return nullptr;
   }
 
 } // namespace detail
@@ -6,35 +6,62 @@
 
 #pragma once
 
-#include "carla/Iterator.h"
 #include "carla/ListView.h"
+#include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/client/ActorSnapshot.h"
 #include "carla/client/Timestamp.h"
 #include "carla/geom/Vector3DInt.h"
 #include "carla/sensor/data/RawEpisodeState.h"
 
+#include <boost/iterator/transform_iterator.hpp>
 #include <boost/optional.hpp>
 
 #include <memory>
-#include <unordered_map>
+#include <mutex>
+#include <vector>
 
 namespace carla {
 namespace client {
 namespace detail {
 
   /// Represents the state of all the actors of an episode at a given frame.
+  ///
+  /// The actors are read directly from the packed records of the received
+  /// message, no per-actor copy is made. The index used to find actors by id
+  /// is only built the first time it is needed.
   class EpisodeState
     : public std::enable_shared_from_this<EpisodeState>,
       private NonCopyable {
 
       using SimulationState = sensor::s11n::EpisodeStateSerializer::SimulationState;
 
+      using ActorDynamicState = sensor::data::ActorDynamicState;
+
+      static ActorSnapshot MakeActorSnapshot(const ActorDynamicState &actor) {
+        return ActorSnapshot{
+            actor.id,
+            actor.actor_state,
+            actor.transform,
+            actor.velocity,
+            actor.angular_velocity,
+            actor.acceleration,
+            actor.state};
+      }
+
+      static ActorId GetActorId(const ActorDynamicState &actor) {
+        return actor.id;
+      }
+
   public:
 
     explicit EpisodeState(uint64_t episode_id) : _episode_id(episode_id) {}
 
-    explicit EpisodeState(const sensor::data::RawEpisodeState &state);
+    /// Keeps @a state alive and reads the actors from its buffer.
+    explicit EpisodeState(SharedPtr<const sensor::data::RawEpisodeState> state);
+
+    /// Apply the delta @a state on top of the actors of @a previous.
+    EpisodeState(const sensor::data::RawEpisodeState &state, const EpisodeState &previous);
 
     auto GetEpisodeId() const {
       return _episode_id;
@@ -44,6 +71,14 @@ namespace detail {
       return _timestamp.frame;
     }
 
+    /// Whether the delta @a state applies on top of this state, i.e. this
+    /// state comes from a full message and @a state was encoded against it.
+    bool CanApplyDelta(const sensor::data::RawEpisodeState &state) const {
+      return _has_keyframe &&
+          (_episode_id == state.GetEpisodeId()) &&
+          (GetFrame() == state.GetBaseFrame());
+    }
+
     const auto &GetTimestamp() const {
       return _timestamp;
     }
@@ -61,49 +96,55 @@ namespace detail {
     }
 
     bool ContainsActorSnapshot(ActorId actor_id) const {
-      return _actors.find(actor_id) != _actors.end();
+      return Find(actor_id) != nullptr;
     }
 
     ActorSnapshot GetActorSnapshot(ActorId id) const {
-      ActorSnapshot state;
-      CopyActorSnapshotIfPresent(id, state);
-      return state;
+      auto actor = Find(id);
+      return actor != nullptr ? MakeActorSnapshot(*actor) : ActorSnapshot{};
     }
 
     boost::optional<ActorSnapshot> GetActorSnapshotIfPresent(ActorId id) const {
       boost::optional<ActorSnapshot> state;
-      CopyActorSnapshotIfPresent(id, state);
+      auto actor = Find(id);
+      if (actor != nullptr) {
+        state = MakeActorSnapshot(*actor);
+      }
       return state;
     }
 
     auto GetActorIds() const {
       return MakeListView(
-          iterator::make_map_keys_const_iterator(_actors.begin()),
-          iterator::make_map_keys_const_iterator(_actors.end()));
+          boost::make_transform_iterator(_actors, &GetActorId),
+          boost::make_transform_iterator(_actors + _number_of_actors, &GetActorId));
     }
 
     size_t size() const {
-      return _actors.size();
+      return _number_of_actors;
     }
 
     auto begin() const {
-      return iterator::make_map_values_const_iterator(_actors.begin());
+      return boost::make_transform_iterator(_actors, &MakeActorSnapshot);
     }
 
     auto end() const {
-      return iterator::make_map_values_const_iterator(_actors.end());
+      return boost::make_transform_iterator(_actors + _number_of_actors, &MakeActorSnapshot);
     }
 
   private:
 
-    template <typename T>
-    void CopyActorSnapshotIfPresent(ActorId id, T &value) const {
-      auto it = _actors.find(id);
-      if (it != _actors.end()) {
-        value = it->second;
-      }
+    /// Returns nullptr if the actor is not present.
+    const ActorDynamicState *Find(ActorId id) const;
+
+    /// The i-th actor in increasing id order.
+    const ActorDynamicState &GetSorted(size_t i) const {
+      return _actors[_is_sorted ? i : _sorted_positions[i]];
     }
 
+    void BuildIndex() const;
+
+    void BuildIndexIfMissing() const;
+
     const uint64_t _episode_id;
 
     const Timestamp _timestamp;
@@ -112,7 +153,25 @@ namespace detail {
 
     SimulationState _simulation_state;
 
-    std::unordered_map<ActorId, ActorSnapshot> _actors;
+    /// False until a full message has been received, the actors of an empty
+    /// state cannot be patched.
+    bool _has_keyframe = false;
+
+    /// Message the actors are read from, if any.
+    SharedPtr<const sensor::data::RawEpisodeState> _raw_state;
+
+    /// Storage for the actors of a patched delta, sorted by id.
+    std::vector<ActorDynamicState> _patched_actors;
+
+    const ActorDynamicState *_actors = nullptr;
+
+    size_t _number_of_actors = 0u;
+
+    mutable std::once_flag _index_flag;
+
+    mutable bool _is_sorted = false;
+
+    mutable std::vector<uint32_t> _sorted_positions;
   };
 
 } // namespace detail
@@ -17,6 +17,7 @@
 #include "carla/client/TimeoutException.h"
 #include "carla/client/WalkerAIController.h"
 #include "carla/client/detail/ActorFactory.h"
+#include "carla/profiler/Tracer.h"
 #include "carla/trafficmanager/TrafficManager.h"
 #include "carla/sensor/Deserializer.h"
 
@@ -72,9 +73,10 @@ namespace detail {
       const std::string &host,
       const uint16_t port,
       const size_t worker_threads,
-      const bool enable_garbage_collection)
+      const bool enable_garbage_collection,
+      const bool multiplexed_streaming)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER("SimulatorClient("s + host + ":" + std::to_string(port) + ")"),
-      _client(host, port, worker_threads),
+      _client(host, port, worker_threads, multiplexed_streaming),
       _light_manager(new LightManager()),
       _gc_policy(enable_garbage_collection ?
         GarbageCollectionPolicy::Enabled : GarbageCollectionPolicy::Disabled) {}
@@ -211,6 +213,7 @@ namespace detail {
   }
 
   uint64_t Simulator::Tick(time_duration timeout) {
+    CARLA_TRACE_SCOPE(client, world_tick);
     DEBUG_ASSERT(_episode != nullptr);
     const auto frame = _client.SendTickCue();
     bool result = SynchronizeFrame(frame, *_episode, timeout);
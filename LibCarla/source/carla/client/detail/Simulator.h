@@ -59,7 +59,8 @@ namespace detail {
         const std::string &host,
         uint16_t port,
         size_t worker_threads = 0u,
-        bool enable_garbage_collection = false);
+        bool enable_garbage_collection = false,
+        bool multiplexed_streaming = false);
 
     /// @}
     // =========================================================================
@@ -83,86 +83,126 @@ namespace detail {
 
   // add/update/delete all vehicles in crowd
   void WalkerNavigation::UpdateVehiclesInCrowd(std::shared_ptr<Episode> episode, bool show_debug) {
-    std::vector<carla::nav::VehicleCollisionInfo> vehicles;
+    ++_vehicles_update;
+    _new_actors.clear();
+    _vehicles.clear();
+    _removed_vehicles.clear();
 
     // get current state
     std::shared_ptr<const EpisodeState> state = episode->GetState();
 
-    // get all vehicles from episode
-    for (auto &&actor : episode->GetActors()) {
-      // only vehicles
-      if (actor.description.id.rfind("vehicle.", 0) == 0) {
-        // get the snapshot
-        ActorSnapshot snapshot = state->GetActorSnapshot(actor.id);
-        // add to the vector
-        vehicles.emplace_back(carla::nav::VehicleCollisionInfo{actor.id, snapshot.transform, actor.bounding_box});
+    // get the vehicles we already know, and the actors spawned since last tick
+    size_t actors_in_state = 0u;
+    for (auto &&actor : *state) {
+      auto it = _known_actors.find(actor.id);
+      if (it == _known_actors.end()) {
+        _new_actors.emplace_back(actor.id);
+        continue;
+      }
+      it->second.update = _vehicles_update;
+      ++actors_in_state;
+      if (it->second.is_vehicle) {
+        _vehicles.emplace_back(carla::nav::VehicleCollisionInfo{actor.id, actor.transform, it->second.bounding_box});
+      }
+    }
+
+    // get the description of the new actors only
+    if (!_new_actors.empty()) {
+      for (auto &&actor : episode->GetActorsById(_new_actors)) {
+        const bool is_vehicle = (actor.description.id.rfind("vehicle.", 0) == 0);
+        if (!_known_actors.emplace(actor.id, KnownActor{is_vehicle, actor.bounding_box, _vehicles_update}).second) {
+          continue;
+        }
+        ++actors_in_state;
+        if (is_vehicle) {
+          // get the snapshot
+          ActorSnapshot snapshot = state->GetActorSnapshot(actor.id);
+          _vehicles.emplace_back(carla::nav::VehicleCollisionInfo{actor.id, snapshot.transform, actor.bounding_box});
+        }
+      }
+    }
+
+    // forget the actors destroyed since last tick, which are the known actors
+    // not found in the current state (comparing the sizes alone misses an
+    // actor destroyed in the same tick another one is spawned)
+    if (_known_actors.size() != actors_in_state) {
+      for (auto it = _known_actors.begin(); it != _known_actors.end();) {
+        if (it->second.update != _vehicles_update) {
+          if (it->second.is_vehicle) {
+            _removed_vehicles.emplace_back(it->first);
+          }
+          it = _known_actors.erase(it);
+        } else {
+          ++it;
+        }
       }
     }
 
     // update the vehicles found
-    _nav.UpdateVehicles(vehicles);
+    _nav.UpdateVehicles(_vehicles, _removed_vehicles);
 
     // optional debug info
     if (show_debug) {
-      if (_nav.GetCrowd() == nullptr) return;
-
-      // draw bounding boxes for debug
-      for (int i = 0; i < _nav.GetCrowd()->getAgentCount(); ++i) {
-        // get the agent
-        const dtCrowdAgent *agent = _nav.GetCrowd()->getAgent(i);
-        if (agent && agent->params.useObb) {
-          // draw for debug
-          carla::geom::Location p1, p2, p3, p4;
-          p1.x = agent->params.obb[0];
-          p1.z = agent->params.obb[1];
-          p1.y = agent->params.obb[2];
-          p2.x = agent->params.obb[3];
-          p2.z = agent->params.obb[4];
-          p2.y = agent->params.obb[5];
-          p3.x = agent->params.obb[6];
-          p3.z = agent->params.obb[7];
-          p3.y = agent->params.obb[8];
-          p4.x = agent->params.obb[9];
-          p4.z = agent->params.obb[10];
-          p4.y = agent->params.obb[11];
-          carla::rpc::DebugShape line1;
-          line1.life_time = 0.01f;
-          line1.persistent_lines = false;
-          // line 1
-          line1.primitive = carla::rpc::DebugShape::Line {p1, p2, 0.2f};
-          line1.color = { 0, 255, 0 };
-          _client.DrawDebugShape(line1);
-          // line 2
-          line1.primitive = carla::rpc::DebugShape::Line {p2, p3, 0.2f};
-          line1.color = { 255, 0, 0 };
-          _client.DrawDebugShape(line1);
-          // line 3
-          line1.primitive = carla::rpc::DebugShape::Line {p3, p4, 0.2f};
-          line1.color = { 0, 0, 255 };
-          _client.DrawDebugShape(line1);
-          // line 4
-          line1.primitive = carla::rpc::DebugShape::Line {p4, p1, 0.2f};
-          line1.color = { 255, 255, 0 };
-          _client.DrawDebugShape(line1);
+      // one crowd by tile
+      for (dtCrowd *crowd : _nav.GetCrowds()) {
+        // draw bounding boxes for debug
+        for (int i = 0; i < crowd->getAgentCount(); ++i) {
+          // get the agent
+          const dtCrowdAgent *agent = crowd->getAgent(i);
+          if (agent && agent->params.useObb) {
+            // draw for debug
+            carla::geom::Location p1, p2, p3, p4;
+            p1.x = agent->params.obb[0];
+            p1.z = agent->params.obb[1];
+            p1.y = agent->params.obb[2];
+            p2.x = agent->params.obb[3];
+            p2.z = agent->params.obb[4];
+            p2.y = agent->params.obb[5];
+            p3.x = agent->params.obb[6];
+            p3.z = agent->params.obb[7];
+            p3.y = agent->params.obb[8];
+            p4.x = agent->params.obb[9];
+            p4.z = agent->params.obb[10];
+            p4.y = agent->params.obb[11];
+            carla::rpc::DebugShape line1;
+            line1.life_time = 0.01f;
+            line1.persistent_lines = false;
+            // line 1
+            line1.primitive = carla::rpc::DebugShape::Line {p1, p2, 0.2f};
+            line1.color = { 0, 255, 0 };
+            _client.DrawDebugShape(line1);
+            // line 2
+            line1.primitive = carla::rpc::DebugShape::Line {p2, p3, 0.2f};
+            line1.color = { 255, 0, 0 };
+            _client.DrawDebugShape(line1);
+            // line 3
+            line1.primitive = carla::rpc::DebugShape::Line {p3, p4, 0.2f};
+            line1.color = { 0, 0, 255 };
+            _client.DrawDebugShape(line1);
+            // line 4
+            line1.primitive = carla::rpc::DebugShape::Line {p4, p1, 0.2f};
+            line1.color = { 255, 255, 0 };
+            _client.DrawDebugShape(line1);
+          }
         }
-      }
 
-      // draw some text for debug
-      for (int i = 0; i < _nav.GetCrowd()->getAgentCount(); ++i) {
-        // get the agent
-        const dtCrowdAgent *agent = _nav.GetCrowd()->getAgent(i);
-        if (agent) {
-          // draw for debug
-          carla::geom::Location p1(agent->npos[0], agent->npos[2], agent->npos[1] + 1);
-          if (agent->params.userData) {
-            std::ostringstream out;
-            out << *(reinterpret_cast<const float *>(agent->params.userData));
-            carla::rpc::DebugShape text;
-            text.life_time = 0.01f;
-            text.persistent_lines = false;
-            text.primitive = carla::rpc::DebugShape::String {p1, out.str(), false};
-            text.color = { 0, 255, 0 };
-            _client.DrawDebugShape(text);
+        // draw some text for debug
+        for (int i = 0; i < crowd->getAgentCount(); ++i) {
+          // get the agent
+          const dtCrowdAgent *agent = crowd->getAgent(i);
+          if (agent) {
+            // draw for debug
+            carla::geom::Location p1(agent->npos[0], agent->npos[2], agent->npos[1] + 1);
+            if (agent->params.userData) {
+              std::ostringstream out;
+              out << *(reinterpret_cast<const float *>(agent->params.userData));
+              carla::rpc::DebugShape text;
+              text.life_time = 0.01f;
+              text.persistent_lines = false;
+              text.primitive = carla::rpc::DebugShape::String {p1, out.str(), false};
+              text.color = { 0, 255, 0 };
+              _client.DrawDebugShape(text);
+            }
           }
         }
       }
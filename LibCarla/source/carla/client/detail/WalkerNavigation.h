@@ -14,6 +14,8 @@
 #include "carla/rpc/ActorId.h"
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -104,6 +106,24 @@ namespace detail {
 
     AtomicList<WalkerHandle> _walkers;
 
+    struct KnownActor {
+      bool is_vehicle;
+      geom::BoundingBox bounding_box;
+      /// last update the actor was in the episode
+      uint64_t update;
+    };
+
+    /// actors of the episode seen so far, to only request the description of
+    /// the new ones
+    std::unordered_map<ActorId, KnownActor> _known_actors;
+
+    uint64_t _vehicles_update { 0u };
+
+    /// reused each tick
+    std::vector<ActorId> _new_actors;
+    std::vector<carla::nav::VehicleCollisionInfo> _vehicles;
+    std::vector<ActorId> _removed_vehicles;
+
     /// check a few walkers and if they don't exist then remove from the crowd
     void CheckIfWalkerExist(std::vector<WalkerHandle> walkers, const EpisodeState &state);
     /// add/update/delete all vehicles in crowd
@@ -37,6 +37,13 @@ namespace geom {
       _rtree.insert(elements.begin(), elements.end());
     }
 
+    /// Replace the content of the tree by @a elements. Builds the tree with
+    /// the packing algorithm, faster than inserting the elements one by one
+    /// and giving a better balanced tree.
+    void BulkLoad(const std::vector<TreeElement> &elements) {
+      _rtree = decltype(_rtree)(elements.begin(), elements.end());
+    }
+
     /// Return nearest neighbors with a user defined filter.
     /// The filter reveices as an argument a TreeElement value and needs to
     /// return a bool to accept or reject the value
@@ -94,6 +101,18 @@ namespace geom {
       _rtree.insert(elements.begin(), elements.end());
     }
 
+    /// Replace the content of the tree by @a elements. Builds the tree with
+    /// the packing algorithm, faster than inserting the elements one by one
+    /// and giving a better balanced tree.
+    void BulkLoad(const std::vector<TreeElement> &elements) {
+      _rtree = decltype(_rtree)(elements.begin(), elements.end());
+    }
+
+    /// Return all the elements of the tree, in no particular order.
+    std::vector<TreeElement> GetElements() const {
+      return {_rtree.begin(), _rtree.end()};
+    }
+
     /// Return nearest neighbors with a user defined filter.
     /// The filter reveices as an argument a TreeElement value and needs to
     /// return a bool to accept or reject the value
@@ -105,11 +124,24 @@ namespace geom {
         Filter filter,
         size_t number_neighbours = 1) const {
       std::vector<TreeElement> query_result;
+      GetNearestNeighboursWithFilter(geometry, filter, query_result, number_neighbours);
+      return query_result;
+    }
+
+    /// Same as above, but writes the result to @a query_result, replacing its
+    /// content. Reusing the same vector for several queries avoids allocating
+    /// a new one each time.
+    template <typename Geometry, typename Filter>
+    void GetNearestNeighboursWithFilter(
+        const Geometry &geometry,
+        Filter filter,
+        std::vector<TreeElement> &query_result,
+        size_t number_neighbours = 1) const {
+      query_result.clear();
       _rtree.query(
           boost::geometry::index::nearest(geometry, static_cast<unsigned int>(number_neighbours)) &&
               boost::geometry::index::satisfies(filter),
           std::back_inserter(query_result));
-      return query_result;
     }
 
     template<typename Geometry>
@@ -0,0 +1,242 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/image/ColorConverterKernels.h"
+
+#include "carla/image/BoostGil.h"
+#include "carla/image/ColorConverter.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LIBCARLA_IMAGE_WITH_SSE2
+#  include <emmintrin.h>
+#endif
+
+#if defined(LIBCARLA_IMAGE_WITH_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#  define LIBCARLA_IMAGE_WITH_AVX2
+#  include <immintrin.h>
+#endif
+
+namespace carla {
+namespace image {
+
+  static constexpr size_t bytes_per_pixel = 4u;
+
+  // ===========================================================================
+  // -- Reference ---------------------------------------------------------------
+  // ===========================================================================
+
+  /// Depth encoded in the colour of a pixel, same as ColorConverter::Depth.
+  static uint32_t GetEncodedDepth(const uint8_t *bgra) {
+    return uint32_t(bgra[2u]) + (uint32_t(bgra[1u]) << 8u) + (uint32_t(bgra[0u]) << 16u);
+  }
+
+  static void SetGray(uint8_t *bgra, const uint8_t value) {
+    bgra[0u] = value;
+    bgra[1u] = value;
+    bgra[2u] = value;
+    bgra[3u] = 255u;
+  }
+
+  /// Output of the Boost.GIL logarithmic depth path for an encoded depth.
+  static uint8_t ConvertLogarithmicDepth(const uint32_t depth) {
+    using namespace boost::gil;
+    bgra8_pixel_t src;
+    get_color(src, red_t()) = static_cast<uint8_t>(depth);
+    get_color(src, green_t()) = static_cast<uint8_t>(depth >> 8u);
+    get_color(src, blue_t()) = static_cast<uint8_t>(depth >> 16u);
+    get_color(src, alpha_t()) = 255u;
+    gray32f_pixel_t intermediate;
+    ColorConverter::Depth()(src, intermediate);
+    bgra8_pixel_t dst;
+    ColorConverter::LogarithmicLinear()(intermediate, dst);
+    return get_color(dst, red_t());
+  }
+
+  // ===========================================================================
+  // -- Depth ------------------------------------------------------------------
+  // ===========================================================================
+
+  static constexpr float max_depth = static_cast<float>(256 * 256 * 256 - 1);
+
+  static void DepthScalar(uint8_t *bgra, const size_t number_of_pixels) {
+    for (size_t i = 0u; i < number_of_pixels; ++i, bgra += bytes_per_pixel) {
+      const float normalized = static_cast<float>(GetEncodedDepth(bgra)) / max_depth;
+      SetGray(bgra, static_cast<uint8_t>(normalized * 255 + 0.5f));
+    }
+  }
+
+#ifdef LIBCARLA_IMAGE_WITH_SSE2
+
+  static size_t DepthSSE2(uint8_t *bgra, const size_t number_of_pixels) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128 divisor = _mm_set1_ps(max_depth);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i = 0u;
+    for (; i + 4u <= number_of_pixels; i += 4u, bgra += 4u * bytes_per_pixel) {
+      const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bgra));
+      const __m128i depth = _mm_add_epi32(
+          _mm_add_epi32(
+              _mm_and_si128(_mm_srli_epi32(pixels, 16), mask),
+              _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(pixels, 8), mask), 8)),
+          _mm_slli_epi32(_mm_and_si128(pixels, mask), 16));
+      const __m128 normalized = _mm_div_ps(_mm_cvtepi32_ps(depth), divisor);
+      const __m128i value = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(normalized, scale), half));
+      const __m128i gray = _mm_or_si128(
+          _mm_or_si128(value, _mm_slli_epi32(value, 8)),
+          _mm_or_si128(_mm_slli_epi32(value, 16), alpha));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(bgra), gray);
+    }
+    return i;
+  }
+
+#endif // LIBCARLA_IMAGE_WITH_SSE2
+
+#ifdef LIBCARLA_IMAGE_WITH_AVX2
+
+  __attribute__((target("avx2")))
+  static size_t DepthAVX2(uint8_t *bgra, const size_t number_of_pixels) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256 divisor = _mm256_set1_ps(max_depth);
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t i = 0u;
+    for (; i + 8u <= number_of_pixels; i += 8u, bgra += 8u * bytes_per_pixel) {
+      const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bgra));
+      const __m256i depth = _mm256_add_epi32(
+          _mm256_add_epi32(
+              _mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask),
+              _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask), 8)),
+          _mm256_slli_epi32(_mm256_and_si256(pixels, mask), 16));
+      const __m256 normalized = _mm256_div_ps(_mm256_cvtepi32_ps(depth), divisor);
+      // Multiply and add separately, a fused multiply-add rounds differently.
+      const __m256i value = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(normalized, scale), half));
+      const __m256i gray = _mm256_or_si256(
+          _mm256_or_si256(value, _mm256_slli_epi32(value, 8)),
+          _mm256_or_si256(_mm256_slli_epi32(value, 16), alpha));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(bgra), gray);
+    }
+    return i;
+  }
+
+  static bool HasAVX2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+  }
+
+#endif // LIBCARLA_IMAGE_WITH_AVX2
+
+  void ColorConverterKernels::Depth(uint8_t *bgra, const size_t number_of_pixels) {
+    size_t done = 0u;
+#if defined(LIBCARLA_IMAGE_WITH_AVX2)
+    done = HasAVX2() ?
+        DepthAVX2(bgra, number_of_pixels) :
+        DepthSSE2(bgra, number_of_pixels);
+#elif defined(LIBCARLA_IMAGE_WITH_SSE2)
+    done = DepthSSE2(bgra, number_of_pixels);
+#endif
+    DepthScalar(bgra + done * bytes_per_pixel, number_of_pixels - done);
+  }
+
+  // ===========================================================================
+  // -- LogarithmicDepth -------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    /// For each block of 256 consecutive encoded depths, the output at the
+    /// start of the block and the offset in the block at which the output
+    /// increases by one, or 256 if it doesn't. The logarithm changes slowly
+    /// enough for the output to change at most once per block, otherwise the
+    /// table is left empty and the reference conversion is used instead.
+    class LogarithmicDepthTable {
+    public:
+
+      LogarithmicDepthTable() {
+        std::vector<uint32_t> entries(number_of_blocks);
+        for (uint32_t block = 0u; block < number_of_blocks; ++block) {
+          const uint32_t first = block << 8u;
+          const uint8_t value = ConvertLogarithmicDepth(first);
+          const uint8_t last = ConvertLogarithmicDepth(first + 255u);
+          uint32_t step = 256u;
+          if (last == value + 1u) {
+            // Binary search for the first depth with the next value.
+            uint32_t low = 1u;
+            step = 255u;
+            while (low < step) {
+              const uint32_t middle = (low + step) / 2u;
+              if (ConvertLogarithmicDepth(first + middle) == value) {
+                low = middle + 1u;
+              } else {
+                step = middle;
+              }
+            }
+          } else if (last != value) {
+            return;
+          }
+          entries[block] = value | (step << 8u);
+        }
+        _entries = std::move(entries);
+      }
+
+      bool IsValid() const {
+        return !_entries.empty();
+      }
+
+      uint8_t Convert(const uint32_t depth) const {
+        const uint32_t entry = _entries[depth >> 8u];
+        return static_cast<uint8_t>((entry & 0xFFu) + ((depth & 0xFFu) >= (entry >> 8u) ? 1u : 0u));
+      }
+
+    private:
+
+      static constexpr uint32_t number_of_blocks = (256u * 256u * 256u) / 256u;
+
+      std::vector<uint32_t> _entries;
+    };
+
+  } // namespace
+
+  void ColorConverterKernels::LogarithmicDepth(uint8_t *bgra, const size_t number_of_pixels) {
+    static const LogarithmicDepthTable table;
+    if (table.IsValid()) {
+      for (size_t i = 0u; i < number_of_pixels; ++i, bgra += bytes_per_pixel) {
+        SetGray(bgra, table.Convert(GetEncodedDepth(bgra)));
+      }
+    } else {
+      for (size_t i = 0u; i < number_of_pixels; ++i, bgra += bytes_per_pixel) {
+        SetGray(bgra, ConvertLogarithmicDepth(GetEncodedDepth(bgra)));
+      }
+    }
+  }
+
+  // ===========================================================================
+  // -- CityScapesPalette ------------------------------------------------------
+  // ===========================================================================
+
+  void ColorConverterKernels::CityScapesPalette(uint8_t *bgra, const size_t number_of_pixels) {
+    using Palette = std::array<std::array<uint8_t, bytes_per_pixel>, 256u>;
+    static const Palette palette = []() {
+      Palette result;
+      for (auto tag = 0u; tag < result.size(); ++tag) {
+        const auto color = image::CityScapesPalette::GetColor(static_cast<uint8_t>(tag));
+        result[tag] = {color[2u], color[1u], color[0u], 255u};
+      }
+      return result;
+    }();
+    for (size_t i = 0u; i < number_of_pixels; ++i, bgra += bytes_per_pixel) {
+      std::memcpy(bgra, palette[bgra[2u]].data(), bytes_per_pixel);
+    }
+  }
+
+} // namespace image
+} // namespace carla
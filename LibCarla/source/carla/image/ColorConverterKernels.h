@@ -0,0 +1,38 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace image {
+
+  /// Converters working directly on contiguous rows of BGRA 8-bit pixels, the
+  /// layout of the images sent by the simulator. Used by
+  /// ImageConverter::ConvertInPlace instead of converting pixel by pixel
+  /// through Boost.GIL.
+  ///
+  /// The output is bit-exact with the corresponding ColorConverter:
+  ///
+  ///   - Depth does the same floating point operations on 4 or 8 pixels at a
+  ///     time with SSE2 or AVX2, the latter selected at run-time.
+  ///   - LogarithmicDepth looks up a table of the depths at which the output
+  ///     changes, built once from ColorConverter::LogarithmicLinear.
+  ///   - CityScapesPalette looks up the BGRA value of each tag.
+  class ColorConverterKernels {
+  public:
+
+    static void Depth(uint8_t *bgra, size_t number_of_pixels);
+
+    static void LogarithmicDepth(uint8_t *bgra, size_t number_of_pixels);
+
+    static void CityScapesPalette(uint8_t *bgra, size_t number_of_pixels);
+  };
+
+} // namespace image
+} // namespace carla
@@ -6,8 +6,11 @@
 
 #pragma once
 
+#include "carla/image/ColorConverterKernels.h"
 #include "carla/image/ImageView.h"
 
+#include <type_traits>
+
 namespace carla {
 namespace image {
 
@@ -23,11 +26,63 @@ namespace image {
     static void ConvertInPlace(
         MutableImageView &image_view,
         ColorConverter converter = ColorConverter()) {
+      ConvertInPlace(image_view, converter, IsBgra8View<MutableImageView>());
+    }
+
+  private:
+
+    template <typename ViewT>
+    using IsBgra8View = std::is_same<
+        typename ViewT::x_iterator,
+        boost::gil::bgra8_ptr_t>;
+
+    template <typename ColorConverter, typename MutableImageView>
+    static void ConvertInPlace(
+        MutableImageView &image_view,
+        ColorConverter converter,
+        std::false_type) {
       using DstPixelT = typename MutableImageView::value_type;
       CopyPixels(
           ImageView::MakeColorConvertedView<MutableImageView, DstPixelT>(image_view, converter),
           image_view);
     }
+
+    /// BGRA images, as sent by the simulator, are converted row by row with
+    /// ColorConverterKernels if there is one for @a converter.
+    template <typename ColorConverter, typename MutableImageView>
+    static void ConvertInPlace(
+        MutableImageView &image_view,
+        ColorConverter converter,
+        std::true_type) {
+      auto kernel = GetKernel(converter);
+      if (kernel == nullptr) {
+        ConvertInPlace(image_view, converter, std::false_type());
+        return;
+      }
+      const auto width = static_cast<size_t>(image_view.width());
+      for (decltype(image_view.height()) y = 0; y < image_view.height(); ++y) {
+        kernel(reinterpret_cast<uint8_t *>(image_view.row_begin(y)), width);
+      }
+    }
+
+    using Kernel = void (*)(uint8_t *, size_t);
+
+    template <typename ColorConverter>
+    static Kernel GetKernel(ColorConverter) {
+      return nullptr;
+    }
+
+    static Kernel GetKernel(ColorConverter::Depth) {
+      return ColorConverterKernels::Depth;
+    }
+
+    static Kernel GetKernel(ColorConverter::LogarithmicDepth) {
+      return ColorConverterKernels::LogarithmicDepth;
+    }
+
+    static Kernel GetKernel(ColorConverter::CityScapesPalette) {
+      return ColorConverterKernels::CityScapesPalette;
+    }
   };
 
 } // namespace image
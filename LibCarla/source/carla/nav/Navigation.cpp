@@ -13,9 +13,12 @@
 #include "carla/nav/WalkerManager.h"
 #include "carla/geom/Math.h"
 
+#include <algorithm>
+#include <future>
 #include <iterator>
 #include <fstream>
 #include <mutex>
+#include <thread>
 
 namespace carla {
 namespace nav {
@@ -31,7 +34,7 @@ namespace nav {
   // these settings are the same than in RecastBuilder, so if you change the height of the agent, 
   // you should do the same in RecastBuilder
   static const int   MAX_POLYS = 256;
-  static const int   MAX_AGENTS = 500;
+  static const int   MAX_AGENTS_PER_TILE = 1000;
   static const int   MAX_QUERY_SEARCH_NODES = 2048;
   static const float AGENT_HEIGHT = 1.8f;
   static const float AGENT_RADIUS = 0.3f;
@@ -40,6 +43,15 @@ namespace nav {
   static const float AGENT_UNBLOCK_DISTANCE_SQUARED = AGENT_UNBLOCK_DISTANCE * AGENT_UNBLOCK_DISTANCE;
   static const float AGENT_UNBLOCK_TIME = 4.0f;
 
+  // size of the square tiles the crowd is split in
+  static const float TILE_SIZE = 100.0f;
+  // distance a walker goes past the border of its tile before moving to the neighbour tile
+  static const float TILE_HANDOFF_DISTANCE = 2.0f;
+  static const float TILE_HANDOFF_DISTANCE_SQUARED = TILE_HANDOFF_DISTANCE * TILE_HANDOFF_DISTANCE;
+  // distance to the border of a neighbour tile to be avoided by its walkers
+  static const float TILE_WALKER_OBSTACLE_DISTANCE = 3.0f;
+  static const float TILE_VEHICLE_OBSTACLE_DISTANCE = 10.0f;
+
   static const float AREA_GRASS_COST =  1.0f;
   static const float AREA_ROAD_COST  = 10.0f;
 
@@ -48,6 +60,58 @@ namespace nav {
     return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
   }
 
+  static int GetTileCoordinate(float value) {
+    return static_cast<int>(std::floor(value / TILE_SIZE));
+  }
+
+  static uint64_t GetTileKey(int x, int y) {
+    // shift as unsigned, shifting a negative signed value is undefined
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+  }
+
+  /// A square area of the map with its own crowd. The walkers belong to the
+  /// tile they are in, the vehicles and the walkers of neighbour tiles close
+  /// to it are added as obstacles.
+  struct Navigation::CrowdTile {
+
+    CrowdTile(int tile_x, int tile_y, dtCrowd *tile_crowd)
+      : x(tile_x), y(tile_y), crowd(tile_crowd) {}
+
+    ~CrowdTile() {
+      dtFreeCrowd(crowd);
+    }
+
+    // squared distance from a point (in Unreal coordinates) to the tile
+    float SquaredDistance(float px, float py) const {
+      const float min_x = static_cast<float>(x) * TILE_SIZE;
+      const float min_y = static_cast<float>(y) * TILE_SIZE;
+      const float dx = std::max(std::max(min_x - px, px - (min_x + TILE_SIZE)), 0.0f);
+      const float dy = std::max(std::max(min_y - py, py - (min_y + TILE_SIZE)), 0.0f);
+      return dx * dx + dy * dy;
+    }
+
+    // remove an agent added as obstacle
+    void RemoveObstacle(ActorId id) {
+      auto it = obstacles.find(id);
+      if (it != obstacles.end()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        crowd->removeAgent(it->second);
+        obstacles.erase(it);
+      }
+    }
+
+    const int x;
+    const int y;
+    dtCrowd *crowd;
+    std::mutex mutex;
+    /// walkers by agent index
+    std::unordered_map<int, ActorId> walkers;
+    /// agent index of the vehicles and walkers of other tiles
+    std::unordered_map<ActorId, int> obstacles;
+    /// saves the position of each walker at intervals and check if any is blocked
+    std::unordered_map<int, carla::geom::Vector3D> blocked_position;
+  };
+
   Navigation::Navigation() {
     // assign walker manager
     _walker_manager.SetNav(this);
@@ -56,13 +120,13 @@ namespace nav {
   Navigation::~Navigation() {
     _ready = false;
     _time_to_unblock = 0.0f;
+    _thread_pool.reset();
     _mapped_walkers_id.clear();
-    _mapped_vehicles_id.clear();
-    _mapped_by_index.clear();
-    _walkers_blocked_position.clear();
+    _vehicles.clear();
+    _obstacle_tiles.clear();
     _yaw_walkers.clear();
     _binary_mesh.clear();
-    dtFreeCrowd(_crowd);
+    _tiles.clear();
     dtFreeNavMeshQuery(_nav_query);
     dtFreeNavMesh(_nav_mesh);
   }
@@ -181,71 +245,68 @@ namespace nav {
     _nav_query = dtAllocNavMeshQuery();
     _nav_query->init(_nav_mesh, MAX_QUERY_SEARCH_NODES);
 
+    // the crowds are created by tile as the walkers are added
+    _tiles.clear();
+    _mapped_walkers_id.clear();
+    _vehicles.clear();
+    _obstacle_tiles.clear();
+
     // copy
     _binary_mesh = std::move(content);
     _ready = true;
 
-    // create and init the crowd manager
-    CreateCrowd();
-
     return true;
   }
 
-  void Navigation::CreateCrowd(void) {
-
-    // check if all is ready
-    if (!_ready) {
-      return;
-    }
-
-    DEBUG_ASSERT(_crowd == nullptr);
+  dtCrowd *Navigation::CreateCrowd() {
 
     // create and init
-    _crowd = dtAllocCrowd();
+    dtCrowd *crowd = dtAllocCrowd();
     // these radius should be the maximum size of the vehicles (CarlaCola for Carla)
     const float max_agent_radius = AGENT_RADIUS * 20;
-    if (!_crowd->init(MAX_AGENTS, max_agent_radius, _nav_mesh)) {
+    if (!crowd->init(MAX_AGENTS_PER_TILE, max_agent_radius, _nav_mesh)) {
       logging::log("Nav: failed to create crowd");
-      return;
+      dtFreeCrowd(crowd);
+      return nullptr;
     }
 
     // set different filters
     // filter 0 can not walk on roads
-    _crowd->getEditableFilter(0)->setIncludeFlags(CARLA_TYPE_WALKABLE);
-    _crowd->getEditableFilter(0)->setExcludeFlags(CARLA_TYPE_ROAD);
-    _crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
-    _crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
+    crowd->getEditableFilter(0)->setIncludeFlags(CARLA_TYPE_WALKABLE);
+    crowd->getEditableFilter(0)->setExcludeFlags(CARLA_TYPE_ROAD);
+    crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
+    crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
     // filter 1 can walk on roads
-    _crowd->getEditableFilter(1)->setIncludeFlags(CARLA_TYPE_WALKABLE);
-    _crowd->getEditableFilter(1)->setExcludeFlags(CARLA_TYPE_NONE);
-    _crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
-    _crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
+    crowd->getEditableFilter(1)->setIncludeFlags(CARLA_TYPE_WALKABLE);
+    crowd->getEditableFilter(1)->setExcludeFlags(CARLA_TYPE_NONE);
+    crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
+    crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
 
     // Setup local avoidance params to different qualities.
     dtObstacleAvoidanceParams params;
     // Use mostly default settings, copy from dtCrowd.
-    memcpy(&params, _crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
+    memcpy(&params, crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
 
     // Low (11)
     params.velBias = 0.5f;
     params.adaptiveDivs = 5;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 1;
-    _crowd->setObstacleAvoidanceParams(0, &params);
+    crowd->setObstacleAvoidanceParams(0, &params);
 
     // Medium (22)
     params.velBias = 0.5f;
     params.adaptiveDivs = 5;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 2;
-    _crowd->setObstacleAvoidanceParams(1, &params);
+    crowd->setObstacleAvoidanceParams(1, &params);
 
     // Good (45)
     params.velBias = 0.5f;
     params.adaptiveDivs = 7;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 3;
-    _crowd->setObstacleAvoidanceParams(2, &params);
+    crowd->setObstacleAvoidanceParams(2, &params);
 
     // High (66)
     params.velBias = 0.5f;
@@ -253,7 +314,61 @@ namespace nav {
     params.adaptiveRings = 3;
     params.adaptiveDepth = 3;
 
-    _crowd->setObstacleAvoidanceParams(3, &params);
+    crowd->setObstacleAvoidanceParams(3, &params);
+
+    return crowd;
+  }
+
+  // return the tile at a location, creating it if needed
+  Navigation::CrowdTile *Navigation::GetOrCreateTile(float x, float y) {
+    const int tile_x = GetTileCoordinate(x);
+    const int tile_y = GetTileCoordinate(y);
+    auto &tile = _tiles[GetTileKey(tile_x, tile_y)];
+    if (tile == nullptr) {
+      dtCrowd *crowd = CreateCrowd();
+      if (crowd == nullptr) {
+        _tiles.erase(GetTileKey(tile_x, tile_y));
+        return nullptr;
+      }
+      tile = std::make_unique<CrowdTile>(tile_x, tile_y, crowd);
+    }
+    return tile.get();
+  }
+
+  // find the tiles with walkers closer than distance to a location
+  void Navigation::GetTilesNear(
+      float x,
+      float y,
+      float distance,
+      const CrowdTile *except,
+      std::vector<CrowdTile *> &tiles) {
+    tiles.clear();
+    const int min_x = GetTileCoordinate(x - distance);
+    const int max_x = GetTileCoordinate(x + distance);
+    const int min_y = GetTileCoordinate(y - distance);
+    const int max_y = GetTileCoordinate(y + distance);
+    for (int tile_x = min_x; tile_x <= max_x; ++tile_x) {
+      for (int tile_y = min_y; tile_y <= max_y; ++tile_y) {
+        auto it = _tiles.find(GetTileKey(tile_x, tile_y));
+        // a tile without walkers doesn't need obstacles
+        if (it == _tiles.end() || it->second.get() == except || it->second->walkers.empty()) {
+          continue;
+        }
+        if (it->second->SquaredDistance(x, y) <= distance * distance) {
+          tiles.emplace_back(it->second.get());
+        }
+      }
+    }
+  }
+
+  // find a walker
+  bool Navigation::FindWalker(ActorId id, AgentIndex &agent) const {
+    auto it = _mapped_walkers_id.find(id);
+    if (it == _mapped_walkers_id.end()) {
+      return false;
+    }
+    agent = it->second;
+    return true;
   }
 
   // return the path points to go from one position to another
@@ -361,7 +476,6 @@ namespace nav {
 
     return true;
   }
-
   bool Navigation::GetAgentRoute(ActorId id, carla::geom::Location from, carla::geom::Location to,
   std::vector<carla::geom::Location> &path, std::vector<unsigned char> &area) {
     // path found
@@ -386,15 +500,17 @@ namespace nav {
     float poly_pick_ext[3] = {2,4,2};
 
     // get current filter from agent
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end())
-      return false;
-
-    const dtQueryFilter *filter;
+    dtQueryFilter filter;
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      filter = _crowd->getFilter(_crowd->getAgent(it->second)->params.queryFilterType);
+      AgentIndex agent;
+      if (!FindWalker(id, agent)) {
+        return false;
+      }
+      std::lock_guard<std::mutex> tile_lock(agent.tile->mutex);
+      dtCrowd *crowd = agent.tile->crowd;
+      filter = *crowd->getFilter(crowd->getAgent(agent.index)->params.queryFilterType);
     }
 
     // set the points
@@ -405,8 +521,8 @@ namespace nav {
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
-      _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
+      _nav_query->findNearestPoly(start_pos, poly_pick_ext, &filter, &start_ref, 0);
+      _nav_query->findNearestPoly(end_pos, poly_pick_ext, &filter, &end_ref, 0);
     }
     if (!start_ref || !end_ref) {
       return false;
@@ -416,7 +532,7 @@ namespace nav {
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
+      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, &filter, polys, &num_polys, MAX_POLYS);
     }
 
     // get the path of points
@@ -471,8 +587,6 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // set parameters
     memset(&params, 0, sizeof(params));
     params.radius = AGENT_RADIUS;
@@ -499,23 +613,30 @@ namespace nav {
     // from Unreal coordinates (subtract half height to move pivot from center
     // (unreal) to bottom (recast))
     float point_from[3] = { from.x, from.z - (AGENT_HEIGHT / 2.0f), from.y };
-    // add walker
-    int index;
+    // add walker to the crowd of its tile
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      index = _crowd->addAgent(point_from, &params);
+      CrowdTile *tile = GetOrCreateTile(from.x, from.y);
+      if (tile == nullptr) {
+        return false;
+      }
+      int index;
+      {
+        std::lock_guard<std::mutex> tile_lock(tile->mutex);
+        index = tile->crowd->addAgent(point_from, &params);
+      }
       if (index == -1) {
         return false;
       }
-    }
 
-    // save the id
-    _mapped_walkers_id[id] = index;
-    _mapped_by_index[index] = id;
+      // save the id
+      tile->walkers[index] = id;
+      _mapped_walkers_id[id] = AgentIndex { tile, index };
 
-    // init yaw
-    _yaw_walkers[id] = 0.0f;
+      // init yaw
+      _yaw_walkers[id] = 0.0f;
+    }
 
     // add walker for the route planning
     _walker_manager.AddWalker(id);
@@ -525,20 +646,42 @@ namespace nav {
 
   // create a new vehicle in crowd to be avoided by walkers
   bool Navigation::AddOrUpdateVehicle(VehicleCollisionInfo &vehicle) {
-    namespace cg = carla::geom;
-    dtCrowdAgentParams params;
 
     // check if all is ready
     if (!_ready) {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+    UpdateVehicle(vehicle);
+
+    return true;
+  }
+
+  // add or update a vehicle in the tiles with walkers near it
+  void Navigation::UpdateVehicle(const VehicleCollisionInfo &vehicle) {
+    namespace cg = carla::geom;
+    dtCrowdAgentParams params;
 
     // get the bounding box extension plus some space around
     float marge = 0.8f;
     float hx = vehicle.bounding.extent.x + marge;
     float hy = vehicle.bounding.extent.y + marge;
+
+    // find the tiles where walkers could reach it
+    const float radius = std::sqrt((hx + 0.2f) * (hx + 0.2f) + hy * hy);
+    GetTilesNear(
+        vehicle.transform.location.x,
+        vehicle.transform.location.y,
+        radius + TILE_VEHICLE_OBSTACLE_DISTANCE,
+        nullptr,
+        _tiles_near);
+    _vehicles.insert(vehicle.id);
+    if (_tiles_near.empty() && _obstacle_tiles.find(vehicle.id) == _obstacle_tiles.end()) {
+      // far from every walker
+      return;
+    }
     // define the 4 corners of the bounding box
     cg::Vector3D box_corner1 {-hx, -hy, 0};
     cg::Vector3D box_corner2 { hx + 0.2f, -hy, 0};
@@ -556,42 +699,6 @@ namespace nav {
     box_corner3 += vehicle.transform.location;
     box_corner4 += vehicle.transform.location;
 
-    // check if this actor exists
-    auto it = _mapped_vehicles_id.find(vehicle.id);
-    if (it != _mapped_vehicles_id.end()) {
-      // get the index found
-      int index = it->second;
-      if (index != -1) {
-        // get the agent
-        dtCrowdAgent *agent;
-        {
-          // critical section, force single thread running this
-          std::lock_guard<std::mutex> lock(_mutex);
-          agent = _crowd->getEditableAgent(index);
-        }
-        if (agent) {
-          // update its position
-          agent->npos[0] = vehicle.transform.location.x;
-          agent->npos[1] = vehicle.transform.location.z;
-          agent->npos[2] = vehicle.transform.location.y;
-          // update its oriented bounding box
-          agent->params.obb[0]  = box_corner1.x;
-          agent->params.obb[1]  = box_corner1.z;
-          agent->params.obb[2]  = box_corner1.y;
-          agent->params.obb[3]  = box_corner2.x;
-          agent->params.obb[4]  = box_corner2.z;
-          agent->params.obb[5]  = box_corner2.y;
-          agent->params.obb[6]  = box_corner3.x;
-          agent->params.obb[7]  = box_corner3.z;
-          agent->params.obb[8]  = box_corner3.y;
-          agent->params.obb[9]  = box_corner4.x;
-          agent->params.obb[10] = box_corner4.z;
-          agent->params.obb[11] = box_corner4.y;
-        }
-        return true;
-      }
-    }
-
     // set parameters
     memset(&params, 0, sizeof(params));
     params.radius = 2;
@@ -626,30 +733,77 @@ namespace nav {
     float point_from[3] = { vehicle.transform.location.x,
                             vehicle.transform.location.z,
                             vehicle.transform.location.y };
+    float velocity[3] = { 0.0f, 0.0f, 0.0f };
 
-    // add walker
-    int index;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      index = _crowd->addAgent(point_from, &params);
-      if (index == -1) {
-        logging::log("Vehicle agent not added to the crowd by some problem!");
-        return false;
+    // add or update the vehicle in the tiles
+    SetObstacleTiles(vehicle.id, _tiles_near, params, point_from, velocity);
+  }
+
+  // make an agent an obstacle in exactly the given tiles
+  void Navigation::SetObstacleTiles(
+      ActorId id,
+      const std::vector<CrowdTile *> &tiles,
+      const dtCrowdAgentParams &params,
+      const float *position,
+      const float *velocity) {
+    auto it = _obstacle_tiles.find(id);
+    if (it == _obstacle_tiles.end()) {
+      if (tiles.empty()) {
+        return;
       }
+      it = _obstacle_tiles.emplace(id, std::vector<CrowdTile *>()).first;
+    }
 
-      // mark as valid
-      dtCrowdAgent *agent = _crowd->getEditableAgent(index);
-      if (agent) {
+    // remove from the tiles that are not near anymore
+    auto &current = it->second;
+    current.erase(std::remove_if(current.begin(), current.end(), [&](CrowdTile *tile) {
+      if (std::find(tiles.begin(), tiles.end(), tile) != tiles.end()) {
+        return false;
+      }
+      tile->RemoveObstacle(id);
+      return true;
+    }), current.end());
+
+    // add or update in the rest
+    for (CrowdTile *tile : tiles) {
+      std::lock_guard<std::mutex> tile_lock(tile->mutex);
+      dtCrowdAgent *agent;
+      auto obstacle = tile->obstacles.find(id);
+      if (obstacle != tile->obstacles.end()) {
+        // update its position and oriented bounding box
+        agent = tile->crowd->getEditableAgent(obstacle->second);
+        dtVcopy(agent->npos, position);
+        memcpy(agent->params.obb, params.obb, sizeof(params.obb));
+      } else {
+        const int index = tile->crowd->addAgent(position, &params);
+        if (index == -1) {
+          logging::log("Nav: obstacle agent not added to the crowd, the tile is full");
+          continue;
+        }
+        // mark as valid
+        agent = tile->crowd->getEditableAgent(index);
         agent->state = DT_CROWDAGENT_STATE_WALKING;
+        tile->obstacles[id] = index;
+        current.emplace_back(tile);
       }
+      dtVcopy(agent->vel, velocity);
     }
 
-    // save the id
-    _mapped_vehicles_id[vehicle.id] = index;
-    _mapped_by_index[index] = vehicle.id;
+    if (current.empty()) {
+      _obstacle_tiles.erase(it);
+    }
+  }
 
-    return true;
+  // remove an agent as obstacle from all the tiles
+  void Navigation::RemoveObstacle(ActorId id) {
+    auto it = _obstacle_tiles.find(id);
+    if (it == _obstacle_tiles.end()) {
+      return;
+    }
+    for (CrowdTile *tile : it->second) {
+      tile->RemoveObstacle(id);
+    }
+    _obstacle_tiles.erase(it);
   }
 
   // remove an agent
@@ -660,37 +814,35 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    std::unique_lock<std::mutex> lock(_mutex);
 
     // get the internal walker index
     auto it = _mapped_walkers_id.find(id);
     if (it != _mapped_walkers_id.end()) {
       // remove from crowd
+      CrowdTile *tile = it->second.tile;
+      const int index = it->second.index;
       {
-        // critical section, force single thread running this
-        std::lock_guard<std::mutex> lock(_mutex);
-        _crowd->removeAgent(it->second);
+        std::lock_guard<std::mutex> tile_lock(tile->mutex);
+        tile->crowd->removeAgent(index);
       }
-      _walker_manager.RemoveWalker(id);
+      tile->walkers.erase(index);
+      tile->blocked_position.erase(index);
       // remove from mapping
       _mapped_walkers_id.erase(it);
-      _mapped_by_index.erase(it->second);
+      // and from the neighbour tiles
+      RemoveObstacle(id);
+      lock.unlock();
+
+      _walker_manager.RemoveWalker(id);
 
       return true;
     }
 
-    // get the internal vehicle index
-    it = _mapped_vehicles_id.find(id);
-    if (it != _mapped_vehicles_id.end()) {
-      // remove from crowd
-      {
-        // critical section, force single thread running this
-        std::lock_guard<std::mutex> lock(_mutex);
-        _crowd->removeAgent(it->second);
-      }
-      // remove from mapping
-      _mapped_vehicles_id.erase(it);
-      _mapped_by_index.erase(it->second);
+    // get the vehicle
+    if (_vehicles.erase(id) > 0u) {
+      // remove from all crowds
+      RemoveObstacle(id);
 
       return true;
     }
@@ -703,27 +855,47 @@ namespace nav {
     std::unordered_set<carla::rpc::ActorId> updated;
 
     // add all current mapped vehicles in the set
-    for (auto &&entry : _mapped_vehicles_id) {
-      updated.insert(entry.first);
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      updated = _vehicles;
     }
 
-    // add all vehicles (if already exists, it gets updated only)
+    // mark as updated the vehicles of this frame
     for (auto &&entry : vehicles) {
-      // try to add or update the vehicle
-      AddOrUpdateVehicle(entry);
-      // mark as updated (to avoid removing it in this frame)
       updated.erase(entry.id);
     }
 
     // remove all vehicles not updated (they don't exist in this frame)
-    for (auto &&entry : updated) {
-      // remove agent not updated
-      RemoveAgent(entry);
-    }
+    UpdateVehicles(vehicles, std::vector<ActorId>(updated.begin(), updated.end()));
 
     return true;
   }
 
+  // add/update vehicles and delete removed vehicles in crowd
+  void Navigation::UpdateVehicles(
+      const std::vector<VehicleCollisionInfo> &vehicles,
+      const std::vector<ActorId> &removed_vehicles) {
+
+    // check if all is ready
+    if (!_ready) {
+      return;
+    }
+
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (ActorId id : removed_vehicles) {
+      if (_vehicles.erase(id) > 0u) {
+        RemoveObstacle(id);
+      }
+    }
+
+    // if already exists, it gets updated only
+    for (auto &&vehicle : vehicles) {
+      UpdateVehicle(vehicle);
+    }
+  }
+
   // set new max speed
   bool Navigation::SetWalkerMaxSpeed(ActorId id, float max_speed) {
 
@@ -732,23 +904,21 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
+    AgentIndex walker;
+    if (!FindWalker(id, walker)) {
       return false;
     }
 
     // get the agent
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      dtCrowdAgent *agent = _crowd->getEditableAgent(it->second);
-      if (agent) {
-        agent->params.maxSpeed = max_speed;
-        return true;
-      }
+    std::lock_guard<std::mutex> tile_lock(walker.tile->mutex);
+    dtCrowdAgent *agent = walker.tile->crowd->getEditableAgent(walker.index);
+    if (agent) {
+      agent->params.maxSpeed = max_speed;
+      return true;
     }
 
     return false;
@@ -763,9 +933,11 @@ namespace nav {
     }
 
     // get the internal index
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      return false;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_mapped_walkers_id.find(id) == _mapped_walkers_id.end()) {
+        return false;
+      }
     }
 
     return _walker_manager.SetWalkerRoute(id, to);
@@ -779,24 +951,21 @@ namespace nav {
       return false;
     }
 
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
     // get the internal index
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
+    AgentIndex walker;
+    if (!FindWalker(id, walker)) {
       return false;
     }
 
-    return SetWalkerDirectTargetIndex(it->second, to);
+    return SetAgentTarget(*walker.tile, walker.index, to);
   }
 
-  // set a new target point to go directly without events
-  bool Navigation::SetWalkerDirectTargetIndex(int index, carla::geom::Location to) {
+  // set a new target point to go directly for an agent
+  bool Navigation::SetAgentTarget(CrowdTile &tile, int index, carla::geom::Location to) {
 
-    // check if all is ready
-    if (!_ready) {
-      return false;
-    }
-
-    DEBUG_ASSERT(_crowd != nullptr);
     DEBUG_ASSERT(_nav_query != nullptr);
 
     if (index == -1) {
@@ -806,39 +975,39 @@ namespace nav {
     // set target position
     float point_to[3] = { to.x, to.z, to.y };
     float nearest[3];
-    bool res;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      const dtQueryFilter *filter = _crowd->getFilter(0);
-      dtPolyRef target_ref;
-      _nav_query->findNearestPoly(point_to, _crowd->getQueryHalfExtents(), filter, &target_ref, nearest);
-      if (!target_ref) {
-        return false;
-      }
-
-      res = _crowd->requestMoveTarget(index, target_ref, point_to);
+    std::lock_guard<std::mutex> tile_lock(tile.mutex);
+    const dtQueryFilter *filter = tile.crowd->getFilter(0);
+    dtPolyRef target_ref;
+    _nav_query->findNearestPoly(point_to, tile.crowd->getQueryHalfExtents(), filter, &target_ref, nearest);
+    if (!target_ref) {
+      return false;
     }
 
-    return res;
+    return tile.crowd->requestMoveTarget(index, target_ref, point_to);
   }
 
   // update all walkers in crowd
   void Navigation::UpdateCrowd(const client::detail::EpisodeState &state) {
+    UpdateCrowd(state.GetTimestamp().delta_seconds);
+  }
+
+  // update all walkers in crowd
+  void Navigation::UpdateCrowd(double delta_seconds) {
 
     // check if all is ready
     if (!_ready) {
       return;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
     // update crowd agents
-    _delta_seconds = state.GetTimestamp().delta_seconds;
+    _delta_seconds = delta_seconds;
+    UpdateTiles(static_cast<float>(_delta_seconds));
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      _crowd->update(static_cast<float>(_delta_seconds), nullptr);
+      HandOffWalkers();
+      UpdateWalkerObstacles();
+      FreeEmptyTiles();
     }
 
     // update the walkers route
@@ -847,70 +1016,249 @@ namespace nav {
     // update the time to check for blocked agents
     _time_to_unblock += _delta_seconds;
 
-    // check all active agents
-    int total_unblocked = 0;
-    int total_agents;
+    // check for unblocking actors
+    if (_time_to_unblock >= AGENT_UNBLOCK_TIME) {
+      for (ActorId id : GetBlockedWalkers()) {
+        // set a new random target
+        carla::geom::Location location;
+        GetRandomLocation(location, nullptr);
+        _walker_manager.SetWalkerRoute(id, location);
+      }
+      _time_to_unblock = 0.0f;
+    }
+  }
+
+  // update the crowds of all tiles
+  void Navigation::UpdateTiles(float delta_seconds) {
+    std::vector<CrowdTile *> tiles;
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      total_agents = _crowd->getAgentCount();
+      tiles.reserve(_tiles.size());
+      for (auto &entry : _tiles) {
+        if (!entry.second->walkers.empty()) {
+          tiles.emplace_back(entry.second.get());
+        }
+      }
     }
-    const dtCrowdAgent *ag;
-    for (int i = 0; i < total_agents; ++i) {
-      {
-        // critical section, force single thread running this
-        std::lock_guard<std::mutex> lock(_mutex);
-        ag = _crowd->getAgent(i);
+
+    auto update = [delta_seconds](CrowdTile *tile) {
+      std::lock_guard<std::mutex> tile_lock(tile->mutex);
+      tile->crowd->update(delta_seconds, nullptr);
+    };
+
+    // the crowds of the tiles are independent, update the first in this
+    // thread and the rest in the pool
+    std::vector<std::future<void>> updates;
+    if (tiles.size() > 1u) {
+      if (_thread_pool == nullptr) {
+        const unsigned cores = std::thread::hardware_concurrency();
+        _thread_pool = std::make_unique<ThreadPool>();
+        _thread_pool->AsyncRun(cores > 1u ? cores - 1u : 1u);
+      }
+      updates.reserve(tiles.size() - 1u);
+      for (size_t i = 1u; i < tiles.size(); ++i) {
+        CrowdTile *tile = tiles[i];
+        updates.emplace_back(_thread_pool->Post([&update, tile]() { update(tile); }));
+      }
+    }
+    if (!tiles.empty()) {
+      update(tiles[0u]);
+    }
+    for (auto &future : updates) {
+      future.get();
+    }
+  }
+
+  // move the walkers that left their tile to the tile they are in
+  void Navigation::HandOffWalkers() {
+    struct Move {
+      ActorId id;
+      float x;
+      float y;
+    };
+    std::vector<Move> moves;
+    for (auto &entry : _tiles) {
+      CrowdTile &tile = *entry.second;
+      std::lock_guard<std::mutex> tile_lock(tile.mutex);
+      for (auto &walker : tile.walkers) {
+        const dtCrowdAgent *agent = tile.crowd->getAgent(walker.first);
+        // keep the walker in its tile until it is a bit past the border, so
+        // it doesn't change tile back and forth walking along it
+        if (agent->active &&
+            tile.SquaredDistance(agent->npos[0], agent->npos[2]) > TILE_HANDOFF_DISTANCE_SQUARED) {
+          moves.emplace_back(Move { walker.second, agent->npos[0], agent->npos[2] });
+        }
       }
-      if (!ag->active || ag->paused) {
+    }
+    // out of the loop, as it can create tiles
+    for (auto &move : moves) {
+      CrowdTile *tile = GetOrCreateTile(move.x, move.y);
+      if (tile != nullptr) {
+        MoveWalker(move.id, *tile);
+      }
+    }
+  }
+
+  // move a walker to the crowd of another tile
+  bool Navigation::MoveWalker(ActorId id, CrowdTile &to) {
+    AgentIndex &walker = _mapped_walkers_id[id];
+    CrowdTile &from = *walker.tile;
+    DEBUG_ASSERT(&from != &to);
+
+    // it could be already an obstacle in the tile
+    RemoveObstacle(id);
+
+    std::lock(from.mutex, to.mutex);
+    std::lock_guard<std::mutex> from_lock(from.mutex, std::adopt_lock);
+    std::lock_guard<std::mutex> to_lock(to.mutex, std::adopt_lock);
+
+    const dtCrowdAgent *agent = from.crowd->getAgent(walker.index);
+    const int index = to.crowd->addAgent(agent->npos, &agent->params);
+    if (index == -1) {
+      // the tile is full, try again in the next update
+      return false;
+    }
+
+    // keep its movement and target
+    dtCrowdAgent *moved = to.crowd->getEditableAgent(index);
+    dtVcopy(moved->vel, agent->vel);
+    dtVcopy(moved->dvel, agent->dvel);
+    moved->paused = agent->paused;
+    if (agent->targetState == DT_CROWDAGENT_TARGET_VALID &&
+        moved->state == DT_CROWDAGENT_STATE_WALKING &&
+        agent->corridor.getPathCount() > 0 &&
+        agent->corridor.getFirstPoly() == moved->corridor.getFirstPoly()) {
+      // the polygons are of the same navmesh, so the path is still valid and
+      // the walker doesn't stop while a new one is planned
+      moved->corridor.setCorridor(agent->targetPos, agent->corridor.getPath(), agent->corridor.getPathCount());
+      moved->targetState = agent->targetState;
+      moved->targetRef = agent->targetRef;
+      dtVcopy(moved->targetPos, agent->targetPos);
+      moved->targetReplan = agent->targetReplan;
+      moved->targetReplanTime = agent->targetReplanTime;
+    } else if (agent->targetState == DT_CROWDAGENT_TARGET_VELOCITY) {
+      to.crowd->requestMoveVelocity(index, agent->targetPos);
+    } else if (agent->targetRef &&
+        agent->targetState != DT_CROWDAGENT_TARGET_NONE &&
+        agent->targetState != DT_CROWDAGENT_TARGET_FAILED) {
+      to.crowd->requestMoveTarget(index, agent->targetRef, agent->targetPos);
+    }
+    auto blocked = from.blocked_position.find(walker.index);
+    if (blocked != from.blocked_position.end()) {
+      to.blocked_position[index] = blocked->second;
+      from.blocked_position.erase(blocked);
+    }
+
+    // remove from the previous tile
+    from.crowd->removeAgent(walker.index);
+    from.walkers.erase(walker.index);
+    to.walkers[index] = id;
+    walker = AgentIndex { &to, index };
+
+    return true;
+  }
+
+  // free the tiles left without walkers, so the crowds allocated don't grow
+  // with the area the walkers have covered
+  void Navigation::FreeEmptyTiles() {
+    for (auto it = _tiles.begin(); it != _tiles.end();) {
+      CrowdTile *tile = it->second.get();
+      if (!tile->walkers.empty()) {
+        ++it;
         continue;
       }
+      // forget it in the agents that are obstacles in it
+      for (auto &obstacle : tile->obstacles) {
+        auto tiles = _obstacle_tiles.find(obstacle.first);
+        if (tiles == _obstacle_tiles.end()) {
+          continue;
+        }
+        auto &current = tiles->second;
+        current.erase(std::remove(current.begin(), current.end(), tile), current.end());
+        if (current.empty()) {
+          _obstacle_tiles.erase(tiles);
+        }
+      }
+      it = _tiles.erase(it);
+    }
+  }
 
-      // check only pedestrians not paused, and no vehicles
-      if (!ag->params.useObb && !ag->paused) {
-        bool reset_target_pos = false;
-        bool use_same_filter = false;
-
-        // check for unblocking actors
-        if (_time_to_unblock >= AGENT_UNBLOCK_TIME) {
-          // get the distance moved by each actor
-          carla::geom::Vector3D previous = _walkers_blocked_position[i];
-          carla::geom::Vector3D current = carla::geom::Vector3D(ag->npos[0], ag->npos[1], ag->npos[2]);
-          carla::geom::Vector3D distance = current - previous;
-          float d = distance.SquaredLength();
-          if (d < AGENT_UNBLOCK_DISTANCE_SQUARED) {
-            ++total_unblocked;
-            reset_target_pos = true;
-            use_same_filter = true;
-          }
-          // update with current position
-          _walkers_blocked_position[i] = current;
-
-          // check to assign a new target position
-          if (reset_target_pos) {
-            // set if the agent can cross roads or not
-            if (!use_same_filter) {
-              if (frand() <= _probability_crossing) {
-                SetAgentFilter(i, 1);
-              } else {
-                SetAgentFilter(i, 0);
-              }
-            }
-            // set a new random target
-            carla::geom::Location location;
-            GetRandomLocation(location, nullptr);
-            _walker_manager.SetWalkerRoute(_mapped_by_index[i], location);
-          }
+  // add walkers close to the border of their tile as obstacles of the neighbour tiles
+  void Navigation::UpdateWalkerObstacles() {
+    struct WalkerState {
+      ActorId id;
+      CrowdTile *tile;
+      float position[3];
+      float velocity[3];
+    };
+
+    // avoided as circles moving as they did in the last update
+    dtCrowdAgentParams params;
+    memset(&params, 0, sizeof(params));
+    params.radius = AGENT_RADIUS;
+    params.height = AGENT_HEIGHT;
+    params.maxAcceleration = 0.0f;
+    params.maxSpeed = 0.0f;
+    params.collisionQueryRange = 0;
+    params.obstacleAvoidanceType = 0;
+    params.separationWeight = 0.0f;
+    params.updateFlags = 0;
+
+    std::vector<WalkerState> walkers;
+    walkers.reserve(_mapped_walkers_id.size());
+    for (auto &entry : _tiles) {
+      CrowdTile &tile = *entry.second;
+      std::lock_guard<std::mutex> tile_lock(tile.mutex);
+      for (auto &walker : tile.walkers) {
+        const dtCrowdAgent *agent = tile.crowd->getAgent(walker.first);
+        if (!agent->active) {
+          continue;
         }
+        walkers.emplace_back();
+        walkers.back().id = walker.second;
+        walkers.back().tile = &tile;
+        dtVcopy(walkers.back().position, agent->npos);
+        dtVcopy(walkers.back().velocity, agent->vel);
       }
     }
 
-    // check for resetting time
-    if (_time_to_unblock >= AGENT_UNBLOCK_TIME) {
-      _time_to_unblock = 0.0f;
+    for (auto &walker : walkers) {
+      GetTilesNear(walker.position[0], walker.position[2], TILE_WALKER_OBSTACLE_DISTANCE, walker.tile, _tiles_near);
+      SetObstacleTiles(walker.id, _tiles_near, params, walker.position, walker.velocity);
     }
   }
 
+  // return the walkers that haven't moved for a while
+  std::vector<ActorId> Navigation::GetBlockedWalkers() {
+    std::vector<ActorId> blocked;
+
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &entry : _tiles) {
+      CrowdTile &tile = *entry.second;
+      std::lock_guard<std::mutex> tile_lock(tile.mutex);
+      // check only pedestrians not paused, and no vehicles
+      for (auto &walker : tile.walkers) {
+        const dtCrowdAgent *agent = tile.crowd->getAgent(walker.first);
+        if (!agent->active || agent->paused) {
+          continue;
+        }
+        // get the distance moved by each actor
+        carla::geom::Vector3D previous = tile.blocked_position[walker.first];
+        carla::geom::Vector3D current = carla::geom::Vector3D(agent->npos[0], agent->npos[1], agent->npos[2]);
+        carla::geom::Vector3D distance = current - previous;
+        if (distance.SquaredLength() < AGENT_UNBLOCK_DISTANCE_SQUARED) {
+          blocked.emplace_back(walker.second);
+        }
+        // update with current position
+        tile.blocked_position[walker.first] = current;
+      }
+    }
+
+    return blocked;
+  }
+
   // get the walker current transform
   bool Navigation::GetWalkerTransform(ActorId id, carla::geom::Transform &trans) {
 
@@ -919,27 +1267,18 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      return false;
-    }
-
-    // get the index found
-    int index = it->second;
-    if (index == -1) {
+    AgentIndex walker;
+    if (!FindWalker(id, walker)) {
       return false;
     }
 
     // get the walker
-    const dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
-    }
+    std::lock_guard<std::mutex> tile_lock(walker.tile->mutex);
+    const dtCrowdAgent *agent = walker.tile->crowd->getAgent(walker.index);
 
     if (!agent->active) {
       return false;
@@ -983,27 +1322,18 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      return false;
-    }
-
-    // get the index found
-    int index = it->second;
-    if (index == -1) {
+    AgentIndex walker;
+    if (!FindWalker(id, walker)) {
       return false;
     }
 
     // get the walker
-    const dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
-    }
+    std::lock_guard<std::mutex> tile_lock(walker.tile->mutex);
+    const dtCrowdAgent *agent = walker.tile->crowd->getAgent(walker.index);
 
     if (!agent->active) {
       return false;
@@ -1024,27 +1354,18 @@ namespace nav {
       return 0.0f;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      return 0.0f;
-    }
-
-    // get the index found
-    int index = it->second;
-    if (index == -1) {
+    AgentIndex walker;
+    if (!FindWalker(id, walker)) {
       return 0.0f;
     }
 
     // get the walker
-    const dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
-    }
+    std::lock_guard<std::mutex> tile_lock(walker.tile->mutex);
+    const dtCrowdAgent *agent = walker.tile->crowd->getAgent(walker.index);
 
     return sqrt(agent->vel[0] * agent->vel[0] + agent->vel[1] * agent->vel[1] + agent->vel[2] *
     agent->vel[2]);
@@ -1091,19 +1412,6 @@ namespace nav {
     return (rounds > 0);
   }
 
-  // assign a filter index to an agent
-  void Navigation::SetAgentFilter(int agent_index, int filter_index)
-  {
-    // get the walker
-    dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getEditableAgent(agent_index);
-    }
-    agent->params.queryFilterType = static_cast<unsigned char>(filter_index);
-  }
-
   // set the probability that an agent could cross the roads in its path following
   // percentage of 0.0f means no pedestrian can cross roads
   // percentage of 0.5f means 50% of all pedestrians can cross roads
@@ -1120,69 +1428,65 @@ namespace nav {
       return;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
+    AgentIndex walker;
+    if (!FindWalker(id, walker)) {
       return;
     }
 
-    // get the index found
-    int index = it->second;
-    if (index == -1) {
-      return;
-    }
+    // mark
+    std::lock_guard<std::mutex> tile_lock(walker.tile->mutex);
+    walker.tile->crowd->getEditableAgent(walker.index)->paused = pause;
+  }
 
-    // get the walker
-    dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getEditableAgent(index);
+  // find a walker, or a vehicle in one of the tiles it is an obstacle
+  bool Navigation::FindAgent(ActorId id, AgentIndex &agent) const {
+    if (FindWalker(id, agent)) {
+      return true;
     }
-
-    // mark
-    agent->paused = pause;
+    if (_vehicles.find(id) == _vehicles.end()) {
+      return false;
+    }
+    auto it = _obstacle_tiles.find(id);
+    if (it == _obstacle_tiles.end()) {
+      return false;
+    }
+    CrowdTile *tile = it->second.front();
+    agent = AgentIndex { tile, tile->obstacles.at(id) };
+    return true;
   }
 
   bool Navigation::HasVehicleNear(ActorId id, float distance, carla::geom::Location direction) {
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
     // get the internal index (walker or vehicle)
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      it = _mapped_vehicles_id.find(id);
-      if (it == _mapped_vehicles_id.end()) {
-        return false;
-      }
+    AgentIndex agent;
+    if (!FindAgent(id, agent)) {
+      return false;
     }
 
     float dir[3] = { direction.x, direction.z, direction.y };
-    bool result;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      result = _crowd->hasVehicleNear(it->second, distance * distance, dir, false);
-    }
-    return result;
+    std::lock_guard<std::mutex> tile_lock(agent.tile->mutex);
+    return agent.tile->crowd->hasVehicleNear(agent.index, distance * distance, dir, false);
   }
 
   /// make agent look at some location
   bool Navigation::SetWalkerLookAt(ActorId id, carla::geom::Location location) {
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
     // get the internal index (walker or vehicle)
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      it = _mapped_vehicles_id.find(id);
-      if (it == _mapped_vehicles_id.end()) {
-        return false;
-      }
+    AgentIndex index;
+    if (!FindAgent(id, index)) {
+      return false;
     }
 
-    dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getEditableAgent(it->second);
-    }
+    std::lock_guard<std::mutex> tile_lock(index.tile->mutex);
+    dtCrowdAgent *agent = index.tile->crowd->getEditableAgent(index.index);
 
     // get the position
     float x = (location.x - agent->npos[0]) * 0.0001f;
@@ -1203,5 +1507,22 @@ namespace nav {
     return true;
   }
 
+  // return the crowd of each tile
+  std::vector<dtCrowd *> Navigation::GetCrowds() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<dtCrowd *> crowds;
+    crowds.reserve(_tiles.size());
+    for (auto &entry : _tiles) {
+      crowds.emplace_back(entry.second->crowd);
+    }
+    return crowds;
+  }
+
+  // return the number of walkers
+  size_t Navigation::GetNumberOfWalkers() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _mapped_walkers_id.size();
+  }
+
 } // namespace nav
 } // namespace carla
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/AtomicList.h"
+#include "carla/ThreadPool.h"
 #include "carla/client/detail/EpisodeState.h"
 #include "carla/geom/BoundingBox.h"
 #include "carla/geom/Location.h"
@@ -20,6 +21,12 @@
 #include <recast/DetourNavMeshQuery.h>
 #include <recast/DetourCommon.h>
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 namespace carla {
 namespace nav {
 
@@ -54,6 +61,11 @@ namespace nav {
   ///
   /// This class gets the binary content of the map from the server, which is required for the path finding.
   /// Then this class can add or remove pedestrians, and also set target points to walk for each one.
+  ///
+  /// The map is split in square tiles, each with its own crowd, created when the first walker enters it.
+  /// Walkers are handed off to the neighbour tile when they cross the border, and walkers close to the
+  /// border and vehicles are added as obstacles to the neighbour tiles so they are still avoided. The
+  /// tiles are updated in parallel.
   class Navigation : private NonCopyable {
 
   public:
@@ -73,8 +85,6 @@ namespace nav {
 
     /// set the seed to use with random numbers
     void SetSeed(unsigned int seed);
-    /// create the crowd object
-    void CreateCrowd(void);
     /// create a new walker
     bool AddWalker(ActorId id, carla::geom::Location from);
     /// create a new vehicle in crowd to be avoided by walkers
@@ -83,13 +93,16 @@ namespace nav {
     bool RemoveAgent(ActorId id);
     /// add/update/delete vehicles in crowd
     bool UpdateVehicles(std::vector<VehicleCollisionInfo> vehicles);
+    /// add/update @a vehicles and delete @a removed_vehicles in crowd, the rest are left as they are
+    void UpdateVehicles(
+        const std::vector<VehicleCollisionInfo> &vehicles,
+        const std::vector<ActorId> &removed_vehicles);
     /// set new max speed
     bool SetWalkerMaxSpeed(ActorId id, float max_speed);
     /// set a new target point to go through a route with events
     bool SetWalkerTarget(ActorId id, carla::geom::Location to);
     // set a new target point to go directly without events
     bool SetWalkerDirectTarget(ActorId id, carla::geom::Location to);
-    bool SetWalkerDirectTargetIndex(int index, carla::geom::Location to);
     /// get the walker current transform
     bool GetWalkerTransform(ActorId id, carla::geom::Transform &trans);
     /// get the walker current location
@@ -98,6 +111,8 @@ namespace nav {
     float GetWalkerSpeed(ActorId id);
     /// update all walkers in crowd
     void UpdateCrowd(const client::detail::EpisodeState &state);
+    /// update all walkers in crowd by @a delta_seconds
+    void UpdateCrowd(double delta_seconds);
     /// get a random location for navigation
     bool GetRandomLocation(carla::geom::Location &location, dtQueryFilter * filter = nullptr) const;
     /// set the probability that an agent could cross the roads in its path following
@@ -109,41 +124,86 @@ namespace nav {
     /// make agent look at some location
     bool SetWalkerLookAt(ActorId id, carla::geom::Location location);
 
-    dtCrowd *GetCrowd() { return _crowd; };
+    /// return the crowd of each tile
+    std::vector<dtCrowd *> GetCrowds() const;
+    /// return the number of walkers
+    size_t GetNumberOfWalkers() const;
 
     /// return the last delta seconds
     double GetDeltaSeconds() { return _delta_seconds; };
 
   private:
 
+    struct CrowdTile;
+
+    /// agent in the crowd of a tile
+    struct AgentIndex {
+      CrowdTile *tile;
+      int index;
+    };
+
     bool _ready { false };
     std::vector<uint8_t> _binary_mesh;
     double _delta_seconds { 0.0 };
     /// meshes
     dtNavMesh *_nav_mesh { nullptr };
     dtNavMeshQuery *_nav_query { nullptr };
-    /// crowd
-    dtCrowd *_crowd { nullptr };
+    /// tiles with a crowd, by tile coordinates
+    std::unordered_map<uint64_t, std::unique_ptr<CrowdTile>> _tiles;
     /// mapping Id
-    std::unordered_map<ActorId, int> _mapped_walkers_id;
-    std::unordered_map<ActorId, int> _mapped_vehicles_id;
-    // mapping by index also
-    std::unordered_map<int, ActorId> _mapped_by_index;
+    std::unordered_map<ActorId, AgentIndex> _mapped_walkers_id;
+    std::unordered_set<ActorId> _vehicles;
+    /// tiles where each vehicle, or walker close to a border, is an obstacle
+    std::unordered_map<ActorId, std::vector<CrowdTile *>> _obstacle_tiles;
+    /// reused to find the tiles near an agent
+    std::vector<CrowdTile *> _tiles_near;
     /// store walkers yaw angle from previous tick
     std::unordered_map<ActorId, float> _yaw_walkers;
-    /// saves the position of each actor at intervals and check if any is blocked
-    std::unordered_map<int, carla::geom::Vector3D> _walkers_blocked_position;
     double _time_to_unblock { 0.0 };
 
     /// walker manager for the route planning with events
     WalkerManager _walker_manager;
 
+    /// protects the navigation query and the mappings, each tile has its
+    /// own mutex for its crowd, always locked after this one
     mutable std::mutex _mutex;
 
+    /// updates the tiles in parallel, created with the second tile
+    std::unique_ptr<ThreadPool> _thread_pool;
+
     float _probability_crossing { 0.0f };
 
-    /// assign a filter index to an agent
-    void SetAgentFilter(int agent_index, int filter_index);
+    /// return the tile at a location, creating it if needed
+    CrowdTile *GetOrCreateTile(float x, float y);
+    /// create and init a crowd for a tile
+    dtCrowd *CreateCrowd();
+    /// find a walker
+    bool FindWalker(ActorId id, AgentIndex &agent) const;
+    /// find a walker, or a vehicle in one of the tiles it is an obstacle
+    bool FindAgent(ActorId id, AgentIndex &agent) const;
+    /// set a new target point to go directly for an agent
+    bool SetAgentTarget(CrowdTile &tile, int index, carla::geom::Location to);
+    /// update the crowds of all tiles
+    void UpdateTiles(float delta_seconds);
+    /// move the walkers that left their tile to the tile they are in
+    void HandOffWalkers();
+    /// move a walker to the crowd of another tile
+    bool MoveWalker(ActorId id, CrowdTile &to);
+    /// add walkers close to the border of their tile as obstacles of the neighbour tiles
+    void UpdateWalkerObstacles();
+    /// free the tiles without walkers
+    void FreeEmptyTiles();
+    /// add or update a vehicle in the tiles with walkers near it
+    void UpdateVehicle(const VehicleCollisionInfo &vehicle);
+    /// make @a id an obstacle in exactly @a tiles
+    void SetObstacleTiles(ActorId id, const std::vector<CrowdTile *> &tiles,
+    const dtCrowdAgentParams &params, const float *position, const float *velocity);
+    /// remove @a id as obstacle from all the tiles
+    void RemoveObstacle(ActorId id);
+    /// find the tiles with walkers closer than @a distance to a location
+    void GetTilesNear(float x, float y, float distance, const CrowdTile *except, std::vector<CrowdTile *> &tiles);
+    /// return the walkers that haven't moved for a while
+    std::vector<ActorId> GetBlockedWalkers();
   };
 
 } // namespace nav
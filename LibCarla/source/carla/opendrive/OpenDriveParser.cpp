@@ -17,6 +17,7 @@
 #include "carla/opendrive/parser/RoadParser.h"
 #include "carla/opendrive/parser/SignalParser.h"
 #include "carla/opendrive/parser/TrafficGroupParser.h"
+#include "carla/profiler/Tracer.h"
 #include "carla/road/MapBuilder.h"
 
 #include <pugixml/pugixml.hpp>
@@ -25,8 +26,30 @@ namespace carla {
 namespace opendrive {
 
   boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+    return Load(opendrive, nullptr);
+  }
+
+  boost::optional<road::Map> OpenDriveParser::Load(
+      const std::string &opendrive,
+      const road::MapCache &cache) {
+    if (!cache.IsCacheOf(opendrive)) {
+      log_warning("map cache was not created from this OpenDRIVE, ignoring it");
+      return Load(opendrive, nullptr);
+    }
+    return Load(opendrive, &cache);
+  }
+
+  boost::optional<road::Map> OpenDriveParser::Load(
+      const std::string &opendrive,
+      const road::MapCache *cache) {
+    CARLA_TRACE_SCOPE(opendrive, load);
+
     pugi::xml_document xml;
-    pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());
+    pugi::xml_parse_result parse_result;
+    {
+      CARLA_TRACE_SCOPE(opendrive, parse_xml);
+      parse_result = xml.load_string(opendrive.c_str());
+    }
 
     if (parse_result == false) {
       log_error("unable to parse the OpenDRIVE XML string");
@@ -35,18 +58,25 @@ namespace opendrive {
 
     carla::road::MapBuilder map_builder;
 
-    parser::GeoReferenceParser::Parse(xml, map_builder);
-    parser::RoadParser::Parse(xml, map_builder);
-    parser::JunctionParser::Parse(xml, map_builder);
-    parser::GeometryParser::Parse(xml, map_builder);
-    parser::LaneParser::Parse(xml, map_builder);
-    parser::ProfilesParser::Parse(xml, map_builder);
-    parser::TrafficGroupParser::Parse(xml, map_builder);
-    parser::SignalParser::Parse(xml, map_builder);
-    parser::ObjectParser::Parse(xml, map_builder);
-    parser::ControllerParser::Parse(xml, map_builder);
-
-    return map_builder.Build();
+    // The parsers fill the same map builder, they run one after the other.
+    {
+      CARLA_TRACE_SCOPE(opendrive, parse_roads);
+      parser::GeoReferenceParser::Parse(xml, map_builder);
+      parser::RoadParser::Parse(xml, map_builder);
+      parser::JunctionParser::Parse(xml, map_builder);
+      parser::GeometryParser::Parse(xml, map_builder);
+      parser::LaneParser::Parse(xml, map_builder);
+      parser::ProfilesParser::Parse(xml, map_builder);
+    }
+    {
+      CARLA_TRACE_SCOPE(opendrive, parse_signals);
+      parser::TrafficGroupParser::Parse(xml, map_builder);
+      parser::SignalParser::Parse(xml, map_builder);
+      parser::ObjectParser::Parse(xml, map_builder);
+      parser::ControllerParser::Parse(xml, map_builder);
+    }
+
+    return (cache != nullptr) ? map_builder.Build(*cache) : map_builder.Build();
   }
 
 } // namespace opendrive
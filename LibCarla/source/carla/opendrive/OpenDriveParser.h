@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/road/Map.h"
+#include "carla/road/MapCache.h"
 
 #include <boost/optional.hpp>
 
@@ -19,6 +20,19 @@ namespace opendrive {
   public:
 
     static boost::optional<road::Map> Load(const std::string &opendrive);
+
+    /// Same as Load, but restores the data computed from the roads from
+    /// @a cache if it is a snapshot of this @a opendrive, which skips most of
+    /// the loading time.
+    static boost::optional<road::Map> Load(
+        const std::string &opendrive,
+        const road::MapCache &cache);
+
+  private:
+
+    static boost::optional<road::Map> Load(
+        const std::string &opendrive,
+        const road::MapCache *cache);
   };
 
 } // namespace opendrive
@@ -0,0 +1,141 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/pointcloud/Lzf.h"
+
+#include <algorithm>
+
+namespace carla {
+namespace pointcloud {
+
+  // Each token starts with a control byte. Below 32 it is followed by
+  // control + 1 literal bytes, otherwise it is a back-reference: the length
+  // minus 2 in the top 3 bits (7 meaning an extra length byte follows) and
+  // the offset minus 1 in the low 5 bits plus the next byte.
+
+  static constexpr size_t max_literal = 32u;
+  static constexpr size_t max_offset = 1u << 13u;
+  static constexpr size_t max_match = 264u;
+  static constexpr size_t hash_bits = 14u;
+
+  static size_t Hash(const uint8_t *p) {
+    const uint32_t v = (uint32_t(p[0u]) << 16u) | (uint32_t(p[1u]) << 8u) | uint32_t(p[2u]);
+    return ((v * 2654435761u) >> (32u - hash_bits)) & ((1u << hash_bits) - 1u);
+  }
+
+  void Lzf::Compress(const uint8_t *data, const size_t size, std::vector<uint8_t> &out) {
+    out.clear();
+    out.reserve(size + size / max_literal + 1u);
+    // Position + 1 of the last occurrence of each hash, 0 if none.
+    std::vector<size_t> table(size_t(1u) << hash_bits, 0u);
+
+    size_t literal_start = out.size();
+    size_t literal_size = 0u;
+    out.emplace_back(0u);
+
+    auto close_literal = [&]() {
+      if (literal_size > 0u) {
+        out[literal_start] = static_cast<uint8_t>(literal_size - 1u);
+      } else {
+        out.pop_back();
+      }
+    };
+
+    auto push_literal = [&](uint8_t byte) {
+      out.emplace_back(byte);
+      if (++literal_size == max_literal) {
+        close_literal();
+        literal_start = out.size();
+        literal_size = 0u;
+        out.emplace_back(0u);
+      }
+    };
+
+    size_t position = 0u;
+    while (position + 2u < size) {
+      auto &entry = table[Hash(data + position)];
+      const size_t reference = entry;
+      entry = position + 1u;
+      if ((reference > 0u) &&
+          (position - reference < max_offset) &&
+          std::equal(data + reference - 1u, data + reference + 2u, data + position)) {
+        const size_t match_start = reference - 1u;
+        const size_t offset = position - match_start - 1u;
+        const size_t limit = std::min(max_match, size - position);
+        size_t length = 3u;
+        while ((length < limit) && (data[match_start + length] == data[position + length])) {
+          ++length;
+        }
+
+        close_literal();
+        const size_t encoded_length = length - 2u;
+        if (encoded_length < 7u) {
+          out.emplace_back(static_cast<uint8_t>((encoded_length << 5u) | (offset >> 8u)));
+        } else {
+          out.emplace_back(static_cast<uint8_t>((7u << 5u) | (offset >> 8u)));
+          out.emplace_back(static_cast<uint8_t>(encoded_length - 7u));
+        }
+        out.emplace_back(static_cast<uint8_t>(offset & 0xFFu));
+
+        // Index the positions inside the match too.
+        for (size_t i = position + 1u; (i < position + length) && (i + 2u < size); ++i) {
+          table[Hash(data + i)] = i + 1u;
+        }
+        position += length;
+
+        literal_start = out.size();
+        literal_size = 0u;
+        out.emplace_back(0u);
+      } else {
+        push_literal(data[position++]);
+      }
+    }
+    while (position < size) {
+      push_literal(data[position++]);
+    }
+    close_literal();
+  }
+
+  bool Lzf::Decompress(const uint8_t *data, const size_t size, std::vector<uint8_t> &out) {
+    size_t in = 0u;
+    size_t position = 0u;
+    while (in < size) {
+      const size_t control = data[in++];
+      if (control < max_literal) {
+        const size_t length = control + 1u;
+        if ((in + length > size) || (position + length > out.size())) {
+          return false;
+        }
+        std::copy(data + in, data + in + length, out.begin() + static_cast<std::ptrdiff_t>(position));
+        in += length;
+        position += length;
+      } else {
+        size_t length = control >> 5u;
+        if (length == 7u) {
+          if (in >= size) {
+            return false;
+          }
+          length += data[in++];
+        }
+        if (in >= size) {
+          return false;
+        }
+        const size_t offset = ((control & 0x1Fu) << 8u) + data[in++] + 1u;
+        length += 2u;
+        if ((offset > position) || (position + length > out.size())) {
+          return false;
+        }
+        // The reference may overlap the output, copy byte by byte.
+        for (size_t i = 0u; i < length; ++i, ++position) {
+          out[position] = out[position - offset];
+        }
+      }
+    }
+    return position == out.size();
+  }
+
+} // namespace pointcloud
+} // namespace carla
@@ -0,0 +1,31 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace pointcloud {
+
+  /// LZF compression, the format used by the "binary_compressed" PCD files.
+  class Lzf {
+  public:
+
+    /// Compress @a size bytes at @a data into @a out, replacing its contents.
+    static void Compress(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+
+    /// Decompress @a size bytes at @a data into @a out, which must be already
+    /// sized to the uncompressed size.
+    ///
+    /// @return false if the data is corrupt or does not fit in @a out.
+    static bool Decompress(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+  };
+
+} // namespace pointcloud
+} // namespace carla
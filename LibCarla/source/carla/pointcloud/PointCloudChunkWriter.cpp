@@ -0,0 +1,58 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/pointcloud/PointCloudChunkWriter.h"
+
+#include "carla/Exception.h"
+
+#include <stdexcept>
+
+namespace carla {
+namespace pointcloud {
+
+  constexpr char PointCloudChunkWriter::magic[8u];
+  constexpr uint32_t PointCloudChunkWriter::version;
+
+  template <typename T>
+  static void WriteValue(std::ostream &out, const T &value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  PointCloudChunkWriter::PointCloudChunkWriter(std::string path, const PointCloudFormat format)
+    : _path(std::move(path)),
+      _format(format) {
+    FileSystem::ValidateFilePath(_path, ".pcl");
+    _out.open(_path, std::ios::binary | std::ios::app);
+    if (!_out) {
+      throw_exception(std::runtime_error(_path + ": failed to open file"));
+    }
+    _out.seekp(0, std::ios::end);
+    if (_out.tellp() == std::streampos(0)) {
+      _out.write(magic, sizeof(magic));
+      WriteValue(_out, version);
+    }
+  }
+
+  void PointCloudChunkWriter::Flush() {
+    _out.flush();
+  }
+
+  void PointCloudChunkWriter::WriteChunk(
+      const uint64_t frame,
+      const double timestamp,
+      const std::string &payload) {
+    WriteValue(_out, frame);
+    WriteValue(_out, timestamp);
+    WriteValue(_out, static_cast<uint8_t>(_format));
+    WriteValue(_out, static_cast<uint64_t>(payload.size()));
+    _out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!_out) {
+      throw_exception(std::runtime_error(_path + ": failed to write point cloud"));
+    }
+  }
+
+} // namespace pointcloud
+} // namespace carla
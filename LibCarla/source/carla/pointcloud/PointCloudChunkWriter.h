@@ -0,0 +1,74 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/pointcloud/PointCloudIO.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace carla {
+namespace pointcloud {
+
+  /// Appends the point clouds of consecutive frames to a single file, instead
+  /// of a file per frame. Appending to an existing file continues it.
+  ///
+  /// The file starts with the 8 bytes "CARLAPCL" and a uint32_t version,
+  /// followed by one chunk per frame:
+  ///
+  ///    {
+  ///      uint64_t frame,
+  ///      double   timestamp,
+  ///      uint8_t  format (PointCloudFormat),
+  ///      uint64_t size,
+  ///      size bytes, the complete PLY or PCD file of the frame
+  ///    }
+  ///
+  /// All the values are stored in the byte order of the writer.
+  class PointCloudChunkWriter : private NonCopyable {
+  public:
+
+    static constexpr char magic[8u] = {'C', 'A', 'R', 'L', 'A', 'P', 'C', 'L'};
+
+    static constexpr uint32_t version = 1u;
+
+    explicit PointCloudChunkWriter(
+        std::string path,
+        PointCloudFormat format = PointCloudFormat::PlyBinary);
+
+    const std::string &GetPath() const {
+      return _path;
+    }
+
+    PointCloudFormat GetFormat() const {
+      return _format;
+    }
+
+    template <typename PointIt>
+    void Append(uint64_t frame, double timestamp, PointIt begin, PointIt end) {
+      std::ostringstream payload;
+      PointCloudIO::Dump(payload, begin, end, _format);
+      WriteChunk(frame, timestamp, payload.str());
+    }
+
+    void Flush();
+
+  private:
+
+    void WriteChunk(uint64_t frame, double timestamp, const std::string &payload);
+
+    std::string _path;
+
+    const PointCloudFormat _format;
+
+    std::ofstream _out;
+  };
+
+} // namespace pointcloud
+} // namespace carla
@@ -6,15 +6,33 @@
 
 #pragma once
 
+#include "carla/Debug.h"
 #include "carla/FileSystem.h"
+#include "carla/pointcloud/Lzf.h"
 
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iterator>
 #include <iomanip>
+#include <sstream>
+#include <type_traits>
+#include <vector>
 
 namespace carla {
 namespace pointcloud {
 
+  enum class PointCloudFormat : uint8_t {
+    /// PLY, one line of text per point.
+    PlyAscii,
+    /// PLY, the points as stored in memory.
+    PlyBinary,
+    /// PCD, the points as stored in memory.
+    PcdBinary,
+    /// PCD, each field of all the points stored together and LZF compressed.
+    PcdBinaryCompressed
+  };
+
   class PointCloudIO {
 
   public:
@@ -27,6 +45,26 @@ namespace pointcloud {
       }
     }
 
+    /// Write the points in @a format. The binary formats write the header and
+    /// then all the points in a single write.
+    template <typename PointIt>
+    static void Dump(std::ostream &out, PointIt begin, PointIt end, PointCloudFormat format) {
+      switch (format) {
+        case PointCloudFormat::PlyAscii:
+          Dump(out, begin, end);
+          break;
+        case PointCloudFormat::PlyBinary:
+          DumpBinaryPly(out, MakeContiguous(begin, end));
+          break;
+        case PointCloudFormat::PcdBinary:
+          DumpBinaryPcd(out, MakeContiguous(begin, end), false);
+          break;
+        case PointCloudFormat::PcdBinaryCompressed:
+          DumpBinaryPcd(out, MakeContiguous(begin, end), true);
+          break;
+      }
+    }
+
     template <typename PointIt>
     static std::string SaveToDisk(std::string path, PointIt begin, PointIt end) {
       FileSystem::ValidateFilePath(path, ".ply");
@@ -35,6 +73,26 @@ namespace pointcloud {
       return path;
     }
 
+    /// Save the points in @a format, the extension is added if the path has
+    /// none.
+    template <typename PointIt>
+    static std::string SaveToDisk(
+        std::string path,
+        PointIt begin,
+        PointIt end,
+        PointCloudFormat format) {
+      FileSystem::ValidateFilePath(path, GetExtension(format));
+      std::ofstream out(path, std::ios::binary);
+      Dump(out, begin, end, format);
+      return path;
+    }
+
+    static const char *GetExtension(PointCloudFormat format) {
+      return (format == PointCloudFormat::PlyAscii) || (format == PointCloudFormat::PlyBinary) ?
+          ".ply" :
+          ".pcd";
+    }
+
   private:
     template <typename PointIt> static void WriteHeader(std::ostream &out, PointIt begin, PointIt end) {
       DEBUG_ASSERT(std::distance(begin, end) >= 0);
@@ -45,6 +103,102 @@ namespace pointcloud {
       out << "\nend_header\n";
       out << std::fixed << std::setprecision(4u);
     }
+
+    /// A range of points contiguous in memory.
+    template <typename T>
+    struct PointRange {
+      const T *data;
+      size_t size;
+      /// Holds a copy of the points if the source was not contiguous.
+      std::vector<T> copy;
+    };
+
+    template <typename T>
+    static PointRange<T> MakeContiguous(const T *begin, const T *end) {
+      DEBUG_ASSERT(begin <= end);
+      return {begin, static_cast<size_t>(end - begin), {}};
+    }
+
+    template <typename T>
+    static PointRange<T> MakeContiguous(T *begin, T *end) {
+      return MakeContiguous(static_cast<const T *>(begin), static_cast<const T *>(end));
+    }
+
+    template <typename PointIt>
+    static auto MakeContiguous(PointIt begin, PointIt end) {
+      using T = typename std::iterator_traits<PointIt>::value_type;
+      PointRange<T> range{nullptr, 0u, std::vector<T>(begin, end)};
+      range.data = range.copy.data();
+      range.size = range.copy.size();
+      return range;
+    }
+
+    static bool IsLittleEndian() {
+      const uint16_t value = 1u;
+      uint8_t first_byte;
+      std::memcpy(&first_byte, &value, 1u);
+      return first_byte == 1u;
+    }
+
+    template <typename T>
+    static void DumpBinaryPly(std::ostream &out, const PointRange<T> &points) {
+      std::ostringstream header;
+      header << "ply\n"
+                "format " << (IsLittleEndian() ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+                "element vertex " << points.size << "\n";
+      T().WritePlyHeaderInfo(header);
+      header << "\nend_header\n";
+      const std::string text = header.str();
+      out.write(text.data(), static_cast<std::streamsize>(text.size()));
+      out.write(
+          reinterpret_cast<const char *>(points.data),
+          static_cast<std::streamsize>(points.size * sizeof(T)));
+    }
+
+    template <typename T>
+    static void DumpBinaryPcd(std::ostream &out, const PointRange<T> &points, bool compressed) {
+      // Every field of the points is 4 bytes long.
+      static_assert(sizeof(T) % sizeof(uint32_t) == 0u, "Invalid point size");
+      std::ostringstream header;
+      header << "# .PCD v0.7 - Point Cloud Data file format\n"
+                "VERSION 0.7\n";
+      T().WritePcdHeaderInfo(header);
+      header << "\nWIDTH " << points.size << "\n"
+                "HEIGHT 1\n"
+                "VIEWPOINT 0 0 0 1 0 0 0\n"
+                "POINTS " << points.size << "\n"
+                "DATA " << (compressed ? "binary_compressed" : "binary") << "\n";
+      const std::string text = header.str();
+      out.write(text.data(), static_cast<std::streamsize>(text.size()));
+
+      const size_t size = points.size * sizeof(T);
+      if (!compressed) {
+        out.write(reinterpret_cast<const char *>(points.data), static_cast<std::streamsize>(size));
+        return;
+      }
+
+      // Store each field of all the points together, then compress.
+      constexpr size_t number_of_fields = sizeof(T) / sizeof(uint32_t);
+      std::vector<uint8_t> fields(size);
+      const auto *source = reinterpret_cast<const uint8_t *>(points.data);
+      for (size_t i = 0u; i < points.size; ++i) {
+        for (size_t field = 0u; field < number_of_fields; ++field) {
+          std::memcpy(
+              fields.data() + (field * points.size + i) * sizeof(uint32_t),
+              source + (i * number_of_fields + field) * sizeof(uint32_t),
+              sizeof(uint32_t));
+        }
+      }
+      std::vector<uint8_t> compressed_fields;
+      Lzf::Compress(fields.data(), fields.size(), compressed_fields);
+      const uint32_t sizes[2u] = {
+          static_cast<uint32_t>(compressed_fields.size()),
+          static_cast<uint32_t>(size)};
+      out.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+      out.write(
+          reinterpret_cast<const char *>(compressed_fields.data()),
+          static_cast<std::streamsize>(compressed_fields.size()));
+    }
   };
 
 } // namespace pointcloud
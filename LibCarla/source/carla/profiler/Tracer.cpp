@@ -0,0 +1,287 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/profiler/Tracer.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace carla {
+namespace profiler {
+
+namespace {
+
+  /// Ring buffer of the events of a thread. Written only by its thread, read
+  /// by the exporter; an event is valid once the head moves past it, and
+  /// until the head moves past it again by a full turn.
+  class ThreadBuffer {
+  public:
+
+    // One more slot than the events kept, the one the thread may be writing
+    // while the events are copied.
+    explicit ThreadBuffer(uint32_t index)
+      : thread_index(index),
+        events(Tracer::events_per_thread + 1u) {}
+
+    void Push(const TraceEvent &event) {
+      const auto head = _head.load(std::memory_order_relaxed);
+      events[head % events.size()] = event;
+      _head.store(head + 1u, std::memory_order_release);
+    }
+
+    void Clear() {
+      _first.store(_head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+
+    void CopyEvents(std::vector<TraceEvent> &out) const {
+      const uint64_t size = events.size();
+      const auto head = _head.load(std::memory_order_acquire);
+      auto first = std::max(_first.load(std::memory_order_relaxed), head > size ? head - size : 0u);
+      const auto begin = out.size();
+      for (auto i = first; i < head; ++i) {
+        out.emplace_back(events[i % size]);
+      }
+      // Discard the events overwritten while copying, including the one in
+      // the slot the thread may be writing now.
+      const auto new_head = _head.load(std::memory_order_acquire);
+      const auto overwritten = new_head + 1u > size ? new_head + 1u - size : 0u;
+      if (overwritten > first) {
+        const auto count = std::min(overwritten - first, head - first);
+        out.erase(
+            out.begin() + static_cast<std::ptrdiff_t>(begin),
+            out.begin() + static_cast<std::ptrdiff_t>(begin + count));
+      }
+    }
+
+    const uint32_t thread_index;
+
+    /// Traced scopes currently open, only used by the thread.
+    uint32_t depth = 0u;
+
+    /// Guarded by the mutex of the registry.
+    std::string thread_name;
+
+    std::vector<TraceEvent> events;
+
+  private:
+
+    std::atomic<uint64_t> _head{0u};
+
+    std::atomic<uint64_t> _first{0u};
+  };
+
+  /// The buffers of every thread that traced a scope, kept after the threads
+  /// exit until their events are exported.
+  class Registry {
+  public:
+
+    std::shared_ptr<ThreadBuffer> Register() {
+      std::lock_guard<std::mutex> lock(mutex);
+      buffers.emplace_back(std::make_shared<ThreadBuffer>(next_thread_index++));
+      return buffers.back();
+    }
+
+    /// Frees the buffers of the threads that exited, only held here.
+    void RemoveExitedThreads() {
+      buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const auto &buffer) {
+        return buffer.use_count() == 1;
+      }), buffers.end());
+    }
+
+    std::mutex mutex;
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+    uint32_t next_thread_index = 0u;
+  };
+
+  static Registry &GetRegistry() {
+    static Registry registry;
+    return registry;
+  }
+
+  static ThreadBuffer &GetThreadBuffer() {
+    static thread_local std::shared_ptr<ThreadBuffer> buffer = GetRegistry().Register();
+    return *buffer;
+  }
+
+  /// Events of every thread sorted by begin time, optionally freeing the
+  /// buffers of the threads that exited.
+  static std::vector<TraceEvent> CopyEvents(bool remove_exited_threads) {
+    std::vector<TraceEvent> events;
+    {
+      auto &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      for (auto &buffer : registry.buffers) {
+        buffer->CopyEvents(events);
+      }
+      if (remove_exited_threads) {
+        // Their events are copied, and no new ones will come.
+        registry.RemoveExitedThreads();
+      }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.begin_ns < rhs.begin_ns;
+    });
+    return events;
+  }
+
+  static void WriteJsonString(std::ostream &out, const std::string &str) {
+    out << '"';
+    for (const char c : str) {
+      if ((c == '"') || (c == '\\')) {
+        out << '\\' << c;
+      } else if (static_cast<unsigned char>(c) < 0x20u) {
+        out << ' ';
+      } else {
+        out << c;
+      }
+    }
+    out << '"';
+  }
+
+  /// Starts tracing with the process if CARLA_TRACE_FILE is set, and saves the
+  /// trace at exit.
+  class TraceFileFromEnvironment {
+  public:
+
+    TraceFileFromEnvironment() {
+      // Construct the registry first so it outlives this object.
+      GetRegistry();
+      Tracer::Now();
+      const char *path = std::getenv("CARLA_TRACE_FILE");
+      if ((path != nullptr) && (path[0u] != '\0')) {
+        _path = path;
+        Tracer::Enable();
+      }
+    }
+
+    ~TraceFileFromEnvironment() {
+      if (!_path.empty()) {
+        try {
+          Tracer::Disable();
+          log_info("tracer: trace saved to", Tracer::SaveChromeTrace(_path));
+        } catch (const std::exception &e) {
+          log_error("tracer:", e.what());
+        }
+      }
+    }
+
+  private:
+
+    std::string _path;
+  };
+
+  static TraceFileFromEnvironment TRACE_FILE_FROM_ENVIRONMENT;
+
+} // namespace
+
+  constexpr size_t Tracer::events_per_thread;
+
+  std::atomic_bool &Tracer::GetEnabledFlag() {
+    static std::atomic_bool is_enabled{false};
+    return is_enabled;
+  }
+
+  const std::chrono::steady_clock::time_point &Tracer::GetEpoch() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return epoch;
+  }
+
+  uint32_t Tracer::BeginScope() {
+    return GetThreadBuffer().depth++;
+  }
+
+  void Tracer::EndScope(
+      const char *context,
+      const char *name,
+      const uint64_t begin_ns,
+      const uint32_t depth) {
+    const auto end_ns = Now();
+    auto &buffer = GetThreadBuffer();
+    buffer.depth = depth;
+    buffer.Push({context, name, begin_ns, end_ns - begin_ns, depth, buffer.thread_index});
+  }
+
+  void Tracer::Clear() {
+    auto &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto &buffer : registry.buffers) {
+      buffer->Clear();
+    }
+    registry.RemoveExitedThreads();
+  }
+
+  void Tracer::SetThreadName(std::string name) {
+    auto &buffer = GetThreadBuffer();
+    auto &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    buffer.thread_name = std::move(name);
+  }
+
+  std::vector<TraceEvent> Tracer::GetEvents() {
+    return CopyEvents(false);
+  }
+
+  void Tracer::ExportChromeTrace(std::ostream &out) {
+    // Names first, copying the events frees the buffers of exited threads.
+    std::vector<std::pair<uint32_t, std::string>> thread_names;
+    {
+      auto &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      for (auto &buffer : registry.buffers) {
+        if (!buffer->thread_name.empty()) {
+          thread_names.emplace_back(buffer->thread_index, buffer->thread_name);
+        }
+      }
+    }
+    const auto events = CopyEvents(true);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    out << std::fixed << std::setprecision(3);
+    bool first = true;
+    auto separator = [&]() {
+      out << (first ? "\n" : ",\n");
+      first = false;
+    };
+    for (const auto &thread_name : thread_names) {
+      separator();
+      out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread_name.first
+          << ",\"args\":{\"name\":";
+      WriteJsonString(out, thread_name.second);
+      out << "}}";
+    }
+    for (const auto &event : events) {
+      separator();
+      out << "{\"name\":\"" << event.name
+          << "\",\"cat\":\"" << event.context
+          << "\",\"ph\":\"X\",\"ts\":" << (1e-3 * static_cast<double>(event.begin_ns))
+          << ",\"dur\":" << (1e-3 * static_cast<double>(event.duration_ns))
+          << ",\"pid\":1,\"tid\":" << event.thread_index
+          << ",\"args\":{\"depth\":" << event.depth << "}}";
+    }
+    out << "\n]}\n";
+  }
+
+  std::string Tracer::SaveChromeTrace(std::string path) {
+    std::ofstream out(path);
+    if (!out) {
+      throw_exception(std::runtime_error("failed to open " + path));
+    }
+    ExportChromeTrace(out);
+    return path;
+  }
+
+} // namespace profiler
+} // namespace carla
@@ -0,0 +1,156 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace profiler {
+
+  /// A scope recorded by the Tracer.
+  struct TraceEvent {
+
+    /// Module of the scope, e.g. "streaming".
+    const char *context;
+
+    const char *name;
+
+    /// Nanoseconds since the tracer started.
+    uint64_t begin_ns;
+
+    uint64_t duration_ns;
+
+    /// Number of traced scopes enclosing this one in the same thread.
+    uint32_t depth;
+
+    /// Index of the thread, in order of first traced scope.
+    uint32_t thread_index;
+  };
+
+  /// Records the scopes instrumented with CARLA_TRACE_SCOPE.
+  ///
+  /// Tracing is off by default and toggled at run-time; when off a traced
+  /// scope costs a relaxed atomic load. When on, each thread appends its
+  /// scopes to its own ring buffer without locking, the oldest events of a
+  /// thread are overwritten when its buffer is full.
+  ///
+  /// If the environment variable CARLA_TRACE_FILE is set, tracing starts with
+  /// the process and the trace is saved to that file at exit.
+  ///
+  /// The trace is exported in the Chrome trace event format, readable by
+  /// chrome://tracing and Perfetto.
+  class Tracer {
+  public:
+
+    /// Events kept per thread.
+    static constexpr size_t events_per_thread = 1u << 15u;
+
+    static bool IsEnabled() {
+      return GetEnabledFlag().load(std::memory_order_relaxed);
+    }
+
+    static void Enable(bool enable = true) {
+      GetEnabledFlag().store(enable, std::memory_order_relaxed);
+    }
+
+    static void Disable() {
+      Enable(false);
+    }
+
+    /// Discard the events recorded so far, and free the buffers of the
+    /// threads that exited.
+    static void Clear();
+
+    /// Name the calling thread in the trace.
+    static void SetThreadName(std::string name);
+
+    /// Events recorded so far by every thread, sorted by begin time.
+    static std::vector<TraceEvent> GetEvents();
+
+    /// Write the events recorded so far as Chrome trace event JSON. The
+    /// buffers of the threads that exited are freed, so their events are
+    /// exported only once.
+    static void ExportChromeTrace(std::ostream &out);
+
+    /// Save the events recorded so far as Chrome trace event JSON.
+    ///
+    /// @return the path of the file written.
+    static std::string SaveChromeTrace(std::string path);
+
+    /// Nanoseconds since the tracer started.
+    static uint64_t Now() {
+      using namespace std::chrono;
+      return static_cast<uint64_t>(
+          duration_cast<nanoseconds>(steady_clock::now() - GetEpoch()).count());
+    }
+
+  private:
+
+    friend class ScopedTrace;
+
+    static std::atomic_bool &GetEnabledFlag();
+
+    static const std::chrono::steady_clock::time_point &GetEpoch();
+
+    /// Open a scope in the calling thread, returns its depth.
+    static uint32_t BeginScope();
+
+    /// Close the innermost scope of the calling thread.
+    static void EndScope(const char *context, const char *name, uint64_t begin_ns, uint32_t depth);
+  };
+
+  /// Records the lifetime of the enclosing scope if tracing is enabled when
+  /// it starts.
+  class ScopedTrace {
+  public:
+
+    ScopedTrace(const char *context, const char *name)
+      : _context(context),
+        _name(name),
+        _is_enabled(Tracer::IsEnabled()) {
+      if (_is_enabled) {
+        _depth = Tracer::BeginScope();
+        _begin_ns = Tracer::Now();
+      }
+    }
+
+    ~ScopedTrace() {
+      if (_is_enabled) {
+        Tracer::EndScope(_context, _name, _begin_ns, _depth);
+      }
+    }
+
+    ScopedTrace(const ScopedTrace &) = delete;
+    ScopedTrace &operator=(const ScopedTrace &) = delete;
+
+  private:
+
+    const char *_context;
+
+    const char *_name;
+
+    const bool _is_enabled;
+
+    uint32_t _depth = 0u;
+
+    uint64_t _begin_ns = 0u;
+  };
+
+} // namespace profiler
+} // namespace carla
+
+#ifdef LIBCARLA_DISABLE_TRACING
+#  define CARLA_TRACE_SCOPE(context, trace_name)
+#else
+#  define CARLA_TRACE_SCOPE(context, trace_name) \
+      ::carla::profiler::ScopedTrace carla_trace_ ## context ## _ ## trace_name ## _scope(#context, #trace_name);
+#endif // LIBCARLA_DISABLE_TRACING
@@ -0,0 +1,81 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/InformationSet.h"
+
+#include "carla/Debug.h"
+
+namespace carla {
+namespace road {
+
+  using namespace element;
+
+  /// Finds the type index of a RoadInfo.
+  class RoadInfoTypeVisitor : public RoadInfoVisitor {
+  public:
+
+    size_t type = NUMBER_OF_ROAD_INFO_TYPES;
+
+  private:
+
+    template <typename T>
+    void Set() {
+      type = RoadInfoTypeIndex<T>::value;
+    }
+
+    void Visit(RoadInfoElevation &) final { Set<RoadInfoElevation>(); }
+    void Visit(RoadInfoGeometry &) final { Set<RoadInfoGeometry>(); }
+    void Visit(RoadInfoLane &) final { Set<RoadInfoLane>(); }
+    void Visit(RoadInfoLaneAccess &) final { Set<RoadInfoLaneAccess>(); }
+    void Visit(RoadInfoLaneBorder &) final { Set<RoadInfoLaneBorder>(); }
+    void Visit(RoadInfoLaneHeight &) final { Set<RoadInfoLaneHeight>(); }
+    void Visit(RoadInfoLaneMaterial &) final { Set<RoadInfoLaneMaterial>(); }
+    void Visit(RoadInfoLaneOffset &) final { Set<RoadInfoLaneOffset>(); }
+    void Visit(RoadInfoLaneRule &) final { Set<RoadInfoLaneRule>(); }
+    void Visit(RoadInfoLaneVisibility &) final { Set<RoadInfoLaneVisibility>(); }
+    void Visit(RoadInfoLaneWidth &) final { Set<RoadInfoLaneWidth>(); }
+    void Visit(RoadInfoMarkRecord &) final { Set<RoadInfoMarkRecord>(); }
+    void Visit(RoadInfoMarkTypeLine &) final { Set<RoadInfoMarkTypeLine>(); }
+    void Visit(RoadInfoSpeed &) final { Set<RoadInfoSpeed>(); }
+    void Visit(RoadInfoCrosswalk &) final { Set<RoadInfoCrosswalk>(); }
+    void Visit(RoadInfoSignal &) final { Set<RoadInfoSignal>(); }
+  };
+
+  InformationSet::InformationSet(std::vector<std::unique_ptr<RoadInfo>> &&vec)
+    : _road_set(std::move(vec)) {
+    const auto &infos = _road_set.GetAll();
+
+    std::vector<size_t> types;
+    types.reserve(infos.size());
+    std::array<uint32_t, NUMBER_OF_ROAD_INFO_TYPES + 1u> counts{};
+    for (const auto &info : infos) {
+      DEBUG_ASSERT(info != nullptr);
+      RoadInfoTypeVisitor visitor;
+      info->AcceptVisitor(visitor);
+      DEBUG_ASSERT(visitor.type < NUMBER_OF_ROAD_INFO_TYPES);
+      types.emplace_back(visitor.type);
+      ++counts[visitor.type];
+    }
+
+    // Counting sort, keeps the order by s within each type.
+    for (size_t type = 0u; type < NUMBER_OF_ROAD_INFO_TYPES; ++type) {
+      _type_offsets[type + 1u] = _type_offsets[type] + counts[type];
+    }
+    auto next = _type_offsets;
+    const auto total = _type_offsets[NUMBER_OF_ROAD_INFO_TYPES];
+    _infos_by_type.resize(total);
+    _distances.resize(total);
+    for (size_t i = 0u; i < infos.size(); ++i) {
+      if (types[i] < NUMBER_OF_ROAD_INFO_TYPES) {
+        const auto index = next[types[i]]++;
+        _infos_by_type[index] = infos[i].get();
+        _distances[index] = infos[i]->GetDistance();
+      }
+    }
+  }
+
+} // namespace road
+} // namespace carla
@@ -9,29 +9,39 @@
 #include "carla/NonCopyable.h"
 #include "carla/road/RoadElementSet.h"
 #include "carla/road/element/RoadInfo.h"
-#include "carla/road/element/RoadInfoIterator.h"
+#include "carla/road/element/RoadInfoVisitor.h"
 
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace carla {
 namespace road {
 
+  /// The RoadInfo records of a road or a lane.
+  ///
+  /// Besides owning the records sorted by s, keeps them grouped by type, so
+  /// looking up the records of a type is a binary search over its own s
+  /// values without visiting the records of other types.
   class InformationSet : private MovableNonCopyable {
   public:
 
     InformationSet() = default;
 
-    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
-      : _road_set(std::move(vec)) {}
+    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec);
 
     /// Return all infos given a type from the start of the road
     template <typename T>
     std::vector<const T *> GetInfos() const {
+      const auto range = GetRange<T>();
       std::vector<const T *> vec;
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetAll());
-      for (; !it.IsAtEnd(); ++it) {
-        vec.emplace_back(&*it);
+      vec.reserve(range.second - range.first);
+      for (auto i = range.first; i < range.second; ++i) {
+        vec.emplace_back(Get<T>(i));
       }
       return vec;
     }
@@ -40,25 +50,35 @@ namespace road {
     /// the start of the road
     template <typename T>
     const T *GetInfo(const double s) const {
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetReverseSubset(s));
-      return it.IsAtEnd() ? nullptr : &*it;
+      const auto range = GetRange<T>();
+      // Last info with distance <= s.
+      const auto it = std::upper_bound(
+          _distances.begin() + range.first,
+          _distances.begin() + range.second,
+          s);
+      const auto index = static_cast<size_t>(it - _distances.begin());
+      return index == range.first ? nullptr : Get<T>(index - 1u);
     }
 
     /// Return all infos given a type in a given range of the road
     template <typename T>
     std::vector<const T *> GetInfos(const double min_s, const double max_s) const {
+      const auto range = GetRange<T>();
+      const auto begin = _distances.begin() + range.first;
+      const auto end = _distances.begin() + range.second;
       std::vector<const T *> vec;
       if(min_s < max_s) {
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetSubsetInRange(min_s, max_s)); //reverse
-        for (; !it.IsAtEnd(); ++it) {
-          vec.emplace_back(&*it);
+        const auto low_bound = std::lower_bound(begin, end, min_s);
+        const auto up_bound = std::upper_bound(low_bound, end, max_s);
+        for (auto it = low_bound; it != up_bound; ++it) {
+          vec.emplace_back(Get<T>(static_cast<size_t>(it - _distances.begin())));
         }
       } else {
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetReverseSubsetInRange(max_s, min_s)); //reverse
-        for (; !it.IsAtEnd(); ++it) {
-          vec.emplace_back(&*it);
+        //reverse
+        const auto low_bound = std::lower_bound(begin, end, max_s);
+        const auto up_bound = std::upper_bound(low_bound, end, min_s);
+        for (auto it = up_bound; it != low_bound; --it) {
+          vec.emplace_back(Get<T>(static_cast<size_t>(it - _distances.begin()) - 1u));
         }
       }
       return vec;
@@ -66,7 +86,29 @@ namespace road {
 
   private:
 
+    /// Range of the indices of the infos of type T.
+    template <typename T>
+    std::pair<size_t, size_t> GetRange() const {
+      constexpr auto type = element::RoadInfoTypeIndex<std::remove_cv_t<T>>::value;
+      return {_type_offsets[type], _type_offsets[type + 1u]};
+    }
+
+    template <typename T>
+    const T *Get(const size_t index) const {
+      return static_cast<const T *>(_infos_by_type[index]);
+    }
+
     RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set;
+
+    /// The infos grouped by type, each group sorted by s as in _road_set. The
+    /// infos of the type with index i are in
+    /// [_type_offsets[i], _type_offsets[i + 1]).
+    std::vector<const element::RoadInfo *> _infos_by_type;
+
+    /// The s of each info in _infos_by_type.
+    std::vector<double> _distances;
+
+    std::array<uint32_t, element::NUMBER_OF_ROAD_INFO_TYPES + 1u> _type_offsets{};
   };
 
 } // road
@@ -6,7 +6,11 @@
 
 #include "carla/road/Map.h"
 #include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/ParallelFor.h"
 #include "carla/geom/Math.h"
+#include "carla/profiler/Tracer.h"
+#include "carla/road/MapCache.h"
 #include "carla/road/MeshFactory.h"
 #include "carla/road/element/LaneCrossingCalculator.h"
 #include "carla/road/element/RoadInfoCrosswalk.h"
@@ -17,9 +21,11 @@
 #include "carla/road/element/RoadInfoMarkRecord.h"
 #include "carla/road/element/RoadInfoSignal.h"
 
+#include <iterator>
 #include <vector>
 #include <unordered_map>
 #include <stdexcept>
+#include <type_traits>
 
 namespace carla {
 namespace road {
@@ -46,6 +52,23 @@ namespace road {
     return dst;
   }
 
+  /// Number of queries processed together by each thread in the batched
+  /// queries.
+  static constexpr size_t QUERIES_PER_CHUNK = 256u;
+
+  /// Return @a query(input) for each of @a inputs, computed in parallel.
+  template <typename InputT, typename QueryT>
+  static auto ParallelQuery(const std::vector<InputT> &inputs, QueryT &&query) {
+    std::vector<std::decay_t<decltype(query(inputs.front()))>> results(inputs.size());
+    ParallelFor(inputs.size(), QUERIES_PER_CHUNK, GetDefaultNumberOfThreads(),
+        [&](const size_t begin, const size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        results[i] = query(inputs[i]);
+      }
+    });
+    return results;
+  }
+
   static double GetDistanceAtStartOfLane(const Lane &lane) {
     if (lane.GetId() <= 0) {
       return lane.GetDistance() + 10.0 * EPSILON;
@@ -156,12 +179,20 @@ namespace road {
   boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
       const geom::Location &pos,
       int32_t lane_type) const {
-    std::vector<Rtree::TreeElement> query_result =
-        _rtree.GetNearestNeighboursWithFilter(Rtree::BPoint(pos.x, pos.y, pos.z),
+    std::vector<Rtree::TreeElement> query_result;
+    return GetClosestWaypointOnRoad(pos, lane_type, query_result);
+  }
+
+  boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
+      const geom::Location &pos,
+      int32_t lane_type,
+      std::vector<Rtree::TreeElement> &query_result) const {
+    _rtree.GetNearestNeighboursWithFilter(Rtree::BPoint(pos.x, pos.y, pos.z),
         [&](Rtree::TreeElement const &element) {
           const Lane &lane = GetLane(element.second.first);
           return (lane_type & static_cast<int32_t>(lane.GetType())) > 0;
-        });
+        },
+        query_result);
 
     if (query_result.size() == 0) {
       return boost::optional<Waypoint>{};
@@ -203,7 +234,15 @@ namespace road {
   boost::optional<Waypoint> Map::GetWaypoint(
       const geom::Location &pos,
       int32_t lane_type) const {
-    boost::optional<Waypoint> w = GetClosestWaypointOnRoad(pos, lane_type);
+    std::vector<Rtree::TreeElement> query_result;
+    return GetWaypoint(pos, lane_type, query_result);
+  }
+
+  boost::optional<Waypoint> Map::GetWaypoint(
+      const geom::Location &pos,
+      int32_t lane_type,
+      std::vector<Rtree::TreeElement> &query_result) const {
+    boost::optional<Waypoint> w = GetClosestWaypointOnRoad(pos, lane_type, query_result);
 
     if (!w.has_value()) {
       return w;
@@ -502,6 +541,60 @@ namespace road {
     return result;
   }
 
+  // ===========================================================================
+  // -- Map: Batched queries ---------------------------------------------------
+  // ===========================================================================
+
+  std::vector<boost::optional<Waypoint>> Map::GetClosestWaypointsOnRoad(
+      const std::vector<geom::Location> &locations,
+      const int32_t lane_type) const {
+    std::vector<boost::optional<Waypoint>> result(locations.size());
+    ParallelFor(locations.size(), QUERIES_PER_CHUNK, GetDefaultNumberOfThreads(),
+        [&](const size_t begin, const size_t end) {
+      std::vector<Rtree::TreeElement> query_result;
+      for (auto i = begin; i < end; ++i) {
+        result[i] = GetClosestWaypointOnRoad(locations[i], lane_type, query_result);
+      }
+    });
+    return result;
+  }
+
+  std::vector<boost::optional<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      const int32_t lane_type) const {
+    std::vector<boost::optional<Waypoint>> result(locations.size());
+    ParallelFor(locations.size(), QUERIES_PER_CHUNK, GetDefaultNumberOfThreads(),
+        [&](const size_t begin, const size_t end) {
+      std::vector<Rtree::TreeElement> query_result;
+      for (auto i = begin; i < end; ++i) {
+        result[i] = GetWaypoint(locations[i], lane_type, query_result);
+      }
+    });
+    return result;
+  }
+
+  std::vector<geom::Transform> Map::ComputeTransforms(
+      const std::vector<Waypoint> &waypoints) const {
+    return ParallelQuery(waypoints, [this](const Waypoint &waypoint) {
+      return ComputeTransform(waypoint);
+    });
+  }
+
+  std::vector<double> Map::GetLaneWidths(
+      const std::vector<Waypoint> &waypoints) const {
+    return ParallelQuery(waypoints, [this](const Waypoint &waypoint) {
+      return GetLaneWidth(waypoint);
+    });
+  }
+
+  std::vector<std::vector<Waypoint>> Map::GetNextWaypoints(
+      const std::vector<Waypoint> &waypoints,
+      const double distance) const {
+    return ParallelQuery(waypoints, [this, distance](const Waypoint &waypoint) {
+      return GetNext(waypoint, distance);
+    });
+  }
+
   // ===========================================================================
   // -- Map: Waypoint generation -----------------------------------------------
   // ===========================================================================
@@ -821,7 +914,7 @@ namespace road {
       geom::Transform &current_transform,
       geom::Transform &next_transform,
       Waypoint &current_waypoint,
-      Waypoint &next_waypoint) {
+      Waypoint &next_waypoint) const {
     Rtree::BPoint init =
         Rtree::BPoint(
         current_transform.location.x,
@@ -841,7 +934,7 @@ namespace road {
       std::vector<Rtree::TreeElement> &rtree_elements,
       geom::Transform &current_transform,
       Waypoint &current_waypoint,
-      Waypoint &next_waypoint) {
+      Waypoint &next_waypoint) const {
     geom::Transform next_transform = ComputeTransform(next_waypoint);
     AddElementToRtree(rtree_elements, current_transform, next_transform,
     current_waypoint, next_waypoint);
@@ -859,7 +952,9 @@ namespace road {
     }
   }
 
-  void Map::CreateRtree() {
+  void Map::AddLaneToRtree(
+      std::vector<Rtree::TreeElement> &rtree_elements,
+      const Waypoint &lane_start_waypoint) const {
     const double epsilon = 0.000001; // small delta in the road (set to 1
                                      // micrometer to prevent numeric errors)
     const double min_delta_s = 1;    // segments of minimum 1m through the road
@@ -869,6 +964,89 @@ namespace road {
     // maximum distance of a segment
     constexpr double max_segment_length = 100.0;
 
+    auto current_waypoint = lane_start_waypoint;
+
+    const Lane &lane = GetLane(current_waypoint);
+
+    geom::Transform current_transform = ComputeTransform(current_waypoint);
+
+    // Save computation time in straight lines
+    if (lane.IsStraight()) {
+      double delta_s = min_delta_s;
+      double remaining_length =
+          GetRemainingLength(lane, current_waypoint.s);
+      remaining_length -= epsilon;
+      delta_s = remaining_length;
+      if (delta_s < epsilon) {
+        return;
+      }
+      auto next = GetNext(current_waypoint, delta_s);
+
+      RELEASE_ASSERT(next.size() == 1);
+      RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id);
+      auto next_waypoint = next.front();
+
+      AddElementToRtreeAndUpdateTransforms(
+          rtree_elements,
+          current_transform,
+          current_waypoint,
+          next_waypoint);
+      // end of lane
+    } else {
+      auto next_waypoint = current_waypoint;
+
+      // Loop until the end of the lane
+      // Advance in small s-increments
+      while (true) {
+        double delta_s = min_delta_s;
+        double remaining_length =
+            GetRemainingLength(lane, next_waypoint.s);
+        remaining_length -= epsilon;
+        delta_s = std::min(delta_s, remaining_length);
+
+        if (delta_s < epsilon) {
+          AddElementToRtreeAndUpdateTransforms(
+              rtree_elements,
+              current_transform,
+              current_waypoint,
+              next_waypoint);
+          break;
+        }
+
+        auto next = GetNext(next_waypoint, delta_s);
+        if (next.size() != 1 ||
+        current_waypoint.section_id != next.front().section_id) {
+          AddElementToRtreeAndUpdateTransforms(
+              rtree_elements,
+              current_transform,
+              current_waypoint,
+              next_waypoint);
+          break;
+        }
+
+        next_waypoint = next.front();
+        geom::Transform next_transform = ComputeTransform(next_waypoint);
+        double angle = geom::Math::GetVectorAngle(
+            current_transform.GetForwardVector(), next_transform.GetForwardVector());
+
+        if (std::abs(angle) > angle_threshold ||
+            std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) {
+          AddElementToRtree(
+              rtree_elements,
+              current_transform,
+              next_transform,
+              current_waypoint,
+              next_waypoint);
+          current_waypoint = next_waypoint;
+          current_transform = next_transform;
+        }
+      }
+    }
+  }
+
+  void Map::CreateRtree() {
+    CARLA_TRACE_SCOPE(road, create_rtree);
+
     // Generate waypoints at start of every lane
     std::vector<Waypoint> topology;
     for (const auto &pair : _data.GetRoads()) {
@@ -880,93 +1058,72 @@ namespace road {
       });
     }
 
-    // Container of segments and waypoints
-    std::vector<Rtree::TreeElement> rtree_elements;
-    // Loop through all lanes
-    for (auto &waypoint : topology) {
-      auto &lane_start_waypoint = waypoint;
-
-      auto current_waypoint = lane_start_waypoint;
-
-      const Lane &lane = GetLane(current_waypoint);
+    // Lanes are independent and the map is only read, so the segments are
+    // computed in parallel, each chunk of lanes into its own container.
+    constexpr size_t lanes_per_chunk = 32u;
+    std::vector<std::vector<Rtree::TreeElement>> chunks(
+        (topology.size() + lanes_per_chunk - 1u) / lanes_per_chunk);
+    {
+      CARLA_TRACE_SCOPE(road, create_rtree_segments);
+      ParallelFor(topology.size(), lanes_per_chunk, GetDefaultNumberOfThreads(),
+          [&](const size_t begin, const size_t end) {
+        auto &chunk = chunks[begin / lanes_per_chunk];
+        for (auto i = begin; i < end; ++i) {
+          AddLaneToRtree(chunk, topology[i]);
+        }
+      });
+    }
 
-      geom::Transform current_transform = ComputeTransform(current_waypoint);
+    // Concatenate in lane order so the result does not depend on the threads.
+    size_t total_size = 0u;
+    for (const auto &chunk : chunks) {
+      total_size += chunk.size();
+    }
+    std::vector<Rtree::TreeElement> rtree_elements;
+    rtree_elements.reserve(total_size);
+    for (auto &chunk : chunks) {
+      std::move(chunk.begin(), chunk.end(), std::back_inserter(rtree_elements));
+    }
 
-      // Save computation time in straight lines
-      if (lane.IsStraight()) {
-        double delta_s = min_delta_s;
-        double remaining_length =
-            GetRemainingLength(lane, current_waypoint.s);
-        remaining_length -= epsilon;
-        delta_s = remaining_length;
-        if (delta_s < epsilon) {
-          continue;
-        }
-        auto next = GetNext(current_waypoint, delta_s);
-
-        RELEASE_ASSERT(next.size() == 1);
-        RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id);
-        auto next_waypoint = next.front();
-
-        AddElementToRtreeAndUpdateTransforms(
-            rtree_elements,
-            current_transform,
-            current_waypoint,
-            next_waypoint);
-        // end of lane
-      } else {
-        auto next_waypoint = current_waypoint;
-
-        // Loop until the end of the lane
-        // Advance in small s-increments
-        while (true) {
-          double delta_s = min_delta_s;
-          double remaining_length =
-              GetRemainingLength(lane, next_waypoint.s);
-          remaining_length -= epsilon;
-          delta_s = std::min(delta_s, remaining_length);
-
-          if (delta_s < epsilon) {
-            AddElementToRtreeAndUpdateTransforms(
-                rtree_elements,
-                current_transform,
-                current_waypoint,
-                next_waypoint);
-            break;
-          }
+    // Add segments to Rtree
+    CARLA_TRACE_SCOPE(road, create_rtree_bulk_load);
+    _rtree.BulkLoad(rtree_elements);
+  }
 
-          auto next = GetNext(next_waypoint, delta_s);
-          if (next.size() != 1 ||
-          current_waypoint.section_id != next.front().section_id) {
-            AddElementToRtreeAndUpdateTransforms(
-                rtree_elements,
-                current_transform,
-                current_waypoint,
-                next_waypoint);
-            break;
-          }
+  Map::Map(MapData m, const MapCache &cache) : _data(std::move(m)) {
+    if (!LoadRtree(cache)) {
+      log_warning("map cache does not match the map, computing the waypoint rtree");
+      CreateRtree();
+    }
+  }
 
-          next_waypoint = next.front();
-          geom::Transform next_transform = ComputeTransform(next_waypoint);
-          double angle = geom::Math::GetVectorAngle(
-              current_transform.GetForwardVector(), next_transform.GetForwardVector());
-
-          if (std::abs(angle) > angle_threshold ||
-              std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) {
-            AddElementToRtree(
-                rtree_elements,
-                current_transform,
-                next_transform,
-                current_waypoint,
-                next_waypoint);
-            current_waypoint = next_waypoint;
-            current_transform = next_transform;
-          }
-        }
+  bool Map::LoadRtree(const MapCache &cache) {
+    CARLA_TRACE_SCOPE(road, load_rtree);
+    const auto &roads = _data.GetRoads();
+    auto to_waypoint = [&](const MapCache::WaypointRecord &record, Waypoint &waypoint) {
+      waypoint.road_id = record.road_id;
+      waypoint.section_id = record.section_id;
+      waypoint.lane_id = record.lane_id;
+      waypoint.s = record.s;
+      return roads.find(record.road_id) != roads.end();
+    };
+
+    std::vector<Rtree::TreeElement> rtree_elements(cache.GetNumberOfSegments());
+    for (uint32_t i = 0u; i < cache.GetNumberOfSegments(); ++i) {
+      const auto &record = cache.GetSegment(i);
+      auto &element = rtree_elements[i];
+      element.first = Rtree::BSegment(
+          Rtree::BPoint(record.start[0], record.start[1], record.start[2]),
+          Rtree::BPoint(record.end[0], record.end[1], record.end[2]));
+      // Lanes are not checked, a cache of the same OpenDRIVE has the same
+      // lanes.
+      if (!to_waypoint(record.waypoints[0u], element.second.first) ||
+          !to_waypoint(record.waypoints[1u], element.second.second)) {
+        return false;
       }
     }
-    // Add segments to Rtree
-    _rtree.InsertElements(rtree_elements);
+    _rtree.BulkLoad(rtree_elements);
+    return true;
   }
 
   Junction* Map::GetJunction(JuncId id) {
@@ -24,6 +24,8 @@
 namespace carla {
 namespace road {
 
+  class MapCache;
+
   class Map : private MovableNonCopyable {
   public:
 
@@ -104,6 +106,35 @@ namespace road {
     std::vector<const element::RoadInfoSignal*>
         GetAllSignalReferences() const;
 
+    /// ========================================================================
+    /// -- Batched queries -----------------------------------------------------
+    /// ========================================================================
+
+    /// The following are equivalent to calling the single query for each
+    /// element, but split the elements in chunks that are processed in
+    /// parallel, and reuse the R-tree query buffers within each chunk. The
+    /// i-th result corresponds to the i-th element of the input.
+
+    std::vector<boost::optional<Waypoint>> GetClosestWaypointsOnRoad(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
+    std::vector<boost::optional<Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
+    std::vector<geom::Transform> ComputeTransforms(
+        const std::vector<Waypoint> &waypoints) const;
+
+    std::vector<double> GetLaneWidths(
+        const std::vector<Waypoint> &waypoints) const;
+
+    /// Return, for each of @a waypoints, the waypoints at @a distance as
+    /// returned by GetNext.
+    std::vector<std::vector<Waypoint>> GetNextWaypoints(
+        const std::vector<Waypoint> &waypoints,
+        double distance) const;
+
     /// ========================================================================
     /// -- Waypoint generation -------------------------------------------------
     /// ========================================================================
@@ -181,26 +212,52 @@ namespace road {
 private:
 
     friend MapBuilder;
+    friend MapCache;
     MapData _data;
 
     using Rtree = geom::SegmentCloudRtree<Waypoint>;
     Rtree _rtree;
 
+    /// Restore the rtree from @a cache instead of computing it.
+    Map(MapData m, const MapCache &cache);
+
     void CreateRtree();
 
+    /// GetClosestWaypointOnRoad and GetWaypoint using @a query_result as
+    /// buffer for the R-tree query.
+    boost::optional<Waypoint> GetClosestWaypointOnRoad(
+        const geom::Location &location,
+        int32_t lane_type,
+        std::vector<Rtree::TreeElement> &query_result) const;
+
+    boost::optional<Waypoint> GetWaypoint(
+        const geom::Location &location,
+        int32_t lane_type,
+        std::vector<Rtree::TreeElement> &query_result) const;
+
+    /// Load the rtree segments of @a cache. Returns false, leaving the rtree
+    /// empty, if they do not belong to this map.
+    bool LoadRtree(const MapCache &cache);
+
     /// Helper Functions for constructing the rtree element list
     void AddElementToRtree(
         std::vector<Rtree::TreeElement> &rtree_elements,
         geom::Transform &current_transform,
         geom::Transform &next_transform,
         Waypoint &current_waypoint,
-        Waypoint &next_waypoint);
+        Waypoint &next_waypoint) const;
 
     void AddElementToRtreeAndUpdateTransforms(
         std::vector<Rtree::TreeElement> &rtree_elements,
         geom::Transform &current_transform,
         Waypoint &current_waypoint,
-        Waypoint &next_waypoint);
+        Waypoint &next_waypoint) const;
+
+    /// Append the segments of the lane starting at @a lane_start_waypoint.
+    /// Only reads the map, safe to call from several threads.
+    void AddLaneToRtree(
+        std::vector<Rtree::TreeElement> &rtree_elements,
+        const Waypoint &lane_start_waypoint) const;
   };
 
 } // namespace road
@@ -4,10 +4,13 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/ParallelFor.h"
 #include "carla/StringUtil.h"
+#include "carla/profiler/Tracer.h"
 #include "carla/road/MapBuilder.h"
 #include "carla/road/element/RoadInfoElevation.h"
 #include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoIterator.h"
 #include "carla/road/element/RoadInfoLaneAccess.h"
 #include "carla/road/element/RoadInfoLaneBorder.h"
 #include "carla/road/element/RoadInfoLaneHeight.h"
@@ -36,6 +39,15 @@ namespace carla {
 namespace road {
 
   boost::optional<Map> MapBuilder::Build() {
+    return Build(nullptr);
+  }
+
+  boost::optional<Map> MapBuilder::Build(const MapCache &cache) {
+    return Build(&cache);
+  }
+
+  boost::optional<Map> MapBuilder::Build(const MapCache *cache) {
+    CARLA_TRACE_SCOPE(road, build_map);
 
     CreatePointersBetweenRoadSegments();
     RemoveZeroLaneValiditySignalReferences();
@@ -62,10 +74,17 @@ namespace road {
     // _map_data is a memeber of MapBuilder so you must especify if
     // you want to keep it (will return copy -> Map(const Map &))
     // or move it (will return move -> Map(Map &&))
-    Map map(std::move(_map_data));
-    CreateJunctionBoundingBoxes(map);
-    ComputeJunctionRoadConflicts(map);
-    CheckSignalsOnRoads(map);
+    Map map = (cache != nullptr) ?
+        Map(std::move(_map_data), *cache) :
+        Map(std::move(_map_data));
+    if ((cache == nullptr) || !LoadJunctions(map, *cache)) {
+      CreateJunctionBoundingBoxes(map);
+      ComputeJunctionRoadConflicts(map);
+    }
+    {
+      CARLA_TRACE_SCOPE(road, check_signals);
+      CheckSignalsOnRoads(map);
+    }
 
     return map;
   }
@@ -836,71 +855,81 @@ namespace road {
   }
 
   void MapBuilder::CreateJunctionBoundingBoxes(Map &map) {
+    CARLA_TRACE_SCOPE(road, junction_bounding_boxes);
+    std::vector<Junction *> junctions;
+    junctions.reserve(map._data.GetJunctions().size());
     for (auto &junctionpair : map._data.GetJunctions()) {
-      auto* junction = map.GetJunction(junctionpair.first);
-      auto waypoints = map.GetJunctionWaypoints(junction->GetId(), Lane::LaneType::Any);
-      const int number_intervals = 10;
-
-      float minx = std::numeric_limits<float>::max();
-      float miny = std::numeric_limits<float>::max();
-      float minz = std::numeric_limits<float>::max();
-      float maxx = -std::numeric_limits<float>::max();
-      float maxy = -std::numeric_limits<float>::max();
-      float maxz = -std::numeric_limits<float>::max();
-
-      auto get_min_max = [&](geom::Location position) {
-        if (position.x < minx) {
-          minx = position.x;
-        }
-        if (position.y < miny) {
-          miny = position.y;
-        }
-        if (position.z < minz) {
-          minz = position.z;
-        }
+      junctions.emplace_back(&junctionpair.second);
+    }
+    // Each junction only writes its own bounding box.
+    ParallelFor(junctions.size(), 1u, GetDefaultNumberOfThreads(),
+        [&](const size_t begin, const size_t end) {
+      for (auto index = begin; index < end; ++index) {
+        auto* junction = junctions[index];
+        auto waypoints = map.GetJunctionWaypoints(junction->GetId(), Lane::LaneType::Any);
+        const int number_intervals = 10;
+
+        float minx = std::numeric_limits<float>::max();
+        float miny = std::numeric_limits<float>::max();
+        float minz = std::numeric_limits<float>::max();
+        float maxx = -std::numeric_limits<float>::max();
+        float maxy = -std::numeric_limits<float>::max();
+        float maxz = -std::numeric_limits<float>::max();
+
+        auto get_min_max = [&](geom::Location position) {
+          if (position.x < minx) {
+            minx = position.x;
+          }
+          if (position.y < miny) {
+            miny = position.y;
+          }
+          if (position.z < minz) {
+            minz = position.z;
+          }
 
-        if (position.x > maxx) {
-          maxx = position.x;
-        }
-        if (position.y > maxy) {
-          maxy = position.y;
-        }
-        if (position.z > maxz) {
-          maxz = position.z;
-        }
-      };
+          if (position.x > maxx) {
+            maxx = position.x;
+          }
+          if (position.y > maxy) {
+            maxy = position.y;
+          }
+          if (position.z > maxz) {
+            maxz = position.z;
+          }
+        };
 
-      for (auto &waypoint_p : waypoints) {
-        auto &waypoint_start = waypoint_p.first;
-        auto &waypoint_end = waypoint_p.second;
-        double interval = (waypoint_end.s - waypoint_start.s) / static_cast<double>(number_intervals);
-        auto next_wp = waypoint_end;
-        auto location = map.ComputeTransform(next_wp).location;
+        for (auto &waypoint_p : waypoints) {
+          auto &waypoint_start = waypoint_p.first;
+          auto &waypoint_end = waypoint_p.second;
+          double interval = (waypoint_end.s - waypoint_start.s) / static_cast<double>(number_intervals);
+          auto next_wp = waypoint_end;
+          auto location = map.ComputeTransform(next_wp).location;
 
-        get_min_max(location);
+          get_min_max(location);
 
-        next_wp = waypoint_start;
-        location = map.ComputeTransform(next_wp).location;
+          next_wp = waypoint_start;
+          location = map.ComputeTransform(next_wp).location;
 
-        get_min_max(location);
+          get_min_max(location);
 
-        for (int i = 0; i < number_intervals; ++i) {
-          if (interval < std::numeric_limits<double>::epsilon())
-            break;
-          auto next = map.GetNext(next_wp, interval);
-          if(next.size()){
-            next_wp = next.back();
-          }
+          for (int i = 0; i < number_intervals; ++i) {
+            if (interval < std::numeric_limits<double>::epsilon())
+              break;
+            auto next = map.GetNext(next_wp, interval);
+            if(next.size()){
+              next_wp = next.back();
+            }
 
-          location = map.ComputeTransform(next_wp).location;
-          get_min_max(location);
+            location = map.ComputeTransform(next_wp).location;
+            get_min_max(location);
+          }
         }
-      }
-      carla::geom::Location location(0.5f * (maxx + minx), 0.5f * (maxy + miny), 0.5f * (maxz + minz));
-      carla::geom::Vector3D extent(0.5f * (maxx - minx), 0.5f * (maxy - miny), 0.5f * (maxz - minz));
+        carla::geom::Location location(0.5f * (maxx + minx), 0.5f * (maxy + miny), 0.5f * (maxz + minz));
+        carla::geom::Vector3D extent(0.5f * (maxx - minx), 0.5f * (maxy - miny), 0.5f * (maxz - minz));
 
-      junction->_bounding_box = carla::geom::BoundingBox(location, extent);
-    }
+        junction->_bounding_box = carla::geom::BoundingBox(location, extent);
+      }
+    });
   }
 
 void MapBuilder::CreateController(
@@ -932,10 +961,48 @@ void MapBuilder::CreateController(
 }
 
   void MapBuilder::ComputeJunctionRoadConflicts(Map &map) {
+    CARLA_TRACE_SCOPE(road, junction_road_conflicts);
+    std::vector<Junction *> junctions;
+    junctions.reserve(map._data.GetJunctions().size());
     for (auto &junctionpair : map._data.GetJunctions()) {
-      auto& junction = junctionpair.second;
-      junction._road_conflicts = (map.ComputeJunctionConflicts(junction.GetId()));
+      junctions.emplace_back(&junctionpair.second);
+    }
+    // The rtree is only read here, each junction writes its own conflicts.
+    ParallelFor(junctions.size(), 1u, GetDefaultNumberOfThreads(),
+        [&](const size_t begin, const size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        auto &junction = *junctions[i];
+        junction._road_conflicts = (map.ComputeJunctionConflicts(junction.GetId()));
+      }
+    });
+  }
+
+  bool MapBuilder::LoadJunctions(Map &map, const MapCache &cache) {
+    CARLA_TRACE_SCOPE(road, load_junctions);
+    auto &junctions = map._data.GetJunctions();
+    if (cache.GetNumberOfJunctions() != junctions.size()) {
+      log_warning("map cache does not match the junctions, computing them");
+      return false;
+    }
+    for (uint32_t i = 0u; i < cache.GetNumberOfJunctions(); ++i) {
+      if (junctions.find(cache.GetJunction(i).id) == junctions.end()) {
+        log_warning("map cache does not match the junctions, computing them");
+        return false;
+      }
+    }
+    for (uint32_t i = 0u; i < cache.GetNumberOfJunctions(); ++i) {
+      const auto &record = cache.GetJunction(i);
+      auto &junction = junctions.at(record.id);
+      junction._bounding_box = geom::BoundingBox(
+          geom::Location(record.location[0], record.location[1], record.location[2]),
+          geom::Vector3D(record.extent[0], record.extent[1], record.extent[2]));
+      junction._road_conflicts.clear();
+      for (uint32_t j = 0u; j < record.number_of_conflicts; ++j) {
+        const auto &conflict = cache.GetConflict(record.first_conflict + j);
+        junction._road_conflicts[conflict.road_id].insert(conflict.conflicting_road_id);
+      }
     }
+    return true;
   }
 
   void MapBuilder::GenerateDefaultValiditiesForSignalReferences() {
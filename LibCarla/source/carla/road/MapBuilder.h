@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/road/Map.h"
+#include "carla/road/MapCache.h"
 #include "carla/road/element/RoadInfoCrosswalk.h"
 #include "carla/road/element/RoadInfoSignal.h"
 
@@ -22,6 +23,11 @@ namespace road {
 
     boost::optional<Map> Build();
 
+    /// Same as Build, but restores the rtree and the junction bounding boxes
+    /// and conflicts from @a cache instead of computing them. The cache must
+    /// have been created from the same OpenDRIVE.
+    boost::optional<Map> Build(const MapCache &cache);
+
     // called from road parser
     carla::road::Road *AddRoad(
         const RoadId road_id,
@@ -383,6 +389,12 @@ namespace road {
     /// Compute the conflicts of the roads (intersecting roads)
     void ComputeJunctionRoadConflicts(Map &map);
 
+    /// Restore the bounding boxes and conflicts of the junctions from
+    /// @a cache. Returns false if the cache does not match the junctions.
+    bool LoadJunctions(Map &map, const MapCache &cache);
+
+    boost::optional<Map> Build(const MapCache *cache);
+
     /// Generates a default validity field for signal references with missing validity record in OpenDRIVE
     void GenerateDefaultValiditiesForSignalReferences();
 
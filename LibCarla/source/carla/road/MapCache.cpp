@@ -0,0 +1,166 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/MapCache.h"
+
+#include "carla/Logging.h"
+#include "carla/road/Map.h"
+
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  static constexpr char CACHE_MAGIC[4] = {'C', 'R', 'M', 'C'};
+
+  constexpr uint32_t MapCache::VERSION;
+
+  template <typename T>
+  static void WriteArray(std::ostream &out, const T *data, size_t count) {
+    out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(sizeof(T) * count));
+  }
+
+  template <typename PointT>
+  static void WritePoint(const PointT &point, float (&out)[3]) {
+    out[0] = point.template get<0>();
+    out[1] = point.template get<1>();
+    out[2] = point.template get<2>();
+  }
+
+  static void WriteWaypoint(const element::Waypoint &waypoint, MapCache::WaypointRecord &out) {
+    out.s = waypoint.s;
+    out.road_id = waypoint.road_id;
+    out.section_id = waypoint.section_id;
+    out.lane_id = waypoint.lane_id;
+  }
+
+  uint64_t MapCache::Hash(const std::string &opendrive) {
+    // 64-bit FNV-1a.
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : opendrive) {
+      hash ^= static_cast<uint8_t>(c);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  bool MapCache::HasHeader(const uint8_t *data, size_t size) {
+    return size >= sizeof(Header) && std::memcmp(data, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0;
+  }
+
+  bool MapCache::Write(const Map &map, const std::string &opendrive, std::ostream &out) {
+    const auto rtree_elements = map._rtree.GetElements();
+    std::vector<SegmentRecord> segments(rtree_elements.size());
+    for (size_t i = 0u; i < rtree_elements.size(); ++i) {
+      const auto &element = rtree_elements[i];
+      SegmentRecord &record = segments[i];
+      std::memset(&record, 0, sizeof(SegmentRecord));
+      WritePoint(element.first.first, record.start);
+      WritePoint(element.first.second, record.end);
+      WriteWaypoint(element.second.first, record.waypoints[0u]);
+      WriteWaypoint(element.second.second, record.waypoints[1u]);
+    }
+
+    std::vector<JunctionRecord> junctions;
+    std::vector<ConflictRecord> conflicts;
+    junctions.reserve(map._data.GetJunctions().size());
+    for (const auto &pair : map._data.GetJunctions()) {
+      const Junction &junction = pair.second;
+      JunctionRecord record;
+      std::memset(&record, 0, sizeof(JunctionRecord));
+      record.id = junction.GetId();
+      const auto &bounding_box = junction._bounding_box;
+      record.location[0] = bounding_box.location.x;
+      record.location[1] = bounding_box.location.y;
+      record.location[2] = bounding_box.location.z;
+      record.extent[0] = bounding_box.extent.x;
+      record.extent[1] = bounding_box.extent.y;
+      record.extent[2] = bounding_box.extent.z;
+      record.first_conflict = static_cast<uint32_t>(conflicts.size());
+      for (const auto &road_conflicts : junction._road_conflicts) {
+        for (const auto conflicting_road_id : road_conflicts.second) {
+          conflicts.push_back({road_conflicts.first, conflicting_road_id});
+        }
+      }
+      record.number_of_conflicts = static_cast<uint32_t>(conflicts.size()) - record.first_conflict;
+      junctions.emplace_back(record);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = VERSION;
+    header.opendrive_hash = Hash(opendrive);
+    header.opendrive_size = opendrive.size();
+    header.number_of_segments = static_cast<uint32_t>(segments.size());
+    header.number_of_junctions = static_cast<uint32_t>(junctions.size());
+    header.number_of_conflicts = static_cast<uint32_t>(conflicts.size());
+
+    WriteArray(out, &header, 1u);
+    WriteArray(out, segments.data(), segments.size());
+    WriteArray(out, junctions.data(), junctions.size());
+    WriteArray(out, conflicts.data(), conflicts.size());
+    return out.good();
+  }
+
+  MapCache::MapCache(const uint8_t *data, size_t size) {
+    if (!HasHeader(data, size)) {
+      log_error("map cache: unknown file format");
+      return;
+    }
+    if (reinterpret_cast<uintptr_t>(data) % alignof(SegmentRecord) != 0u) {
+      log_error("map cache: misaligned buffer");
+      return;
+    }
+
+    const Header &header = *reinterpret_cast<const Header *>(data);
+    if (header.version != VERSION) {
+      log_error("map cache: unsupported version", header.version, "expected", VERSION);
+      return;
+    }
+
+    const size_t expected_size =
+        sizeof(Header) +
+        sizeof(SegmentRecord) * header.number_of_segments +
+        sizeof(JunctionRecord) * header.number_of_junctions +
+        sizeof(ConflictRecord) * header.number_of_conflicts;
+    if (size < expected_size) {
+      log_error("map cache: truncated file");
+      return;
+    }
+
+    const uint8_t *position = data + sizeof(Header);
+    const auto *segments = reinterpret_cast<const SegmentRecord *>(position);
+    position += sizeof(SegmentRecord) * header.number_of_segments;
+    const auto *junctions = reinterpret_cast<const JunctionRecord *>(position);
+    position += sizeof(JunctionRecord) * header.number_of_junctions;
+    const auto *conflicts = reinterpret_cast<const ConflictRecord *>(position);
+
+    // Validating the ranges once here allows using them unchecked later.
+    for (uint32_t i = 0u; i < header.number_of_junctions; ++i) {
+      const JunctionRecord &junction = junctions[i];
+      if (junction.first_conflict > header.number_of_conflicts ||
+          junction.number_of_conflicts > header.number_of_conflicts - junction.first_conflict) {
+        log_error("map cache: corrupted junction conflicts");
+        return;
+      }
+    }
+
+    _header = &header;
+    _segments = segments;
+    _junctions = junctions;
+    _conflicts = conflicts;
+  }
+
+  bool MapCache::IsCacheOf(const std::string &opendrive) const {
+    return IsValid() &&
+        (_header->opendrive_size == opendrive.size()) &&
+        (_header->opendrive_hash == Hash(opendrive));
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,143 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/RoadTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace carla {
+namespace road {
+
+  class Map;
+
+  /// Read-only view over a binary snapshot of the data of a road::Map that is
+  /// computed from the roads after parsing the OpenDRIVE: the segments of the
+  /// waypoint rtree, and the bounding box and road conflicts of each
+  /// junction. Building these takes most of the time of loading a map.
+  ///
+  /// The snapshot is keyed by a hash of the OpenDRIVE it was created from and
+  /// is only used with that same OpenDRIVE. The view does not copy nor decode
+  /// the buffer, so it can be used directly on top of a memory-mapped file.
+  ///
+  /// Layout (native endianness):
+  ///
+  ///   Header
+  ///   SegmentRecord[number_of_segments]
+  ///   JunctionRecord[number_of_junctions]
+  ///   ConflictRecord[number_of_conflicts]
+  ///
+  /// The conflicts of junction i are the records in
+  /// [first_conflict, first_conflict + number_of_conflicts).
+  class MapCache {
+  public:
+
+    static constexpr uint32_t VERSION = 1u;
+
+    struct Header {
+      char magic[4];
+      uint32_t version;
+      uint64_t opendrive_hash;
+      uint64_t opendrive_size;
+      uint32_t number_of_segments;
+      uint32_t number_of_junctions;
+      uint32_t number_of_conflicts;
+      uint32_t reserved;
+    };
+
+    struct WaypointRecord {
+      double s;
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+      uint32_t padding;
+    };
+
+    struct SegmentRecord {
+      float start[3];
+      float end[3];
+      WaypointRecord waypoints[2];
+    };
+
+    struct JunctionRecord {
+      JuncId id;
+      float location[3];
+      float extent[3];
+      uint32_t first_conflict;
+      uint32_t number_of_conflicts;
+      uint32_t padding;
+    };
+
+    struct ConflictRecord {
+      RoadId road_id;
+      RoadId conflicting_road_id;
+    };
+
+    static_assert(sizeof(Header) == 40u, "Unexpected map cache header size");
+    static_assert(sizeof(SegmentRecord) == 72u, "Unexpected map cache segment size");
+    static_assert(sizeof(JunctionRecord) == 40u, "Unexpected map cache junction size");
+    static_assert(sizeof(ConflictRecord) == 8u, "Unexpected map cache conflict size");
+
+    /// Hash of @a opendrive used as key of the snapshot, stable across
+    /// platforms and runs.
+    static uint64_t Hash(const std::string &opendrive);
+
+    /// Returns whether @a data starts with a header of this layout, of any
+    /// version.
+    static bool HasHeader(const uint8_t *data, size_t size);
+
+    /// Writes the snapshot of @a map, loaded from @a opendrive. Returns false
+    /// if the stream could not be written.
+    static bool Write(const Map &map, const std::string &opendrive, std::ostream &out);
+
+    /// Creates a view over @a data. The buffer must outlive the view. Use
+    /// IsValid() to check the buffer holds a supported version of the layout.
+    MapCache(const uint8_t *data, size_t size);
+
+    bool IsValid() const {
+      return _header != nullptr;
+    }
+
+    /// Whether this is a valid snapshot of the map loaded from @a opendrive.
+    bool IsCacheOf(const std::string &opendrive) const;
+
+    uint32_t GetNumberOfSegments() const {
+      return _header->number_of_segments;
+    }
+
+    const SegmentRecord &GetSegment(uint32_t index) const {
+      return _segments[index];
+    }
+
+    uint32_t GetNumberOfJunctions() const {
+      return _header->number_of_junctions;
+    }
+
+    const JunctionRecord &GetJunction(uint32_t index) const {
+      return _junctions[index];
+    }
+
+    const ConflictRecord &GetConflict(uint32_t index) const {
+      return _conflicts[index];
+    }
+
+  private:
+
+    const Header *_header = nullptr;
+
+    const SegmentRecord *_segments = nullptr;
+
+    const JunctionRecord *_junctions = nullptr;
+
+    const ConflictRecord *_conflicts = nullptr;
+  };
+
+} // namespace road
+} // namespace carla
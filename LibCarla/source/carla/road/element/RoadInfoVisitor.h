@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <type_traits>
+
 namespace carla {
 namespace road {
 namespace element {
@@ -28,6 +31,30 @@ namespace element {
   class RoadInfoCrosswalk;
   class RoadInfoSignal;
 
+  /// Index of each RoadInfo type, in the order of the Visit overloads of
+  /// RoadInfoVisitor.
+  template <typename T>
+  struct RoadInfoTypeIndex;
+
+  template <> struct RoadInfoTypeIndex<RoadInfoElevation>      : std::integral_constant<size_t, 0u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoGeometry>       : std::integral_constant<size_t, 1u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoLane>           : std::integral_constant<size_t, 2u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoLaneAccess>     : std::integral_constant<size_t, 3u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoLaneBorder>     : std::integral_constant<size_t, 4u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoLaneHeight>     : std::integral_constant<size_t, 5u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoLaneMaterial>   : std::integral_constant<size_t, 6u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoLaneOffset>     : std::integral_constant<size_t, 7u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoLaneRule>       : std::integral_constant<size_t, 8u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoLaneVisibility> : std::integral_constant<size_t, 9u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoLaneWidth>      : std::integral_constant<size_t, 10u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoMarkRecord>     : std::integral_constant<size_t, 11u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoMarkTypeLine>   : std::integral_constant<size_t, 12u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoSpeed>          : std::integral_constant<size_t, 13u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoCrosswalk>      : std::integral_constant<size_t, 14u> {};
+  template <> struct RoadInfoTypeIndex<RoadInfoSignal>         : std::integral_constant<size_t, 15u> {};
+
+  constexpr size_t NUMBER_OF_ROAD_INFO_TYPES = 16u;
+
   class RoadInfoVisitor {
   public:
 
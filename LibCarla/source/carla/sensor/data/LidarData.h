@@ -63,6 +63,13 @@ namespace data {
           "property float32 I";
       }
 
+      void WritePcdHeaderInfo(std::ostream& out) const{
+        out << "FIELDS x y z intensity\n" \
+          "SIZE 4 4 4 4\n" \
+          "TYPE F F F F\n" \
+          "COUNT 1 1 1 1";
+      }
+
       void WriteDetection(std::ostream& out) const{
         out << point.x << ' ' << point.y << ' ' << point.z << ' ' << intensity;
       }
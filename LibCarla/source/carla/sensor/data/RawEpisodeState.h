@@ -66,6 +66,17 @@ namespace data {
       return GetHeader().simulation_state;
     }
 
+    /// Whether this message only contains the actors that changed since the
+    /// previous message, see s11n::EpisodeStateDeltaEncoder.
+    bool IsDelta() const {
+      return (GetHeader().simulation_state & Serializer::DeltaState) != 0;
+    }
+
+    /// Frame of the message this delta applies to.
+    uint64_t GetBaseFrame() const {
+      return GetHeader().base_frame;
+    }
+
   };
 
 } // namespace data
@@ -71,6 +71,13 @@ namespace data {
            "property uint32 ObjTag";
       }
 
+      void WritePcdHeaderInfo(std::ostream& out) const{
+        out << "FIELDS x y z CosAngle ObjIdx ObjTag\n" \
+           "SIZE 4 4 4 4 4 4\n" \
+           "TYPE F F F F U U\n" \
+           "COUNT 1 1 1 1 1 1";
+      }
+
       void WriteDetection(std::ostream& out) const{
         out << point.x << ' ' << point.y << ' ' << point.z << ' ' \
           << cos_inc_angle << ' ' << object_idx << ' ' << object_tag;
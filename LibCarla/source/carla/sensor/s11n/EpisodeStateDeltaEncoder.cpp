@@ -0,0 +1,158 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/EpisodeStateDeltaEncoder.h"
+
+#include "carla/Debug.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  using data::ActorDynamicState;
+
+  constexpr float EpisodeStateDeltaEncoder::location_tolerance;
+  constexpr float EpisodeStateDeltaEncoder::rotation_tolerance;
+  constexpr float EpisodeStateDeltaEncoder::velocity_tolerance;
+
+  static bool IsFar(const geom::Vector3D &lhs, const geom::Vector3D &rhs, float tolerance) {
+    return
+        std::abs(lhs.x - rhs.x) > tolerance ||
+        std::abs(lhs.y - rhs.y) > tolerance ||
+        std::abs(lhs.z - rhs.z) > tolerance;
+  }
+
+  static bool IsFar(const geom::Rotation &lhs, const geom::Rotation &rhs, float tolerance) {
+    return
+        std::abs(lhs.pitch - rhs.pitch) > tolerance ||
+        std::abs(lhs.yaw - rhs.yaw) > tolerance ||
+        std::abs(lhs.roll - rhs.roll) > tolerance;
+  }
+
+  bool EpisodeStateDeltaEncoder::HasChanged(
+      const ActorDynamicState &previous,
+      const ActorDynamicState &current) {
+    using TypeDependentState = ActorDynamicState::TypeDependentState;
+    return
+        previous.actor_state != current.actor_state ||
+        IsFar(previous.transform.location, current.transform.location, location_tolerance) ||
+        IsFar(previous.transform.rotation, current.transform.rotation, rotation_tolerance) ||
+        IsFar(previous.velocity, current.velocity, velocity_tolerance) ||
+        IsFar(previous.angular_velocity, current.angular_velocity, velocity_tolerance) ||
+        IsFar(previous.acceleration, current.acceleration, velocity_tolerance) ||
+        std::memcmp(&previous.state, &current.state, sizeof(TypeDependentState)) != 0;
+  }
+
+  void EpisodeStateDeltaEncoder::SetKeyframeInterval(uint32_t keyframe_interval) {
+    _keyframe_interval = keyframe_interval;
+    Reset();
+  }
+
+  void EpisodeStateDeltaEncoder::Reset() {
+    _messages_since_keyframe = 0u;
+    _last_sent.clear();
+  }
+
+  void EpisodeStateDeltaEncoder::StoreKeyframe(
+      const unsigned char *begin,
+      const size_t number_of_actors) {
+    _last_sent.clear();
+    _last_sent.reserve(number_of_actors);
+    for (size_t i = 0u; i < number_of_actors; ++i) {
+      SentState sent;
+      std::memcpy(&sent.state, begin + i * sizeof(ActorDynamicState), sizeof(ActorDynamicState));
+      sent.message_count = _message_count;
+      _last_sent[sent.state.id] = sent;
+    }
+  }
+
+  bool EpisodeStateDeltaEncoder::Encode(Buffer &message, const uint64_t frame) {
+    if (_keyframe_interval == 0u) {
+      return false;
+    }
+    DEBUG_ASSERT(message.size() >= sizeof(Header));
+    DEBUG_ASSERT((message.size() - sizeof(Header)) % sizeof(ActorDynamicState) == 0u);
+
+    Header header;
+    std::memcpy(&header, message.data(), sizeof(Header));
+    const size_t number_of_actors =
+        (message.size() - sizeof(Header)) / sizeof(ActorDynamicState);
+    unsigned char *actors = message.data() + sizeof(Header);
+    ++_message_count;
+    const uint64_t base_frame = _last_frame;
+    _last_frame = frame;
+
+    const bool is_keyframe =
+        (_messages_since_keyframe == 0u) ||
+        (_messages_since_keyframe >= _keyframe_interval) ||
+        (header.episode_id != _episode_id) ||
+        ((header.simulation_state & EpisodeStateSerializer::MapChange) != 0);
+    _episode_id = header.episode_id;
+
+    if (is_keyframe) {
+      StoreKeyframe(actors, number_of_actors);
+      _messages_since_keyframe = 1u;
+      return false;
+    }
+    ++_messages_since_keyframe;
+
+    // Compact the changed actors towards the beginning of the message, the
+    // write position never overtakes the read position.
+    size_t written = 0u;
+    for (size_t i = 0u; i < number_of_actors; ++i) {
+      unsigned char *source = actors + i * sizeof(ActorDynamicState);
+      ActorDynamicState current;
+      std::memcpy(&current, source, sizeof(ActorDynamicState));
+
+      auto it = _last_sent.find(current.id);
+      if (it == _last_sent.end()) {
+        it = _last_sent.emplace(current.id, SentState{current, _message_count}).first;
+      } else {
+        it->second.message_count = _message_count;
+        if (!HasChanged(it->second.state, current)) {
+          continue;
+        }
+        it->second.state = current;
+      }
+      if (written != i) {
+        std::memcpy(actors + written * sizeof(ActorDynamicState), source, sizeof(ActorDynamicState));
+      }
+      ++written;
+    }
+
+    // Append the actors that were not present in this message.
+    size_t removed = 0u;
+    for (const auto &item : _last_sent) {
+      if (item.second.message_count != _message_count) {
+        ++removed;
+      }
+    }
+    message.resize(sizeof(Header) + (written + removed) * sizeof(ActorDynamicState));
+    unsigned char *tombstone = message.data() + sizeof(Header) + written * sizeof(ActorDynamicState);
+    for (auto it = _last_sent.begin(); it != _last_sent.end();) {
+      if (it->second.message_count == _message_count) {
+        ++it;
+        continue;
+      }
+      it->second.state.actor_state = rpc::ActorState::Invalid;
+      std::memcpy(tombstone, &it->second.state, sizeof(ActorDynamicState));
+      tombstone += sizeof(ActorDynamicState);
+      it = _last_sent.erase(it);
+    }
+
+    header.simulation_state = static_cast<EpisodeStateSerializer::SimulationState>(
+        header.simulation_state | EpisodeStateSerializer::DeltaState);
+    header.base_frame = base_frame;
+    std::memcpy(message.data(), &header, sizeof(Header));
+    return true;
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
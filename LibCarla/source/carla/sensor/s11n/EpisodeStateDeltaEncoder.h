@@ -0,0 +1,96 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/rpc/ActorId.h"
+#include "carla/sensor/data/ActorDynamicState.h"
+#include "carla/sensor/s11n/EpisodeStateSerializer.h"
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// Turns the full episode state messages written by the server into delta
+  /// messages, keeping track of the state of each actor as it was last sent.
+  ///
+  /// Every @a keyframe_interval messages (and whenever the map or the episode
+  /// change) a full message is sent untouched. In between, only the actors
+  /// whose state changed beyond the tolerances below are kept, and actors
+  /// that disappeared are appended with rpc::ActorState::Invalid. Comparing
+  /// against the last sent state, instead of the previous frame, prevents
+  /// slow motions from drifting away on the client side.
+  ///
+  /// Every delta carries the frame of the previous message, so clients that
+  /// missed a message, or joined in the middle of a sequence, can tell it
+  /// does not apply to the state they hold and wait for the next keyframe.
+  ///
+  /// A keyframe interval of zero disables the delta mode.
+  class EpisodeStateDeltaEncoder : private NonCopyable {
+  public:
+
+    using Header = EpisodeStateSerializer::Header;
+
+    constexpr static float location_tolerance = 1e-3f; // m
+    constexpr static float rotation_tolerance = 1e-2f; // deg
+    constexpr static float velocity_tolerance = 1e-3f; // m/s, deg/s and m/s^2
+
+    explicit EpisodeStateDeltaEncoder(uint32_t keyframe_interval = 0u)
+      : _keyframe_interval(keyframe_interval) {}
+
+    uint32_t GetKeyframeInterval() const {
+      return _keyframe_interval;
+    }
+
+    /// Changing the interval forces the next message to be a keyframe.
+    void SetKeyframeInterval(uint32_t keyframe_interval);
+
+    /// Forces the next message to be a keyframe.
+    void Reset();
+
+    /// Encode in place a full episode state @a message (header followed by
+    /// one data::ActorDynamicState per actor) to be sent at @a frame.
+    ///
+    /// @return whether the message was turned into a delta.
+    bool Encode(Buffer &message, uint64_t frame);
+
+    /// Whether @a current differs from @a previous beyond the tolerances. The
+    /// actor state and the type dependent state are compared exactly.
+    static bool HasChanged(
+        const data::ActorDynamicState &previous,
+        const data::ActorDynamicState &current);
+
+  private:
+
+    struct SentState {
+      data::ActorDynamicState state;
+      uint64_t message_count;
+    };
+
+    void StoreKeyframe(const unsigned char *begin, size_t number_of_actors);
+
+    uint32_t _keyframe_interval;
+
+    uint32_t _messages_since_keyframe = 0u;
+
+    uint64_t _message_count = 0u;
+
+    uint64_t _episode_id = 0u;
+
+    /// Frame of the previous message.
+    uint64_t _last_frame = 0u;
+
+    std::unordered_map<ActorId, SentState> _last_sent;
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
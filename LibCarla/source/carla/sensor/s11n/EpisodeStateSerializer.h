@@ -30,7 +30,11 @@ namespace s11n {
     enum SimulationState {
       None               = (0x0 << 0),
       MapChange          = (0x1 << 0),
-      PendingLightUpdate = (0x1 << 1)
+      PendingLightUpdate = (0x1 << 1),
+      /// The message only contains the actors that changed since the message
+      /// of frame Header::base_frame, removed actors are sent with
+      /// rpc::ActorState::Invalid.
+      DeltaState         = (0x1 << 2)
     };
 
 #pragma pack(push, 1)
@@ -40,6 +44,8 @@ namespace s11n {
       float delta_seconds;
       geom::Vector3DInt map_origin;
       SimulationState simulation_state = SimulationState::None;
+      /// Frame of the message a delta applies to, zero for full messages.
+      uint64_t base_frame = 0u;
     };
 #pragma pack(pop)
 
@@ -16,9 +16,9 @@ namespace s11n {
       SensorHeaderSerializer::header_offset == 3u * 8u + 6u * 4u,
       "Header size missmatch");
 
-  static Buffer PopBufferFromPool() {
+  static Buffer PopBufferFromPool(const Buffer::size_type size) {
     static auto pool = std::make_shared<BufferPool>();
-    return pool->Pop();
+    return pool->Pop(size);
   }
 
   Buffer SensorHeaderSerializer::Serialize(
@@ -31,7 +31,7 @@ namespace s11n {
     h.frame = frame;
     h.timestamp = timestamp;
     h.sensor_transform = transform;
-    auto buffer = PopBufferFromPool();
+    auto buffer = PopBufferFromPool(sizeof(h));
     buffer.copy_from(reinterpret_cast<const unsigned char *>(&h), sizeof(h));
     return buffer;
   }
@@ -10,7 +10,9 @@
 #include "carla/ThreadPool.h"
 #include "carla/streaming/Token.h"
 #include "carla/streaming/detail/tcp/Client.h"
+#include "carla/streaming/detail/tcp/MultiplexedClient.h"
 #include "carla/streaming/low_level/Client.h"
+#include "carla/streaming/low_level/MultiplexedClient.h"
 
 #include <boost/asio/io_context.hpp>
 
@@ -19,15 +21,31 @@ namespace streaming {
 
   using stream_token = detail::token_type;
 
+  /// How a Client connects to the streams it subscribes to.
+  enum class TransportMode {
+    /// One connection per stream.
+    PerStream,
+    /// One connection per server, shared by all the streams of that server.
+    Multiplexed
+  };
+
   /// A client able to subscribe to multiple streams.
   class Client {
     using underlying_client = low_level::Client<detail::tcp::Client>;
+    using underlying_multiplexed_client = low_level::MultiplexedClient<detail::tcp::MultiplexedClient>;
   public:
 
     Client() = default;
 
-    explicit Client(const std::string &fallback_address)
-      : _client(fallback_address) {}
+    explicit Client(TransportMode mode)
+      : _mode(mode) {}
+
+    explicit Client(
+        const std::string &fallback_address,
+        TransportMode mode = TransportMode::PerStream)
+      : _mode(mode),
+        _client(fallback_address),
+        _multiplexed_client(fallback_address) {}
 
     ~Client() {
       _service.Stop();
@@ -37,11 +55,23 @@ namespace streaming {
     /// MultiStream).
     template <typename Functor>
     void Subscribe(const Token &token, Functor &&callback) {
-      _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      if (_mode == TransportMode::Multiplexed) {
+        _multiplexed_client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      } else {
+        _client.Subscribe(_service.io_context(), token, std::forward<Functor>(callback));
+      }
     }
 
     void UnSubscribe(const Token &token) {
-      _client.UnSubscribe(token);
+      if (_mode == TransportMode::Multiplexed) {
+        _multiplexed_client.UnSubscribe(token);
+      } else {
+        _client.UnSubscribe(token);
+      }
+    }
+
+    TransportMode GetTransportMode() const {
+      return _mode;
     }
 
     void Run() {
@@ -54,11 +84,15 @@ namespace streaming {
 
   private:
 
-    // The order of these two arguments is very important.
+    TransportMode _mode = TransportMode::PerStream;
+
+    // The order of these arguments is very important.
 
     ThreadPool _service;
 
     underlying_client _client;
+
+    underlying_multiplexed_client _multiplexed_client;
   };
 
 } // namespace streaming
@@ -12,6 +12,9 @@
 
 #include <boost/asio/io_context.hpp>
 
+#include <thread>
+#include <vector>
+
 namespace carla {
 namespace streaming {
 
@@ -64,6 +67,29 @@ namespace streaming {
       _server.SetSynchronousMode(is_synchro);
     }
 
+    /// Write the messages to shared memory, instead of the socket, for the
+    /// clients running on the same host. Applies only to new sessions.
+    void SetSharedMemoryEnabled(bool enabled) {
+      _server.SetSharedMemoryEnabled(enabled);
+    }
+
+    /// Set how the sessions queue the messages waiting to be sent when the
+    /// client reads slower than the sensors produce them.
+    void SetSendQueueSettings(const detail::tcp::SendQueueSettings &settings) {
+      _server.SetSendQueueSettings(settings);
+    }
+
+    /// Never block the writers on the thread @a id when a send queue is full,
+    /// typically the simulation thread.
+    void SetNonBlockingThread(std::thread::id id) {
+      _server.SetNonBlockingThread(id);
+    }
+
+    /// Queued, sent, and dropped messages of every open session.
+    std::vector<detail::tcp::SessionStatistics> GetSessionStatistics() const {
+      return _server.GetSessionStatistics();
+    }
+
   private:
 
     // The order of these two arguments is very important.
@@ -48,36 +48,64 @@ namespace detail {
 
   carla::streaming::Stream Dispatcher::MakeStream() {
     std::lock_guard<std::mutex> lock(_mutex);
-    ++_cached_token._token.stream_id; // id zero only happens in overflow.
+    // Id zero only happens in overflow, the last id is reserved for
+    // multiplexed sessions and the high bit for the transport request.
+    do {
+      ++_cached_token._token.stream_id;
+    } while ((_cached_token._token.stream_id == 0u) ||
+             (_cached_token._token.stream_id == multiplexed_stream_id) ||
+             ((_cached_token._token.stream_id & shared_memory_request_flag) != 0u));
     log_info("Created new stream:", _cached_token._token.stream_id);
     return MakeStreamState<MultiStreamState>(_cached_token, _stream_map);
   }
 
   bool Dispatcher::RegisterSession(std::shared_ptr<Session> session) {
     DEBUG_ASSERT(session != nullptr);
+    const auto stream_id = session->get_stream_id();
+    return RegisterSession(std::move(session), stream_id);
+  }
+
+  bool Dispatcher::RegisterSession(
+      std::shared_ptr<Session> session,
+      const stream_id_type stream_id) {
+    DEBUG_ASSERT(session != nullptr);
     std::lock_guard<std::mutex> lock(_mutex);
-    auto search = _stream_map.find(session->get_stream_id());
+    auto search = _stream_map.find(stream_id);
     if (search != _stream_map.end()) {
       auto stream_state = search->second.lock();
       if (stream_state != nullptr) {
-        log_info("Connecting session (stream ", session->get_stream_id(), ")");
+        log_info("Connecting session (stream ", stream_id, ")");
         stream_state->ConnectSession(std::move(session));
         return true;
       }
     }
-    log_error("Invalid session: no stream available with id", session->get_stream_id());
+    log_error("Invalid session: no stream available with id", stream_id);
     return false;
   }
 
   void Dispatcher::DeregisterSession(std::shared_ptr<Session> session) {
     DEBUG_ASSERT(session != nullptr);
+    if (session->IsMultiplexed()) {
+      for (auto stream_id : session->GetSubscriptions()) {
+        DeregisterSession(session, stream_id);
+      }
+    } else {
+      const auto stream_id = session->get_stream_id();
+      DeregisterSession(std::move(session), stream_id);
+    }
+  }
+
+  void Dispatcher::DeregisterSession(
+      std::shared_ptr<Session> session,
+      const stream_id_type stream_id) {
+    DEBUG_ASSERT(session != nullptr);
     std::lock_guard<std::mutex> lock(_mutex);
     ClearExpiredStreams();
-    auto search = _stream_map.find(session->get_stream_id());
+    auto search = _stream_map.find(stream_id);
     if (search != _stream_map.end()) {
       auto stream_state = search->second.lock();
       if (stream_state != nullptr) {
-        log_info("Disconnecting session (stream ", session->get_stream_id(), ")");
+        log_info("Disconnecting session (stream ", stream_id, ")");
         stream_state->DisconnectSession(session);
       }
     }
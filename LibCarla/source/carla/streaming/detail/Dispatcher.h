@@ -35,8 +35,16 @@ namespace detail {
 
     bool RegisterSession(std::shared_ptr<Session> session);
 
+    /// Register @a session as a subscriber of @a stream_id, used by
+    /// multiplexed sessions that carry several streams.
+    bool RegisterSession(std::shared_ptr<Session> session, stream_id_type stream_id);
+
+    /// Disconnect @a session from its stream or, if the session is
+    /// multiplexed, from every stream it is subscribed to.
     void DeregisterSession(std::shared_ptr<Session> session);
 
+    void DeregisterSession(std::shared_ptr<Session> session, stream_id_type stream_id);
+
   private:
 
     void ClearExpiredStreams();
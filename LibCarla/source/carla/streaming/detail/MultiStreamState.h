@@ -11,99 +11,93 @@
 #include "carla/streaming/detail/StreamStateBase.h"
 #include "carla/streaming/detail/tcp/Message.h"
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
 #include <mutex>
 #include <vector>
-#include <atomic>
 
 namespace carla {
 namespace streaming {
 namespace detail {
 
-  /// A stream state that can hold any number of sessions.
+  /// A stream state that can hold any number of sessions. Sessions may be
+  /// dedicated to this stream or multiplexed, a multiplexed session frames
+  /// each message with the id of this stream.
   ///
-  /// @todo Lacking some optimization.
+  /// The list of sessions is copied on write, connecting and disconnecting
+  /// sessions publishes a new list while writers keep iterating the list they
+  /// loaded, so writing a message never waits for the list to change.
   class MultiStreamState final : public StreamStateBase {
   public:
 
     using StreamStateBase::StreamStateBase;
 
-    MultiStreamState(const token_type &token) : 
-      StreamStateBase(token), 
-      _session(nullptr)
-      {};
-
     template <typename... Buffers>
     void Write(Buffers &&... buffers) {
+      auto sessions = _sessions.load();
+      if (sessions == nullptr) {
+        return;
+      }
       auto message = Session::MakeMessage(std::move(buffers)...);
-
-      // try write single stream
-      auto session = _session.load();
-      if (session != nullptr) {
-        session->Write(std::move(message));
-        // Return here, _session is only valid if we have a 
-        // single session.
-        return; 
+      const bool is_lossless = IsLossless();
+      for (auto &session : *sessions) {
+        session->Write(token().get_stream_id(), message, is_lossless);
       }
+    }
 
-      // try write multiple stream
-      std::lock_guard<std::mutex> lock(_mutex);
-      for (auto &s : _sessions) {
-        if (s != nullptr) {
-          s->Write(message);
-        }
-      }
+    size_t GetNumberOfSessions() const {
+      auto sessions = _sessions.load();
+      return sessions == nullptr ? 0u : sessions->size();
     }
 
   private:
 
+    using SessionList = std::vector<std::shared_ptr<Session>>;
+
     void ConnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
       std::lock_guard<std::mutex> lock(_mutex);
-      _sessions.emplace_back(std::move(session));
-      log_debug("Connecting multistream sessions:", _sessions.size());
-      if (_sessions.size() == 1) {
-        _session.store(_sessions[0]);
-      }
-      else if (_sessions.size() > 1) {
-        _session.store(nullptr);
+      auto sessions = std::make_shared<SessionList>();
+      auto current = _sessions.load();
+      if (current != nullptr) {
+        sessions->reserve(current->size() + 1u);
+        *sessions = *current;
       }
+      sessions->emplace_back(std::move(session));
+      log_debug("Connecting multistream sessions:", sessions->size());
+      _sessions.store(std::move(sessions));
     }
 
     void DisconnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
       std::lock_guard<std::mutex> lock(_mutex);
-      if (_sessions.size() == 0) return;
-      if (_sessions.size() == 1) {
-        DEBUG_ASSERT(session == _session.load());
-        _session.store(nullptr);
-        _sessions.clear();
+      auto current = _sessions.load();
+      if (current == nullptr) {
+        return;
+      }
+      auto sessions = std::make_shared<SessionList>();
+      sessions->reserve(current->size());
+      std::remove_copy(current->begin(), current->end(), std::back_inserter(*sessions), session);
+      log_debug("Disconnecting multistream sessions:", sessions->size());
+      if (sessions->empty()) {
+        _sessions.store(nullptr);
       } else {
-        _sessions.erase(
-            std::remove(_sessions.begin(), _sessions.end(), session),
-            _sessions.end());
-        
-        // set single session if only one
-        if (_sessions.size() == 1)
-          _session.store(_sessions[0]);
-        else
-          _session.store(nullptr);
+        _sessions.store(std::move(sessions));
       }
-      log_debug("Disconnecting multistream sessions:", _sessions.size());
     }
 
     void ClearSessions() final {
       std::lock_guard<std::mutex> lock(_mutex);
-      _sessions.clear();
-      _session.store(nullptr);
+      _sessions.store(nullptr);
       log_debug("Disconnecting all multistream sessions");
     }
 
+    /// Serializes the changes to the list, never taken by the writers.
     std::mutex _mutex;
 
-    // if there is only one session, then we use atomic
-    AtomicSharedPtr<Session> _session;
-    // if there are more than one session, we use vector of sessions with mutex
-    std::vector<std::shared_ptr<Session>> _sessions;
+    /// Null if there are no sessions.
+    AtomicSharedPtr<const SessionList> _sessions;
   };
 
 } // namespace detail
@@ -40,12 +40,25 @@ namespace detail {
     /// buffers are re-used to avoid memory allocations.
     ///
     /// @note Re-using buffers is optimized for the use case in which all the
-    /// messages sent through the stream are big and have (approximately) the
-    /// same size.
+    /// messages sent through the stream have (approximately) the same size.
     Buffer MakeBuffer() {
       return _shared_state->MakeBuffer();
     }
 
+    /// @copydoc MakeBuffer()
+    ///
+    /// The buffer is already sized to @a size bytes.
+    Buffer MakeBuffer(Buffer::size_type size) {
+      return _shared_state->MakeBuffer(size);
+    }
+
+    /// Never drop nor coalesce the messages of this stream when the send
+    /// queue of a session is full, they are queued past the limit instead.
+    /// For streams whose messages depend on the previous ones.
+    void SetLossless(bool is_lossless) {
+      _shared_state->SetLossless(is_lossless);
+    }
+
     /// Flush @a buffers down the stream. No copies are made.
     template <typename... Buffers>
     void Write(Buffers &&... buffers) {
@@ -10,6 +10,7 @@
 #include "carla/streaming/detail/Session.h"
 #include "carla/streaming/detail/Token.h"
 
+#include <atomic>
 #include <memory>
 
 namespace carla {
@@ -34,6 +35,18 @@ namespace detail {
 
     Buffer MakeBuffer();
 
+    Buffer MakeBuffer(Buffer::size_type size);
+
+    /// Whether the sessions must never drop nor coalesce the messages of
+    /// this stream.
+    bool IsLossless() const {
+      return _is_lossless;
+    }
+
+    void SetLossless(bool is_lossless) {
+      _is_lossless = is_lossless;
+    }
+
     virtual void ConnectSession(std::shared_ptr<Session> session) = 0;
 
     virtual void DisconnectSession(std::shared_ptr<Session> session) = 0;
@@ -45,6 +58,8 @@ namespace detail {
     const token_type _token;
 
     const std::shared_ptr<BufferPool> _buffer_pool;
+
+    std::atomic_bool _is_lossless{false};
   };
 
 } // namespace detail
@@ -9,6 +9,7 @@
 #include "carla/Buffer.h"
 
 #include <cstdint>
+#include <limits>
 #include <type_traits>
 
 namespace carla {
@@ -19,6 +20,15 @@ namespace detail {
 
   using message_size_type = uint32_t;
 
+  /// Stream id sent on connection by the clients that receive several streams
+  /// over a single connection. Never assigned to a stream.
+  constexpr stream_id_type multiplexed_stream_id = std::numeric_limits<stream_id_type>::max();
+
+  /// Set by the clients on the stream id sent on connection to request the
+  /// shared memory transport. Never part of a stream id, so clients and
+  /// servers that do not know about it keep using plain TCP.
+  constexpr stream_id_type shared_memory_request_flag = stream_id_type(1u) << 31u;
+
   static_assert(
       std::is_same<message_size_type, Buffer::size_type>::value,
       "uint type mismatch!");
@@ -11,6 +11,7 @@
 #include "carla/Exception.h"
 #include "carla/Logging.h"
 #include "carla/Time.h"
+#include "carla/profiler/Tracer.h"
 
 #include <boost/asio/connect.hpp>
 #include <boost/asio/read.hpp>
@@ -30,11 +31,11 @@ namespace tcp {
   // ===========================================================================
 
   /// Helper for reading incoming TCP messages. Allocates the whole message in
-  /// a single buffer.
+  /// a single buffer from the pool once its size is known.
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
+    explicit IncomingMessage(std::shared_ptr<BufferPool> pool) : _pool(std::move(pool)) {}
 
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
@@ -42,12 +43,20 @@ namespace tcp {
 
     boost::asio::mutable_buffer buffer() {
       DEBUG_ASSERT(_size > 0u);
-      _message.reset(_size);
+      _message = _pool->Pop(_size);
       return _message.buffer();
     }
 
     auto size() const {
-      return _size;
+      return _size & ~shared_memory_flag;
+    }
+
+    bool is_in_shared_memory() const {
+      return (_size & shared_memory_flag) != 0u;
+    }
+
+    void read_from(SharedMemoryRing &ring) {
+      _message = ring.Read(size());
     }
 
     auto pop() {
@@ -56,6 +65,8 @@ namespace tcp {
 
   private:
 
+    const std::shared_ptr<BufferPool> _pool;
+
     message_size_type _size = 0u;
 
     Buffer _message;
@@ -96,6 +107,7 @@ namespace tcp {
       if (_socket.is_open()) {
         _socket.close();
       }
+      _shared_memory = nullptr;
 
       DEBUG_ASSERT(_token.is_valid());
       DEBUG_ASSERT(_token.protocol_is_tcp());
@@ -110,21 +122,30 @@ namespace tcp {
           // Improves the sync mode velocity on Linux by a factor of ~3.
           _socket.set_option(boost::asio::ip::tcp::no_delay(true));
           log_debug("streaming client: connected to", ep);
-          // Send the stream id to subscribe to the stream.
+          // Send the stream id to subscribe to the stream, flagged if
+          // requesting the shared memory transport.
           const auto &stream_id = _token.get_stream_id();
           log_debug("streaming client: sending stream id", stream_id);
+          const bool request_shared_memory = !_shared_memory_failed && IsSameHost();
+          _request_stream_id = request_shared_memory ?
+              (stream_id | shared_memory_request_flag) :
+              stream_id;
           boost::asio::async_write(
               _socket,
-              boost::asio::buffer(&stream_id, sizeof(stream_id)),
+              boost::asio::buffer(&_request_stream_id, sizeof(_request_stream_id)),
               boost::asio::bind_executor(_strand, [=](error_code ec, size_t DEBUG_ONLY(bytes)) {
                 // Ensures to stop the execution once the connection has been stopped.
                 if (_done) {
                   return;
                 }
                 if (!ec) {
-                  DEBUG_ASSERT_EQ(bytes, sizeof(stream_id));
+                  DEBUG_ASSERT_EQ(bytes, sizeof(_request_stream_id));
                   // If succeeded start reading data.
-                  ReadData();
+                  if (request_shared_memory) {
+                    ReadTransportReply();
+                  } else {
+                    ReadData();
+                  }
                 } else {
                   // Else try again.
                   log_debug("streaming client: failed to send stream id:", ec.message());
@@ -163,6 +184,55 @@ namespace tcp {
     });
   }
 
+  bool Client::IsSameHost() const {
+    boost::system::error_code ec;
+    const auto local = _socket.local_endpoint(ec);
+    if (ec) {
+      return false;
+    }
+    const auto remote = _socket.remote_endpoint(ec);
+    return !ec && (local.address() == remote.address());
+  }
+
+  void Client::ReadTransportReply() {
+    auto self = shared_from_this();
+    auto reply = std::make_shared<SharedMemoryReply>();
+
+    auto handle_reply = [this, self, reply](boost::system::error_code ec, size_t) {
+      if (_done) {
+        return;
+      }
+      if (ec) {
+        // Servers that do not know about the transport close the session.
+        log_debug("streaming client: failed to read transport reply:", ec.message());
+        _shared_memory_failed = true;
+        Connect();
+        return;
+      }
+      if (reply->accepted != 0u) {
+        reply->name[SharedMemoryReply::max_name_size] = '\0';
+        _shared_memory = SharedMemoryRing::Open(reply->name);
+        if (_shared_memory == nullptr) {
+          // Same address but different host, e.g. a container without access
+          // to the shared memory of the server. Start over with plain TCP.
+          log_warning("streaming client: shared memory not available, falling back to TCP");
+          _shared_memory_failed = true;
+          Connect();
+          return;
+        }
+        // Both ends have the segment mapped already, no need to keep its name.
+        _shared_memory->RemoveName();
+        log_debug("streaming client: using shared memory", reply->name);
+      }
+      ReadData();
+    };
+
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(reply.get(), sizeof(SharedMemoryReply)),
+        boost::asio::bind_executor(_strand, handle_reply));
+  }
+
   void Client::ReadData() {
     auto self = shared_from_this();
     boost::asio::post(_strand, [this, self]() {
@@ -172,9 +242,10 @@ namespace tcp {
 
       // log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      auto message = std::make_shared<IncomingMessage>(_buffer_pool);
 
       auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
+        CARLA_TRACE_SCOPE(streaming, client_read_data);
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
         if (!ec) {
           DEBUG_ASSERT_EQ(bytes, message->size());
@@ -182,7 +253,10 @@ namespace tcp {
           // Move the buffer to the callback function and start reading the next
           // piece of data.
           // log_debug("streaming client: success reading data, calling the callback");
-          boost::asio::post(_strand, [self, message]() { self->_callback(message->pop()); });
+          boost::asio::post(_strand, [self, message]() {
+            CARLA_TRACE_SCOPE(streaming, client_callback);
+            self->_callback(message->pop());
+          });
           ReadData();
         } else {
           // As usual, if anything fails start over from the very top.
@@ -200,6 +274,22 @@ namespace tcp {
           if (_done) {
             return;
           }
+          if (message->is_in_shared_memory()) {
+            if (_shared_memory == nullptr) {
+              log_error("streaming client: unexpected shared memory message");
+              Connect();
+              return;
+            }
+            // The payload is already in the ring, nothing else to read from
+            // the socket.
+            message->read_from(*_shared_memory);
+            boost::asio::post(_strand, [self, message]() {
+              CARLA_TRACE_SCOPE(streaming, client_callback);
+              self->_callback(message->pop());
+            });
+            ReadData();
+            return;
+          }
           // Now that we know the size of the coming buffer, we can allocate our
           // buffer and start putting data into it.
           boost::asio::async_read(
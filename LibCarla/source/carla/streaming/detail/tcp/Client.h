@@ -11,6 +11,7 @@
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_context.hpp>
@@ -31,6 +32,12 @@ namespace tcp {
 
   /// A client that connects to a single stream.
   ///
+  /// If the server runs on the same host, the client requests the shared
+  /// memory transport on connection. If the server does not reply, or the
+  /// shared memory segment cannot be opened, it reconnects using plain TCP.
+  /// Messages read from shared memory are views over the ring, see
+  /// SharedMemoryRing::Read.
+  ///
   /// @warning This client should be stopped before releasing the shared pointer
   /// or won't be destroyed.
   class Client
@@ -64,6 +71,10 @@ namespace tcp {
 
     void ReadData();
 
+    void ReadTransportReply();
+
+    bool IsSameHost() const;
+
     const token_type _token;
 
     callback_function_type _callback;
@@ -77,6 +88,16 @@ namespace tcp {
     std::shared_ptr<BufferPool> _buffer_pool;
 
     std::atomic_bool _done{false};
+
+    /// The following members are only accessed within the strand.
+
+    /// Stream id sent to the server, with shared_memory_request_flag set if
+    /// requesting the shared memory transport.
+    stream_id_type _request_stream_id = 0u;
+
+    bool _shared_memory_failed = false;
+
+    std::shared_ptr<SharedMemoryRing> _shared_memory;
   };
 
 } // namespace tcp
@@ -0,0 +1,238 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/tcp/MultiplexedClient.h"
+
+#include "carla/BufferPool.h"
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+#include "carla/Time.h"
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/bind_executor.hpp>
+
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  // Sent on connection, needs to outlive the asynchronous write.
+  static const stream_id_type MULTIPLEXED_STREAM_ID = multiplexed_stream_id;
+
+  MultiplexedClient::MultiplexedClient(
+      boost::asio::io_context &io_context,
+      endpoint ep)
+    : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
+          std::string("tcp multiplexed client ") + ep.address().to_string() +
+          ":" + std::to_string(ep.port())),
+      _endpoint(std::move(ep)),
+      _socket(io_context),
+      _strand(io_context),
+      _connection_timer(io_context),
+      _buffer_pool(std::make_shared<BufferPool>()) {}
+
+  MultiplexedClient::~MultiplexedClient() = default;
+
+  void MultiplexedClient::Connect() {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      if (_done) {
+        return;
+      }
+
+      using boost::system::error_code;
+
+      if (_socket.is_open()) {
+        _socket.close();
+      }
+      // Pending requests are sent again from _callbacks once connected.
+      _is_connected = false;
+      _requests.clear();
+
+      auto handle_connect = [this, self](error_code ec) {
+        if (!ec) {
+          if (_done) {
+            return;
+          }
+          // This forces not using Nagle's algorithm.
+          _socket.set_option(boost::asio::ip::tcp::no_delay(true));
+          log_debug("streaming multiplexed client: connected to", _endpoint);
+          boost::asio::async_write(
+              _socket,
+              boost::asio::buffer(&MULTIPLEXED_STREAM_ID, sizeof(MULTIPLEXED_STREAM_ID)),
+              boost::asio::bind_executor(_strand, [=](error_code write_ec, size_t DEBUG_ONLY(bytes)) {
+                if (_done) {
+                  return;
+                }
+                if (!write_ec) {
+                  DEBUG_ASSERT_EQ(bytes, sizeof(MULTIPLEXED_STREAM_ID));
+                  _is_connected = true;
+                  for (auto &pair : _callbacks) {
+                    SendRequest(MultiplexedRequest::Command::Subscribe, pair.first);
+                  }
+                  ReadData();
+                } else {
+                  log_debug("streaming multiplexed client: failed to send stream id:", write_ec.message());
+                  Connect();
+                }
+              }));
+        } else {
+          log_info("streaming multiplexed client: connection failed:", ec.message());
+          Reconnect();
+        }
+      };
+
+      log_debug("streaming multiplexed client: connecting to", _endpoint);
+      _socket.async_connect(_endpoint, boost::asio::bind_executor(_strand, handle_connect));
+    });
+  }
+
+  void MultiplexedClient::Subscribe(
+      const stream_id_type stream_id,
+      callback_function_type callback) {
+    DEBUG_ASSERT(callback);
+    auto self = shared_from_this();
+    auto callback_ptr = std::make_shared<callback_function_type>(std::move(callback));
+    boost::asio::post(_strand, [this, self, stream_id, callback_ptr]() {
+      const bool is_new = (_callbacks.find(stream_id) == _callbacks.end());
+      _callbacks[stream_id] = callback_ptr;
+      if (is_new && _is_connected) {
+        SendRequest(MultiplexedRequest::Command::Subscribe, stream_id);
+      }
+    });
+  }
+
+  void MultiplexedClient::UnSubscribe(const stream_id_type stream_id) {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self, stream_id]() {
+      if ((_callbacks.erase(stream_id) > 0u) && _is_connected) {
+        SendRequest(MultiplexedRequest::Command::UnSubscribe, stream_id);
+      }
+    });
+  }
+
+  void MultiplexedClient::Stop() {
+    _connection_timer.cancel();
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      _done = true;
+      _is_connected = false;
+      _requests.clear();
+      _callbacks.clear();
+      if (_socket.is_open()) {
+        _socket.close();
+      }
+    });
+  }
+
+  void MultiplexedClient::Reconnect() {
+    auto self = shared_from_this();
+    _connection_timer.expires_from_now(time_duration::seconds(1u));
+    _connection_timer.async_wait([this, self](boost::system::error_code ec) {
+      if (!ec) {
+        Connect();
+      }
+    });
+  }
+
+  void MultiplexedClient::SendRequest(
+      const MultiplexedRequest::Command command,
+      const stream_id_type stream_id) {
+    DEBUG_ASSERT(_is_connected);
+    _requests.push_back(MultiplexedRequest{command, stream_id});
+    if (!_is_writing) {
+      WriteNextRequest();
+    }
+  }
+
+  void MultiplexedClient::WriteNextRequest() {
+    DEBUG_ASSERT(!_requests.empty());
+    auto request = std::make_shared<MultiplexedRequest>(_requests.front());
+    _requests.pop_front();
+    _is_writing = true;
+
+    auto self = shared_from_this();
+    auto handle_sent = [this, self, request](boost::system::error_code ec, size_t) {
+      _is_writing = false;
+      if (ec) {
+        // A broken connection is detected and restarted by ReadData.
+        log_debug("streaming multiplexed client: failed to send request:", ec.message());
+      }
+      // The queue may have been refilled by a new connection in the meantime.
+      if (!_done && _is_connected && !_requests.empty()) {
+        WriteNextRequest();
+      }
+    };
+
+    boost::asio::async_write(
+        _socket,
+        boost::asio::buffer(request.get(), sizeof(MultiplexedRequest)),
+        boost::asio::bind_executor(_strand, handle_sent));
+  }
+
+  void MultiplexedClient::ReadData() {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      if (_done) {
+        return;
+      }
+
+      auto header = std::make_shared<MultiplexedHeader>();
+      auto message = std::make_shared<Buffer>();
+
+      auto handle_read_data = [this, self, header, message](
+          boost::system::error_code ec,
+          size_t DEBUG_ONLY(bytes)) {
+        if (!ec) {
+          DEBUG_ASSERT_EQ(bytes, header->size);
+          // Messages of streams unsubscribed in the meantime are dropped.
+          auto it = _callbacks.find(header->stream_id);
+          if (it != _callbacks.end()) {
+            auto callback = it->second;
+            boost::asio::post(_strand, [callback, message]() { (*callback)(std::move(*message)); });
+          }
+          ReadData();
+        } else if (!_done) {
+          log_debug("streaming multiplexed client: failed to read data:", ec.message());
+          Connect();
+        }
+      };
+
+      auto handle_read_header = [this, self, header, message, handle_read_data](
+          boost::system::error_code ec,
+          size_t DEBUG_ONLY(bytes)) {
+        if (!ec && (header->size > 0u)) {
+          DEBUG_ASSERT_EQ(bytes, sizeof(MultiplexedHeader));
+          if (_done) {
+            return;
+          }
+          *message = _buffer_pool->Pop(header->size);
+          boost::asio::async_read(
+              _socket,
+              message->buffer(),
+              boost::asio::bind_executor(_strand, handle_read_data));
+        } else if (!_done) {
+          log_debug("streaming multiplexed client: failed to read header:", ec.message());
+          Connect();
+        }
+      };
+
+      boost::asio::async_read(
+          _socket,
+          boost::asio::buffer(header.get(), sizeof(MultiplexedHeader)),
+          boost::asio::bind_executor(_strand, handle_read_header));
+    });
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,101 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/MultiplexedMessage.h"
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace carla {
+
+  class BufferPool;
+
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// A client that receives any number of streams of the same server through
+  /// a single connection. On reconnection it subscribes again to every stream.
+  ///
+  /// @warning This client should be stopped before releasing the shared pointer
+  /// or won't be destroyed.
+  class MultiplexedClient
+    : public std::enable_shared_from_this<MultiplexedClient>,
+      private profiler::LifetimeProfiled,
+      private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::tcp::endpoint;
+    using protocol_type = endpoint::protocol_type;
+    using callback_function_type = std::function<void (Buffer)>;
+
+    MultiplexedClient(boost::asio::io_context &io_context, endpoint ep);
+
+    ~MultiplexedClient();
+
+    void Connect();
+
+    /// Start receiving the messages of @a stream_id. Replaces the previous
+    /// callback if already subscribed.
+    void Subscribe(stream_id_type stream_id, callback_function_type callback);
+
+    void UnSubscribe(stream_id_type stream_id);
+
+    void Stop();
+
+  private:
+
+    void Reconnect();
+
+    void ReadData();
+
+    void SendRequest(MultiplexedRequest::Command command, stream_id_type stream_id);
+
+    void WriteNextRequest();
+
+    const endpoint _endpoint;
+
+    boost::asio::ip::tcp::socket _socket;
+
+    boost::asio::io_context::strand _strand;
+
+    boost::asio::deadline_timer _connection_timer;
+
+    std::shared_ptr<BufferPool> _buffer_pool;
+
+    std::atomic_bool _done{false};
+
+    /// The following members are only accessed within the strand.
+
+    bool _is_connected = false;
+
+    bool _is_writing = false;
+
+    std::deque<MultiplexedRequest> _requests;
+
+    std::unordered_map<
+        stream_id_type,
+        std::shared_ptr<callback_function_type>> _callbacks;
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
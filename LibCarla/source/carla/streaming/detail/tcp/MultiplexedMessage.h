@@ -0,0 +1,49 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// Wire format of the multiplexed connections. The client sends
+  /// multiplexed_stream_id instead of a stream id on connection, then any
+  /// number of MultiplexedRequest to subscribe or unsubscribe from streams.
+  /// The server prefixes every message with a MultiplexedHeader instead of
+  /// the message size alone.
+
+#pragma pack(push, 1)
+  struct MultiplexedRequest {
+
+    enum class Command : uint8_t {
+      Subscribe,
+      UnSubscribe
+    };
+
+    Command command;
+
+    stream_id_type stream_id;
+  };
+
+  struct MultiplexedHeader {
+
+    /// Size of the message, excluding this header.
+    message_size_type size;
+
+    stream_id_type stream_id;
+  };
+#pragma pack(pop)
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
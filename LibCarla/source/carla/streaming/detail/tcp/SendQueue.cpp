@@ -0,0 +1,154 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/tcp/SendQueue.h"
+
+#include "carla/Debug.h"
+
+#include <algorithm>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  bool SendQueue::Push(
+      Item item,
+      const SendQueueSettings &settings,
+      const bool may_block) {
+    DEBUG_ASSERT(item.message != nullptr);
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_is_closed) {
+      return false;
+    }
+
+    // Messages being sent don't count, an idle queue always accepts one.
+    const auto is_full = [&]() {
+      return _is_consuming && (_items.size() >= settings.max_queued_messages);
+    };
+
+    const auto find_lossy = [&](auto predicate) {
+      return std::find_if(_items.begin(), _items.end(), [&](const Item &queued) {
+        return !queued.is_lossless && predicate(queued);
+      });
+    };
+
+    // Lossless messages, and writers that may not block, queue past the
+    // limit.
+    if (is_full() && !item.is_lossless) {
+      switch (settings.policy) {
+        case SendQueuePolicy::Block:
+          if (!may_block) {
+            break;
+          }
+          _condition.wait_for(lock, settings.block_timeout.to_chrono(), [&]() {
+            return _is_closed || !is_full();
+          });
+          if (_is_closed) {
+            return false;
+          }
+          if (is_full()) {
+            Drop(item);
+            return false;
+          }
+          break;
+        case SendQueuePolicy::DropOldest: {
+          const auto it = find_lossy([](const Item &) { return true; });
+          if (it == _items.end()) {
+            Drop(item);
+            return false;
+          }
+          DropQueued(*it);
+          _items.erase(it);
+          break;
+        }
+        case SendQueuePolicy::DropNewest:
+          Drop(item);
+          return false;
+        case SendQueuePolicy::CoalesceLatest: {
+          auto it = find_lossy([&](const Item &queued) {
+            return queued.stream_id == item.stream_id;
+          });
+          if (it == _items.end()) {
+            it = find_lossy([](const Item &) { return true; });
+            if (it == _items.end()) {
+              Drop(item);
+              return false;
+            }
+          }
+          // Keep the position of the replaced message so every stream gets
+          // its turn.
+          DropQueued(*it);
+          _statistics.queued_bytes += item.message->size();
+          *it = std::move(item);
+          return false;
+        }
+      }
+    }
+
+    _statistics.queued_bytes += item.message->size();
+    _items.emplace_back(std::move(item));
+    const bool start_consumer = !_is_consuming;
+    _is_consuming = true;
+    return start_consumer;
+  }
+
+  bool SendQueue::PopBatch(std::vector<Item> &batch, const size_t max_messages) {
+    DEBUG_ASSERT(max_messages > 0u);
+    std::lock_guard<std::mutex> lock(_mutex);
+    DEBUG_ASSERT(_is_consuming);
+    if (_items.empty()) {
+      _is_consuming = false;
+      return false;
+    }
+    const size_t count = std::min(max_messages, _items.size());
+    for (size_t i = 0u; i < count; ++i) {
+      _statistics.queued_bytes -= _items.front().message->size();
+      batch.emplace_back(std::move(_items.front()));
+      _items.pop_front();
+    }
+    _condition.notify_all();
+    return true;
+  }
+
+  void SendQueue::OnSent(const size_t messages, const size_t bytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _statistics.sent_messages += messages;
+    _statistics.sent_bytes += bytes;
+  }
+
+  void SendQueue::Close() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _is_closed = true;
+    for (const auto &item : _items) {
+      DropQueued(item);
+    }
+    _items.clear();
+    _condition.notify_all();
+  }
+
+  SessionStatistics SendQueue::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    SessionStatistics statistics = _statistics;
+    statistics.queued_messages = _items.size();
+    return statistics;
+  }
+
+  void SendQueue::Drop(const Item &item) {
+    ++_statistics.dropped_messages;
+    _statistics.dropped_bytes += item.message->size();
+  }
+
+  void SendQueue::DropQueued(const Item &item) {
+    DEBUG_ASSERT(_statistics.queued_bytes >= item.message->size());
+    _statistics.queued_bytes -= item.message->size();
+    Drop(item);
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
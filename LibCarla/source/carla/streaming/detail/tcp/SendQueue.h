@@ -0,0 +1,133 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/Time.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/Message.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// What a session does with a new message when its send queue is full.
+  /// Messages of lossless streams are never dropped nor replaced, they are
+  /// queued past the limit instead.
+  enum class SendQueuePolicy : uint8_t {
+    /// Block the writer until there is room, or drop the message after the
+    /// time-out. Writers that may not block queue the message past the limit.
+    Block,
+    /// Drop the oldest queued message.
+    DropOldest,
+    /// Drop the new message.
+    DropNewest,
+    /// Replace the queued message of the same stream, if any, otherwise drop
+    /// the oldest queued message. Messages are never replaced while there is
+    /// room.
+    CoalesceLatest
+  };
+
+  struct SendQueueSettings {
+
+    SendQueuePolicy policy = SendQueuePolicy::CoalesceLatest;
+
+    /// Maximum number of messages waiting behind the ones being sent.
+    size_t max_queued_messages = 64u;
+
+    /// Maximum time blocked with SendQueuePolicy::Block.
+    time_duration block_timeout = time_duration::seconds(10u);
+  };
+
+  struct SessionStatistics {
+
+    size_t session_id = 0u;
+
+    stream_id_type stream_id = 0u;
+
+    size_t queued_messages = 0u;
+
+    size_t queued_bytes = 0u;
+
+    size_t sent_messages = 0u;
+
+    size_t sent_bytes = 0u;
+
+    size_t dropped_messages = 0u;
+
+    size_t dropped_bytes = 0u;
+  };
+
+  /// Bounded queue of the messages of a session waiting to be written to the
+  /// socket. Thread-safe, messages are pushed by any number of writers and
+  /// popped in batches by a single consumer, the session's strand.
+  class SendQueue : private NonCopyable {
+  public:
+
+    struct Item {
+      stream_id_type stream_id;
+      std::shared_ptr<const Message> message;
+      /// Whether the message may be dropped or replaced.
+      bool is_lossless = false;
+    };
+
+    /// Queue @a item applying the policy of @a settings if full. With
+    /// SendQueuePolicy::Block, the writer waits for room only if @a may_block.
+    ///
+    /// @return whether the consumer was idle and needs to be started, in which
+    /// case it has to call PopBatch until it returns false.
+    bool Push(Item item, const SendQueueSettings &settings, bool may_block = true);
+
+    /// Move up to @a max_messages queued messages at the end of @a batch. If
+    /// there are none, the consumer becomes idle.
+    ///
+    /// @return whether any message was moved.
+    bool PopBatch(std::vector<Item> &batch, size_t max_messages);
+
+    /// Count @a messages of @a bytes in total as sent.
+    void OnSent(size_t messages, size_t bytes);
+
+    /// Drop all queued messages, reject new ones, and wake up blocked
+    /// writers.
+    void Close();
+
+    /// Statistics of the queue, the session fields are left unset.
+    SessionStatistics GetStatistics() const;
+
+  private:
+
+    /// Count a message as dropped.
+    void Drop(const Item &item);
+
+    /// Count a message removed from the queue as dropped.
+    void DropQueued(const Item &item);
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    std::deque<Item> _items;
+
+    bool _is_consuming = false;
+
+    bool _is_closed = false;
+
+    SessionStatistics _statistics;
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
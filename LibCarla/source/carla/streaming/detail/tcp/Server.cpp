@@ -10,6 +10,7 @@
 
 #include "carla/Logging.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace carla {
@@ -21,7 +22,41 @@ namespace tcp {
     : _io_context(io_context),
       _acceptor(_io_context, std::move(ep)),
       _timeout(time_duration::seconds(10u)),
-      _synchronous(false) {}
+      _synchronous(false),
+      _block_timeout(time_duration::seconds(10u)) {}
+
+  void Server::SetSendQueueSettings(const SendQueueSettings &settings) {
+    _send_queue_policy = settings.policy;
+    _max_queued_messages = settings.max_queued_messages;
+    _block_timeout = settings.block_timeout;
+    _has_send_queue_settings = true;
+  }
+
+  SendQueueSettings Server::GetSendQueueSettings() const {
+    SendQueueSettings settings;
+    if (_has_send_queue_settings) {
+      settings.policy = _send_queue_policy;
+      settings.max_queued_messages = _max_queued_messages;
+      settings.block_timeout = _block_timeout;
+    } else if (_synchronous) {
+      settings.policy = SendQueuePolicy::Block;
+      settings.block_timeout = _timeout;
+    }
+    return settings;
+  }
+
+  std::vector<SessionStatistics> Server::GetSessionStatistics() const {
+    std::vector<SessionStatistics> result;
+    std::lock_guard<std::mutex> lock(_sessions_mutex);
+    result.reserve(_sessions.size());
+    for (const auto &weak_session : _sessions) {
+      auto session = weak_session.lock();
+      if (session != nullptr) {
+        result.emplace_back(session->GetStatistics());
+      }
+    }
+    return result;
+  }
 
   void Server::OpenSession(
       time_duration timeout,
@@ -31,8 +66,17 @@ namespace tcp {
 
     auto session = std::make_shared<ServerSession>(_io_context, timeout, *this);
 
-    auto handle_query = [on_opened, on_closed, session](const error_code &ec) {
+    auto handle_query = [this, on_opened, on_closed, session](const error_code &ec) {
       if (!ec) {
+        {
+          std::lock_guard<std::mutex> lock(_sessions_mutex);
+          _sessions.erase(
+              std::remove_if(_sessions.begin(), _sessions.end(), [](const auto &weak_session) {
+                return weak_session.expired();
+              }),
+              _sessions.end());
+          _sessions.emplace_back(session);
+        }
         session->Open(std::move(on_opened), std::move(on_closed));
       } else {
         log_error("tcp accept error:", ec.message());
@@ -15,6 +15,10 @@
 #include <boost/asio/post.hpp>
 
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -62,6 +66,43 @@ namespace tcp {
       return _synchronous;
     }
 
+    /// Set how the sessions queue the messages waiting to be sent. Until set,
+    /// sessions block in synchronous mode and coalesce the messages of each
+    /// stream in asynchronous mode, in both cases only once the queue is full.
+    void SetSendQueueSettings(const SendQueueSettings &settings);
+
+    SendQueueSettings GetSendQueueSettings() const;
+
+    /// Writers on the thread @a id never block on a full send queue, their
+    /// messages are queued past the limit instead. Meant for the thread
+    /// running the simulation.
+    void SetNonBlockingThread(std::thread::id id) {
+      _non_blocking_thread = id;
+    }
+
+    std::thread::id GetNonBlockingThread() const {
+      return _non_blocking_thread;
+    }
+
+    /// Statistics of every open session.
+    std::vector<SessionStatistics> GetSessionStatistics() const;
+
+    /// Offer a shared memory ring of @a capacity bytes to the clients running
+    /// on the same host, instead of writing the messages to the socket.
+    /// Applies only to newly created sessions. Disabled by default.
+    void SetSharedMemoryEnabled(bool enabled, size_t capacity = 64u * 1024u * 1024u) {
+      _shared_memory_capacity = capacity;
+      _shared_memory_enabled = enabled;
+    }
+
+    bool IsSharedMemoryEnabled() const {
+      return _shared_memory_enabled;
+    }
+
+    size_t GetSharedMemoryCapacity() const {
+      return _shared_memory_capacity;
+    }
+
   private:
 
     void OpenSession(
@@ -76,6 +117,24 @@ namespace tcp {
     std::atomic<time_duration> _timeout;
 
     bool _synchronous;
+
+    mutable std::mutex _sessions_mutex;
+
+    std::vector<std::weak_ptr<ServerSession>> _sessions;
+
+    std::atomic_bool _has_send_queue_settings{false};
+
+    std::atomic<SendQueuePolicy> _send_queue_policy{SendQueuePolicy::CoalesceLatest};
+
+    std::atomic_size_t _max_queued_messages{0u};
+
+    std::atomic<time_duration> _block_timeout;
+
+    std::atomic<std::thread::id> _non_blocking_thread{};
+
+    std::atomic_bool _shared_memory_enabled{false};
+
+    std::atomic_size_t _shared_memory_capacity{0u};
   };
 
 } // namespace tcp
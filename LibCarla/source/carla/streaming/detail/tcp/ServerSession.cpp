@@ -9,6 +9,7 @@
 
 #include "carla/Debug.h"
 #include "carla/Logging.h"
+#include "carla/profiler/Tracer.h"
 
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
@@ -16,7 +17,9 @@
 #include <boost/asio/post.hpp>
 
 #include <atomic>
+#include <cstring>
 #include <thread>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -59,7 +62,14 @@ namespace tcp {
         if (!ec) {
           DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
           log_debug("session", _session_id, "for stream", _stream_id, " started");
-          boost::asio::post(_strand.context(), [=]() { callback(self); });
+          if (IsMultiplexed()) {
+            boost::asio::post(_strand.context(), [=]() { callback(self); });
+          } else if ((_stream_id & shared_memory_request_flag) != 0u) {
+            _stream_id &= ~shared_memory_request_flag;
+            NegotiateTransport(std::move(callback));
+          } else {
+            boost::asio::post(_strand.context(), [=]() { callback(self); });
+          }
         } else {
           log_error("session", _session_id, ": error retrieving stream id :", ec.message());
           CloseNow();
@@ -75,49 +85,212 @@ namespace tcp {
     });
   }
 
-  void ServerSession::Write(std::shared_ptr<const Message> message) {
+  void ServerSession::NegotiateTransport(callback_function_type on_opened) {
+    auto self = shared_from_this();
+
+    auto reply = std::make_shared<SharedMemoryReply>();
+    if (_server.IsSharedMemoryEnabled() && IsSameHost()) {
+      const std::string name =
+          "carla-stream-" + std::to_string(_socket.local_endpoint().port()) +
+          "-" + std::to_string(_session_id);
+      _shared_memory = SharedMemoryRing::Create(name, _server.GetSharedMemoryCapacity());
+      if (_shared_memory != nullptr) {
+        reply->accepted = 1u;
+        std::strncpy(reply->name, name.c_str(), SharedMemoryReply::max_name_size);
+        log_debug("session", _session_id, ": using shared memory", name);
+      }
+    }
+
+    auto handle_reply = [this, self, reply, callback=std::move(on_opened)](
+        const boost::system::error_code &ec,
+        size_t) {
+      if (!ec) {
+        boost::asio::post(_strand.context(), [=]() { callback(self); });
+      } else {
+        log_error("session", _session_id, ": error sending transport reply :", ec.message());
+        CloseNow();
+      }
+    };
+
+    boost::asio::async_write(
+        _socket,
+        boost::asio::buffer(reply.get(), sizeof(SharedMemoryReply)),
+        boost::asio::bind_executor(_strand, handle_reply));
+  }
+
+  bool ServerSession::IsSameHost() const {
+    boost::system::error_code ec;
+    const auto local = _socket.local_endpoint(ec);
+    if (ec) {
+      return false;
+    }
+    const auto remote = _socket.remote_endpoint(ec);
+    return !ec && (local.address() == remote.address());
+  }
+
+  void ServerSession::Write(
+      const stream_id_type stream_id,
+      std::shared_ptr<const Message> message,
+      const bool is_lossless) {
+    CARLA_TRACE_SCOPE(streaming, server_session_write);
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
+    DEBUG_ASSERT(IsMultiplexed() || (stream_id == _stream_id));
+    DEBUG_ASSERT((message->size() & shared_memory_flag) == 0u);
+    const bool may_block = std::this_thread::get_id() != _server.GetNonBlockingThread();
+    if (_send_queue.Push(
+            {stream_id, std::move(message), is_lossless},
+            _server.GetSendQueueSettings(),
+            may_block)) {
+      boost::asio::post(_strand, [self=shared_from_this()]() { self->WriteNextBatch(); });
+    }
+  }
+
+  /// Messages written to the socket, and the headers they need, with a single
+  /// call to async_write.
+  struct MessageBatch {
+    std::vector<SendQueue::Item> items;
+    std::vector<MultiplexedHeader> headers;
+    std::vector<message_size_type> shared_memory_sizes;
+    std::vector<boost::asio::const_buffer> buffers;
+  };
+
+  void ServerSession::WriteNextBatch() {
+    CARLA_TRACE_SCOPE(streaming, server_session_write_batch);
+    // Enough to fill a single writev call (asio uses at most 64 buffers).
+    constexpr size_t max_messages_per_batch = 16u;
+
+    auto batch = std::make_shared<MessageBatch>();
+    if (!_send_queue.PopBatch(batch->items, max_messages_per_batch)) {
+      return;
+    }
+
+    const size_t count = batch->items.size();
+    batch->headers.reserve(count);
+    batch->shared_memory_sizes.reserve(count);
+    batch->buffers.reserve(count * (Message::max_size() + 1u));
+    size_t bytes = 0u;
+    for (const auto &item : batch->items) {
+      const auto &message = *item.message;
+      bytes += message.size();
+      // Messages that do not fit in the ring go through the socket as usual.
+      const bool is_shared =
+          (_shared_memory != nullptr) &&
+          _shared_memory->TryWrite(message.GetPayloadBufferSequence(), message.size());
+      if (IsMultiplexed()) {
+        batch->headers.emplace_back(MultiplexedHeader{message.size(), item.stream_id});
+        batch->buffers.emplace_back(boost::asio::buffer(&batch->headers.back(), sizeof(MultiplexedHeader)));
+        for (auto &&view : message.GetPayloadBufferSequence()) {
+          batch->buffers.emplace_back(view);
+        }
+      } else if (is_shared) {
+        batch->shared_memory_sizes.emplace_back(message.size() | shared_memory_flag);
+        batch->buffers.emplace_back(boost::asio::buffer(
+            &batch->shared_memory_sizes.back(),
+            sizeof(message_size_type)));
+      } else {
+        for (auto &&view : message.GetBufferSequence()) {
+          batch->buffers.emplace_back(view);
+        }
+      }
+    }
+
+    auto self = shared_from_this();
+    auto handle_sent = [this, self, batch, bytes](
+        const boost::system::error_code &ec,
+        size_t DEBUG_ONLY(bytes_sent)) {
+      if (ec) {
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        // Closing the session closes the queue too, nothing else to send.
+        if (_socket.is_open()) {
+          CloseNow();
+        }
+        return;
+      }
+      DEBUG_ASSERT_EQ(bytes_sent, boost::asio::buffer_size(batch->buffers));
+      _send_queue.OnSent(batch->items.size(), bytes);
+      WriteNextBatch();
+    };
+
+    log_debug("session", _session_id, ": sending", count, "messages of", bytes, "bytes");
+
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        batch->buffers,
+        boost::asio::bind_executor(_strand, handle_sent));
+  }
+
+  SessionStatistics ServerSession::GetStatistics() const {
+    SessionStatistics statistics = _send_queue.GetStatistics();
+    statistics.session_id = _session_id;
+    statistics.stream_id = _stream_id;
+    return statistics;
+  }
+
+  void ServerSession::ReadRequests(request_callback_type callback) {
+    DEBUG_ASSERT(IsMultiplexed());
+    DEBUG_ASSERT(callback);
+    ReadNextRequest(std::make_shared<request_callback_type>(std::move(callback)));
+  }
+
+  void ServerSession::ReadNextRequest(std::shared_ptr<request_callback_type> callback) {
     auto self = shared_from_this();
     boost::asio::post(_strand, [=]() {
       if (!_socket.is_open()) {
         return;
       }
-      if (_is_writing) {
-        if (_server.IsSynchronousMode()) {
-          // wait until previous message has been sent
-          while (_is_writing) {
-            std::this_thread::yield();
-          }
-        } else {
-          // ignore this message
-          log_debug("session", _session_id, ": connection too slow: message discarded");
-          return;
-        }      
-      }
-      _is_writing = true;
+      auto request = std::make_shared<MultiplexedRequest>();
 
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
-        _is_writing = false;
+      auto handle_request = [this, self, callback, request](
+          const boost::system::error_code &ec,
+          size_t DEBUG_ONLY(bytes_received)) {
+        if (!_socket.is_open()) {
+          return;
+        }
         if (ec) {
-          log_info("session", _session_id, ": error sending data :", ec.message());
+          log_debug("session", _session_id, ": error reading request :", ec.message());
           CloseNow();
-        } else {
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+          return;
         }
-      };
+        DEBUG_ASSERT_EQ(bytes_received, sizeof(MultiplexedRequest));
+        _deadline.expires_from_now(_timeout);
 
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+        const auto stream_id = request->stream_id;
+        bool is_subscribed;
+        {
+          std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+          is_subscribed = _subscriptions.find(stream_id) != _subscriptions.end();
+        }
+        // The callback is called within the strand so a subscription can
+        // never be registered after the session is closed.
+        if (request->command == MultiplexedRequest::Command::Subscribe) {
+          if (!is_subscribed && (*callback)(self, *request)) {
+            log_debug("session", _session_id, "subscribed to stream", stream_id);
+            std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+            _subscriptions.insert(stream_id);
+          }
+        } else if (is_subscribed) {
+          (*callback)(self, *request);
+          log_debug("session", _session_id, "unsubscribed from stream", stream_id);
+          std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+          _subscriptions.erase(stream_id);
+        }
+        ReadNextRequest(callback);
+      };
 
-      _deadline.expires_from_now(_timeout);
-      boost::asio::async_write(
+      boost::asio::async_read(
           _socket,
-          message->GetBufferSequence(),
-          handle_sent);
+          boost::asio::buffer(request.get(), sizeof(MultiplexedRequest)),
+          boost::asio::bind_executor(_strand, handle_request));
     });
   }
 
+  std::vector<stream_id_type> ServerSession::GetSubscriptions() const {
+    std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+    return {_subscriptions.begin(), _subscriptions.end()};
+  }
+
   void ServerSession::Close() {
     boost::asio::post(_strand, [self=shared_from_this()]() { self->CloseNow(); });
   }
@@ -139,6 +312,7 @@ namespace tcp {
 
   void ServerSession::CloseNow() {
     _deadline.cancel();
+    _send_queue.Close();
     if (_socket.is_open()) {
       _socket.close();
     }
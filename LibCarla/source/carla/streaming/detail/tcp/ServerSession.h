@@ -12,6 +12,9 @@
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/streaming/detail/Types.h"
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/tcp/MultiplexedMessage.h"
+#include "carla/streaming/detail/tcp/SendQueue.h"
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_context.hpp>
@@ -20,6 +23,9 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -31,6 +37,19 @@ namespace tcp {
   /// A TCP server session. When a session opens, it reads from the socket a
   /// stream id object and passes itself to the callback functor. The session
   /// closes itself after @a timeout of inactivity is met.
+  ///
+  /// Messages are queued in a bounded SendQueue, following the settings of the
+  /// server, and written to the socket in batches.
+  ///
+  /// If the stream id read is multiplexed_stream_id, the session carries the
+  /// messages of every stream the client subscribes to with
+  /// MultiplexedRequest, see ReadRequests.
+  ///
+  /// If the stream id carries shared_memory_request_flag, the client asked for
+  /// the shared memory transport and waits for a SharedMemoryReply. If the
+  /// server enabled it and both ends are on the same host, the messages are
+  /// written to a SharedMemoryRing and only their size goes through the
+  /// socket.
   class ServerSession
     : public std::enable_shared_from_this<ServerSession>,
       private profiler::LifetimeProfiled,
@@ -39,6 +58,7 @@ namespace tcp {
 
     using socket_type = boost::asio::ip::tcp::socket;
     using callback_function_type = std::function<void(std::shared_ptr<ServerSession>)>;
+    using request_callback_type = std::function<bool(std::shared_ptr<ServerSession>, const MultiplexedRequest &)>;
 
     explicit ServerSession(
         boost::asio::io_context &io_context,
@@ -57,6 +77,20 @@ namespace tcp {
       return _stream_id;
     }
 
+    /// @warning This function should only be called after the session is
+    /// opened.
+    bool IsMultiplexed() const {
+      return _stream_id == multiplexed_stream_id;
+    }
+
+    /// Start reading the subscription requests of a multiplexed session. The
+    /// @a callback is called within the session's strand and returns whether
+    /// the request succeeded.
+    void ReadRequests(request_callback_type callback);
+
+    /// Streams a multiplexed session is subscribed to.
+    std::vector<stream_id_type> GetSubscriptions() const;
+
     template <typename... Buffers>
     static auto MakeMessage(Buffers &&... buffers) {
       static_assert(
@@ -66,7 +100,9 @@ namespace tcp {
     }
 
     /// Writes some data to the socket.
-    void Write(std::shared_ptr<const Message> message);
+    void Write(std::shared_ptr<const Message> message) {
+      Write(_stream_id, std::move(message));
+    }
 
     /// Writes some data to the socket.
     template <typename... Buffers>
@@ -74,15 +110,33 @@ namespace tcp {
       Write(MakeMessage(std::move(buffers)...));
     }
 
+    /// Writes a message of the stream @a stream_id to the socket, prefixed
+    /// with the stream id if the session is multiplexed. Messages of lossless
+    /// streams are never dropped by the send queue.
+    void Write(
+        stream_id_type stream_id,
+        std::shared_ptr<const Message> message,
+        bool is_lossless = false);
+
     /// Post a job to close the session.
     void Close();
 
+    SessionStatistics GetStatistics() const;
+
   private:
 
     void StartTimer();
 
+    void NegotiateTransport(callback_function_type on_opened);
+
+    bool IsSameHost() const;
+
     void CloseNow();
 
+    void ReadNextRequest(std::shared_ptr<request_callback_type> callback);
+
+    void WriteNextBatch();
+
     friend class Server;
 
     Server &_server;
@@ -101,7 +155,13 @@ namespace tcp {
 
     callback_function_type _on_closed;
 
-    bool _is_writing = false;
+    SendQueue _send_queue;
+
+    std::unique_ptr<SharedMemoryRing> _shared_memory;
+
+    mutable std::mutex _subscriptions_mutex;
+
+    std::unordered_set<stream_id_type> _subscriptions;
   };
 
 } // namespace tcp
@@ -0,0 +1,137 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/tcp/SharedMemoryRing.h"
+
+#include "carla/Logging.h"
+
+#include <boost/interprocess/exceptions.hpp>
+
+#include <algorithm>
+#include <new>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  namespace bip = boost::interprocess;
+
+  constexpr size_t SharedMemoryReply::max_name_size;
+  constexpr size_t SharedMemoryRing::data_offset;
+
+  SharedMemoryRing::SharedMemoryRing(
+      std::string name,
+      bip::shared_memory_object &&segment,
+      const bool is_owner)
+    : _name(std::move(name)),
+      _is_owner(is_owner),
+      _segment(std::move(segment)),
+      _region(_segment, bip::read_write) {}
+
+  std::unique_ptr<SharedMemoryRing> SharedMemoryRing::Create(
+      const std::string &name,
+      const size_t capacity) {
+    DEBUG_ASSERT(name.size() <= SharedMemoryReply::max_name_size);
+    DEBUG_ASSERT(capacity > 0u);
+    try {
+      // A previous server may have died without removing it.
+      bip::shared_memory_object::remove(name.c_str());
+      bip::shared_memory_object segment(bip::create_only, name.c_str(), bip::read_write);
+      segment.truncate(static_cast<bip::offset_t>(data_offset + capacity));
+      std::unique_ptr<SharedMemoryRing> ring{
+          new SharedMemoryRing(name, std::move(segment), true)};
+      Header *header = new (ring->_region.get_address()) Header;
+      header->read_position.store(0u, std::memory_order_relaxed);
+      header->capacity = capacity;
+      ring->_capacity = capacity;
+      return ring;
+    } catch (const bip::interprocess_exception &e) {
+      log_warning("failed to create shared memory segment", name, ':', e.what());
+      bip::shared_memory_object::remove(name.c_str());
+      return nullptr;
+    }
+  }
+
+  std::shared_ptr<SharedMemoryRing> SharedMemoryRing::Open(const std::string &name) {
+    try {
+      bip::shared_memory_object segment(bip::open_only, name.c_str(), bip::read_write);
+      std::shared_ptr<SharedMemoryRing> ring{
+          new SharedMemoryRing(name, std::move(segment), false)};
+      const size_t capacity = ring->GetHeader().capacity;
+      if ((capacity == 0u) || (ring->_region.get_size() < data_offset + capacity)) {
+        log_warning("invalid shared memory segment", name);
+        return nullptr;
+      }
+      ring->_capacity = capacity;
+      return ring;
+    } catch (const bip::interprocess_exception &e) {
+      log_info("failed to open shared memory segment", name, ':', e.what());
+      return nullptr;
+    }
+  }
+
+  SharedMemoryRing::~SharedMemoryRing() {
+    if (_is_owner) {
+      RemoveName();
+    }
+  }
+
+  void SharedMemoryRing::RemoveName() {
+    bip::shared_memory_object::remove(_name.c_str());
+  }
+
+  void SharedMemoryRing::Copy(const unsigned char *source, const size_t size) {
+    // TryWrite already skipped the end of the ring if needed.
+    const size_t offset = static_cast<size_t>(_position % _capacity);
+    DEBUG_ASSERT(size <= (_capacity - offset));
+    std::memcpy(GetData() + offset, source, size);
+    _position += size;
+  }
+
+  Buffer SharedMemoryRing::Read(const size_t size) {
+    DEBUG_ASSERT(size > 0u);
+    DEBUG_ASSERT(size <= _capacity);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    _position += GetPadding(_position, size);
+    unsigned char *data = GetData() + static_cast<size_t>(_position % _capacity);
+    _position += size;
+    const uint64_t end = _position;
+    {
+      std::lock_guard<std::mutex> lock(_release_mutex);
+      _slots.emplace_back(end, false);
+    }
+    // The view keeps the segment mapped, even if the client is gone.
+    std::shared_ptr<unsigned char> view(data, [self=shared_from_this(), end](unsigned char *) {
+      self->Release(end);
+    });
+    return Buffer{std::move(view), static_cast<Buffer::size_type>(size)};
+  }
+
+  void SharedMemoryRing::Release(const uint64_t end) {
+    std::lock_guard<std::mutex> lock(_release_mutex);
+    auto it = std::find_if(_slots.begin(), _slots.end(), [end](const auto &slot) {
+      return slot.first == end;
+    });
+    DEBUG_ASSERT(it != _slots.end());
+    if (it == _slots.end()) {
+      return;
+    }
+    it->second = true;
+    uint64_t read_position = 0u;
+    while (!_slots.empty() && _slots.front().second) {
+      read_position = _slots.front().first;
+      _slots.pop_front();
+    }
+    if (read_position > 0u) {
+      GetHeader().read_position.store(read_position, std::memory_order_release);
+    }
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,176 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Debug.h"
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// Set on the size of a message whose payload was written to the session's
+  /// SharedMemoryRing, in which case only the size goes through the socket.
+  constexpr message_size_type shared_memory_flag = message_size_type(1u) << 31u;
+
+#pragma pack(push, 1)
+  /// Sent by the server after a same-host client requested the shared memory
+  /// transport, see tcp::Client.
+  struct SharedMemoryReply {
+
+    static constexpr size_t max_name_size = 63u;
+
+    uint8_t accepted = 0u;
+
+    /// Null-terminated name of the shared memory segment.
+    char name[max_name_size + 1u] = {};
+  };
+#pragma pack(pop)
+
+  /// Single-producer single-consumer ring buffer in a named shared memory
+  /// segment. The server copies the messages of a session into the ring and
+  /// notifies the client through the socket, so the payload never goes
+  /// through the kernel. Messages are read in the same order as written.
+  ///
+  /// Every message is stored contiguously, skipping the end of the ring if it
+  /// does not fit there, so the client reads it as a Buffer view over its
+  /// slot. The slot is released once the buffer is destroyed, slots released
+  /// out of order are kept until the older ones are released too.
+  ///
+  /// Only the read position is shared, the write position is known by the
+  /// client from the sizes received through the socket.
+  class SharedMemoryRing
+    : public std::enable_shared_from_this<SharedMemoryRing>,
+      private NonCopyable {
+  public:
+
+    /// Create a new segment of @a capacity bytes, replacing any stale segment
+    /// with the same name. Returns nullptr on failure.
+    static std::unique_ptr<SharedMemoryRing> Create(const std::string &name, size_t capacity);
+
+    /// Open an existing segment. Returns nullptr on failure.
+    static std::shared_ptr<SharedMemoryRing> Open(const std::string &name);
+
+    /// The creator of the segment removes its name on destruction.
+    ~SharedMemoryRing();
+
+    const std::string &GetName() const {
+      return _name;
+    }
+
+    size_t GetCapacity() const {
+      return _capacity;
+    }
+
+    /// Remove the name of the segment. Already mapped rings remain valid.
+    void RemoveName();
+
+    /// Copy @a buffers, of @a size bytes in total, into the ring if there is
+    /// enough room for them.
+    ///
+    /// @warning Producer side only.
+    template <typename ConstBufferSequence>
+    bool TryWrite(const ConstBufferSequence &buffers, size_t size) {
+      const uint64_t read_position = GetHeader().read_position.load(std::memory_order_acquire);
+      DEBUG_ASSERT(_position >= read_position);
+      const size_t padding = GetPadding(_position, size);
+      if ((padding + size) > (_capacity - static_cast<size_t>(_position - read_position))) {
+        return false;
+      }
+      _position += padding;
+      for (const boost::asio::const_buffer &buffer : buffers) {
+        Copy(static_cast<const unsigned char *>(buffer.data()), buffer.size());
+      }
+      std::atomic_thread_fence(std::memory_order_release);
+      return true;
+    }
+
+    /// View over the next message, of @a size bytes. The producer cannot
+    /// overwrite it until the returned buffer is destroyed.
+    ///
+    /// @warning Consumer side only, the ring must be owned by a shared_ptr.
+    Buffer Read(size_t size);
+
+  private:
+
+    struct Header {
+      std::atomic<uint64_t> read_position;
+      uint64_t capacity;
+    };
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared atomics need to be lock-free.");
+
+    /// The data starts at the next cache line after the header.
+    static constexpr size_t data_offset = 64u;
+
+    static_assert(sizeof(Header) <= data_offset, "Invalid header size.");
+
+    SharedMemoryRing(
+        std::string name,
+        boost::interprocess::shared_memory_object &&segment,
+        bool is_owner);
+
+    Header &GetHeader() const {
+      return *static_cast<Header *>(_region.get_address());
+    }
+
+    unsigned char *GetData() const {
+      return static_cast<unsigned char *>(_region.get_address()) + data_offset;
+    }
+
+    /// Bytes skipped at the end of the ring so a message of @a size bytes
+    /// written at @a position is contiguous.
+    size_t GetPadding(uint64_t position, size_t size) const {
+      const size_t offset = static_cast<size_t>(position % _capacity);
+      return (size > (_capacity - offset)) ? (_capacity - offset) : 0u;
+    }
+
+    void Copy(const unsigned char *source, size_t size);
+
+    /// Release the slot of the message ending at @a end, called from any
+    /// thread when its view is destroyed.
+    void Release(uint64_t end);
+
+    const std::string _name;
+
+    const bool _is_owner;
+
+    boost::interprocess::shared_memory_object _segment;
+
+    boost::interprocess::mapped_region _region;
+
+    size_t _capacity = 0u;
+
+    /// Write position for the producer, read position for the consumer.
+    uint64_t _position = 0u;
+
+    std::mutex _release_mutex;
+
+    /// End of the slots read by the consumer and not yet released in the
+    /// shared header, and whether their view was destroyed.
+    std::deque<std::pair<uint64_t, bool>> _slots;
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,107 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/tcp/MultiplexedClient.h"
+
+#include <boost/asio/io_context.hpp>
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+namespace carla {
+namespace streaming {
+namespace low_level {
+
+  /// A client able to subscribe to multiple streams, sharing a single
+  /// connection among all the streams of the same server. Same interface as
+  /// low_level::Client. Accepts an external io_context.
+  ///
+  /// @warning The client should not be destroyed before the @a io_context is
+  /// stopped.
+  template <typename T>
+  class MultiplexedClient {
+  public:
+
+    using underlying_client = T;
+    using protocol_type = typename underlying_client::protocol_type;
+    using token_type = carla::streaming::detail::token_type;
+
+    explicit MultiplexedClient(boost::asio::ip::address fallback_address)
+      : _fallback_address(std::move(fallback_address)) {}
+
+    explicit MultiplexedClient(const std::string &fallback_address)
+      : MultiplexedClient(carla::streaming::make_address(fallback_address)) {}
+
+    explicit MultiplexedClient()
+      : MultiplexedClient(carla::streaming::make_localhost_address()) {}
+
+    ~MultiplexedClient() {
+      for (auto &pair : _connections) {
+        pair.second.client->Stop();
+      }
+    }
+
+    /// @warning cannot subscribe twice to the same stream (even if it's a
+    /// MultiStream).
+    template <typename Functor>
+    void Subscribe(
+        boost::asio::io_context &io_context,
+        token_type token,
+        Functor &&callback) {
+      DEBUG_ASSERT_EQ(_streams.find(token.get_stream_id()), _streams.end());
+      if (!token.has_address()) {
+        token.set_address(_fallback_address);
+      }
+      const auto ep = token.to_tcp_endpoint();
+      auto &connection = _connections[ep];
+      if (connection.client == nullptr) {
+        connection.client = std::make_shared<underlying_client>(io_context, ep);
+        connection.client->Connect();
+      }
+      connection.client->Subscribe(token.get_stream_id(), std::forward<Functor>(callback));
+      ++connection.number_of_streams;
+      _streams.emplace(token.get_stream_id(), ep);
+    }
+
+    void UnSubscribe(token_type token) {
+      auto it = _streams.find(token.get_stream_id());
+      if (it == _streams.end()) {
+        return;
+      }
+      auto connection = _connections.find(it->second);
+      DEBUG_ASSERT(connection != _connections.end());
+      connection->second.client->UnSubscribe(token.get_stream_id());
+      if (--connection->second.number_of_streams == 0u) {
+        connection->second.client->Stop();
+        _connections.erase(connection);
+      }
+      _streams.erase(it);
+    }
+
+  private:
+
+    using endpoint = typename underlying_client::endpoint;
+
+    struct Connection {
+      std::shared_ptr<underlying_client> client;
+      size_t number_of_streams = 0u;
+    };
+
+    boost::asio::ip::address _fallback_address;
+
+    std::map<endpoint, Connection> _connections;
+
+    std::unordered_map<detail::stream_id_type, endpoint> _streams;
+  };
+
+} // namespace low_level
+} // namespace streaming
+} // namespace carla
@@ -11,6 +11,9 @@
 
 #include <boost/asio/io_context.hpp>
 
+#include <thread>
+#include <type_traits>
+
 namespace carla {
 namespace streaming {
 namespace low_level {
@@ -68,11 +71,44 @@ namespace low_level {
       _server.SetSynchronousMode(is_synchro);
     }
 
+    /// Write the messages to shared memory, instead of the socket, for the
+    /// clients running on the same host. Applies only to new sessions.
+    void SetSharedMemoryEnabled(bool enabled) {
+      _server.SetSharedMemoryEnabled(enabled);
+    }
+
+    /// Set how the sessions queue the messages waiting to be sent, see
+    /// underlying_server::SetSendQueueSettings.
+    template <typename SettingsT>
+    void SetSendQueueSettings(const SettingsT &settings) {
+      _server.SetSendQueueSettings(settings);
+    }
+
+    /// See underlying_server::SetNonBlockingThread.
+    void SetNonBlockingThread(std::thread::id id) {
+      _server.SetNonBlockingThread(id);
+    }
+
+    /// Queued, sent, and dropped messages of every open session.
+    auto GetSessionStatistics() const {
+      return _server.GetSessionStatistics();
+    }
+
   private:
 
     void StartServer() {
       auto on_session_opened = [this](auto session) {
-        if (!_dispatcher.RegisterSession(session)) {
+        if (session->IsMultiplexed()) {
+          // Multiplexed sessions subscribe to streams on demand.
+          session->ReadRequests([this](auto session, const auto &request) {
+            using Command = std::decay_t<decltype(request.command)>;
+            if (request.command == Command::Subscribe) {
+              return _dispatcher.RegisterSession(std::move(session), request.stream_id);
+            }
+            _dispatcher.DeregisterSession(std::move(session), request.stream_id);
+            return true;
+          });
+        } else if (!_dispatcher.RegisterSession(session)) {
           session->Close();
         }
       };
@@ -391,6 +391,16 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
   simulation_state.RemoveActor(actor_id);
 }
 
+std::vector<cg::Location> ALSM::GetHeroLocations() const {
+  std::vector<cg::Location> hero_locations;
+  for (auto &hero_actor_info: hero_actors) {
+    if (simulation_state.ContainsActor(hero_actor_info.first)) {
+      hero_locations.push_back(simulation_state.GetLocation(hero_actor_info.first));
+    }
+  }
+  return hero_locations;
+}
+
 void ALSM::Reset() {
   unregistered_actors.clear();
   idle_time.clear();
@@ -113,6 +113,9 @@ public:
   // from various stages tracking the said vehicle.
   void RemoveActor(const ActorId actor_id, const bool registered_actor);
 
+  // Method to retrieve the locations of the hero vehicles in the current cycle.
+  std::vector<cg::Location> GetHeroLocations() const;
+
   void Reset();
 };
 
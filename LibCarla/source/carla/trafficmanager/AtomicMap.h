@@ -47,6 +47,18 @@ namespace traffic_manager {
       return map.at(key);
     }
 
+    /// Copy the value of @a key into @a value, if present.
+    bool TryGetValue(const Key &key, Value &value) const {
+
+      std::lock_guard<std::mutex> lock(map_mutex);
+      auto it = map.find(key);
+      if (it == map.end()) {
+        return false;
+      }
+      value = it->second;
+      return true;
+    }
+
     void RemoveEntry(const Key &key) {
 
       std::lock_guard<std::mutex> lock(map_mutex);
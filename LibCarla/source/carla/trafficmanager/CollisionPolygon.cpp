@@ -0,0 +1,139 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/CollisionPolygon.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace carla {
+namespace traffic_manager {
+
+  using Point = CollisionPolygon::Point;
+
+  static double Cross(const Point &origin, const Point &a, const Point &b) {
+    return (a.x - origin.x) * (b.y - origin.y) - (a.y - origin.y) * (b.x - origin.x);
+  }
+
+  static double SquaredDistanceToSegment(const Point &point, const Point &a, const Point &b) {
+    const double dx = b.x - a.x;
+    const double dy = b.y - a.y;
+    const double length_squared = dx * dx + dy * dy;
+    double t = 0.0;
+    if (length_squared > 0.0) {
+      t = ((point.x - a.x) * dx + (point.y - a.y) * dy) / length_squared;
+      t = std::max(0.0, std::min(1.0, t));
+    }
+    const double ex = a.x + t * dx - point.x;
+    const double ey = a.y + t * dy - point.y;
+    return ex * ex + ey * ey;
+  }
+
+  /// Whether the segments cross at a point interior to both. Segments that
+  /// only touch are at distance zero anyway.
+  static bool SegmentsCross(const Point &a0, const Point &a1, const Point &b0, const Point &b1) {
+    const double d0 = Cross(a0, a1, b0);
+    const double d1 = Cross(a0, a1, b1);
+    const double d2 = Cross(b0, b1, a0);
+    const double d3 = Cross(b0, b1, a1);
+    return (((d0 < 0.0) && (d1 > 0.0)) || ((d0 > 0.0) && (d1 < 0.0))) &&
+           (((d2 < 0.0) && (d3 > 0.0)) || ((d2 > 0.0) && (d3 < 0.0)));
+  }
+
+  /// Squared distance between two axis aligned boxes, zero if they overlap.
+  static double SquaredBoxGap(
+      const Point &min0, const Point &max0,
+      const Point &min1, const Point &max1) {
+    const double dx = std::max(0.0, std::max(min1.x - max0.x, min0.x - max1.x));
+    const double dy = std::max(0.0, std::max(min1.y - max0.y, min0.y - max1.y));
+    return dx * dx + dy * dy;
+  }
+
+  CollisionPolygon::CollisionPolygon(const std::vector<cg::Location> &boundary) {
+    _points.reserve(boundary.size());
+    for (const cg::Location &location : boundary) {
+      _points.push_back({location.x, location.y});
+    }
+    if (!_points.empty()) {
+      _min = _points.front();
+      _max = _points.front();
+      for (const Point &point : _points) {
+        _min = {std::min(_min.x, point.x), std::min(_min.y, point.y)};
+        _max = {std::max(_max.x, point.x), std::max(_max.y, point.y)};
+      }
+    }
+  }
+
+  bool CollisionPolygon::Contains(const Point &point) const {
+    if (_points.empty() ||
+        point.x <= _min.x || point.x >= _max.x ||
+        point.y <= _min.y || point.y >= _max.y) {
+      return false;
+    }
+    // Even-odd rule.
+    bool inside = false;
+    for (size_t i = 0u, j = _points.size() - 1u; i < _points.size(); j = i++) {
+      const Point &pi = _points[i];
+      const Point &pj = _points[j];
+      if ((pi.y > point.y) != (pj.y > point.y)) {
+        const double x_cross = pj.x + (point.y - pj.y) * (pi.x - pj.x) / (pi.y - pj.y);
+        if (point.x < x_cross) {
+          inside = !inside;
+        }
+      }
+    }
+    return inside;
+  }
+
+  double CollisionPolygon::Distance(const CollisionPolygon &lhs, const CollisionPolygon &rhs) {
+    const std::vector<Point> &a = lhs._points;
+    const std::vector<Point> &b = rhs._points;
+    if (a.empty() || b.empty()) {
+      return std::numeric_limits<double>::infinity();
+    }
+
+    const bool boxes_overlap = SquaredBoxGap(lhs._min, lhs._max, rhs._min, rhs._max) <= 0.0;
+    if (boxes_overlap && (lhs.Contains(b.front()) || rhs.Contains(a.front()))) {
+      return 0.0;
+    }
+
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t i = 0u, pi = a.size() - 1u; i < a.size(); pi = i++) {
+      const Point &a0 = a[pi];
+      const Point &a1 = a[i];
+      const Point a_min{std::min(a0.x, a1.x), std::min(a0.y, a1.y)};
+      const Point a_max{std::max(a0.x, a1.x), std::max(a0.y, a1.y)};
+      if (SquaredBoxGap(a_min, a_max, rhs._min, rhs._max) >= best) {
+        continue;
+      }
+      for (size_t j = 0u, pj = b.size() - 1u; j < b.size(); pj = j++) {
+        const Point &b0 = b[pj];
+        const Point &b1 = b[j];
+        const Point b_min{std::min(b0.x, b1.x), std::min(b0.y, b1.y)};
+        const Point b_max{std::max(b0.x, b1.x), std::max(b0.y, b1.y)};
+        if (SquaredBoxGap(a_min, a_max, b_min, b_max) >= best) {
+          continue;
+        }
+        if (boxes_overlap && SegmentsCross(a0, a1, b0, b1)) {
+          return 0.0;
+        }
+        best = std::min({
+            best,
+            SquaredDistanceToSegment(a0, b0, b1),
+            SquaredDistanceToSegment(a1, b0, b1),
+            SquaredDistanceToSegment(b0, a0, a1),
+            SquaredDistanceToSegment(b1, a0, a1)});
+        if (best <= 0.0) {
+          return 0.0;
+        }
+      }
+    }
+    return std::sqrt(best);
+  }
+
+} // namespace traffic_manager
+} // namespace carla
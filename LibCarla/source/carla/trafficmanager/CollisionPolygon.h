@@ -0,0 +1,63 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <vector>
+
+#include "carla/geom/Location.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+
+  /// Polygon on the XY plane used by the collision stage, the boundary of a
+  /// vehicle or of the path ahead of it.
+  ///
+  /// The polygon is closed implicitly between its last and first points and
+  /// does not need to be convex, the path boundaries are not. Its bounding
+  /// box is kept to discard most pairs of edges when computing distances.
+  class CollisionPolygon {
+  public:
+
+    struct Point {
+      double x;
+      double y;
+    };
+
+    CollisionPolygon() = default;
+
+    /// Polygon with the XY coordinates of @a boundary, in the same order.
+    explicit CollisionPolygon(const std::vector<cg::Location> &boundary);
+
+    const std::vector<Point> &GetPoints() const {
+      return _points;
+    }
+
+    bool empty() const {
+      return _points.empty();
+    }
+
+    /// Whether @a point is strictly inside the polygon.
+    bool Contains(const Point &point) const;
+
+    /// Minimum distance between the polygons, zero if their boundaries
+    /// intersect or one is inside the other; same result as
+    /// boost::geometry::distance for simple polygons.
+    static double Distance(const CollisionPolygon &lhs, const CollisionPolygon &rhs);
+
+  private:
+
+    std::vector<Point> _points;
+
+    Point _min{0.0, 0.0};
+
+    Point _max{0.0, 0.0};
+  };
+
+} // namespace traffic_manager
+} // namespace carla
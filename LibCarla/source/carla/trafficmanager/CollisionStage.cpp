@@ -9,7 +9,6 @@
 namespace carla {
 namespace traffic_manager {
 
-using Point2D = bg::model::point<double, 2, bg::cs::cartesian>;
 using TLS = carla::rpc::TrafficLightState;
 
 using namespace constants::Collision;
@@ -21,6 +20,7 @@ CollisionStage::CollisionStage(
   const BufferMap &buffer_map,
   const TrackTraffic &track_traffic,
   const Parameters &parameters,
+  const LevelOfDetail &level_of_detail,
   CollisionFrame &output_array,
   RandomGeneratorMap &random_devices)
   : vehicle_id_list(vehicle_id_list),
@@ -28,6 +28,7 @@ CollisionStage::CollisionStage(
     buffer_map(buffer_map),
     track_traffic(track_traffic),
     parameters(parameters),
+    level_of_detail(level_of_detail),
     output_array(output_array),
     random_devices(random_devices) {}
 
@@ -37,16 +38,17 @@ void CollisionStage::Update(const unsigned long index) {
   float available_distance_margin = std::numeric_limits<float>::infinity();
 
   const ActorId ego_actor_id = vehicle_id_list.at(index);
-  if (simulation_state.ContainsActor(ego_actor_id)) {
+  const VehicleParameters &ego_parameters = parameters.GetSnapshot()[index];
+  CollisionLockState &ego_lock = cycle_locks.at(index);
+  ego_lock = GetCycleStartLock(ego_actor_id);
+  // Vehicles not updated in this cycle keep their collision lock.
+  if (simulation_state.ContainsActor(ego_actor_id) && level_of_detail.IsScheduled(index)) {
     const cg::Location ego_location = simulation_state.GetLocation(ego_actor_id);
     const Buffer &ego_buffer = buffer_map.at(ego_actor_id);
     const unsigned long look_ahead_index = GetTargetWaypoint(ego_buffer, JUNCTION_LOOK_AHEAD).second;
     const float velocity = simulation_state.GetVelocity(ego_actor_id).Length();
 
-    ActorIdSet overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
-    std::vector<ActorId> collision_candidate_ids;
-    // Run through vehicles with overlapping paths and filter them;
-    const float distance_to_leading = parameters.GetDistanceToLeadingVehicle(ego_actor_id);
+    const float distance_to_leading = ego_parameters.distance_to_leading_vehicle;
     float collision_radius_square = SQUARE(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN);
     if (velocity < 2.0f) {
       const float length = simulation_state.GetDimensions(ego_actor_id).x;
@@ -57,15 +59,19 @@ void CollisionStage::Update(const unsigned long index) {
         collision_radius_square = SQUARE(distance_to_leading);
     }
 
-    for (ActorId overlapping_actor_id : overlapping_actors) {
-      // If actor is within maximum collision avoidance and vertical overlap range.
-      const cg::Location &overlapping_actor_location = simulation_state.GetLocation(overlapping_actor_id);
-      if (overlapping_actor_id != ego_actor_id
-          && cg::Math::DistanceSquared(overlapping_actor_location, ego_location) < collision_radius_square
-          && std::abs(ego_location.z - overlapping_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD) {
-        collision_candidate_ids.push_back(overlapping_actor_id);
-      }
-    }
+    // Run through vehicles with overlapping paths and filter them,
+    // keeping the ones within maximum collision avoidance and vertical overlap range.
+    std::vector<ActorId> &collision_candidate_ids = overlapping_actors.at(index);
+    track_traffic.GetOverlappingVehicles(ego_actor_id, collision_candidate_ids);
+    collision_candidate_ids.erase(
+        std::remove_if(collision_candidate_ids.begin(), collision_candidate_ids.end(),
+                       [this, ego_actor_id, &ego_location, collision_radius_square](const ActorId overlapping_actor_id) {
+                         const cg::Location &overlapping_actor_location = simulation_state.GetLocation(overlapping_actor_id);
+                         return overlapping_actor_id == ego_actor_id
+                             || cg::Math::DistanceSquared(overlapping_actor_location, ego_location) >= collision_radius_square
+                             || std::abs(ego_location.z - overlapping_actor_location.z) >= VERTICAL_OVERLAP_THRESHOLD;
+                       }),
+        collision_candidate_ids.end());
 
     // Sorting collision candidates in accending order of distance to current vehicle.
     std::sort(collision_candidate_ids.begin(), collision_candidate_ids.end(),
@@ -76,6 +82,25 @@ void CollisionStage::Update(const unsigned long index) {
                 return (cg::Math::DistanceSquared(e_loc, loc_1) < cg::Math::DistanceSquared(e_loc, loc_2));
               });
 
+    // Vehicles far from the heroes only check their lane leader, the closest
+    // actor ahead of them within the width of their lane.
+    if (level_of_detail.GetTier(index) > 0u) {
+      const cg::Vector3D ego_heading = simulation_state.GetHeading(ego_actor_id);
+      const auto lane_leader = std::find_if(collision_candidate_ids.begin(), collision_candidate_ids.end(),
+                                            [this, &ego_location, &ego_heading](const ActorId candidate_id) {
+                                              const cg::Vector3D ego_to_candidate = simulation_state.GetLocation(candidate_id) - ego_location;
+                                              const float lateral_distance = std::abs(ego_heading.x * ego_to_candidate.y - ego_heading.y * ego_to_candidate.x);
+                                              return cg::Math::Dot(ego_heading, ego_to_candidate) > 0.0f
+                                                  && lateral_distance < LANE_LEADER_LATERAL_DISTANCE;
+                                            });
+      if (lane_leader != collision_candidate_ids.end()) {
+        const ActorId lane_leader_id = *lane_leader;
+        collision_candidate_ids.assign(1u, lane_leader_id);
+      } else {
+        collision_candidate_ids.clear();
+      }
+    }
+
     // Check every actor in the vicinity if it poses a collision hazard.
     for (auto iter = collision_candidate_ids.begin();
          iter != collision_candidate_ids.end() && !collision_hazard;
@@ -83,17 +108,18 @@ void CollisionStage::Update(const unsigned long index) {
       const ActorId other_actor_id = *iter;
       const ActorType other_actor_type = simulation_state.GetType(other_actor_id);
 
-      if (parameters.GetCollisionDetection(ego_actor_id, other_actor_id)
+      if (ego_parameters.GetCollisionDetection(other_actor_id)
           && buffer_map.find(ego_actor_id) != buffer_map.end()
           && simulation_state.ContainsActor(other_actor_id)) {
         std::pair<bool, float> negotiation_result = NegotiateCollision(ego_actor_id,
                                                                        other_actor_id,
-                                                                       look_ahead_index);
+                                                                       look_ahead_index,
+                                                                       ego_lock);
         if (negotiation_result.first) {
           if ((other_actor_type == ActorType::Vehicle
-               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_devices.at(ego_actor_id).next())
+               && ego_parameters.perc_ignore_vehicles <= random_devices.at(ego_actor_id).next())
               || (other_actor_type == ActorType::Pedestrian
-                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random_devices.at(ego_actor_id).next())) {
+                  && ego_parameters.perc_ignore_walkers <= random_devices.at(ego_actor_id).next())) {
             collision_hazard = true;
             obstacle_id = other_actor_id;
             available_distance_margin = negotiation_result.second;
@@ -115,9 +141,19 @@ void CollisionStage::RemoveActor(const ActorId actor_id) {
 
 void CollisionStage::Reset() {
   collision_locks.clear();
+  cycle_locks.clear();
 }
 
-float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
+CollisionLockState CollisionStage::GetCycleStartLock(const ActorId actor_id) const {
+  CollisionLockState lock_state{false, {0.0, 0.0, 0u}};
+  auto lock_it = collision_locks.find(actor_id);
+  if (lock_it != collision_locks.end()) {
+    lock_state = {true, lock_it->second};
+  }
+  return lock_state;
+}
+
+float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id, const CollisionLockState &lock_state) {
 
   const float velocity = cg::Math::Dot(simulation_state.GetVelocity(actor_id), simulation_state.GetHeading(actor_id));
   float bbox_extension;
@@ -125,8 +161,8 @@ float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
   float velocity_extension = VEL_EXT_FACTOR * velocity;
   bbox_extension = BOUNDARY_EXTENSION_MINIMUM + velocity_extension * velocity_extension;
   // If a valid collision lock present, change boundary length to maintain lock.
-  if (collision_locks.find(actor_id) != collision_locks.end()) {
-    const CollisionLock &lock = collision_locks.at(actor_id);
+  if (lock_state.has_lock) {
+    const CollisionLock &lock = lock_state.lock;
     float lock_boundary_length = static_cast<float>(lock.distance_to_lead_vehicle + LOCKING_DISTANCE_PADDING);
     // Only extend boundary track vehicle if the leading vehicle
     // if it is not further than velocity dependent extension by MAX_LOCKING_EXTENSION.
@@ -169,94 +205,97 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   return bbox_boundary;
 }
 
-LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
+LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id, const LocationVector &bbox) {
   LocationVector geodesic_boundary;
 
-  if (geodesic_boundary_map.find(actor_id) != geodesic_boundary_map.end()) {
-    geodesic_boundary = geodesic_boundary_map.at(actor_id);
-  } else {
-    const LocationVector bbox = GetBoundary(actor_id);
-
-    if (buffer_map.find(actor_id) != buffer_map.end()) {
-      float bbox_extension = GetBoundingBoxExtention(actor_id);
-      const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id);
-      bbox_extension = std::max(specific_lead_distance, bbox_extension);
-      const float bbox_extension_square = SQUARE(bbox_extension);
-
-      LocationVector left_boundary;
-      LocationVector right_boundary;
-      cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id);
-      const float width = dimensions.y;
-      const float length = dimensions.x;
-
-      const Buffer &waypoint_buffer = buffer_map.at(actor_id);
-      const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length);
-      const SimpleWaypointPtr boundary_start = target_wp_info.first;
-      const uint64_t boundary_start_index = target_wp_info.second;
-
-      // At non-signalized junctions, we extend the boundary across the junction
-      // and in all other situations, boundary length is velocity-dependent.
-      SimpleWaypointPtr boundary_end = nullptr;
-      SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
-      bool reached_distance = false;
-      for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
-        if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
-          reached_distance = true;
-        }
-        if (boundary_end == nullptr
-            || cg::Math::Dot(boundary_end->GetForwardVector(), current_point->GetForwardVector()) < COS_10_DEGREES
-            || reached_distance) {
-
-          const cg::Vector3D heading_vector = current_point->GetForwardVector();
-          const cg::Location location = current_point->GetLocation();
-          cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
-          perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
-          // Direction determined for the left-handed system.
-          const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
-          left_boundary.push_back(location + cg::Location(scaled_perpendicular));
-          right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
-
-          boundary_end = current_point;
-        }
-
-        current_point = waypoint_buffer.at(j);
+  if (buffer_map.find(actor_id) != buffer_map.end()) {
+    // Boundaries are shared between vehicles within a cycle, so they are
+    // always built from the lock held at the start of the cycle.
+    float bbox_extension = GetBoundingBoxExtention(actor_id, GetCycleStartLock(actor_id));
+    const float specific_lead_distance = parameters.GetSnapshot().Find(actor_id).distance_to_leading_vehicle;
+    bbox_extension = std::max(specific_lead_distance, bbox_extension);
+    const float bbox_extension_square = SQUARE(bbox_extension);
+
+    LocationVector left_boundary;
+    LocationVector right_boundary;
+    cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id);
+    const float width = dimensions.y;
+    const float length = dimensions.x;
+
+    const Buffer &waypoint_buffer = buffer_map.at(actor_id);
+    const WaypointGraph &graph = waypoint_buffer.GetGraph();
+    const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length);
+    const WaypointIndex boundary_start = target_wp_info.first;
+    const uint64_t boundary_start_index = target_wp_info.second;
+
+    // At non-signalized junctions, we extend the boundary across the junction
+    // and in all other situations, boundary length is velocity-dependent.
+    WaypointIndex boundary_end = WaypointGraph::NO_WAYPOINT;
+    WaypointIndex current_point = waypoint_buffer.at(boundary_start_index);
+    bool reached_distance = false;
+    for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
+      if (graph.DistanceSquared(boundary_start, current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
+        reached_distance = true;
+      }
+      if (boundary_end == WaypointGraph::NO_WAYPOINT
+          || cg::Math::Dot(graph.GetForwardVector(boundary_end), graph.GetForwardVector(current_point)) < COS_10_DEGREES
+          || reached_distance) {
+
+        const cg::Vector3D &heading_vector = graph.GetForwardVector(current_point);
+        const cg::Location &location = graph.GetLocation(current_point);
+        cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
+        perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
+        // Direction determined for the left-handed system.
+        const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
+        left_boundary.push_back(location + cg::Location(scaled_perpendicular));
+        right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
+
+        boundary_end = current_point;
       }
 
-      // Reversing right boundary to construct clockwise (left-hand system)
-      // boundary. This is so because both left and right boundary vectors have
-      // the closest point to the vehicle at their starting index for the right
-      // boundary,
-      // we want to begin at the farthest point to have a clockwise trace.
-      std::reverse(right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
-    } else {
-
-      geodesic_boundary = bbox;
+      current_point = waypoint_buffer.at(j);
     }
 
-    geodesic_boundary_map.insert({actor_id, geodesic_boundary});
+    // Reversing right boundary to construct clockwise (left-hand system)
+    // boundary. This is so because both left and right boundary vectors have
+    // the closest point to the vehicle at their starting index for the right
+    // boundary,
+    // we want to begin at the farthest point to have a clockwise trace.
+    std::reverse(right_boundary.begin(), right_boundary.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
+  } else {
+
+    geodesic_boundary = bbox;
   }
 
   return geodesic_boundary;
 }
 
-Polygon CollisionStage::GetPolygon(const LocationVector &boundary) {
-
-  traffic_manager::Polygon boundary_polygon;
-  for (const cg::Location &location : boundary) {
-    bg::append(boundary_polygon.outer(), Point2D(location.x, location.y));
+const CollisionPolygons &CollisionStage::GetCollisionPolygons(const ActorId actor_id) {
+  {
+    std::lock_guard<std::mutex> lock(cycle_cache_mutex);
+    auto polygons_it = polygon_cache.find(actor_id);
+    if (polygons_it != polygon_cache.end()) {
+      return polygons_it->second;
+    }
   }
-  bg::append(boundary_polygon.outer(), Point2D(boundary.front().x, boundary.front().y));
 
-  return boundary_polygon;
+  const LocationVector bbox = GetBoundary(actor_id);
+  CollisionPolygons polygons{CollisionPolygon(bbox), CollisionPolygon(GetGeodesicBoundary(actor_id, bbox))};
+
+  // If another thread built them meanwhile, the first ones are kept.
+  std::lock_guard<std::mutex> lock(cycle_cache_mutex);
+  return polygon_cache.emplace(actor_id, std::move(polygons)).first->second;
 }
 
 GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId reference_vehicle_id,
                                                             const ActorId other_actor_id) {
 
 
+  // Results are cached with the lower actor id as the reference, so that the
+  // cached entry does not depend on which vehicle was processed first.
   std::pair<ActorId, ActorId> key_parts;
   if (reference_vehicle_id < other_actor_id) {
     key_parts = {reference_vehicle_id, other_actor_id};
@@ -271,40 +310,52 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
   GeometryComparison comparision_result{-1.0, -1.0, -1.0, -1.0};
 
-  if (geometry_cache.find(actor_id_key) != geometry_cache.end()) {
-
-    comparision_result = geometry_cache.at(actor_id_key);
-    double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
-    comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
-    comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
-  } else {
-
-    const Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle_id));
-    const Polygon other_polygon = GetPolygon(GetBoundary(other_actor_id));
+  bool cached = false;
+  {
+    std::lock_guard<std::mutex> lock(cycle_cache_mutex);
+    auto comparison_it = geometry_cache.find(actor_id_key);
+    if (comparison_it != geometry_cache.end()) {
+      comparision_result = comparison_it->second;
+      cached = true;
+    }
+  }
 
-    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(reference_vehicle_id));
+  if (!cached) {
 
-    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(other_actor_id));
+    const CollisionPolygons &reference_polygons = GetCollisionPolygons(key_parts.first);
+    const CollisionPolygons &other_polygons = GetCollisionPolygons(key_parts.second);
 
-    const double reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
-    const double other_vehicle_to_reference_geodesic = bg::distance(other_polygon, reference_geodesic_polygon);
-    const auto inter_geodesic_distance = bg::distance(reference_geodesic_polygon, other_geodesic_polygon);
-    const auto inter_bbox_distance = bg::distance(reference_polygon, other_polygon);
+    const double reference_vehicle_to_other_geodesic =
+        CollisionPolygon::Distance(reference_polygons.bounding_box, other_polygons.geodesic_boundary);
+    const double other_vehicle_to_reference_geodesic =
+        CollisionPolygon::Distance(other_polygons.bounding_box, reference_polygons.geodesic_boundary);
+    const double inter_geodesic_distance =
+        CollisionPolygon::Distance(reference_polygons.geodesic_boundary, other_polygons.geodesic_boundary);
+    const double inter_bbox_distance =
+        CollisionPolygon::Distance(reference_polygons.bounding_box, other_polygons.bounding_box);
 
     comparision_result = {reference_vehicle_to_other_geodesic,
               other_vehicle_to_reference_geodesic,
               inter_geodesic_distance,
               inter_bbox_distance};
 
+    std::lock_guard<std::mutex> lock(cycle_cache_mutex);
     geometry_cache.insert({actor_id_key, comparision_result});
   }
 
+  if (reference_vehicle_id != key_parts.first) {
+    double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
+    comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
+    comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
+  }
+
   return comparision_result;
 }
 
 std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId reference_vehicle_id,
                                                           const ActorId other_actor_id,
-                                                          const uint64_t reference_junction_look_ahead_index) {
+                                                          const uint64_t reference_junction_look_ahead_index,
+                                                          CollisionLockState &reference_lock) {
   // Output variables for the method.
   bool hazard = false;
   float available_distance_margin = std::numeric_limits<float>::infinity();
@@ -328,8 +379,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   float other_vehicle_length = simulation_state.GetDimensions(other_actor_id).x * SQUARE_ROOT_OF_TWO;
 
   float inter_vehicle_distance = cg::Math::DistanceSquared(reference_location, other_location);
-  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id);
-  float other_bounding_box_extension = GetBoundingBoxExtention(other_actor_id);
+  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id, reference_lock);
+  float other_bounding_box_extension = GetBoundingBoxExtention(other_actor_id, GetCycleStartLock(other_actor_id));
   // Calculate minimum distance between vehicle to consider collision negotiation.
   float inter_vehicle_length = reference_vehicle_length + other_vehicle_length;
   float ego_detection_range = SQUARE(ego_bounding_box_extension + inter_vehicle_length);
@@ -341,13 +392,14 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   float reference_heading_to_other_dot = cg::Math::Dot(reference_heading, reference_to_other);
   bool other_vehicle_in_front = reference_heading_to_other_dot > 0;
   const Buffer &reference_vehicle_buffer = buffer_map.at(reference_vehicle_id);
-  SimpleWaypointPtr closest_point = reference_vehicle_buffer.front();
-  bool ego_inside_junction = closest_point->CheckJunction();
+  const WaypointGraph &graph = reference_vehicle_buffer.GetGraph();
+  WaypointIndex closest_point = reference_vehicle_buffer.front();
+  bool ego_inside_junction = graph.IsJunction(closest_point);
   TrafficLightState reference_tl_state = simulation_state.GetTLS(reference_vehicle_id);
   bool ego_at_traffic_light = reference_tl_state.at_traffic_light;
   bool ego_stopped_by_light = reference_tl_state.tl_state != TLS::Green && reference_tl_state.tl_state != TLS::Off;
-  SimpleWaypointPtr look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
-  bool ego_at_junction_entrance = !closest_point->CheckJunction() && look_ahead_point->CheckJunction();
+  WaypointIndex look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
+  bool ego_at_junction_entrance = !graph.IsJunction(closest_point) && graph.IsJunction(look_ahead_point);
 
   // Conditions to consider collision negotiation.
   if (!(ego_at_junction_entrance && ego_at_traffic_light && ego_stopped_by_light)
@@ -374,7 +426,7 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
 
       hazard = true;
 
-      const float reference_lead_distance = parameters.GetDistanceToLeadingVehicle(reference_vehicle_id);
+      const float reference_lead_distance = parameters.GetSnapshot().Find(reference_vehicle_id).distance_to_leading_vehicle;
       const float specific_distance_margin = std::max(reference_lead_distance, MIN_REFERENCE_DISTANCE);
       available_distance_margin = static_cast<float>(std::max(geometry_comparison.reference_vehicle_to_other_geodesic
                                                               - static_cast<double>(specific_distance_margin), 0.0));
@@ -385,8 +437,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
       // This enables us to smoothly approach the lead vehicle.
 
       // When possible collision found, check if an entry for collision lock present.
-      if (collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-        CollisionLock &lock = collision_locks.at(reference_vehicle_id);
+      if (reference_lock.has_lock) {
+        CollisionLock &lock = reference_lock.lock;
         // Check if the same vehicle is under lock.
         if (other_actor_id == lock.lead_vehicle_id) {
           // If the body of the lead vehicle is touching the reference vehicle bounding box.
@@ -403,24 +455,41 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
         }
       } else {
         // Insert and initialize lock entry if not present.
-        collision_locks.insert({reference_vehicle_id,
-                                {geometry_comparison.inter_bbox_distance,
-                                 geometry_comparison.inter_bbox_distance,
-                                 other_actor_id}});
+        reference_lock = {true,
+                          {geometry_comparison.inter_bbox_distance,
+                           geometry_comparison.inter_bbox_distance,
+                           other_actor_id}};
       }
     }
   }
 
   // If no collision hazard detected, then flush collision lock held by the vehicle.
-  if (!hazard && collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-    collision_locks.erase(reference_vehicle_id);
+  if (!hazard) {
+    reference_lock.has_lock = false;
   }
 
   return {hazard, available_distance_margin};
 }
 
+void CollisionStage::PrepareCycle() {
+  cycle_locks.resize(vehicle_id_list.size());
+  overlapping_actors.resize(vehicle_id_list.size());
+}
+
+void CollisionStage::CommitCollisionLocks() {
+  for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+    const ActorId actor_id = vehicle_id_list.at(index);
+    const CollisionLockState &lock_state = cycle_locks.at(index);
+    if (lock_state.has_lock) {
+      collision_locks[actor_id] = lock_state.lock;
+    } else {
+      collision_locks.erase(actor_id);
+    }
+  }
+}
+
 void CollisionStage::ClearCycleCache() {
-  geodesic_boundary_map.clear();
+  polygon_cache.clear();
   geometry_cache.clear();
 }
 
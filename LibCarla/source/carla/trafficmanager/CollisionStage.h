@@ -2,17 +2,16 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 
-#include "boost/geometry.hpp"
-#include "boost/geometry/geometries/geometries.hpp"
-#include "boost/geometry/geometries/point_xy.hpp"
-#include "boost/geometry/geometries/polygon.hpp"
-
+#include "carla/trafficmanager/CollisionPolygon.h"
 #include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/LevelOfDetail.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
 #include "carla/trafficmanager/Stage.h"
+#include "carla/trafficmanager/TrackTraffic.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -31,15 +30,25 @@ struct CollisionLock {
 };
 using CollisionLockMap = std::unordered_map<ActorId, CollisionLock>;
 
+/// Collision lock held by a vehicle while it is being processed in a cycle.
+struct CollisionLockState {
+  bool has_lock;
+  CollisionLock lock;
+};
+
+/// Polygons of an actor compared against other actors, built once per cycle.
+struct CollisionPolygons {
+  CollisionPolygon bounding_box;
+  CollisionPolygon geodesic_boundary;
+};
+
 namespace cc = carla::client;
-namespace bg = boost::geometry;
 
-using Buffer = std::deque<std::shared_ptr<SimpleWaypoint>>;
+using Buffer = WaypointBuffer;
 using BufferMap = std::unordered_map<carla::ActorId, Buffer>;
 using LocationVector = std::vector<cg::Location>;
-using GeodesicBoundaryMap = std::unordered_map<ActorId, LocationVector>;
+using CollisionPolygonMap = std::unordered_map<ActorId, CollisionPolygons>;
 using GeometryComparisonMap = std::unordered_map<uint64_t, GeometryComparison>;
-using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>;
 
 /// This class has functionality to detect potential collision with a nearby actor.
 class CollisionStage : Stage {
@@ -49,31 +58,49 @@ private:
   const BufferMap &buffer_map;
   const TrackTraffic &track_traffic;
   const Parameters &parameters;
+  const LevelOfDetail &level_of_detail;
   CollisionFrame &output_array;
   // Structure keeping track of blocking lead vehicles.
+  // It is only read during the per-vehicle updates, changes are
+  // committed once all vehicles have been processed.
   CollisionLockMap collision_locks;
-  // Structures to cache geodesic boundaries of vehicle and
+  // Collision lock state of every vehicle index for the current cycle.
+  std::vector<CollisionLockState> cycle_locks;
+  // Actors overlapping the path of every vehicle index, the storage is
+  // reused between cycles.
+  std::vector<std::vector<ActorId>> overlapping_actors;
+  // Structures to cache the polygons of each vehicle and
   // comparision between vehicle boundaries
   // to avoid repeated computation within a cycle.
+  // Entries are never modified once inserted, and references to them stay
+  // valid until the cache is cleared.
   GeometryComparisonMap geometry_cache;
-  GeodesicBoundaryMap geodesic_boundary_map;
+  CollisionPolygonMap polygon_cache;
+  // Mutex guarding the cycle caches when vehicles are updated concurrently.
+  std::mutex cycle_cache_mutex;
   RandomGeneratorMap &random_devices;
 
   // Method to determine if a vehicle is on a collision path to another.
   std::pair<bool, float> NegotiateCollision(const ActorId reference_vehicle_id,
                                             const ActorId other_actor_id,
-                                            const uint64_t reference_junction_look_ahead_index);
+                                            const uint64_t reference_junction_look_ahead_index,
+                                            CollisionLockState &reference_lock);
+
+  // Method to retrieve the collision lock held by a vehicle at the start of the cycle.
+  CollisionLockState GetCycleStartLock(const ActorId actor_id) const;
 
   // Method to calculate bounding box extention length ahead of the vehicle.
-  float GetBoundingBoxExtention(const ActorId actor_id);
+  float GetBoundingBoxExtention(const ActorId actor_id, const CollisionLockState &lock_state);
 
   // Method to calculate polygon points around the vehicle's bounding box.
   LocationVector GetBoundary(const ActorId actor_id);
 
-  // Method to construct polygon points around the path boundary of the vehicle.
-  LocationVector GetGeodesicBoundary(const ActorId actor_id);
+  // Method to construct polygon points around the path boundary of the vehicle,
+  // given the polygon points around its bounding box.
+  LocationVector GetGeodesicBoundary(const ActorId actor_id, const LocationVector &bbox);
 
-  Polygon GetPolygon(const LocationVector &boundary);
+  // Method to retrieve the polygons of an actor, building them on first use in the cycle.
+  const CollisionPolygons &GetCollisionPolygons(const ActorId actor_id);
 
   // Method to compare path boundaries, bounding boxes of vehicles
   // and cache the results for reuse in current update cycle.
@@ -89,6 +116,7 @@ public:
                  const BufferMap &buffer_map,
                  const TrackTraffic &track_traffic,
                  const Parameters &parameters,
+                 const LevelOfDetail &level_of_detail,
                  CollisionFrame &output_array,
                  RandomGeneratorMap &random_devices);
 
@@ -98,6 +126,14 @@ public:
 
   void Reset() override;
 
+  // Method to allocate the per-vehicle collision lock states of the current cycle.
+  // Must be called before updating any vehicle.
+  void PrepareCycle();
+
+  // Method to store the collision locks computed in the current cycle.
+  // Must be called once all vehicles have been updated.
+  void CommitCollisionLocks();
+
   // Method to flush cache for current update cycle.
   void ClearCycleCache();
 };
@@ -87,6 +87,7 @@ static const float EPSILON = 2.0f * std::numeric_limits<float>::epsilon();
 static const float MIN_REFERENCE_DISTANCE = 0.5f;
 static const float MIN_VELOCITY_COLL_RADIUS = 2.0f;
 static const float VEL_EXT_FACTOR = 0.36f;
+static const float LANE_LEADER_LATERAL_DISTANCE = 2.0f;
 } // namespace Collision
 
 namespace FrameMemory {
@@ -161,6 +162,12 @@ static const uint64_t BUFFER_STEP_THROUGH = 5;
 static const float INV_BUFFER_STEP_THROUGH = 1.0f / static_cast<float>(BUFFER_STEP_THROUGH);
 } // namespace TrackTraffic
 
+namespace Sharding {
+/// Distance a vehicle has to be past the border of its region before it is
+/// handed off to the traffic manager of the next region.
+static const float REGION_HAND_OFF_MARGIN = 10.0f;
+} // namespace Sharding
+
 } // namespace constants
 } // namespace traffic_manager
 } // namespace carla
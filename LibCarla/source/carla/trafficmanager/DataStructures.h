@@ -16,6 +16,7 @@
 #include "carla/rpc/TrafficLightState.h"
 
 #include "carla/trafficmanager/SimpleWaypoint.h"
+#include "carla/trafficmanager/WaypointBuffer.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -28,14 +29,14 @@ using ActorId = carla::ActorId;
 using ActorPtr = carla::SharedPtr<cc::Actor>;
 using JunctionID = carla::road::JuncId;
 using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-using Buffer = std::deque<SimpleWaypointPtr>;
+using Buffer = WaypointBuffer;
 using BufferMap = std::unordered_map<carla::ActorId, Buffer>;
 using TimeInstance = chr::time_point<chr::system_clock, chr::nanoseconds>;
 using TLS = carla::rpc::TrafficLightState;
 
 struct LocalizationData {
-  SimpleWaypointPtr junction_end_point;
-  SimpleWaypointPtr safe_point;
+  WaypointIndex junction_end_point;
+  WaypointIndex safe_point;
   bool is_at_junction_entrance;
 };
 using LocalizationFrame = std::vector<LocalizationData>;
@@ -9,6 +9,8 @@
 #include "carla/trafficmanager/Constants.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 #include <boost/geometry/geometries/box.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 namespace carla {
 namespace traffic_manager {
@@ -89,27 +91,75 @@ namespace traffic_manager {
       return;
     }
 
-    // write total records
-    uint32_t total = static_cast<uint32_t>(dense_topology.size());
-    out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
-
-    // write simple waypoints
-    std::unordered_set<uint64_t> used_ids;
-    for (auto& wp: dense_topology) {
-      if (used_ids.find(wp->GetId()) != used_ids.end()) {
-        log_error("Could not generate the binary file. There are repeated waypoints");
-      }
-      CachedSimpleWaypoint cached_wp(wp);
-      cached_wp.Write(out_file);
-
-      used_ids.insert(wp->GetId());
+    if (!InMemoryMapCache::Write(dense_topology, out_file)) {
+      log_error("Could not write binary file");
     }
 
     out_file.close();
     return;
   }
 
+  bool InMemoryMap::Load(const std::string& filename) {
+    namespace bip = boost::interprocess;
+    try {
+      bip::file_mapping file(filename.c_str(), bip::read_only);
+      bip::mapped_region region(file, bip::read_only);
+      const uint8_t *data = static_cast<const uint8_t *>(region.get_address());
+      const size_t size = region.get_size();
+      if (InMemoryMapCache::HasHeader(data, size)) {
+        return Load(InMemoryMapCache(data, size));
+      }
+      return LoadRecords(std::vector<uint8_t>(data, data + size));
+    } catch (const bip::interprocess_exception &e) {
+      log_error("Could not map InMemoryMap cache", filename, ":", e.what());
+      return false;
+    }
+  }
+
   bool InMemoryMap::Load(const std::vector<uint8_t>& content) {
+    if (InMemoryMapCache::HasHeader(content.data(), content.size())) {
+      return Load(InMemoryMapCache(content.data(), content.size()));
+    }
+    return LoadRecords(content);
+  }
+
+  bool InMemoryMap::Load(const InMemoryMapCache &cache) {
+    if (!cache.IsValid()) {
+      return false;
+    }
+
+    // The waypoint objects are created from the records long after loading,
+    // so a cache of another version of the map is rejected here instead.
+    const uint32_t total = cache.GetNumberOfWaypoints();
+    const carla::road::Map &road_map = _world_map->GetMap();
+    for (uint32_t i = 0u; i < total; ++i) {
+      const InMemoryMapCache::WaypointRecord &record = cache.GetWaypoint(i);
+      if (!road_map.GetWaypoint(record.road_id, record.lane_id, record.s).has_value()) {
+        log_warning("InMemoryMap cache does not match the map, waypoint", i, "is not on any lane");
+        return false;
+      }
+    }
+
+    // The graph is built straight from the cache records. The waypoint
+    // objects, which need an OpenDRIVE query each, are only created for
+    // the waypoints the stages ask for.
+    dense_topology.clear();
+    waypoint_graph.Build(cache, _world_map);
+
+    std::vector<SpatialTreeEntry> spatial_entries;
+    spatial_entries.reserve(total);
+    for (uint32_t i = 0u; i < total; ++i) {
+      const InMemoryMapCache::WaypointRecord &record = cache.GetWaypoint(i);
+      spatial_entries.emplace_back(Point3D(record.location[0], record.location[1], record.location[2]), i);
+    }
+
+    // Bulk loading the spatial tree from the cached locations.
+    rtree = Rtree(spatial_entries.begin(), spatial_entries.end());
+
+    return true;
+  }
+
+  bool InMemoryMap::LoadRecords(const std::vector<uint8_t>& content) {
     unsigned long pos = 0;
     std::vector<CachedSimpleWaypoint> cached_waypoints;
     std::unordered_map<uint64_t, uint32_t> id2index;
@@ -160,6 +210,8 @@ namespace traffic_manager {
     // create spatial tree
     SetUpSpatialTree();
 
+    waypoint_graph.Build(dense_topology);
+
     return true;
   }
 
@@ -355,16 +407,25 @@ namespace traffic_manager {
 
     // Specifying a RoadOption for each SimpleWaypoint
     SetUpRoadOption();
+
+    waypoint_graph.Build(dense_topology);
   }
 
   void InMemoryMap::SetUpSpatialTree() {
-    for (auto &simple_waypoint: dense_topology) {
+    std::vector<SpatialTreeEntry> spatial_entries;
+    spatial_entries.reserve(dense_topology.size());
+    for (size_t i = 0u; i < dense_topology.size(); ++i) {
+      const SimpleWaypointPtr &simple_waypoint = dense_topology[i];
       if (simple_waypoint != nullptr) {
         const cg::Location loc = simple_waypoint->GetLocation();
         Point3D point(loc.x, loc.y, loc.z);
-        rtree.insert(std::make_pair(point, simple_waypoint));
+        // The entries hold the index the waypoint gets in waypoint_graph.
+        spatial_entries.emplace_back(point, static_cast<WaypointIndex>(i));
       }
     }
+    // Bulk loading packs the tree, which is much faster than inserting
+    // the waypoints one by one.
+    rtree = Rtree(spatial_entries.begin(), spatial_entries.end());
   }
 
   void InMemoryMap::SetUpRoadOption() {
@@ -457,6 +518,10 @@ namespace traffic_manager {
   }
 
   SimpleWaypointPtr InMemoryMap::GetWaypoint(const cg::Location loc) const {
+    return waypoint_graph.GetSimpleWaypoint(GetWaypointIndex(loc));
+  }
+
+  WaypointIndex InMemoryMap::GetWaypointIndex(const cg::Location loc) const {
 
     Point3D query_point(loc.x, loc.y, loc.z);
     std::vector<SpatialTreeEntry> result_1;
@@ -464,9 +529,7 @@ namespace traffic_manager {
     rtree.query(bgi::nearest(query_point, 1), std::back_inserter(result_1));
 
     SpatialTreeEntry &closest_entry = result_1.front();
-    SimpleWaypointPtr &closest_point = closest_entry.second;
-
-    return closest_point;
+    return closest_entry.second;
   }
 
   NodeList InMemoryMap::GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const {
@@ -485,11 +548,11 @@ namespace traffic_manager {
     for (Rtree::const_query_iterator
         it = rtree.qbegin(bgi::within(upper_query_box)
         && !bgi::within(lower_query_box)
-        && bgi::satisfies([&](SpatialTreeEntry const& v) { return !v.second->CheckJunction();}));
+        && bgi::satisfies([&](SpatialTreeEntry const& v) { return !waypoint_graph.IsJunction(v.second);}));
         it != rtree.qend();
         ++it) {
     x++;
-    result.push_back(it->second);
+    result.push_back(waypoint_graph.GetSimpleWaypoint(it->second));
     if (x >= n_points)
         break;
     }
@@ -498,7 +561,11 @@ namespace traffic_manager {
   }
 
   NodeList InMemoryMap::GetDenseTopology() const {
-    return dense_topology;
+    return waypoint_graph.GetSimpleWaypoints();
+  }
+
+  const WaypointGraph &InMemoryMap::GetWaypointGraph() const {
+    return waypoint_graph;
   }
 
   void InMemoryMap::FindAndLinkLaneChange(SimpleWaypointPtr reference_waypoint) {
@@ -517,7 +584,7 @@ namespace traffic_manager {
         left_waypoint->GetType() == crd::Lane::LaneType::Driving &&
         (left_waypoint->GetLaneId() * raw_waypoint->GetLaneId() > 0)) {
 
-          SimpleWaypointPtr closest_simple_waypoint = GetWaypoint(left_waypoint->GetTransform().location);
+          SimpleWaypointPtr closest_simple_waypoint = dense_topology.at(GetWaypointIndex(left_waypoint->GetTransform().location));
           reference_waypoint->SetLeftWaypoint(closest_simple_waypoint);
         }
       }
@@ -531,7 +598,7 @@ namespace traffic_manager {
 	    right_waypoint->GetType() == crd::Lane::LaneType::Driving &&
 	    (right_waypoint->GetLaneId() * raw_waypoint->GetLaneId() > 0)) {
 
-	      SimpleWaypointPtr closest_simple_waypoint = GetWaypoint(right_waypoint->GetTransform().location);
+	      SimpleWaypointPtr closest_simple_waypoint = dense_topology.at(GetWaypointIndex(right_waypoint->GetTransform().location));
 	      reference_waypoint->SetRightWaypoint(closest_simple_waypoint);
 	    }
       }
@@ -546,7 +613,7 @@ namespace traffic_manager {
         right_waypoint->GetType() == crd::Lane::LaneType::Driving &&
         (right_waypoint->GetLaneId() * raw_waypoint->GetLaneId() > 0)) {
 
-          SimpleWaypointPtr closest_simple_waypointR = GetWaypoint(right_waypoint->GetTransform().location);
+          SimpleWaypointPtr closest_simple_waypointR = dense_topology.at(GetWaypointIndex(right_waypoint->GetTransform().location));
           reference_waypoint->SetRightWaypoint(closest_simple_waypointR);
         }
 
@@ -556,7 +623,7 @@ namespace traffic_manager {
         left_waypoint->GetType() == crd::Lane::LaneType::Driving &&
         (left_waypoint->GetLaneId() * raw_waypoint->GetLaneId() > 0)) {
 
-          SimpleWaypointPtr closest_simple_waypointL = GetWaypoint(left_waypoint->GetTransform().location);
+          SimpleWaypointPtr closest_simple_waypointL = dense_topology.at(GetWaypointIndex(left_waypoint->GetTransform().location));
           reference_waypoint->SetLeftWaypoint(closest_simple_waypointL);
         }
       }
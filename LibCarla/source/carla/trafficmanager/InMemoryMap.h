@@ -25,6 +25,8 @@
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
 #include "carla/trafficmanager/CachedSimpleWaypoint.h"
+#include "carla/trafficmanager/InMemoryMapCache.h"
+#include "carla/trafficmanager/WaypointGraph.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -43,7 +45,7 @@ namespace bgi = boost::geometry::index;
 
   using Point3D = bg::model::point<float, 3, bg::cs::cartesian>;
   using Box = bg::model::box<Point3D>;
-  using SpatialTreeEntry = std::pair<Point3D, SimpleWaypointPtr>;
+  using SpatialTreeEntry = std::pair<Point3D, WaypointIndex>;
 
   using SegmentId = std::tuple<crd::RoadId, crd::LaneId, crd::SectionId>;
   using SegmentTopology = std::map<SegmentId, std::pair<std::vector<SegmentId>, std::vector<SegmentId>>>;
@@ -60,10 +62,13 @@ namespace bgi = boost::geometry::index;
     /// Object to hold the world map received by the constructor.
     WorldMap _world_map;
     /// Structure to hold all custom waypoint objects after interpolation of
-    /// sparse topology.
+    /// sparse topology. Empty when the map is loaded from a flat cache.
     NodeList dense_topology;
-    /// Spatial quadratic R-tree for indexing and querying waypoints.
+    /// Spatial quadratic R-tree for indexing and querying waypoints by their
+    /// index in waypoint_graph.
     Rtree rtree;
+    /// Index-addressed view of the waypoints used by the stages.
+    WaypointGraph waypoint_graph;
 
   public:
 
@@ -72,7 +77,9 @@ namespace bgi = boost::geometry::index;
 
     static void Cook(WorldMap world_map, const std::string& path);
 
-    //bool Load(const std::string& filename);
+    /// Loads the local map from a cache file, memory-mapping it.
+    bool Load(const std::string& filename);
+    /// Loads the local map from the content of a cache file.
     bool Load(const std::vector<uint8_t>& content);
 
     /// This method constructs the local map with a resolution of sampling_resolution.
@@ -81,12 +88,19 @@ namespace bgi = boost::geometry::index;
     /// This method returns the closest waypoint to a given location on the map.
     SimpleWaypointPtr GetWaypoint(const cg::Location loc) const;
 
+    /// This method returns the index of the closest waypoint to a given
+    /// location on the map.
+    WaypointIndex GetWaypointIndex(const cg::Location loc) const;
+
     /// This method returns n waypoints in an delta area with a certain distance from the ego vehicle.
     NodeList GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const;
 
     /// This method returns the full list of discrete samples of the map in the local cache.
     NodeList GetDenseTopology() const;
 
+    /// This method returns the index-addressed view of the discrete samples of the map.
+    const WaypointGraph &GetWaypointGraph() const;
+
     std::string GetMapName();
 
     const cc::Map& GetMap() const;
@@ -94,6 +108,12 @@ namespace bgi = boost::geometry::index;
   private:
     void Save(const std::string& path);
 
+    /// Loads the flat, index-based cache layout.
+    bool Load(const InMemoryMapCache &cache);
+    /// Loads the cache layout of one record per waypoint used before
+    /// InMemoryMapCache was introduced.
+    bool LoadRecords(const std::vector<uint8_t>& content);
+
     void SetUpDenseTopology();
     void SetUpSpatialTree();
     void SetUpRoadOption();
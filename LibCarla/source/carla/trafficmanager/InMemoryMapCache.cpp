@@ -0,0 +1,189 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/InMemoryMapCache.h"
+
+#include "carla/Logging.h"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace carla {
+namespace traffic_manager {
+
+  static constexpr char CACHE_MAGIC[4] = {'C', 'T', 'M', 'C'};
+
+  constexpr uint32_t InMemoryMapCache::VERSION;
+  constexpr uint32_t InMemoryMapCache::NO_WAYPOINT;
+
+  template <typename T>
+  static void WriteArray(std::ostream &out, const T *data, size_t count) {
+    out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(sizeof(T) * count));
+  }
+
+  static bool IsValidLinks(const uint32_t *offsets, const uint32_t *indices, uint32_t number_of_waypoints, uint32_t number_of_links) {
+    if (offsets[0] != 0u || offsets[number_of_waypoints] != number_of_links) {
+      return false;
+    }
+    for (uint32_t i = 0u; i < number_of_waypoints; ++i) {
+      if (offsets[i] > offsets[i + 1u]) {
+        return false;
+      }
+    }
+    for (uint32_t i = 0u; i < number_of_links; ++i) {
+      if (indices[i] >= number_of_waypoints) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool InMemoryMapCache::HasHeader(const uint8_t *data, size_t size) {
+    return size >= sizeof(Header) && std::memcmp(data, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0;
+  }
+
+  bool InMemoryMapCache::Write(const std::vector<SimpleWaypointPtr> &dense_topology, std::ostream &out) {
+    const uint32_t total = static_cast<uint32_t>(dense_topology.size());
+
+    // Links to repeated waypoints are resolved to their first occurrence.
+    std::unordered_map<uint64_t, uint32_t> id2index;
+    id2index.reserve(total);
+    for (uint32_t i = 0u; i < total; ++i) {
+      if (!id2index.insert({dense_topology[i]->GetId(), i}).second) {
+        log_error("InMemoryMap cache: there are repeated waypoints");
+      }
+    }
+
+    std::vector<WaypointRecord> records(total);
+    std::vector<uint32_t> next_offsets(total + 1u, 0u);
+    std::vector<uint32_t> next_indices;
+    std::vector<uint32_t> previous_offsets(total + 1u, 0u);
+    std::vector<uint32_t> previous_indices;
+
+    for (uint32_t i = 0u; i < total; ++i) {
+      const SimpleWaypointPtr &simple_waypoint = dense_topology[i];
+      const auto waypoint = simple_waypoint->GetWaypoint();
+      const cg::Transform transform = simple_waypoint->GetTransform();
+      const cg::Location &location = transform.location;
+      const cg::Vector3D forward = transform.GetForwardVector();
+
+      WaypointRecord &record = records[i];
+      std::memset(&record, 0, sizeof(WaypointRecord));
+      record.waypoint_id = simple_waypoint->GetId();
+      record.location[0] = location.x;
+      record.location[1] = location.y;
+      record.location[2] = location.z;
+      record.forward[0] = forward.x;
+      record.forward[1] = forward.y;
+      record.forward[2] = forward.z;
+      record.s = static_cast<float>(waypoint->GetDistance());
+      record.road_id = waypoint->GetRoadId();
+      record.section_id = waypoint->GetSectionId();
+      record.lane_id = waypoint->GetLaneId();
+      record.geodesic_grid_id = simple_waypoint->GetGeodesicGridId();
+      record.left_index = NO_WAYPOINT;
+      record.right_index = NO_WAYPOINT;
+      if (simple_waypoint->GetLeftWaypoint() != nullptr) {
+        record.left_index = id2index.at(simple_waypoint->GetLeftWaypoint()->GetId());
+      }
+      if (simple_waypoint->GetRightWaypoint() != nullptr) {
+        record.right_index = id2index.at(simple_waypoint->GetRightWaypoint()->GetId());
+      }
+      record.is_junction = simple_waypoint->CheckJunction() ? 1u : 0u;
+      record.road_option = static_cast<uint8_t>(simple_waypoint->GetRoadOption());
+
+      for (auto &next : simple_waypoint->GetNextWaypoint()) {
+        next_indices.push_back(id2index.at(next->GetId()));
+      }
+      next_offsets[i + 1u] = static_cast<uint32_t>(next_indices.size());
+
+      for (auto &previous : simple_waypoint->GetPreviousWaypoint()) {
+        previous_indices.push_back(id2index.at(previous->GetId()));
+      }
+      previous_offsets[i + 1u] = static_cast<uint32_t>(previous_indices.size());
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = VERSION;
+    header.number_of_waypoints = total;
+    header.number_of_next_links = static_cast<uint32_t>(next_indices.size());
+    header.number_of_previous_links = static_cast<uint32_t>(previous_indices.size());
+
+    WriteArray(out, &header, 1u);
+    WriteArray(out, records.data(), records.size());
+    WriteArray(out, next_offsets.data(), next_offsets.size());
+    WriteArray(out, next_indices.data(), next_indices.size());
+    WriteArray(out, previous_offsets.data(), previous_offsets.size());
+    WriteArray(out, previous_indices.data(), previous_indices.size());
+    return out.good();
+  }
+
+  InMemoryMapCache::InMemoryMapCache(const uint8_t *data, size_t size) {
+    if (!HasHeader(data, size)) {
+      log_error("InMemoryMap cache: unknown file format");
+      return;
+    }
+    if (reinterpret_cast<uintptr_t>(data) % alignof(WaypointRecord) != 0u) {
+      log_error("InMemoryMap cache: misaligned buffer");
+      return;
+    }
+
+    const Header &header = *reinterpret_cast<const Header *>(data);
+    if (header.version != VERSION) {
+      log_error("InMemoryMap cache: unsupported version", header.version, "expected", VERSION);
+      return;
+    }
+
+    const size_t number_of_waypoints = header.number_of_waypoints;
+    const size_t expected_size =
+        sizeof(Header) +
+        sizeof(WaypointRecord) * number_of_waypoints +
+        sizeof(uint32_t) * (2u * (number_of_waypoints + 1u) +
+                            header.number_of_next_links +
+                            header.number_of_previous_links);
+    if (size < expected_size) {
+      log_error("InMemoryMap cache: truncated file");
+      return;
+    }
+
+    const uint8_t *position = data + sizeof(Header);
+    const auto *records = reinterpret_cast<const WaypointRecord *>(position);
+    position += sizeof(WaypointRecord) * number_of_waypoints;
+    const auto *next_offsets = reinterpret_cast<const uint32_t *>(position);
+    position += sizeof(uint32_t) * (number_of_waypoints + 1u);
+    const auto *next_indices = reinterpret_cast<const uint32_t *>(position);
+    position += sizeof(uint32_t) * header.number_of_next_links;
+    const auto *previous_offsets = reinterpret_cast<const uint32_t *>(position);
+    position += sizeof(uint32_t) * (number_of_waypoints + 1u);
+    const auto *previous_indices = reinterpret_cast<const uint32_t *>(position);
+
+    // Validating the indices once here allows using them unchecked later.
+    bool valid_lane_changes = true;
+    for (size_t i = 0u; i < number_of_waypoints && valid_lane_changes; ++i) {
+      const WaypointRecord &record = records[i];
+      valid_lane_changes =
+          (record.left_index == NO_WAYPOINT || record.left_index < number_of_waypoints) &&
+          (record.right_index == NO_WAYPOINT || record.right_index < number_of_waypoints);
+    }
+    if (!valid_lane_changes ||
+        !IsValidLinks(next_offsets, next_indices, header.number_of_waypoints, header.number_of_next_links) ||
+        !IsValidLinks(previous_offsets, previous_indices, header.number_of_waypoints, header.number_of_previous_links)) {
+      log_error("InMemoryMap cache: corrupted waypoint links");
+      return;
+    }
+
+    _number_of_waypoints = header.number_of_waypoints;
+    _records = records;
+    _next_offsets = next_offsets;
+    _next_indices = next_indices;
+    _previous_offsets = previous_offsets;
+    _previous_indices = previous_indices;
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,126 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "carla/trafficmanager/SimpleWaypoint.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
+
+  /// Read-only view over the flat, index-based binary layout of the traffic
+  /// manager map cache. The view does not copy nor decode the buffer, so it
+  /// can be used directly on top of a memory-mapped file.
+  ///
+  /// Layout (native endianness):
+  ///
+  ///   Header
+  ///   WaypointRecord[number_of_waypoints]
+  ///   uint32_t next_offsets[number_of_waypoints + 1]
+  ///   uint32_t next_indices[number_of_next_links]
+  ///   uint32_t previous_offsets[number_of_waypoints + 1]
+  ///   uint32_t previous_indices[number_of_previous_links]
+  ///
+  /// Next and previous links are stored in compressed sparse row form: the
+  /// links of waypoint i are the indices in [offsets[i], offsets[i + 1]).
+  class InMemoryMapCache {
+  public:
+
+    static constexpr uint32_t VERSION = 2u;
+
+    /// Value of a lane change index with no waypoint.
+    static constexpr uint32_t NO_WAYPOINT = 0xFFFFFFFFu;
+
+    struct Header {
+      char magic[4];
+      uint32_t version;
+      uint32_t number_of_waypoints;
+      uint32_t number_of_next_links;
+      uint32_t number_of_previous_links;
+      uint32_t reserved;
+    };
+
+    struct WaypointRecord {
+      uint64_t waypoint_id;
+      float location[3];
+      float forward[3];
+      float s;
+      uint32_t road_id;
+      uint32_t section_id;
+      int32_t lane_id;
+      int32_t geodesic_grid_id;
+      uint32_t left_index;
+      uint32_t right_index;
+      uint8_t is_junction;
+      uint8_t road_option;
+      uint8_t padding[2];
+    };
+
+    static_assert(sizeof(Header) == 24u, "Unexpected cache header size");
+    static_assert(sizeof(WaypointRecord) == 64u, "Unexpected cache record size");
+
+    /// Range of waypoint indices linked to a waypoint.
+    struct LinkRange {
+      const uint32_t *begin;
+      const uint32_t *end;
+    };
+
+    /// Returns whether @a data starts with a header of this layout, of any
+    /// version.
+    static bool HasHeader(const uint8_t *data, size_t size);
+
+    /// Writes @a dense_topology in this layout. Returns false if the stream
+    /// could not be written.
+    static bool Write(const std::vector<SimpleWaypointPtr> &dense_topology, std::ostream &out);
+
+    /// Creates a view over @a data. The buffer must outlive the view. Use
+    /// IsValid() to check the buffer holds a supported version of the layout.
+    InMemoryMapCache(const uint8_t *data, size_t size);
+
+    bool IsValid() const {
+      return _records != nullptr;
+    }
+
+    uint32_t GetNumberOfWaypoints() const {
+      return _number_of_waypoints;
+    }
+
+    const WaypointRecord &GetWaypoint(uint32_t index) const {
+      return _records[index];
+    }
+
+    LinkRange GetNextWaypoints(uint32_t index) const {
+      return {_next_indices + _next_offsets[index], _next_indices + _next_offsets[index + 1u]};
+    }
+
+    LinkRange GetPreviousWaypoints(uint32_t index) const {
+      return {_previous_indices + _previous_offsets[index], _previous_indices + _previous_offsets[index + 1u]};
+    }
+
+  private:
+
+    uint32_t _number_of_waypoints = 0u;
+
+    const WaypointRecord *_records = nullptr;
+
+    const uint32_t *_next_offsets = nullptr;
+
+    const uint32_t *_next_indices = nullptr;
+
+    const uint32_t *_previous_offsets = nullptr;
+
+    const uint32_t *_previous_indices = nullptr;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
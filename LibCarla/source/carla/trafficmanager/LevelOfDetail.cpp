@@ -0,0 +1,84 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/LevelOfDetail.h"
+
+#include "carla/geom/Math.h"
+#include "carla/trafficmanager/SimulationState.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace carla {
+namespace traffic_manager {
+
+  void LevelOfDetail::Update(
+      const LODTierList &tiers,
+      const std::vector<ActorId> &vehicle_id_list,
+      const SimulationState &simulation_state,
+      const std::vector<cg::Location> &hero_locations) {
+    ++_cycle;
+    const unsigned long number_of_vehicles = vehicle_id_list.size();
+    _vehicle_tiers.assign(number_of_vehicles, 0u);
+    _scheduled.assign(number_of_vehicles, 1u);
+    std::vector<uint64_t> tier_counts(tiers.size() + 1u, 0u);
+    _current_tiers.clear();
+    _current_tiers.reserve(number_of_vehicles);
+
+    std::vector<float> radii_square;
+    radii_square.reserve(tiers.size());
+    for (const LODTier &tier : tiers) {
+      radii_square.push_back(tier.radius * tier.radius);
+    }
+
+    for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+      const ActorId actor_id = vehicle_id_list[index];
+      uint64_t tier = 0u;
+      if (!hero_locations.empty() && simulation_state.ContainsActor(actor_id)) {
+        const cg::Location location = simulation_state.GetLocation(actor_id);
+        float hero_distance_square = std::numeric_limits<float>::max();
+        for (const cg::Location &hero_location : hero_locations) {
+          hero_distance_square = std::min(hero_distance_square, cg::Math::DistanceSquared(location, hero_location));
+        }
+        while (tier < radii_square.size() && hero_distance_square >= radii_square[tier]) {
+          ++tier;
+        }
+      }
+      _vehicle_tiers[index] = tier;
+      _current_tiers.emplace(actor_id, tier);
+      const auto previous_tier = _previous_tiers.find(actor_id);
+      const bool new_to_tier = previous_tier == _previous_tiers.end() || previous_tier->second != tier;
+      if (tier > 0u && !new_to_tier) {
+        // Vehicles are spread over the cycles by their id, so every cycle
+        // updates a similar share of each tier.
+        const uint64_t update_interval = std::max<uint64_t>(tiers[tier - 1u].update_interval, 1u);
+        _scheduled[index] = ((_cycle + actor_id) % update_interval) == 0u ? 1u : 0u;
+      }
+      ++tier_counts[tier];
+    }
+    _previous_tiers.swap(_current_tiers);
+
+    std::lock_guard<std::mutex> lock(_counts_mutex);
+    _tier_counts.swap(tier_counts);
+  }
+
+  std::vector<uint64_t> LevelOfDetail::GetTierCounts() const {
+    std::lock_guard<std::mutex> lock(_counts_mutex);
+    return _tier_counts;
+  }
+
+  void LevelOfDetail::Reset() {
+    _cycle = 0u;
+    _vehicle_tiers.clear();
+    _scheduled.clear();
+    _previous_tiers.clear();
+    _current_tiers.clear();
+    std::lock_guard<std::mutex> lock(_counts_mutex);
+    _tier_counts.clear();
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,89 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+
+  using ActorId = carla::ActorId;
+
+  class SimulationState;
+
+  /// Vehicles farther than @a radius from every hero vehicle are updated
+  /// once every @a update_interval cycles.
+  struct LODTier {
+    float radius;
+    uint64_t update_interval;
+  };
+
+  using LODTierList = std::vector<LODTier>;
+
+  /// Schedules the updates of the registered vehicles by their distance to
+  /// the hero vehicles.
+  ///
+  /// Tier 0 holds the vehicles closer than the first radius to any hero, and
+  /// they are updated every cycle. Tier i holds the vehicles past the i-th
+  /// radius, updated once every update_interval cycles of that radius. In
+  /// the cycles in between their last commands are extrapolated. Vehicles
+  /// new to a tier are updated in their first cycle there. Without tiers or
+  /// hero vehicles every vehicle is in tier 0.
+  class LevelOfDetail {
+  public:
+
+    /// Assigns a tier to every vehicle of @a vehicle_id_list for the current
+    /// cycle. @a tiers must be sorted by radius.
+    void Update(const LODTierList &tiers,
+                const std::vector<ActorId> &vehicle_id_list,
+                const SimulationState &simulation_state,
+                const std::vector<cg::Location> &hero_locations);
+
+    uint64_t GetTier(const unsigned long index) const {
+      return _vehicle_tiers[index];
+    }
+
+    /// Whether the vehicle is updated in the current cycle.
+    bool IsScheduled(const unsigned long index) const {
+      return _scheduled[index] != 0u;
+    }
+
+    /// Number of vehicles in every tier in the last cycle, starting by tier 0.
+    std::vector<uint64_t> GetTierCounts() const;
+
+    void Reset();
+
+  private:
+
+    uint64_t _cycle {0u};
+
+    std::vector<uint64_t> _vehicle_tiers;
+
+    std::vector<uint8_t> _scheduled;
+
+    /// Tier of every vehicle in the previous cycle.
+    std::unordered_map<ActorId, uint64_t> _previous_tiers;
+
+    std::unordered_map<ActorId, uint64_t> _current_tiers;
+
+    /// Guards the tier counts, read from the threads setting up the traffic
+    /// manager.
+    mutable std::mutex _counts_mutex;
+
+    std::vector<uint64_t> _tier_counts;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -13,6 +13,8 @@ using namespace constants::SpeedThreshold;
 using namespace constants::Collision;
 using namespace constants::MotionPlan;
 
+static constexpr WaypointIndex NO_WAYPOINT = WaypointGraph::NO_WAYPOINT;
+
 LocalizationStage::LocalizationStage(
   const std::vector<ActorId> &vehicle_id_list,
   BufferMap &buffer_map,
@@ -48,15 +50,15 @@ void LocalizationStage::Update(const unsigned long index) {
   }
   const float horizon_square = SQUARE(horizon_length);
 
+  const WaypointGraph &graph = local_map->GetWaypointGraph();
   if (buffer_map.find(actor_id) == buffer_map.end()) {
-    buffer_map.insert({actor_id, Buffer()});
+    buffer_map.insert({actor_id, Buffer(graph)});
   }
   Buffer &waypoint_buffer = buffer_map.at(actor_id);
 
   // Clear buffer if vehicle is too far from the first waypoint in the buffer.
   if (!waypoint_buffer.empty() &&
-      cg::Math::DistanceSquared(waypoint_buffer.front()->GetLocation(),
-                                vehicle_location) > SQUARE(MAX_START_DISTANCE)) {
+      graph.DistanceSquared(waypoint_buffer.front(), vehicle_location) > SQUARE(MAX_START_DISTANCE)) {
 
     auto number_of_pops = waypoint_buffer.size();
     for (uint64_t j = 0u; j < number_of_pops; ++j) {
@@ -67,24 +69,24 @@ void LocalizationStage::Update(const unsigned long index) {
   bool is_at_junction_entrance = false;
   if (!waypoint_buffer.empty()) {
     // Purge passed waypoints.
-    float dot_product = DeviationDotProduct(vehicle_location, heading_vector, waypoint_buffer.front()->GetLocation());
+    float dot_product = DeviationDotProduct(vehicle_location, heading_vector, graph.GetLocation(waypoint_buffer.front()));
     while (dot_product <= 0.0f && !waypoint_buffer.empty()) {
       PopWaypoint(actor_id, track_traffic, waypoint_buffer);
       if (!waypoint_buffer.empty()) {
-        dot_product = DeviationDotProduct(vehicle_location, heading_vector, waypoint_buffer.front()->GetLocation());
+        dot_product = DeviationDotProduct(vehicle_location, heading_vector, graph.GetLocation(waypoint_buffer.front()));
       }
     }
 
     if (!waypoint_buffer.empty()) {
       // Determine if the vehicle is at the entrance of a junction.
-      SimpleWaypointPtr look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
-      SimpleWaypointPtr front_waypoint = waypoint_buffer.front();
-      bool front_waypoint_junction = front_waypoint->CheckJunction();
-      is_at_junction_entrance = !front_waypoint_junction && look_ahead_point->CheckJunction();
+      WaypointIndex look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
+      WaypointIndex front_waypoint = waypoint_buffer.front();
+      bool front_waypoint_junction = graph.IsJunction(front_waypoint);
+      is_at_junction_entrance = !front_waypoint_junction && graph.IsJunction(look_ahead_point);
       if (!is_at_junction_entrance) {
-        std::vector<SimpleWaypointPtr> last_passed_waypoints = front_waypoint->GetPreviousWaypoint();
+        const auto last_passed_waypoints = graph.GetPreviousWaypoints(front_waypoint);
         if (last_passed_waypoints.size() == 1) {
-          is_at_junction_entrance = !last_passed_waypoints.front()->CheckJunction() && front_waypoint_junction;
+          is_at_junction_entrance = !graph.IsJunction(last_passed_waypoints.front()) && front_waypoint_junction;
         }
       }
       if (is_at_junction_entrance
@@ -98,15 +100,15 @@ void LocalizationStage::Update(const unsigned long index) {
     // Purge waypoints too far from the front of the buffer, but not if it has reached a junction.
     while (!is_at_junction_entrance
            && !waypoint_buffer.empty()
-           && waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) > horizon_square + horizon_square
-           && !waypoint_buffer.back()->CheckJunction()) {
+           && graph.DistanceSquared(waypoint_buffer.back(), waypoint_buffer.front()) > horizon_square + horizon_square
+           && !graph.IsJunction(waypoint_buffer.back())) {
       PopWaypoint(actor_id, track_traffic, waypoint_buffer, false);
     }
   }
 
   // Initializing buffer if it is empty.
   if (waypoint_buffer.empty()) {
-    SimpleWaypointPtr closest_waypoint = local_map->GetWaypoint(vehicle_location);
+    const WaypointIndex closest_waypoint = local_map->GetWaypointIndex(vehicle_location);
     PushWaypoint(actor_id, track_traffic, waypoint_buffer, closest_waypoint);
   }
 
@@ -117,9 +119,10 @@ void LocalizationStage::Update(const unsigned long index) {
 
   // Apply parameters for keep right rule and random lane changes.
   if (!force_lane_change && vehicle_speed > MIN_LANE_CHANGE_SPEED){
-    const float perc_keep_right = parameters.GetKeepRightPercentage(actor_id);
-    const float perc_random_leftlanechange = parameters.GetRandomLeftLaneChangePercentage(actor_id);
-    const float perc_random_rightlanechange = parameters.GetRandomRightLaneChangePercentage(actor_id);
+    const VehicleParameters &vehicle_parameters = parameters.GetSnapshot()[index];
+    const float perc_keep_right = vehicle_parameters.perc_keep_right;
+    const float perc_random_leftlanechange = vehicle_parameters.perc_random_left;
+    const float perc_random_rightlanechange = vehicle_parameters.perc_random_right;
     const bool is_keep_right = perc_keep_right > random_devices.at(actor_id).next();
     const bool is_random_left_change = perc_random_leftlanechange >= random_devices.at(actor_id).next();
     const bool is_random_right_change = perc_random_rightlanechange >= random_devices.at(actor_id).next();
@@ -140,26 +143,26 @@ void LocalizationStage::Update(const unsigned long index) {
     }
   }
 
-  const SimpleWaypointPtr front_waypoint = waypoint_buffer.front();
+  const WaypointIndex front_waypoint = waypoint_buffer.front();
   const float lane_change_distance = SQUARE(std::max(10.0f * vehicle_speed, INTER_LANE_CHANGE_DISTANCE));
 
   bool recently_not_executed_lane_change = last_lane_change_swpt.find(actor_id) == last_lane_change_swpt.end();
   bool done_with_previous_lane_change = true;
   if (!recently_not_executed_lane_change) {
-    float distance_frm_previous = cg::Math::DistanceSquared(last_lane_change_swpt.at(actor_id)->GetLocation(), vehicle_location);
+    float distance_frm_previous = graph.DistanceSquared(last_lane_change_swpt.at(actor_id), vehicle_location);
     done_with_previous_lane_change = distance_frm_previous > lane_change_distance;
   }
-  bool auto_or_force_lane_change = parameters.GetAutoLaneChange(actor_id) || force_lane_change;
-  bool front_waypoint_not_junction = !front_waypoint->CheckJunction();
+  bool auto_or_force_lane_change = parameters.GetSnapshot()[index].auto_lane_change || force_lane_change;
+  bool front_waypoint_not_junction = !graph.IsJunction(front_waypoint);
 
   if (auto_or_force_lane_change
       && front_waypoint_not_junction
       && (recently_not_executed_lane_change || done_with_previous_lane_change)) {
 
-    SimpleWaypointPtr change_over_point = AssignLaneChange(actor_id, vehicle_location, vehicle_speed,
-                                                           force_lane_change, lane_change_direction);
+    WaypointIndex change_over_point = AssignLaneChange(actor_id, vehicle_location, vehicle_speed,
+                                                       force_lane_change, lane_change_direction);
 
-    if (change_over_point != nullptr) {
+    if (change_over_point != NO_WAYPOINT) {
       if (last_lane_change_swpt.find(actor_id) != last_lane_change_swpt.end()) {
         last_lane_change_swpt.at(actor_id) = change_over_point;
       } else {
@@ -188,9 +191,9 @@ void LocalizationStage::Update(const unsigned long index) {
 
   // Populating the buffer through randomly chosen waypoints.
   else {
-    while (waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
-      SimpleWaypointPtr furthest_waypoint = waypoint_buffer.back();
-      std::vector<SimpleWaypointPtr> next_waypoints = furthest_waypoint->GetNextWaypoint();
+    while (graph.DistanceSquared(waypoint_buffer.back(), waypoint_buffer.front()) <= horizon_square) {
+      WaypointIndex furthest_waypoint = waypoint_buffer.back();
+      const auto next_waypoints = graph.GetNextWaypoints(furthest_waypoint);
       uint64_t selection_index = 0u;
       // Pseudo-randomized path selection if found more than one choice.
       if (next_waypoints.size() > 1) {
@@ -203,7 +206,7 @@ void LocalizationStage::Update(const unsigned long index) {
         marked_for_removal.push_back(actor_id);
         break;
       }
-      SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
+      WaypointIndex next_wp_selection = next_waypoints[selection_index];
       PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
     }
   }
@@ -218,8 +221,8 @@ void LocalizationStage::Update(const unsigned long index) {
     output.junction_end_point = safe_space_end_points.first;
     output.safe_point = safe_space_end_points.second;
   } else {
-    output.junction_end_point = nullptr;
-    output.safe_point = nullptr;
+    output.junction_end_point = NO_WAYPOINT;
+    output.safe_point = NO_WAYPOINT;
   }
 
   // Updating geodesic grid position for actor.
@@ -230,8 +233,9 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
                                                const bool is_at_junction_entrance,
                                                Buffer &waypoint_buffer) {
 
-  SimpleWaypointPtr junction_end_point = nullptr;
-  SimpleWaypointPtr safe_point_after_junction = nullptr;
+  const WaypointGraph &graph = waypoint_buffer.GetGraph();
+  WaypointIndex junction_end_point = NO_WAYPOINT;
+  WaypointIndex safe_point_after_junction = NO_WAYPOINT;
 
   if (is_at_junction_entrance
       && vehicles_at_junction_entrance.find(actor_id) == vehicles_at_junction_entrance.end()) {
@@ -239,22 +243,22 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
     bool entered_junction = false;
     bool past_junction = false;
     bool safe_point_found = false;
-    SimpleWaypointPtr current_waypoint = nullptr;
-    SimpleWaypointPtr junction_begin_point = nullptr;
+    WaypointIndex current_waypoint = NO_WAYPOINT;
+    WaypointIndex junction_begin_point = NO_WAYPOINT;
     float safe_distance_squared = SQUARE(SAFE_DISTANCE_AFTER_JUNCTION);
 
     // Scanning existing buffer points.
     for (unsigned long i = 0u; i < waypoint_buffer.size() && !safe_point_found; ++i) {
       current_waypoint = waypoint_buffer.at(i);
-      if (!entered_junction && current_waypoint->CheckJunction()) {
+      if (!entered_junction && graph.IsJunction(current_waypoint)) {
         entered_junction = true;
         junction_begin_point = current_waypoint;
       }
-      if (entered_junction && !past_junction && !current_waypoint->CheckJunction()) {
+      if (entered_junction && !past_junction && !graph.IsJunction(current_waypoint)) {
         past_junction = true;
         junction_end_point = current_waypoint;
       }
-      if (past_junction && junction_end_point->DistanceSquared(current_waypoint) > safe_distance_squared) {
+      if (past_junction && graph.DistanceSquared(junction_end_point, current_waypoint) > safe_distance_squared) {
         safe_point_found = true;
         safe_point_after_junction = current_waypoint;
       }
@@ -265,11 +269,11 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
       bool abort = false;
 
       while (!past_junction && !abort) {
-        NodeList next_waypoints = current_waypoint->GetNextWaypoint();
+        const auto next_waypoints = graph.GetNextWaypoints(current_waypoint);
         if (!next_waypoints.empty()) {
           current_waypoint = next_waypoints.front();
           PushWaypoint(actor_id, track_traffic, waypoint_buffer, current_waypoint);
-          if (!current_waypoint->CheckJunction()) {
+          if (!graph.IsJunction(current_waypoint)) {
             past_junction = true;
             junction_end_point = current_waypoint;
           }
@@ -279,10 +283,10 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
       }
 
       while (!safe_point_found && !abort) {
-        std::vector<SimpleWaypointPtr> next_waypoints = current_waypoint->GetNextWaypoint();
-        if ((junction_end_point->DistanceSquared(current_waypoint) > safe_distance_squared)
+        const auto next_waypoints = graph.GetNextWaypoints(current_waypoint);
+        if ((graph.DistanceSquared(junction_end_point, current_waypoint) > safe_distance_squared)
             || next_waypoints.size() > 1
-            || current_waypoint->CheckJunction()) {
+            || graph.IsJunction(current_waypoint)) {
 
           safe_point_found = true;
           safe_point_after_junction = current_waypoint;
@@ -297,12 +301,12 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
       }
     }
 
-    if (junction_end_point != nullptr &&
-        safe_point_after_junction != nullptr &&
-        junction_begin_point->DistanceSquared(junction_end_point) < SQUARE(MIN_JUNCTION_LENGTH)) {
+    if (junction_end_point != NO_WAYPOINT &&
+        safe_point_after_junction != NO_WAYPOINT &&
+        graph.DistanceSquared(junction_begin_point, junction_end_point) < SQUARE(MIN_JUNCTION_LENGTH)) {
 
-      junction_end_point = nullptr;
-      safe_point_after_junction = nullptr;
+      junction_end_point = NO_WAYPOINT;
+      safe_point_after_junction = NO_WAYPOINT;
     }
 
     vehicles_at_junction_entrance.insert({actor_id, {junction_end_point, safe_point_after_junction}});
@@ -324,27 +328,29 @@ void LocalizationStage::Reset() {
   vehicles_at_junction.clear();
 }
 
-SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
-                                                      const cg::Location vehicle_location,
-                                                      const float vehicle_speed,
-                                                      bool force, bool direction) {
+WaypointIndex LocalizationStage::AssignLaneChange(const ActorId actor_id,
+                                                  const cg::Location vehicle_location,
+                                                  const float vehicle_speed,
+                                                  bool force, bool direction) {
 
   // Waypoint representing the new starting point for the waypoint buffer
-  // due to lane change. Remains nullptr if lane change not viable.
-  SimpleWaypointPtr change_over_point = nullptr;
+  // due to lane change. Remains NO_WAYPOINT if lane change not viable.
+  WaypointIndex change_over_point = NO_WAYPOINT;
 
   // Retrieve waypoint buffer for current vehicle.
   const Buffer &waypoint_buffer = buffer_map.at(actor_id);
+  const WaypointGraph &graph = waypoint_buffer.GetGraph();
 
   // Check buffer is not empty.
   if (!waypoint_buffer.empty()) {
     // Get the left and right waypoints for the current closest waypoint.
-    const SimpleWaypointPtr &current_waypoint = waypoint_buffer.front();
-    const SimpleWaypointPtr left_waypoint = current_waypoint->GetLeftWaypoint();
-    const SimpleWaypointPtr right_waypoint = current_waypoint->GetRightWaypoint();
+    const WaypointIndex current_waypoint = waypoint_buffer.front();
+    const WaypointIndex left_waypoint = graph.GetLeftWaypoint(current_waypoint);
+    const WaypointIndex right_waypoint = graph.GetRightWaypoint(current_waypoint);
 
     // Retrieve vehicles with overlapping waypoint buffers with current vehicle.
-    const auto blocking_vehicles = track_traffic.GetOverlappingVehicles(actor_id);
+    track_traffic.GetOverlappingVehicles(actor_id, overlapping_vehicles);
+    const std::vector<ActorId> &blocking_vehicles = overlapping_vehicles;
 
     // Find immediate in-lane obstacle and check if any are too close to initiate lane change.
     bool obstacle_too_close = false;
@@ -357,20 +363,20 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
       // Find vehicle in buffer map and check if it's buffer is not empty.
       if (buffer_map.find(other_actor_id) != buffer_map.end() && !buffer_map.at(other_actor_id).empty()) {
         const Buffer &other_buffer = buffer_map.at(other_actor_id);
-        const SimpleWaypointPtr &other_current_waypoint = other_buffer.front();
-        const cg::Location other_location = other_current_waypoint->GetLocation();
+        const WaypointIndex other_current_waypoint = other_buffer.front();
+        const cg::Location other_location = graph.GetLocation(other_current_waypoint);
 
-        const cg::Vector3D reference_heading = current_waypoint->GetForwardVector();
-        cg::Vector3D reference_to_other = other_location - current_waypoint->GetLocation();
-        const cg::Vector3D other_heading = other_current_waypoint->GetForwardVector();
+        const cg::Vector3D reference_heading = graph.GetForwardVector(current_waypoint);
+        cg::Vector3D reference_to_other = other_location - graph.GetLocation(current_waypoint);
+        const cg::Vector3D other_heading = graph.GetForwardVector(other_current_waypoint);
 
-        WaypointPtr current_raw_waypoint = current_waypoint->GetWaypoint();
-        WaypointPtr other_current_raw_waypoint = other_current_waypoint->GetWaypoint();
+        const WaypointPtr &current_raw_waypoint = graph.GetSimpleWaypoint(current_waypoint)->GetWaypoint();
+        const WaypointPtr &other_current_raw_waypoint = graph.GetSimpleWaypoint(other_current_waypoint)->GetWaypoint();
         // Check both vehicles are not in junction,
         // Check if the other vehicle is in front of the current vehicle,
         // Check if the two vehicles have acceptable angular deviation between their headings.
-        if (!current_waypoint->CheckJunction()
-            && !other_current_waypoint->CheckJunction()
+        if (!graph.IsJunction(current_waypoint)
+            && !graph.IsJunction(other_current_waypoint)
             && other_current_raw_waypoint->GetRoadId() == current_raw_waypoint->GetRoadId()
             && other_current_raw_waypoint->GetLaneId() == current_raw_waypoint->GetLaneId()
             && cg::Math::Dot(reference_heading, reference_to_other) > 0.0f
@@ -393,9 +399,9 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
     // If a valid immediate obstacle found.
     if (!obstacle_too_close && obstacle_actor_id != 0u && !force) {
       const Buffer &other_buffer = buffer_map.at(obstacle_actor_id);
-      const SimpleWaypointPtr &other_current_waypoint = other_buffer.front();
-      const auto other_neighbouring_lanes = {other_current_waypoint->GetLeftWaypoint(),
-                                             other_current_waypoint->GetRightWaypoint()};
+      const WaypointIndex other_current_waypoint = other_buffer.front();
+      const auto other_neighbouring_lanes = {graph.GetLeftWaypoint(other_current_waypoint),
+                                             graph.GetRightWaypoint(other_current_waypoint)};
 
       // Flags reflecting whether adjacent lanes are free near the obstacle.
       bool distant_left_lane_free = false;
@@ -404,8 +410,8 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
       // Check if the neighbouring lanes near the obstructing vehicle are free of other vehicles.
       bool left_right = true;
       for (auto &candidate_lane_wp : other_neighbouring_lanes) {
-        if (candidate_lane_wp != nullptr &&
-            track_traffic.GetPassingVehicles(candidate_lane_wp->GetId()).size() == 0) {
+        if (candidate_lane_wp != NO_WAYPOINT &&
+            track_traffic.GetPassingVehicles(candidate_lane_wp).size() == 0) {
 
           if (left_right)
             distant_left_lane_free = true;
@@ -417,27 +423,27 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
 
       // Based on what lanes are free near the obstacle,
       // find the change over point with no vehicles passing through them.
-      if (distant_right_lane_free && right_waypoint != nullptr
-          && track_traffic.GetPassingVehicles(right_waypoint->GetId()).size() == 0) {
+      if (distant_right_lane_free && right_waypoint != NO_WAYPOINT
+          && track_traffic.GetPassingVehicles(right_waypoint).size() == 0) {
         change_over_point = right_waypoint;
-      } else if (distant_left_lane_free && left_waypoint != nullptr
-               && track_traffic.GetPassingVehicles(left_waypoint->GetId()).size() == 0) {
+      } else if (distant_left_lane_free && left_waypoint != NO_WAYPOINT
+               && track_traffic.GetPassingVehicles(left_waypoint).size() == 0) {
         change_over_point = left_waypoint;
       }
     } else if (force) {
-      if (direction && right_waypoint != nullptr) {
+      if (direction && right_waypoint != NO_WAYPOINT) {
         change_over_point = right_waypoint;
-      } else if (!direction && left_waypoint != nullptr) {
+      } else if (!direction && left_waypoint != NO_WAYPOINT) {
         change_over_point = left_waypoint;
       }
     }
 
-    if (change_over_point != nullptr) {
+    if (change_over_point != NO_WAYPOINT) {
       const float change_over_distance = cg::Math::Clamp(1.5f * vehicle_speed, MIN_WPT_DISTANCE, MAX_WPT_DISTANCE);
-      const SimpleWaypointPtr starting_point = change_over_point;
-      while (change_over_point->DistanceSquared(starting_point) < SQUARE(change_over_distance) &&
-             !change_over_point->CheckJunction()) {
-        change_over_point = change_over_point->GetNextWaypoint().front();
+      const WaypointIndex starting_point = change_over_point;
+      while (graph.DistanceSquared(change_over_point, starting_point) < SQUARE(change_over_distance) &&
+             !graph.IsJunction(change_over_point)) {
+        change_over_point = graph.GetNextWaypoints(change_over_point).front();
       }
     }
   }
@@ -456,40 +462,42 @@ void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer,
       parameters.RemoveUploadPath(actor_id, false);
     }
 
+    const WaypointGraph &graph = waypoint_buffer.GetGraph();
+
     // Get the latest imported waypoint. and find its closest waypoint in TM's InMemoryMap.
     cg::Location latest_imported = imported_path.front();
-    SimpleWaypointPtr imported = local_map->GetWaypoint(latest_imported);
+    WaypointIndex imported = local_map->GetWaypointIndex(latest_imported);
 
     // We need to generate a path compatible with TM's waypoints.
-    while (!imported_path.empty() && waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
+    while (!imported_path.empty() && graph.DistanceSquared(waypoint_buffer.back(), waypoint_buffer.front()) <= horizon_square) {
       // Get the latest point we added to the list. If starting, this will be the one referred to the vehicle's location.
-      SimpleWaypointPtr latest_waypoint = waypoint_buffer.back();
+      WaypointIndex latest_waypoint = waypoint_buffer.back();
 
       // Try to link the latest_waypoint to the imported waypoint.
-      std::vector<SimpleWaypointPtr> next_waypoints = latest_waypoint->GetNextWaypoint();
+      const auto next_waypoints = graph.GetNextWaypoints(latest_waypoint);
       uint64_t selection_index = 0u;
 
       // Choose correct path.
       if (next_waypoints.size() > 1) {
-        const float imported_road_id = imported->GetWaypoint()->GetRoadId();
+        const float imported_road_id = graph.GetSimpleWaypoint(imported)->GetWaypoint()->GetRoadId();
         float min_distance = std::numeric_limits<float>::infinity();
         for (uint64_t k = 0u; k < next_waypoints.size(); ++k) {
-          SimpleWaypointPtr junction_end_point = next_waypoints.at(k);
-          while (!junction_end_point->CheckJunction()) {
-            junction_end_point = junction_end_point->GetNextWaypoint().front();
+          WaypointIndex junction_end_point = next_waypoints[k];
+          while (!graph.IsJunction(junction_end_point)) {
+            junction_end_point = graph.GetNextWaypoints(junction_end_point).front();
           }
-          while (junction_end_point->CheckJunction()) {
-            junction_end_point = junction_end_point->GetNextWaypoint().front();
+          while (graph.IsJunction(junction_end_point)) {
+            junction_end_point = graph.GetNextWaypoints(junction_end_point).front();
           }
-          while (next_waypoints.at(k)->DistanceSquared(junction_end_point) < 50.0f) {
-            junction_end_point = junction_end_point->GetNextWaypoint().front();
+          while (graph.DistanceSquared(next_waypoints[k], junction_end_point) < 50.0f) {
+            junction_end_point = graph.GetNextWaypoints(junction_end_point).front();
           }
-          float jep_road_id = junction_end_point->GetWaypoint()->GetRoadId();
+          float jep_road_id = graph.GetSimpleWaypoint(junction_end_point)->GetWaypoint()->GetRoadId();
           if (jep_road_id == imported_road_id) {
             selection_index = k;
             break;
           }
-          float distance = junction_end_point->DistanceSquared(imported);
+          float distance = graph.DistanceSquared(junction_end_point, imported);
           if (distance < min_distance) {
             min_distance = distance;
             selection_index = k;
@@ -502,15 +510,15 @@ void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer,
         marked_for_removal.push_back(actor_id);
         break;
       }
-      SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
+      WaypointIndex next_wp_selection = next_waypoints[selection_index];
       PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
 
       // Remove the imported waypoint from the path if it's close to the last one.
-      if (next_wp_selection->DistanceSquared(imported) < 30.0f) {
+      if (graph.DistanceSquared(next_wp_selection, imported) < 30.0f) {
         imported_path.erase(imported_path.begin());
         PushWaypoint(actor_id, track_traffic, waypoint_buffer, imported);
         latest_imported = imported_path.front();
-        imported = local_map->GetWaypoint(latest_imported);
+        imported = local_map->GetWaypointIndex(latest_imported);
       }
     }
     if (imported_path.empty()) {
@@ -533,17 +541,18 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
       parameters.RemoveImportedRoute(actor_id, false);
     }
 
+    const WaypointGraph &graph = waypoint_buffer.GetGraph();
     RoadOption next_road_option = static_cast<RoadOption>(imported_actions.front());
-    while (!imported_actions.empty() && waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
+    while (!imported_actions.empty() && graph.DistanceSquared(waypoint_buffer.back(), waypoint_buffer.front()) <= horizon_square) {
       // Get the latest point we added to the list. If starting, this will be the one referred to the vehicle's location.
-      SimpleWaypointPtr latest_waypoint = waypoint_buffer.back();
-      RoadOption latest_road_option = latest_waypoint->GetRoadOption();
+      WaypointIndex latest_waypoint = waypoint_buffer.back();
+      RoadOption latest_road_option = graph.GetRoadOption(latest_waypoint);
       // Try to link the latest_waypoint to the correct next RouteOption.
-      std::vector<SimpleWaypointPtr> next_waypoints = latest_waypoint->GetNextWaypoint();
+      const auto next_waypoints = graph.GetNextWaypoints(latest_waypoint);
       uint16_t selection_index = 0u;
       if (next_waypoints.size() > 1) {
         for (uint16_t i=0; i<next_waypoints.size(); ++i) {
-          if (next_waypoints.at(i)->GetRoadOption() == next_road_option) {
+          if (graph.GetRoadOption(next_waypoints[i]) == next_road_option) {
             selection_index = i;
             break;
           } else {
@@ -560,11 +569,11 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
         break;
       }
 
-      SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
+      WaypointIndex next_wp_selection = next_waypoints[selection_index];
       PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
 
       // If we are switching to a new RoadOption, it means the current one is already fully imported.
-      if (latest_road_option != next_wp_selection->GetRoadOption() && next_road_option == next_wp_selection->GetRoadOption()) {
+      if (latest_road_option != graph.GetRoadOption(next_wp_selection) && next_road_option == graph.GetRoadOption(next_wp_selection)) {
         imported_actions.erase(imported_actions.begin());
         next_road_option = static_cast<RoadOption>(imported_actions.front());
       }
@@ -580,31 +589,33 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
 
 Action LocalizationStage::ComputeNextAction(const ActorId& actor_id) {
   auto waypoint_buffer = buffer_map.at(actor_id);
-  auto next_action = std::make_pair(RoadOption::LaneFollow, waypoint_buffer.back()->GetWaypoint());
+  const WaypointGraph &graph = waypoint_buffer.GetGraph();
+  auto next_action = std::make_pair(RoadOption::LaneFollow, graph.GetSimpleWaypoint(waypoint_buffer.back())->GetWaypoint());
   bool is_lane_change = false;
   if (last_lane_change_swpt.find(actor_id) != last_lane_change_swpt.end()) {
     // A lane change is happening.
     is_lane_change = true;
+    const WaypointIndex lane_change_swpt = last_lane_change_swpt.at(actor_id);
     const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
-    const cg::Vector3D relative_vector = simulation_state.GetLocation(actor_id) - last_lane_change_swpt.at(actor_id)->GetLocation();
+    const cg::Vector3D relative_vector = simulation_state.GetLocation(actor_id) - graph.GetLocation(lane_change_swpt);
     bool left_heading = (heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) > 0.0f;
-    if (left_heading) next_action = std::make_pair(RoadOption::ChangeLaneLeft, last_lane_change_swpt.at(actor_id)->GetWaypoint());
-    else next_action = std::make_pair(RoadOption::ChangeLaneRight, last_lane_change_swpt.at(actor_id)->GetWaypoint());
+    if (left_heading) next_action = std::make_pair(RoadOption::ChangeLaneLeft, graph.GetSimpleWaypoint(lane_change_swpt)->GetWaypoint());
+    else next_action = std::make_pair(RoadOption::ChangeLaneRight, graph.GetSimpleWaypoint(lane_change_swpt)->GetWaypoint());
   }
-  for (auto &swpt : waypoint_buffer) {
-    RoadOption road_opt = swpt->GetRoadOption();
+  for (const WaypointIndex swpt : waypoint_buffer) {
+    RoadOption road_opt = graph.GetRoadOption(swpt);
     if (road_opt != RoadOption::LaneFollow) {
       if (!is_lane_change) {
         // No lane change in sight, we can assume this will be the next action.
-        return std::make_pair(road_opt, swpt->GetWaypoint());
+        return std::make_pair(road_opt, graph.GetSimpleWaypoint(swpt)->GetWaypoint());
       } else {
         // A lane change will happen as well as another action, we need to figure out which one will happen first.
-        cg::Location lane_change = last_lane_change_swpt.at(actor_id)->GetLocation();
+        cg::Location lane_change = graph.GetLocation(last_lane_change_swpt.at(actor_id));
         cg::Location actual_location = simulation_state.GetLocation(actor_id);
         auto distance_lane_change = cg::Math::DistanceSquared(actual_location, lane_change);
-        auto distance_other_action = cg::Math::DistanceSquared(actual_location, swpt->GetLocation());
+        auto distance_other_action = cg::Math::DistanceSquared(actual_location, graph.GetLocation(swpt));
         if (distance_lane_change < distance_other_action) return next_action;
-        else return std::make_pair(road_opt, swpt->GetWaypoint());
+        else return std::make_pair(road_opt, graph.GetSimpleWaypoint(swpt)->GetWaypoint());
       }
     }
   }
@@ -614,33 +625,35 @@ Action LocalizationStage::ComputeNextAction(const ActorId& actor_id) {
 ActionBuffer LocalizationStage::ComputeActionBuffer(const ActorId& actor_id) {
 
   auto waypoint_buffer = buffer_map.at(actor_id);
+  const WaypointGraph &graph = waypoint_buffer.GetGraph();
   ActionBuffer action_buffer;
   Action lane_change;
   bool is_lane_change = false;
-  SimpleWaypointPtr buffer_front = waypoint_buffer.front();
-  RoadOption last_road_opt = buffer_front->GetRoadOption();
-  action_buffer.push_back(std::make_pair(last_road_opt, buffer_front->GetWaypoint()));
+  WaypointIndex buffer_front = waypoint_buffer.front();
+  RoadOption last_road_opt = graph.GetRoadOption(buffer_front);
+  action_buffer.push_back(std::make_pair(last_road_opt, graph.GetSimpleWaypoint(buffer_front)->GetWaypoint()));
   if (last_lane_change_swpt.find(actor_id) != last_lane_change_swpt.end()) {
     // A lane change is happening.
     is_lane_change = true;
+    const WaypointIndex lane_change_swpt = last_lane_change_swpt.at(actor_id);
     const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
-    const cg::Vector3D relative_vector = simulation_state.GetLocation(actor_id) - last_lane_change_swpt.at(actor_id)->GetLocation();
+    const cg::Vector3D relative_vector = simulation_state.GetLocation(actor_id) - graph.GetLocation(lane_change_swpt);
     bool left_heading = (heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) > 0.0f;
-    if (left_heading) lane_change = std::make_pair(RoadOption::ChangeLaneLeft, last_lane_change_swpt.at(actor_id)->GetWaypoint());
-    else lane_change = std::make_pair(RoadOption::ChangeLaneRight, last_lane_change_swpt.at(actor_id)->GetWaypoint());
+    if (left_heading) lane_change = std::make_pair(RoadOption::ChangeLaneLeft, graph.GetSimpleWaypoint(lane_change_swpt)->GetWaypoint());
+    else lane_change = std::make_pair(RoadOption::ChangeLaneRight, graph.GetSimpleWaypoint(lane_change_swpt)->GetWaypoint());
   }
-  for (auto &wpt : waypoint_buffer) {
-    RoadOption current_road_opt = wpt->GetRoadOption();
+  for (const WaypointIndex wpt : waypoint_buffer) {
+    RoadOption current_road_opt = graph.GetRoadOption(wpt);
     if (current_road_opt != last_road_opt) {
-      action_buffer.push_back(std::make_pair(current_road_opt, wpt->GetWaypoint()));
+      action_buffer.push_back(std::make_pair(current_road_opt, graph.GetSimpleWaypoint(wpt)->GetWaypoint()));
       last_road_opt = current_road_opt;
     }
   }
   if (is_lane_change) {
     // Insert the lane change action in the appropriate part of the action buffer.
-    auto distance_lane_change = cg::Math::DistanceSquared(waypoint_buffer.front()->GetLocation(), lane_change.second->GetTransform().location);
+    auto distance_lane_change = cg::Math::DistanceSquared(graph.GetLocation(waypoint_buffer.front()), lane_change.second->GetTransform().location);
     for (uint16_t i = 0; i < action_buffer.size(); ++i) {
-      auto distance_action = cg::Math::DistanceSquared(waypoint_buffer.front()->GetLocation(), waypoint_buffer.at(i)->GetLocation());
+      auto distance_action = cg::Math::DistanceSquared(graph.GetLocation(waypoint_buffer.front()), graph.GetLocation(waypoint_buffer.at(i)));
       // If the waypoint related to the next action is further away from the one of the lane change, insert lane change action here.
       // If we reached the end of the buffer, place the action at the end.
       if (i == action_buffer.size()-1) {
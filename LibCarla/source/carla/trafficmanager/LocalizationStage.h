@@ -18,7 +18,7 @@ namespace traffic_manager {
 namespace cc = carla::client;
 
 using LocalMapPtr = std::shared_ptr<InMemoryMap>;
-using LaneChangeSWptMap = std::unordered_map<ActorId, SimpleWaypointPtr>;
+using LaneChangeSWptMap = std::unordered_map<ActorId, WaypointIndex>;
 using WaypointPtr = carla::SharedPtr<cc::Waypoint>;
 using Action = std::pair<RoadOption, WaypointPtr>;
 using ActionBuffer = std::vector<Action>;
@@ -42,14 +42,18 @@ private:
   LocalizationFrame &output_array;
   LaneChangeSWptMap last_lane_change_swpt;
   ActorIdSet vehicles_at_junction;
-  using SimpleWaypointPair = std::pair<SimpleWaypointPtr, SimpleWaypointPtr>;
+  using SimpleWaypointPair = std::pair<WaypointIndex, WaypointIndex>;
   std::unordered_map<ActorId, SimpleWaypointPair> vehicles_at_junction_entrance;
   RandomGeneratorMap &random_devices;
-
-  SimpleWaypointPtr AssignLaneChange(const ActorId actor_id,
-                                     const cg::Location vehicle_location,
-                                     const float vehicle_speed,
-                                     bool force, bool direction);
+  // Vehicles overlapping the path of the vehicle being updated.
+  std::vector<ActorId> overlapping_vehicles;
+
+  // Returns the waypoint the buffer should restart from to change lane,
+  // or WaypointGraph::NO_WAYPOINT if the lane change is not viable.
+  WaypointIndex AssignLaneChange(const ActorId actor_id,
+                                 const cg::Location vehicle_location,
+                                 const float vehicle_speed,
+                                 bool force, bool direction);
 
   void ExtendAndFindSafeSpace(const ActorId actor_id,
                               const bool is_at_junction_entrance,
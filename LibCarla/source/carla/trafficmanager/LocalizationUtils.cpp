@@ -36,30 +36,29 @@ float DeviationDotProduct(const cg::Location &reference_location,
 }
 
 void PushWaypoint(ActorId actor_id, TrackTraffic &track_traffic,
-                  Buffer &buffer, SimpleWaypointPtr &waypoint) {
+                  Buffer &buffer, WaypointIndex waypoint) {
 
-  const uint64_t waypoint_id = waypoint->GetId();
   buffer.push_back(waypoint);
-  track_traffic.UpdatePassingVehicle(waypoint_id, actor_id);
+  track_traffic.UpdatePassingVehicle(waypoint, actor_id);
 }
 
 void PopWaypoint(ActorId actor_id, TrackTraffic &track_traffic,
                  Buffer &buffer, bool front_or_back) {
 
-  SimpleWaypointPtr removed_waypoint = front_or_back ? buffer.front() : buffer.back();
-  const uint64_t removed_waypoint_id = removed_waypoint->GetId();
+  const WaypointIndex removed_waypoint = front_or_back ? buffer.front() : buffer.back();
   if (front_or_back) {
     buffer.pop_front();
   } else {
     buffer.pop_back();
   }
-  track_traffic.RemovePassingVehicle(removed_waypoint_id, actor_id);
+  track_traffic.RemovePassingVehicle(removed_waypoint, actor_id);
 }
 
 TargetWPInfo GetTargetWaypoint(const Buffer &waypoint_buffer, const float &target_point_distance) {
 
-  SimpleWaypointPtr target_waypoint = waypoint_buffer.front();
-  const SimpleWaypointPtr &buffer_front = waypoint_buffer.front();
+  const WaypointGraph &graph = waypoint_buffer.GetGraph();
+  WaypointIndex target_waypoint = waypoint_buffer.front();
+  const WaypointIndex buffer_front = waypoint_buffer.front();
   uint64_t startPosn = static_cast<uint64_t>(std::fabs(target_point_distance * INV_MAP_RESOLUTION));
   uint64_t index = startPosn;
   /// Condition to determine forward or backward scanning of waypoint buffer.
@@ -67,20 +66,20 @@ TargetWPInfo GetTargetWaypoint(const Buffer &waypoint_buffer, const float &targe
   if (startPosn < waypoint_buffer.size()) {
     bool mScanForward = false;
     const float target_point_dist_power = target_point_distance * target_point_distance;
-    if (buffer_front->DistanceSquared(target_waypoint) < target_point_dist_power) {
+    if (graph.DistanceSquared(buffer_front, target_waypoint) < target_point_dist_power) {
       mScanForward = true;
     }
 
     if (mScanForward) {
       for (uint64_t i = startPosn;
-           (i < waypoint_buffer.size()) && (buffer_front->DistanceSquared(target_waypoint) < target_point_dist_power);
+           (i < waypoint_buffer.size()) && (graph.DistanceSquared(buffer_front, target_waypoint) < target_point_dist_power);
            ++i) {
         target_waypoint = waypoint_buffer.at(i);
         index = i;
       }
     } else {
       for (uint64_t i = startPosn;
-           (buffer_front->DistanceSquared(target_waypoint) > target_point_dist_power);
+           (graph.DistanceSquared(buffer_front, target_waypoint) > target_point_dist_power);
            --i) {
         target_waypoint = waypoint_buffer.at(i);
         index = i;
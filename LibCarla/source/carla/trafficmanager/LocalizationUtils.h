@@ -17,6 +17,7 @@
 #include "carla/trafficmanager/Constants.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
 #include "carla/trafficmanager/TrackTraffic.h"
+#include "carla/trafficmanager/WaypointBuffer.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -27,7 +28,7 @@ namespace traffic_manager {
   using ActorId = carla::ActorId;
   using ActorIdSet = std::unordered_set<ActorId>;
   using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-  using Buffer = std::deque<SimpleWaypointPtr>;
+  using Buffer = WaypointBuffer;
   using GeoGridId = carla::road::JuncId;
   using constants::Map::MAP_RESOLUTION;
   using constants::Map::INV_MAP_RESOLUTION;
@@ -46,14 +47,15 @@ namespace traffic_manager {
 
   // Function to add a waypoint to a path buffer and update waypoint tracking.
   void PushWaypoint(ActorId actor_id, TrackTraffic& track_traffic,
-                    Buffer& buffer, SimpleWaypointPtr& waypoint);
+                    Buffer& buffer, WaypointIndex waypoint);
 
   // Function to remove a waypoint from a path buffer and update waypoint tracking.
   void PopWaypoint(ActorId actor_id, TrackTraffic& track_traffic,
                    Buffer& buffer, bool front_or_back=true);
 
-  /// Method to return the wayPoints from the waypoint Buffer by using target point distance
-  using TargetWPInfo = std::pair<SimpleWaypointPtr,uint64_t>;
+  /// Method to return the wayPoints from the waypoint Buffer by using target point distance.
+  /// Returns the waypoint index in the map and its position in the buffer.
+  using TargetWPInfo = std::pair<WaypointIndex,uint64_t>;
   TargetWPInfo GetTargetWaypoint(const Buffer& waypoint_buffer, const float& target_point_distance);
 
 } // namespace traffic_manager
@@ -30,6 +30,7 @@ MotionPlanStage::MotionPlanStage(
   const std::vector<ActorId> &vehicle_id_list,
   const SimulationState &simulation_state,
   const Parameters &parameters,
+  const LevelOfDetail &level_of_detail,
   const BufferMap &buffer_map,
   TrackTraffic &track_traffic,
   const std::vector<float> &urban_longitudinal_parameters,
@@ -46,6 +47,7 @@ MotionPlanStage::MotionPlanStage(
     : vehicle_id_list(vehicle_id_list),
     simulation_state(simulation_state),
     parameters(parameters),
+    level_of_detail(level_of_detail),
     buffer_map(buffer_map),
     track_traffic(track_traffic),
     urban_longitudinal_parameters(urban_longitudinal_parameters),
@@ -69,7 +71,19 @@ MotionPlanStage::MotionPlanStage(
       }
     }
 
+void MotionPlanStage::UpdateWorldInfo() {
+  current_timestamp = world.GetSnapshot().GetTimestamp();
+  teleport_candidates.clear();
+  teleport_candidates.resize(vehicle_id_list.size());
+}
+
 void MotionPlanStage::Update(const unsigned long index) {
+  // Vehicles not updated in this cycle keep following their last command.
+  if (!level_of_detail.IsScheduled(index)) {
+    Extrapolate(index);
+    return;
+  }
+
   const ActorId actor_id = vehicle_id_list.at(index);
   const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
   const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_id);
@@ -78,10 +92,10 @@ void MotionPlanStage::Update(const unsigned long index) {
   const cg::Vector3D vehicle_heading = simulation_state.GetHeading(actor_id);
   const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_id);
   const Buffer &waypoint_buffer = buffer_map.at(actor_id);
+  const WaypointGraph &graph = waypoint_buffer.GetGraph();
   const LocalizationData &localization = localization_frame.at(index);
   const CollisionHazardData &collision_hazard = collision_frame.at(index);
   const bool &tl_hazard = tl_frame.at(index);
-  current_timestamp = world.GetSnapshot().GetTimestamp();
   StateEntry current_state;
 
   // Instanciating teleportation transform as current vehicle transform.
@@ -98,9 +112,7 @@ void MotionPlanStage::Update(const unsigned long index) {
                     0.0f};
 
     // Add entry to teleportation duration clock table if not present.
-    if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-      teleportation_instance.insert({actor_id, current_timestamp});
-    }
+    const cc::Timestamp &last_teleportation = GetTeleportationInstance(actor_id);
 
     // Get lower and upper bound for teleporting vehicle.
     float lower_bound = parameters.GetLowerBoundaryRespawnDormantVehicles();
@@ -108,22 +120,12 @@ void MotionPlanStage::Update(const unsigned long index) {
     float dilate_factor = (upper_bound-lower_bound)/100.0f;
 
     // Measuring time elapsed since last teleportation for the vehicle.
-    double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+    double elapsed_time = current_timestamp.elapsed_seconds - last_teleportation.elapsed_seconds;
 
     if (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
       float random_sample = (static_cast<float>(random_devices.at(actor_id).next())*dilate_factor) + lower_bound;
-      NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
-      if (!teleport_waypoint_list.empty()) {
-        for (auto &teleport_waypoint : teleport_waypoint_list) {
-          GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
-          if (track_traffic.IsGeoGridFree(geogrid_id)) {
-            teleportation_transform = teleport_waypoint->GetTransform();
-            teleportation_transform.location.z += 0.5f;
-            track_traffic.AddTakenGrid(geogrid_id, actor_id);
-            break;
-          }
-        }
-      }
+      // Free locations are claimed in ResolveTeleportation, in vehicle order.
+      teleport_candidates.at(index) = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
     }
     output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
   }
@@ -132,10 +134,10 @@ void MotionPlanStage::Update(const unsigned long index) {
 
     // Target velocity for vehicle.
     const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_id);
-    float max_target_velocity = parameters.GetVehicleTargetVelocity(actor_id, vehicle_speed_limit) / 3.6f;
+    float max_target_velocity = parameters.GetSnapshot()[index].GetTargetVelocity(vehicle_speed_limit) / 3.6f;
 
     // Algorithm to reduce speed near landmarks
-    float max_landmark_target_velocity = GetLandmarkTargetVelocity(*(waypoint_buffer.at(0)), vehicle_location, actor_id, max_target_velocity);
+    float max_landmark_target_velocity = GetLandmarkTargetVelocity(*graph.GetSimpleWaypoint(waypoint_buffer.front()), vehicle_location, actor_id, max_target_velocity);
 
     // Algorithm to reduce speed near turns
     float max_turn_target_velocity = GetTurnTargetVelocity(waypoint_buffer, max_target_velocity);
@@ -158,8 +160,8 @@ void MotionPlanStage::Update(const unsigned long index) {
 
       const float target_point_distance = std::max(vehicle_speed * TARGET_WAYPOINT_TIME_HORIZON,
                                                   MIN_TARGET_WAYPOINT_DISTANCE);
-      const SimpleWaypointPtr &target_waypoint = GetTargetWaypoint(waypoint_buffer, target_point_distance).first;
-      const cg::Location target_location = target_waypoint->GetLocation();
+      const WaypointIndex target_waypoint = GetTargetWaypoint(waypoint_buffer, target_point_distance).first;
+      const cg::Location target_location = graph.GetLocation(target_waypoint);
       float dot_product = DeviationDotProduct(vehicle_location, vehicle_heading, target_location);
       float cross_product = DeviationCrossProduct(vehicle_location, vehicle_heading, target_location);
       dot_product = acos(dot_product) / PI;
@@ -168,15 +170,10 @@ void MotionPlanStage::Update(const unsigned long index) {
       }
       const float angular_deviation = dot_product;
       const float velocity_deviation = (dynamic_target_velocity - vehicle_speed) / dynamic_target_velocity;
-      // If previous state for vehicle not found, initialize state entry.
-      if (pid_state_map.find(actor_id) == pid_state_map.end()) {
-        const auto initial_state = StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f};
-        pid_state_map.insert({actor_id, initial_state});
-      }
-
-      // Retrieving the previous state.
+      // Retrieving the previous state, initialized if not found.
+      StateEntry &state = GetPIDState(actor_id);
       traffic_manager::StateEntry previous_state;
-      previous_state = pid_state_map.at(actor_id);
+      previous_state = state;
 
       // Select PID parameters.
       std::vector<float> longitudinal_parameters;
@@ -210,34 +207,40 @@ void MotionPlanStage::Update(const unsigned long index) {
       vehicle_control.steer = actuation_signal.steer;
 
       output_array.at(index) = carla::rpc::Command::ApplyVehicleControl(actor_id, vehicle_control);
+      {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        last_control_map[actor_id] = vehicle_control;
+      }
 
       // Updating PID state.
       current_state.steer = actuation_signal.steer;
-      StateEntry &state = pid_state_map.at(actor_id);
       state = current_state;
 
     }
     // For physics-less vehicles, determine position and orientation for teleportation.
     else {
+      {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        last_control_map.erase(actor_id);
+      }
+
       // Flushing controller state for vehicle.
       current_state = {current_timestamp,
                       0.0f, 0.0f,
                       0.0f};
 
       // Add entry to teleportation duration clock table if not present.
-      if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-        teleportation_instance.insert({actor_id, current_timestamp});
-      }
+      const cc::Timestamp &last_teleportation = GetTeleportationInstance(actor_id);
 
       // Measuring time elapsed since last teleportation for the vehicle.
-      double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+      double elapsed_time = current_timestamp.elapsed_seconds - last_teleportation.elapsed_seconds;
 
       // Find a location ahead of the vehicle for teleportation to achieve intended velocity.
       if (!emergency_stop && (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT)) {
 
         // Target displacement magnitude to achieve target velocity.
         const float target_displacement = dynamic_target_velocity * HYBRID_MODE_DT_FL;
-        SimpleWaypointPtr teleport_target = waypoint_buffer.front();
+        const SimpleWaypointPtr teleport_target = graph.GetSimpleWaypoint(waypoint_buffer.front());
         cg::Transform target_base_transform = teleport_target->GetTransform();
         cg::Location target_base_location = target_base_transform.location;
         cg::Vector3D target_heading = target_base_transform.GetForwardVector();
@@ -262,22 +265,88 @@ void MotionPlanStage::Update(const unsigned long index) {
   }
 }
 
+void MotionPlanStage::ResolveTeleportation() {
+  for (unsigned long index = 0u; index < teleport_candidates.size(); ++index) {
+    const NodeList &teleport_waypoint_list = teleport_candidates.at(index);
+    const ActorId actor_id = vehicle_id_list.at(index);
+    for (auto &teleport_waypoint : teleport_waypoint_list) {
+      GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
+      if (track_traffic.IsGeoGridFree(geogrid_id)) {
+        cg::Transform teleportation_transform = teleport_waypoint->GetTransform();
+        teleportation_transform.location.z += 0.5f;
+        track_traffic.AddTakenGrid(geogrid_id, actor_id);
+        output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
+        break;
+      }
+    }
+  }
+}
+
+StateEntry &MotionPlanStage::GetPIDState(const ActorId actor_id) {
+  std::lock_guard<std::mutex> lock(state_mutex);
+  auto state_it = pid_state_map.find(actor_id);
+  if (state_it == pid_state_map.end()) {
+    const auto initial_state = StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f};
+    state_it = pid_state_map.insert({actor_id, initial_state}).first;
+  }
+  // References to the entries remain valid on rehashing.
+  return state_it->second;
+}
+
+cc::Timestamp &MotionPlanStage::GetTeleportationInstance(const ActorId actor_id) {
+  std::lock_guard<std::mutex> lock(state_mutex);
+  auto instance_it = teleportation_instance.find(actor_id);
+  if (instance_it == teleportation_instance.end()) {
+    instance_it = teleportation_instance.insert({actor_id, current_timestamp}).first;
+  }
+  return instance_it->second;
+}
+
+void MotionPlanStage::Extrapolate(const unsigned long index) {
+  const ActorId actor_id = vehicle_id_list.at(index);
+  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_id);
+
+  if (simulation_state.IsDormant(actor_id)) {
+    output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, cg::Transform(vehicle_location, vehicle_rotation));
+  }
+  // Vehicles without a control to repeat coast until their next update.
+  else if (simulation_state.IsPhysicsEnabled(actor_id)) {
+    carla::rpc::VehicleControl vehicle_control;
+    {
+      std::lock_guard<std::mutex> lock(state_mutex);
+      auto control_it = last_control_map.find(actor_id);
+      if (control_it != last_control_map.end()) {
+        vehicle_control = control_it->second;
+      }
+    }
+    output_array.at(index) = carla::rpc::Command::ApplyVehicleControl(actor_id, vehicle_control);
+  }
+  // Physics-less vehicles keep the displacement of their last teleportation.
+  else {
+    const cg::Vector3D displacement = simulation_state.GetVelocity(actor_id) * HYBRID_MODE_DT_FL;
+    const cg::Location teleportation_location = vehicle_location + cg::Location(displacement);
+    output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, cg::Transform(teleportation_location, vehicle_rotation));
+  }
+}
+
 bool MotionPlanStage::SafeAfterJunction(const LocalizationData &localization,
                                         const bool tl_hazard,
                                         const bool collision_emergency_stop) {
 
-  SimpleWaypointPtr junction_end_point = localization.junction_end_point;
-  SimpleWaypointPtr safe_point = localization.safe_point;
+  const WaypointGraph &graph = local_map->GetWaypointGraph();
+  const WaypointIndex junction_end_point = localization.junction_end_point;
+  const WaypointIndex safe_point = localization.safe_point;
 
   bool safe_after_junction = true;
   if (!tl_hazard && !collision_emergency_stop
       && localization.is_at_junction_entrance
-      && junction_end_point != nullptr && safe_point != nullptr
-      && junction_end_point->DistanceSquared(safe_point) > SQUARE(MIN_SAFE_INTERVAL_LENGTH)) {
+      && junction_end_point != WaypointGraph::NO_WAYPOINT && safe_point != WaypointGraph::NO_WAYPOINT
+      && graph.DistanceSquared(junction_end_point, safe_point) > SQUARE(MIN_SAFE_INTERVAL_LENGTH)) {
 
-    ActorIdSet passing_safe_point = track_traffic.GetPassingVehicles(safe_point->GetId());
-    ActorIdSet passing_junction_end_point = track_traffic.GetPassingVehicles(junction_end_point->GetId());
-    cg::Location mid_point = (junction_end_point->GetLocation() + safe_point->GetLocation())/2.0f;
+    ActorIdSet passing_safe_point = track_traffic.GetPassingVehicles(safe_point);
+    ActorIdSet passing_junction_end_point = track_traffic.GetPassingVehicles(junction_end_point);
+    cg::Location mid_point = (graph.GetLocation(junction_end_point) + graph.GetLocation(safe_point))/2.0f;
 
     // Only check for vehicles that have the safe point in their passing waypoint, but not
     // the junction end point.
@@ -408,7 +477,7 @@ float MotionPlanStage::GetLandmarkTargetVelocity(const SimpleWaypoint& waypoint,
         minimum_velocity = YIELD_TARGET_VELOCITY;
       } else if (landmark_type == "274") {  // Speed limit
         float value = static_cast<float>(landmark->GetValue()) / 3.6f;
-        value = parameters.GetVehicleTargetVelocity(actor_id, value);
+        value = parameters.GetSnapshot().Find(actor_id).GetTargetVelocity(value);
         minimum_velocity = (value < max_target_velocity) ? value : max_target_velocity;
       } else {
         continue;
@@ -428,13 +497,14 @@ float MotionPlanStage::GetTurnTargetVelocity(const Buffer &waypoint_buffer,
     return max_target_velocity;
   }
   else {
-    const SimpleWaypointPtr first_waypoint = waypoint_buffer.front();
-    const SimpleWaypointPtr last_waypoint = waypoint_buffer.back();
-    const SimpleWaypointPtr middle_waypoint = waypoint_buffer.at(static_cast<uint16_t>(waypoint_buffer.size() / 2));
+    const WaypointGraph &graph = waypoint_buffer.GetGraph();
+    const WaypointIndex first_waypoint = waypoint_buffer.front();
+    const WaypointIndex last_waypoint = waypoint_buffer.back();
+    const WaypointIndex middle_waypoint = waypoint_buffer.at(static_cast<uint16_t>(waypoint_buffer.size() / 2));
 
-    float radius = GetThreePointCircleRadius(first_waypoint->GetLocation(),
-                                             middle_waypoint->GetLocation(),
-                                             last_waypoint->GetLocation());
+    float radius = GetThreePointCircleRadius(graph.GetLocation(first_waypoint),
+                                             graph.GetLocation(middle_waypoint),
+                                             graph.GetLocation(last_waypoint));
 
     // Return the max velocity at the turn
     return std::sqrt(radius * FRICTION * GRAVITY);
@@ -487,12 +557,15 @@ float MotionPlanStage::GetThreePointCircleRadius(cg::Location first_location,
 
 void MotionPlanStage::RemoveActor(const ActorId actor_id) {
   pid_state_map.erase(actor_id);
+  last_control_map.erase(actor_id);
   teleportation_instance.erase(actor_id);
 }
 
 void MotionPlanStage::Reset() {
   pid_state_map.clear();
+  last_control_map.clear();
   teleportation_instance.clear();
+  teleport_candidates.clear();
 }
 
 } // namespace traffic_manager
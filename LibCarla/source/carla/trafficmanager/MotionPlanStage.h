@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "carla/trafficmanager/DataStructures.h"
 #include "carla/trafficmanager/InMemoryMap.h"
+#include "carla/trafficmanager/LevelOfDetail.h"
 #include "carla/trafficmanager/LocalizationUtils.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
@@ -24,6 +27,7 @@ private:
   const std::vector<ActorId> &vehicle_id_list;
   const SimulationState &simulation_state;
   const Parameters &parameters;
+  const LevelOfDetail &level_of_detail;
   const BufferMap &buffer_map;
   TrackTraffic &track_traffic;
   // PID paramenters for various road conditions.
@@ -37,9 +41,18 @@ private:
   const cc::World &world;
   // Structure holding the controller state for registered vehicles.
   std::unordered_map<ActorId, StateEntry> pid_state_map;
+  // Structure holding the last control applied to vehicles with physics,
+  // repeated in the cycles they are not updated.
+  std::unordered_map<ActorId, carla::rpc::VehicleControl> last_control_map;
   // Structure to keep track of duration between teleportation
   // in hybrid physics mode.
   std::unordered_map<ActorId, cc::Timestamp> teleportation_instance;
+  // Mutex guarding insertions in the per-vehicle controller structures
+  // when vehicles are updated concurrently.
+  std::mutex state_mutex;
+  // Candidate waypoints to respawn dormant vehicles, per vehicle index.
+  // Resolved once all vehicles have been updated.
+  std::vector<NodeList> teleport_candidates;
   ControlFrame &output_array;
   cc::Timestamp current_timestamp;
   RandomGeneratorMap &random_devices;
@@ -68,10 +81,21 @@ private:
                                   cg::Location middle_location,
                                   cg::Location last_location);
 
+  // Method to retrieve the controller state of a vehicle, initializing it if not present.
+  StateEntry &GetPIDState(const ActorId actor_id);
+
+  // Method to retrieve the last teleportation instance of a vehicle, initializing it if not present.
+  cc::Timestamp &GetTeleportationInstance(const ActorId actor_id);
+
+  // Method to extrapolate the last command of a vehicle not updated in the
+  // current cycle.
+  void Extrapolate(const unsigned long index);
+
 public:
   MotionPlanStage(const std::vector<ActorId> &vehicle_id_list,
                   const SimulationState &simulation_state,
                   const Parameters &parameters,
+                  const LevelOfDetail &level_of_detail,
                   const BufferMap &buffer_map,
                   TrackTraffic &track_traffic,
                   const std::vector<float> &urban_longitudinal_parameters,
@@ -86,8 +110,16 @@ public:
                   RandomGeneratorMap &random_devices,
                   const LocalMapPtr &local_map);
 
+  // Method to retrieve the world information shared by all vehicles in the current cycle.
+  // Must be called before updating any vehicle.
+  void UpdateWorldInfo();
+
   void Update(const unsigned long index);
 
+  // Method to assign free locations to the dormant vehicles being respawned.
+  // Must be called once all vehicles have been updated.
+  void ResolveTeleportation();
+
   void RemoveActor(const ActorId actor_id);
 
   void Reset();
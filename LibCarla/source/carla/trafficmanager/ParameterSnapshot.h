@@ -0,0 +1,111 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  using ActorId = carla::ActorId;
+
+  /// Parameters of a single vehicle, already resolved against the global
+  /// settings of the traffic manager.
+  struct VehicleParameters {
+    /// % decrease in velocity with respect to the speed limit.
+    float percentage_speed_difference = 0.0f;
+    /// Distance to keep to the leading vehicle.
+    float distance_to_leading_vehicle = 0.0f;
+    /// % of running a traffic light.
+    float perc_run_traffic_light = 0.0f;
+    /// % of running a traffic sign.
+    float perc_run_traffic_sign = 0.0f;
+    /// % of ignoring walkers.
+    float perc_ignore_walkers = 0.0f;
+    /// % of ignoring vehicles.
+    float perc_ignore_vehicles = 0.0f;
+    /// % of keep right rule, negative if not set.
+    float perc_keep_right = -1.0f;
+    /// % of random left lane change, negative if not set.
+    float perc_random_left = -1.0f;
+    /// % of random right lane change, negative if not set.
+    float perc_random_right = -1.0f;
+    /// Automatic lane change switch.
+    bool auto_lane_change = true;
+    /// Automatic vehicle lights update switch.
+    bool update_vehicle_lights = false;
+    /// Sorted list of actors ignored during collision detection.
+    std::vector<ActorId> ignore_collision;
+
+    float GetTargetVelocity(const float speed_limit) const {
+      return speed_limit * (1.0f - percentage_speed_difference / 100.0f);
+    }
+
+    bool GetCollisionDetection(const ActorId other_actor_id) const {
+      return !std::binary_search(ignore_collision.begin(), ignore_collision.end(), other_actor_id);
+    }
+  };
+
+  /// Immutable table with the parameters of every vehicle registered in the
+  /// current cycle, indexed like the vehicle id list of the cycle.
+  ///
+  /// The table is rebuilt by Parameters::UpdateSnapshot at the start of a
+  /// cycle, only when a setter was called or the registered vehicles changed,
+  /// and it is not modified while the stages run, so they can read it from
+  /// any thread without locking.
+  class ParameterSnapshot {
+  public:
+
+    size_t size() const {
+      return _vehicles.size();
+    }
+
+    /// Parameters of the vehicle at @a index of the vehicle id list.
+    const VehicleParameters &operator[](const unsigned long index) const {
+      return _vehicles[index];
+    }
+
+    /// Parameters of @a actor_id, or the global defaults if the actor is not
+    /// a registered vehicle.
+    const VehicleParameters &Find(const ActorId actor_id) const {
+      const auto it = std::lower_bound(
+          _indices.begin(),
+          _indices.end(),
+          std::make_pair(actor_id, 0ul));
+      if (it != _indices.end() && it->first == actor_id) {
+        return _vehicles[it->second];
+      }
+      return _defaults;
+    }
+
+  private:
+
+    friend class Parameters;
+
+    /// Parameters per vehicle index.
+    std::vector<VehicleParameters> _vehicles;
+
+    /// Vehicle id list the table was built for.
+    std::vector<ActorId> _vehicle_ids;
+
+    /// Pairs of actor id and vehicle index sorted by actor id.
+    std::vector<std::pair<ActorId, unsigned long>> _indices;
+
+    /// Parameters of actors without specific settings.
+    VehicleParameters _defaults;
+
+    /// Revision of the parameters the table was built from.
+    uint64_t _revision = std::numeric_limits<uint64_t>::max();
+  };
+
+} // namespace traffic_manager
+} // namespace carla
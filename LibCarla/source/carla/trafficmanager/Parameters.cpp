@@ -7,6 +7,8 @@
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/Constants.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace traffic_manager {
 
@@ -44,11 +46,13 @@ void Parameters::SetPercentageSpeedDifference(const ActorPtr &actor, const float
 
   float new_percentage = std::min(100.0f, percentage);
   percentage_difference_from_speed_limit.AddEntry({actor->GetId(), new_percentage});
+  ++revision;
 }
 
 void Parameters::SetGlobalPercentageSpeedDifference(const float percentage) {
   float new_percentage = std::min(100.0f, percentage);
   global_percentage_difference_from_limit = new_percentage;
+  ++revision;
 }
 
 void Parameters::SetCollisionDetection(const ActorPtr &reference_actor, const ActorPtr &other_actor, const bool detect_collision) {
@@ -75,6 +79,7 @@ void Parameters::SetCollisionDetection(const ActorPtr &reference_actor, const Ac
       ignore_collision.AddEntry(entry);
     }
   }
+  ++revision;
 }
 
 void Parameters::SetForceLaneChange(const ActorPtr &actor, const bool direction) {
@@ -88,31 +93,35 @@ void Parameters::SetKeepRightPercentage(const ActorPtr &actor, const float perce
 
   const auto entry = std::make_pair(actor->GetId(), percentage);
   perc_keep_right.AddEntry(entry);
+  ++revision;
 }
 
 void Parameters::SetRandomLeftLaneChangePercentage(const ActorPtr &actor, const float percentage) {
 
   const auto entry = std::make_pair(actor->GetId(), percentage);
   perc_random_left.AddEntry(entry);
+  ++revision;
 }
 
 void Parameters::SetRandomRightLaneChangePercentage(const ActorPtr &actor, const float percentage) {
 
   const auto entry = std::make_pair(actor->GetId(), percentage);
   perc_random_right.AddEntry(entry);
-
+  ++revision;
 }
 
 void Parameters::SetUpdateVehicleLights(const ActorPtr &actor, const bool do_update) {
 
   const auto entry = std::make_pair(actor->GetId(), do_update);
   auto_update_vehicle_lights.AddEntry(entry);
+  ++revision;
 }
 
 void Parameters::SetAutoLaneChange(const ActorPtr &actor, const bool enable) {
 
   const auto entry = std::make_pair(actor->GetId(), enable);
   auto_lane_change.AddEntry(entry);
+  ++revision;
 }
 
 void Parameters::SetDistanceToLeadingVehicle(const ActorPtr &actor, const float distance) {
@@ -120,6 +129,7 @@ void Parameters::SetDistanceToLeadingVehicle(const ActorPtr &actor, const float
   float new_distance = std::max(0.0f, distance);
   const auto entry = std::make_pair(actor->GetId(), new_distance);
   distance_to_leading_vehicle.AddEntry(entry);
+  ++revision;
 }
 
 void Parameters::SetSynchronousMode(const bool mode_switch) {
@@ -133,6 +143,7 @@ void Parameters::SetSynchronousModeTimeOutInMiliSecond(const double time) {
 void Parameters::SetGlobalDistanceToLeadingVehicle(const float dist) {
 
   distance_margin.store(dist);
+  ++revision;
 }
 
 void Parameters::SetPercentageRunningLight(const ActorPtr &actor, const float perc) {
@@ -140,6 +151,7 @@ void Parameters::SetPercentageRunningLight(const ActorPtr &actor, const float pe
   float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
   const auto entry = std::make_pair(actor->GetId(), new_perc);
   perc_run_traffic_light.AddEntry(entry);
+  ++revision;
 }
 
 void Parameters::SetPercentageRunningSign(const ActorPtr &actor, const float perc) {
@@ -147,6 +159,7 @@ void Parameters::SetPercentageRunningSign(const ActorPtr &actor, const float per
   float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
   const auto entry = std::make_pair(actor->GetId(), new_perc);
   perc_run_traffic_sign.AddEntry(entry);
+  ++revision;
 }
 
 void Parameters::SetPercentageIgnoreVehicles(const ActorPtr &actor, const float perc) {
@@ -154,6 +167,7 @@ void Parameters::SetPercentageIgnoreVehicles(const ActorPtr &actor, const float
   float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
   const auto entry = std::make_pair(actor->GetId(), new_perc);
   perc_ignore_vehicles.AddEntry(entry);
+  ++revision;
 }
 
 void Parameters::SetPercentageIgnoreWalkers(const ActorPtr &actor, const float perc) {
@@ -161,6 +175,7 @@ void Parameters::SetPercentageIgnoreWalkers(const ActorPtr &actor, const float p
   float new_perc = cg::Math::Clamp(perc,0.0f,100.0f);
   const auto entry = std::make_pair(actor->GetId(), new_perc);
   perc_ignore_walkers.AddEntry(entry);
+  ++revision;
 }
 
 void Parameters::SetHybridPhysicsRadius(const float radius) {
@@ -172,6 +187,24 @@ void Parameters::SetOSMMode(const bool mode_switch) {
   osm_mode.store(mode_switch);
 }
 
+void Parameters::SetWorkerThreads(const uint64_t number_of_threads) {
+  worker_threads.store(number_of_threads);
+}
+
+void Parameters::SetLevelOfDetail(const std::vector<float> &radii, const std::vector<uint64_t> &update_intervals) {
+  LODTierList tiers;
+  const size_t number_of_tiers = std::min(radii.size(), update_intervals.size());
+  for (size_t i = 0u; i < number_of_tiers; ++i) {
+    tiers.push_back({std::max(radii[i], 0.0f), std::max<uint64_t>(update_intervals[i], 1u)});
+  }
+  std::sort(tiers.begin(), tiers.end(), [](const LODTier &a, const LODTier &b) {
+    return a.radius < b.radius;
+  });
+
+  std::lock_guard<std::mutex> lock(lod_mutex);
+  lod_tiers = std::move(tiers);
+}
+
 void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   const auto entry = std::make_pair(actor->GetId(), path);
   custom_path.AddEntry(entry);
@@ -401,6 +434,17 @@ bool Parameters::GetOSMMode() const {
   return osm_mode.load();
 }
 
+uint64_t Parameters::GetWorkerThreads() const {
+
+  return worker_threads.load();
+}
+
+LODTierList Parameters::GetLevelOfDetail() const {
+
+  std::lock_guard<std::mutex> lock(lod_mutex);
+  return lod_tiers;
+}
+
 bool Parameters::GetUploadPath(const ActorId &actor_id) const {
 
   bool custom_path_bool = false;
@@ -446,6 +490,59 @@ Route Parameters::GetImportedRoute(const ActorId &actor_id) const {
   return custom_route_import;
 }
 
+//////////////////////////////////// SNAPSHOT /////////////////////////////////
+
+void Parameters::UpdateSnapshot(const std::vector<ActorId> &vehicle_id_list) {
+
+  // Setters increase the revision after modifying their map, so a change
+  // racing with the copy below is picked up in the next cycle.
+  const uint64_t current_revision = revision.load();
+  if (current_revision == snapshot._revision && vehicle_id_list == snapshot._vehicle_ids) {
+    return;
+  }
+
+  VehicleParameters defaults;
+  defaults.percentage_speed_difference = global_percentage_difference_from_limit;
+  defaults.distance_to_leading_vehicle = distance_margin.load();
+
+  const unsigned long number_of_vehicles = vehicle_id_list.size();
+  snapshot._vehicles.assign(number_of_vehicles, defaults);
+  snapshot._indices.resize(number_of_vehicles);
+
+  for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+    const ActorId actor_id = vehicle_id_list[index];
+    VehicleParameters &vehicle = snapshot._vehicles[index];
+
+    percentage_difference_from_speed_limit.TryGetValue(actor_id, vehicle.percentage_speed_difference);
+    distance_to_leading_vehicle.TryGetValue(actor_id, vehicle.distance_to_leading_vehicle);
+    perc_run_traffic_light.TryGetValue(actor_id, vehicle.perc_run_traffic_light);
+    perc_run_traffic_sign.TryGetValue(actor_id, vehicle.perc_run_traffic_sign);
+    perc_ignore_walkers.TryGetValue(actor_id, vehicle.perc_ignore_walkers);
+    perc_ignore_vehicles.TryGetValue(actor_id, vehicle.perc_ignore_vehicles);
+    perc_keep_right.TryGetValue(actor_id, vehicle.perc_keep_right);
+    perc_random_left.TryGetValue(actor_id, vehicle.perc_random_left);
+    perc_random_right.TryGetValue(actor_id, vehicle.perc_random_right);
+    auto_lane_change.TryGetValue(actor_id, vehicle.auto_lane_change);
+    auto_update_vehicle_lights.TryGetValue(actor_id, vehicle.update_vehicle_lights);
+
+    std::shared_ptr<AtomicActorSet> ignored_actors;
+    if (ignore_collision.TryGetValue(actor_id, ignored_actors)) {
+      vehicle.ignore_collision = ignored_actors->GetIDList();
+      std::sort(vehicle.ignore_collision.begin(), vehicle.ignore_collision.end());
+    }
+
+    snapshot._indices[index] = std::make_pair(actor_id, index);
+  }
+  std::sort(snapshot._indices.begin(), snapshot._indices.end());
+
+  snapshot._defaults = std::move(defaults);
+  snapshot._vehicle_ids = vehicle_id_list;
+  snapshot._revision = current_revision;
+}
+
+const ParameterSnapshot &Parameters::GetSnapshot() const {
+  return snapshot;
+}
 
 } // namespace traffic_manager
 } // namespace carla
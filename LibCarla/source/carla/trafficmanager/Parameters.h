@@ -8,6 +8,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <mutex>
 #include <random>
 #include <unordered_map>
 
@@ -18,6 +19,8 @@
 
 #include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/AtomicMap.h"
+#include "carla/trafficmanager/LevelOfDetail.h"
+#include "carla/trafficmanager/ParameterSnapshot.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -85,6 +88,12 @@ private:
   std::atomic<float> hybrid_physics_radius {70.0};
   /// Parameter specifying Open Street Map mode.
   std::atomic<bool> osm_mode {true};
+  /// Number of threads used to run the per-vehicle stage updates.
+  std::atomic<uint64_t> worker_threads {0u};
+  /// Level of detail tiers, sorted by radius.
+  LODTierList lod_tiers;
+  /// Mutex guarding the level of detail tiers.
+  mutable std::mutex lod_mutex;
   /// Parameter specifying if importing a custom path.
   AtomicMap<ActorId, bool> upload_path;
   /// Structure to hold all custom paths.
@@ -93,6 +102,10 @@ private:
   AtomicMap<ActorId, bool> upload_route;
   /// Structure to hold all custom routes.
   AtomicMap<ActorId, Route> custom_route;
+  /// Counter increased by every setter of a parameter held in the snapshot.
+  std::atomic<uint64_t> revision {0u};
+  /// Parameters of the registered vehicles for the current cycle.
+  ParameterSnapshot snapshot;
 
 public:
   Parameters();
@@ -167,6 +180,13 @@ public:
   /// Method to set Open Street Map mode.
   void SetOSMMode(const bool mode_switch);
 
+  /// Method to set the number of threads used to run the stages.
+  void SetWorkerThreads(const uint64_t number_of_threads);
+
+  /// Method to set the level of detail tiers. Vehicles farther than radii[i]
+  /// from every hero vehicle are updated once every update_intervals[i] cycles.
+  void SetLevelOfDetail(const std::vector<float> &radii, const std::vector<uint64_t> &update_intervals);
+
   /// Method to set if we are automatically respawning vehicles.
   void SetRespawnDormantVehicles(const bool mode_switch);
 
@@ -259,6 +279,12 @@ public:
   /// Method to get Open Street Map mode.
   bool GetOSMMode() const;
 
+  /// Method to get the number of threads used to run the stages.
+  uint64_t GetWorkerThreads() const;
+
+  /// Method to get the level of detail tiers, sorted by radius.
+  LODTierList GetLevelOfDetail() const;
+
   /// Method to get if we are uploading a path.
   bool GetUploadPath(const ActorId &actor_id) const;
 
@@ -271,6 +297,16 @@ public:
   /// Method to get a custom route.
   Route GetImportedRoute(const ActorId &actor_id) const;
 
+  ///////////////////////////////// SNAPSHOT ////////////////////////////////////
+
+  /// Method to rebuild the parameter snapshot for the vehicles of the
+  /// upcoming cycle, if any parameter changed or the list is different.
+  /// Must be called from the traffic manager thread before running the stages.
+  void UpdateSnapshot(const std::vector<ActorId> &vehicle_id_list);
+
+  /// Method to retrieve the parameters of the vehicles of the current cycle.
+  const ParameterSnapshot &GetSnapshot() const;
+
   /// Synchronous mode time out variable.
   std::chrono::duration<double, std::milli> synchronous_time_out;
 };
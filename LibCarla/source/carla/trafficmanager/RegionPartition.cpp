@@ -0,0 +1,76 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/RegionPartition.h"
+
+#include "carla/Exception.h"
+#include "carla/trafficmanager/WaypointGraph.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace carla {
+namespace traffic_manager {
+
+  void RegionPartition::CheckRegion(uint64_t region, uint64_t number_of_regions) {
+    if (number_of_regions == 0u || region >= number_of_regions) {
+      throw_exception(std::invalid_argument(
+          "invalid region " + std::to_string(region) + " of " +
+          std::to_string(number_of_regions) + " regions"));
+    }
+  }
+
+  RegionPartition::RegionPartition(const WaypointGraph &graph, uint64_t number_of_regions) {
+    const size_t number_of_waypoints = graph.Size();
+    if (number_of_regions < 2u || number_of_waypoints < number_of_regions) {
+      return;
+    }
+
+    float min_x = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float min_y = std::numeric_limits<float>::max();
+    float max_y = std::numeric_limits<float>::lowest();
+    for (WaypointIndex index = 0u; index < number_of_waypoints; ++index) {
+      const cg::Location location = graph.GetLocation(index);
+      min_x = std::min(min_x, location.x);
+      max_x = std::max(max_x, location.x);
+      min_y = std::min(min_y, location.y);
+      max_y = std::max(max_y, location.y);
+    }
+    _along_x = (max_x - min_x) >= (max_y - min_y);
+
+    std::vector<float> coordinates;
+    coordinates.reserve(number_of_waypoints);
+    for (WaypointIndex index = 0u; index < number_of_waypoints; ++index) {
+      coordinates.push_back(GetCoordinate(graph.GetLocation(index)));
+    }
+    std::sort(coordinates.begin(), coordinates.end());
+
+    _cuts.reserve(number_of_regions - 1u);
+    for (uint64_t region = 1u; region < number_of_regions; ++region) {
+      _cuts.push_back(coordinates[(region * number_of_waypoints) / number_of_regions]);
+    }
+  }
+
+  uint64_t RegionPartition::GetRegion(const cg::Location &location) const {
+    const auto it = std::upper_bound(_cuts.begin(), _cuts.end(), GetCoordinate(location));
+    return static_cast<uint64_t>(it - _cuts.begin());
+  }
+
+  bool RegionPartition::IsInRegion(const cg::Location &location, uint64_t region, float margin) const {
+    if (region >= GetNumberOfRegions()) {
+      return false;
+    }
+    const float coordinate = GetCoordinate(location);
+    const bool after_lower_cut = (region == 0u) || (coordinate >= _cuts[region - 1u] - margin);
+    const bool before_upper_cut = (region == _cuts.size()) || (coordinate < _cuts[region] + margin);
+    return after_lower_cut && before_upper_cut;
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,63 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "carla/geom/Location.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+
+  class WaypointGraph;
+
+  /// Split of the local map in regions, each of them driven by its own
+  /// traffic manager shard.
+  ///
+  /// The map is cut in slabs along its longest horizontal axis, with the
+  /// same number of waypoints in each slab so that shards get a similar
+  /// share of the roads. The cuts only depend on the waypoints of the map,
+  /// so every shard of a town computes the same partition.
+  class RegionPartition {
+  public:
+
+    /// Partition with a single region covering the whole map.
+    RegionPartition() = default;
+
+    RegionPartition(const WaypointGraph &graph, uint64_t number_of_regions);
+
+    /// Throws std::invalid_argument unless @a region is one of
+    /// @a number_of_regions regions.
+    static void CheckRegion(uint64_t region, uint64_t number_of_regions);
+
+    uint64_t GetNumberOfRegions() const {
+      return _cuts.size() + 1u;
+    }
+
+    /// Region containing @a location.
+    uint64_t GetRegion(const cg::Location &location) const;
+
+    /// Whether @a location is in @a region or less than @a margin away from it.
+    bool IsInRegion(const cg::Location &location, uint64_t region, float margin = 0.0f) const;
+
+  private:
+
+    float GetCoordinate(const cg::Location &location) const {
+      return _along_x ? location.x : location.y;
+    }
+
+    bool _along_x = true;
+
+    /// Coordinates of the cuts between consecutive regions, sorted.
+    std::vector<float> _cuts;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,59 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/ShardBatch.h"
+
+#include <unordered_map>
+
+namespace carla {
+namespace traffic_manager {
+
+  std::shared_ptr<ShardBatch> ShardBatch::Get(uint16_t first_port) {
+    static std::mutex registry_mutex;
+    static std::unordered_map<uint16_t, std::weak_ptr<ShardBatch>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::shared_ptr<ShardBatch> batch = registry[first_port].lock();
+    if (batch == nullptr) {
+      batch = std::make_shared<ShardBatch>();
+      registry[first_port] = batch;
+    }
+    return batch;
+  }
+
+  void ShardBatch::Join(uint64_t region) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _joined.insert(region);
+  }
+
+  bool ShardBatch::Leave(uint64_t region, CommandList &batch) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _joined.erase(region);
+    _added.erase(region);
+    if (_added.empty() || _added.size() < _joined.size()) {
+      return false;
+    }
+    batch.clear();
+    batch.swap(_commands);
+    _added.clear();
+    return true;
+  }
+
+  bool ShardBatch::Add(uint64_t region, const CommandList &commands, CommandList &batch) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const bool added_before = !_added.insert(region).second;
+    _commands.insert(_commands.end(), commands.begin(), commands.end());
+    if (!added_before && _added.size() < _joined.size()) {
+      return false;
+    }
+    batch.clear();
+    batch.swap(_commands);
+    _added.clear();
+    return true;
+  }
+
+} // namespace traffic_manager
+} // namespace carla
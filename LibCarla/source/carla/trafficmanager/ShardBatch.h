@@ -0,0 +1,62 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "carla/rpc/Command.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /// Commands of the traffic manager shards of a town ticked by this process,
+  /// whether they run in it or in another one, combined to send them to the
+  /// simulator in a single batch.
+  ///
+  /// Every shard adds the commands of its cycle, and the shard completing the
+  /// batch sends it. In synchronous mode the shards are ticked one after
+  /// another, so the last one sends a batch with the commands of all of them
+  /// for the tick.
+  class ShardBatch {
+  public:
+
+    using CommandList = std::vector<rpc::Command>;
+
+    /// Batch shared by the shards of the town whose first region listens on
+    /// @a first_port. It lives as long as any shard holds it.
+    static std::shared_ptr<ShardBatch> Get(uint16_t first_port);
+
+    void Join(uint64_t region);
+
+    /// Removes @a region from the shards of the town. Returns true and moves
+    /// the combined commands into @a batch if the remaining shards have
+    /// already added theirs, so that they are not held until the next tick.
+    bool Leave(uint64_t region, CommandList &batch);
+
+    /// Adds the commands of @a region. Returns true and moves the combined
+    /// commands into @a batch if every shard has added its commands, or if
+    /// @a region adds commands again before the others, so that a shard
+    /// falling behind does not stall the rest.
+    bool Add(uint64_t region, const CommandList &commands, CommandList &batch);
+
+  private:
+
+    std::mutex _mutex;
+
+    std::set<uint64_t> _joined;
+
+    std::set<uint64_t> _added;
+
+    CommandList _commands;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
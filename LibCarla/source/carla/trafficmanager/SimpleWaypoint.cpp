@@ -142,5 +142,13 @@ namespace traffic_manager {
     return road_option;
   }
 
+  void SimpleWaypoint::SetIndex(WaypointIndex _index) {
+    index = _index;
+  }
+
+  WaypointIndex SimpleWaypoint::GetIndex() const {
+    return index;
+  }
+
 } // namespace traffic_manager
 } // namespace carla
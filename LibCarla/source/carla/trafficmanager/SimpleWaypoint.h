@@ -22,6 +22,7 @@ namespace traffic_manager {
   namespace cg = carla::geom;
   using WaypointPtr = carla::SharedPtr<cc::Waypoint>;
   using GeoGridId = carla::road::JuncId;
+  using WaypointIndex = uint32_t;
   enum class RoadOption : uint8_t {
     Void = 0,
     Left = 1,
@@ -57,6 +58,8 @@ namespace traffic_manager {
     GeoGridId geodesic_grid_id = 0;
     // Boolean to hold if the waypoint belongs to a junction
     bool _is_junction = false;
+    /// Position of the waypoint in the local map's WaypointGraph.
+    WaypointIndex index = 0u;
 
   public:
 
@@ -134,6 +137,10 @@ namespace traffic_manager {
     // Accessor methods for road option.
     void SetRoadOption(RoadOption _road_option);
     RoadOption GetRoadOption();
+
+    /// Accessor methods for the index in the local map's WaypointGraph.
+    void SetIndex(WaypointIndex _index);
+    WaypointIndex GetIndex() const;
   };
 
 } // namespace traffic_manager
@@ -3,6 +3,8 @@
 
 #include "carla/trafficmanager/TrackTraffic.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace traffic_manager {
 
@@ -14,78 +16,107 @@ TrackTraffic::TrackTraffic() {}
 void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
                                                   const std::vector<SimpleWaypointPtr> waypoints) {
 
-    DeleteActor(actor_id);
+    if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
+        WaypointIdSet waypoint_id_set = waypoint_occupied.at(actor_id);
+        for (const WaypointIndex &waypoint_index : waypoint_id_set) {
+            RemovePassingVehicle(waypoint_index, actor_id);
+        }
+    }
 
-    std::unordered_set<GeoGridId> current_grids;
     // Step through waypoints and update grid list for actor and actor list for grids.
+    grid_scratch.clear();
     for (auto &waypoint : waypoints) {
-        UpdatePassingVehicle(waypoint->GetId(), actor_id);
-
-        GeoGridId ggid = waypoint->GetGeodesicGridId();
-        current_grids.insert(ggid);
-
-        if (grid_to_actors.find(ggid) != grid_to_actors.end()) {
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
-            }
-        } else {
-            grid_to_actors.insert({ggid, {actor_id}});
-        }
+        UpdatePassingVehicle(waypoint->GetIndex(), actor_id);
+        grid_scratch.push_back(waypoint->GetGeodesicGridId());
     }
 
-    actor_to_grids.insert({actor_id, current_grids});
+    SetActorGrids(actor_id, grid_scratch);
 }
 
 void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer) {
     if (!buffer.empty()) {
 
-        // Clear current actor from all grids containing itself.
-        if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-            std::unordered_set<GeoGridId> &current_grids = actor_to_grids.at(actor_id);
-            for (auto &grid_id : current_grids) {
-                if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                    ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                    actor_ids.erase(actor_id);
-                }
-            }
-
-            actor_to_grids.erase(actor_id);
-        }
-
-        // Step through buffer and update grid list for actor and actor list for grids.
-        std::unordered_set<GeoGridId> current_grids;
+        // Step through buffer and collect the grids of the path.
+        const WaypointGraph &graph = buffer.GetGraph();
+        grid_scratch.clear();
         uint64_t buffer_size = buffer.size();
         for (uint64_t i = 0u; i <= buffer_size - 1u; ++i) {
-            auto waypoint = buffer.at(i);
-            GeoGridId ggid = waypoint->GetGeodesicGridId();
-            current_grids.insert(ggid);
-            // Add grid entry if not present.
-            if (grid_to_actors.find(ggid) == grid_to_actors.end()) {
-                grid_to_actors.insert({ggid, {}});
+            GeoGridId ggid = graph.GetGeodesicGridId(buffer.at(i));
+            // Consecutive waypoints mostly share the same grid.
+            if (grid_scratch.empty() || grid_scratch.back() != ggid) {
+                grid_scratch.push_back(ggid);
             }
+        }
 
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
-            }
+        SetActorGrids(actor_id, grid_scratch);
+    }
+}
+
+void TrackTraffic::SetActorGrids(const ActorId actor_id, GeoGridList &grids) {
+    std::sort(grids.begin(), grids.end());
+    grids.erase(std::unique(grids.begin(), grids.end()), grids.end());
+
+    GeoGridList &current_grids = actor_to_grids[actor_id];
+
+    // Both lists are sorted, walk them together to find the grids
+    // the actor leaves and the ones it enters.
+    auto current = current_grids.begin();
+    auto next = grids.begin();
+    while (current != current_grids.end() || next != grids.end()) {
+        if (next == grids.end() || (current != current_grids.end() && *current < *next)) {
+            RemoveActorFromGrid(*current, actor_id);
+            ++current;
+        } else if (current == current_grids.end() || *next < *current) {
+            AddActorToGrid(*next, actor_id);
+            ++next;
+        } else {
+            ++current;
+            ++next;
         }
+    }
+
+    // Keep the previous list's storage for the next update.
+    current_grids.swap(grids);
+}
 
-        actor_to_grids.insert({actor_id, current_grids});
+void TrackTraffic::AddActorToGrid(const GeoGridId geogrid_id, const ActorId actor_id) {
+    const size_t grid_index = static_cast<size_t>(geogrid_id);
+    if (grid_index >= grid_to_actors.size()) {
+        grid_to_actors.resize(grid_index + 1u);
     }
+    grid_to_actors[grid_index].push_back(actor_id);
 }
 
+void TrackTraffic::RemoveActorFromGrid(const GeoGridId geogrid_id, const ActorId actor_id) {
+    const size_t grid_index = static_cast<size_t>(geogrid_id);
+    if (grid_index < grid_to_actors.size()) {
+        std::vector<ActorId> &actor_ids = grid_to_actors[grid_index];
+        auto it = std::find(actor_ids.begin(), actor_ids.end(), actor_id);
+        if (it != actor_ids.end()) {
+            *it = actor_ids.back();
+            actor_ids.pop_back();
+        }
+    }
+}
 
 bool TrackTraffic::IsGeoGridFree(const GeoGridId geogrid_id) const {
-    if (grid_to_actors.find(geogrid_id) != grid_to_actors.end()) {
-        return grid_to_actors.at(geogrid_id).empty();
+    const size_t grid_index = static_cast<size_t>(geogrid_id);
+    if (grid_index < grid_to_actors.size()) {
+        return grid_to_actors[grid_index].empty();
     }
     return true;
 }
 
 void TrackTraffic::AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id) {
-    if (grid_to_actors.find(geogrid_id) == grid_to_actors.end()) {
-        grid_to_actors.insert({geogrid_id, {actor_id}});
+    if (IsGeoGridFree(geogrid_id)) {
+        AddActorToGrid(geogrid_id, actor_id);
+        // Record the grid for the actor too, so that it is released
+        // with the next update of the actor's path.
+        GeoGridList &current_grids = actor_to_grids[actor_id];
+        auto it = std::lower_bound(current_grids.begin(), current_grids.end(), geogrid_id);
+        if (it == current_grids.end() || *it != geogrid_id) {
+            current_grids.insert(it, geogrid_id);
+        }
     }
 }
 
@@ -98,75 +129,71 @@ cg::Location TrackTraffic::GetHeroLocation() const {
     return hero_location;
 }
 
-ActorIdSet TrackTraffic::GetOverlappingVehicles(ActorId actor_id) const {
-    ActorIdSet actor_id_set;
+void TrackTraffic::GetOverlappingVehicles(ActorId actor_id, std::vector<ActorId> &overlapping) const {
+    overlapping.clear();
 
-    if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        const std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
-        for (auto &grid_id : grid_ids) {
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                const ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                actor_id_set.insert(actor_ids.begin(), actor_ids.end());
-            }
+    auto it = actor_to_grids.find(actor_id);
+    if (it != actor_to_grids.end()) {
+        for (const GeoGridId grid_id : it->second) {
+            const std::vector<ActorId> &actor_ids = grid_to_actors[static_cast<size_t>(grid_id)];
+            overlapping.insert(overlapping.end(), actor_ids.begin(), actor_ids.end());
         }
+        // Paths share several grids with their neighbours.
+        std::sort(overlapping.begin(), overlapping.end());
+        overlapping.erase(std::unique(overlapping.begin(), overlapping.end()), overlapping.end());
     }
-
-    return actor_id_set;
 }
 
 void TrackTraffic::DeleteActor(ActorId actor_id) {
-    if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
-        for (auto &grid_id : grid_ids) {
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                actor_ids.erase(actor_id);
-                }
-            }
-        actor_to_grids.erase(actor_id);
+    auto it = actor_to_grids.find(actor_id);
+    if (it != actor_to_grids.end()) {
+        for (const GeoGridId grid_id : it->second) {
+            RemoveActorFromGrid(grid_id, actor_id);
+        }
+        actor_to_grids.erase(it);
     }
 
     if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
         WaypointIdSet waypoint_id_set = waypoint_occupied.at(actor_id);
-        for (const uint64_t &waypoint_id : waypoint_id_set) {
-            RemovePassingVehicle(waypoint_id, actor_id);
+        for (const WaypointIndex &waypoint_index : waypoint_id_set) {
+            RemovePassingVehicle(waypoint_index, actor_id);
         }
     }
 }
 
-void TrackTraffic::UpdatePassingVehicle(uint64_t waypoint_id, ActorId actor_id) {
-    if (waypoint_overlap_tracker.find(waypoint_id) != waypoint_overlap_tracker.end()) {
-        ActorIdSet &actor_id_set = waypoint_overlap_tracker.at(waypoint_id);
+void TrackTraffic::UpdatePassingVehicle(WaypointIndex waypoint_index, ActorId actor_id) {
+    if (waypoint_overlap_tracker.find(waypoint_index) != waypoint_overlap_tracker.end()) {
+        ActorIdSet &actor_id_set = waypoint_overlap_tracker.at(waypoint_index);
         if (actor_id_set.find(actor_id) == actor_id_set.end()) {
             actor_id_set.insert(actor_id);
         }
     } else {
-        waypoint_overlap_tracker.insert({waypoint_id, {actor_id}});
+        waypoint_overlap_tracker.insert({waypoint_index, {actor_id}});
     }
 
     if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
         WaypointIdSet &waypoint_id_set = waypoint_occupied.at(actor_id);
-        if (waypoint_id_set.find(waypoint_id) == waypoint_id_set.end()) {
-            waypoint_id_set.insert(waypoint_id);
+        if (waypoint_id_set.find(waypoint_index) == waypoint_id_set.end()) {
+            waypoint_id_set.insert(waypoint_index);
         }
     } else {
-        waypoint_occupied.insert({actor_id, {waypoint_id}});
+        waypoint_occupied.insert({actor_id, {waypoint_index}});
     }
 }
 
-void TrackTraffic::RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id) {
-    if (waypoint_overlap_tracker.find(waypoint_id) != waypoint_overlap_tracker.end()) {
-        ActorIdSet &actor_id_set = waypoint_overlap_tracker.at(waypoint_id);
+void TrackTraffic::RemovePassingVehicle(WaypointIndex waypoint_index, ActorId actor_id) {
+    if (waypoint_overlap_tracker.find(waypoint_index) != waypoint_overlap_tracker.end()) {
+        ActorIdSet &actor_id_set = waypoint_overlap_tracker.at(waypoint_index);
         actor_id_set.erase(actor_id);
 
         if (actor_id_set.size() == 0) {
-            waypoint_overlap_tracker.erase(waypoint_id);
+            waypoint_overlap_tracker.erase(waypoint_index);
         }
     }
 
     if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
         WaypointIdSet &waypoint_id_set = waypoint_occupied.at(actor_id);
-        waypoint_id_set.erase(waypoint_id);
+        waypoint_id_set.erase(waypoint_index);
 
         if (waypoint_id_set.size() == 0) {
             waypoint_occupied.erase(actor_id);
@@ -174,10 +201,10 @@ void TrackTraffic::RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id)
     }
 }
 
-ActorIdSet TrackTraffic::GetPassingVehicles(uint64_t waypoint_id) const {
+ActorIdSet TrackTraffic::GetPassingVehicles(WaypointIndex waypoint_index) const {
 
-    if (waypoint_overlap_tracker.find(waypoint_id) != waypoint_overlap_tracker.end()) {
-        return waypoint_overlap_tracker.at(waypoint_id);
+    if (waypoint_overlap_tracker.find(waypoint_index) != waypoint_overlap_tracker.end()) {
+        return waypoint_overlap_tracker.at(waypoint_index);
     } else {
         return ActorIdSet();
     }
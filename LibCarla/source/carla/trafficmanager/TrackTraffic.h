@@ -5,6 +5,7 @@
 #include "carla/rpc/ActorId.h"
 
 #include "carla/trafficmanager/SimpleWaypoint.h"
+#include "carla/trafficmanager/WaypointBuffer.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -12,43 +13,56 @@ namespace traffic_manager {
 using ActorId = carla::ActorId;
 using ActorIdSet = std::unordered_set<ActorId>;
 using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-using Buffer = std::deque<SimpleWaypointPtr>;
+using Buffer = WaypointBuffer;
 using GeoGridId = carla::road::JuncId;
+using GeoGridList = std::vector<GeoGridId>;
 
 // This class is used to track the waypoint occupancy of all the actors.
 class TrackTraffic {
 
 private:
     /// Structure to keep track of overlapping waypoints between vehicles.
-    using WaypointOverlap = std::unordered_map<uint64_t, ActorIdSet>;
+    using WaypointOverlap = std::unordered_map<WaypointIndex, ActorIdSet>;
     WaypointOverlap waypoint_overlap_tracker;
 
     /// Structure to keep track of waypoints occupied by vehicles;
-    using WaypointIdSet = std::unordered_set<uint64_t>;
+    using WaypointIdSet = std::unordered_set<WaypointIndex>;
     using WaypointOccupancyMap = std::unordered_map<ActorId, WaypointIdSet>;
     WaypointOccupancyMap waypoint_occupied;
 
-    /// Geodesic grids occupied by actors's paths.
-    std::unordered_map<ActorId, std::unordered_set<GeoGridId>> actor_to_grids;
-    /// Actors currently passing through grids.
-    std::unordered_map<GeoGridId, ActorIdSet> grid_to_actors;
+    /// Geodesic grids occupied by actors's paths, sorted by grid id.
+    std::unordered_map<ActorId, GeoGridList> actor_to_grids;
+    /// Actors currently passing through grids, indexed by grid id.
+    std::vector<std::vector<ActorId>> grid_to_actors;
+    /// Grids of the path being updated, reused between updates.
+    GeoGridList grid_scratch;
     /// Current hero location.
     cg::Location hero_location = cg::Location(0,0,0);
 
+    void AddActorToGrid(const GeoGridId geogrid_id, const ActorId actor_id);
+    void RemoveActorFromGrid(const GeoGridId geogrid_id, const ActorId actor_id);
+
+    /// Replaces the grids of an actor with the grids in @a grids, which are
+    /// sorted in place. Only the grids the actor enters or leaves are updated.
+    void SetActorGrids(const ActorId actor_id, GeoGridList &grids);
 
 public:
     TrackTraffic();
 
-    /// Methods to update, remove and retrieve vehicles passing through a waypoint.
-    void UpdatePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
-    void RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
-    ActorIdSet GetPassingVehicles(uint64_t waypoint_id) const;
+    /// Methods to update, remove and retrieve vehicles passing through a waypoint,
+    /// given by its index in the local map's WaypointGraph.
+    void UpdatePassingVehicle(WaypointIndex waypoint_index, ActorId actor_id);
+    void RemovePassingVehicle(WaypointIndex waypoint_index, ActorId actor_id);
+    ActorIdSet GetPassingVehicles(WaypointIndex waypoint_index) const;
 
     void UpdateGridPosition(const ActorId actor_id, const Buffer &buffer);
     void UpdateUnregisteredGridPosition(const ActorId actor_id,
                                         const std::vector<SimpleWaypointPtr> waypoints);
 
-    ActorIdSet GetOverlappingVehicles(ActorId actor_id) const;
+    /// Retrieves the actors whose paths share a geodesic grid with the path
+    /// of @a actor_id, including itself, sorted by id. @a overlapping is
+    /// cleared first so the caller can reuse it between queries.
+    void GetOverlappingVehicles(ActorId actor_id, std::vector<ActorId> &overlapping) const;
     bool IsGeoGridFree(const GeoGridId geogrid_id) const;
     void AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id);
 
@@ -32,9 +32,10 @@ void TrafficLightStage::Update(const unsigned long index) {
   const ActorId ego_actor_id = vehicle_id_list.at(index);
   if (!simulation_state.IsDormant(ego_actor_id)) {
     const Buffer &waypoint_buffer = buffer_map.at(ego_actor_id);
-    const SimpleWaypointPtr look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
+    const WaypointGraph &graph = waypoint_buffer.GetGraph();
+    const WaypointIndex look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
 
-    const JunctionID junction_id = look_ahead_point->GetWaypoint()->GetJunctionId();
+    const JunctionID junction_id = graph.GetSimpleWaypoint(look_ahead_point)->GetJunctionId();
     current_timestamp = world.GetSnapshot().GetTimestamp();
 
     const TrafficLightState tl_state = simulation_state.GetTLS(ego_actor_id);
@@ -46,16 +47,16 @@ void TrafficLightStage::Update(const unsigned long index) {
     if (is_at_traffic_light &&
         traffic_light_state != TLS::Green &&
         traffic_light_state != TLS::Off &&
-        parameters.GetPercentageRunningLight(ego_actor_id) <= random_devices.at(ego_actor_id).next()) {
+        parameters.GetSnapshot()[index].perc_run_traffic_light <= random_devices.at(ego_actor_id).next()) {
 
       traffic_light_hazard = true;
     }
     // Handle entry negotiation at non-signalised junction.
-    else if (look_ahead_point->CheckJunction() &&
+    else if (graph.IsJunction(look_ahead_point) &&
             !is_at_traffic_light &&
             traffic_light_state != TLS::Green &&
             traffic_light_state != TLS::Off &&
-            parameters.GetPercentageRunningSign(ego_actor_id) <= random_devices.at(ego_actor_id).next()) {
+            parameters.GetSnapshot()[index].perc_run_traffic_sign <= random_devices.at(ego_actor_id).next()) {
 
       traffic_light_hazard = HandleNonSignalisedJunction(ego_actor_id, junction_id, current_timestamp);
     }
@@ -65,6 +65,45 @@ public:
     }
   }
 
+  /// Method to set the number of threads used to run the per-vehicle stage updates.
+  /// Values of 0 or 1 run every stage on the traffic manager thread.
+  void SetWorkerThreads(const uint64_t number_of_threads) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetWorkerThreads(number_of_threads);
+    }
+  }
+
+  /// Method to split the town in @a number_of_regions regions, each driven by
+  /// its own traffic manager, and drive @a region with this one. The traffic
+  /// manager of region i must listen on the port of region 0 plus i.
+  void SetRegion(const uint64_t region, const uint64_t number_of_regions) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetRegion(region, number_of_regions);
+    }
+  }
+
+  /// Method to set the level of detail tiers. Vehicles farther than radii[i]
+  /// from every hero vehicle are updated once every update_intervals[i] cycles,
+  /// checking only their lane leader for collisions.
+  void SetLevelOfDetail(const std::vector<float> radii, const std::vector<uint64_t> update_intervals) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetLevelOfDetail(radii, update_intervals);
+    }
+  }
+
+  /// Method to get the number of vehicles in every level of detail tier in
+  /// the last cycle, starting by the vehicles updated every cycle.
+  std::vector<uint64_t> GetLevelOfDetailCounts() {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      return tm_ptr->GetLevelOfDetailCounts();
+    }
+    return {};
+  }
+
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
     TrafficManagerBase* tm_ptr = GetTM(_port);
@@ -7,7 +7,9 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "carla/client/Actor.h"
+#include "carla/rpc/Command.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
 
 namespace carla {
@@ -96,6 +98,11 @@ public:
   /// Method to provide synchronous tick
   virtual bool SynchronousTick() = 0;
 
+  /// Method to provide synchronous tick to a shard of the town ticked by
+  /// another process, returning the commands of its cycle to be sent by
+  /// that process instead of sending them to the simulator.
+  virtual std::vector<carla::rpc::Command> SynchronousTickShard() = 0;
+
   /// Get carla episode information
   virtual  carla::client::detail::EpisodeProxy& GetEpisodeProxy() = 0;
 
@@ -123,6 +130,24 @@ public:
   /// Method to set Open Street Map mode.
   virtual void SetOSMMode(const bool mode_switch) = 0;
 
+  /// Method to set the number of threads used to run the per-vehicle stage updates.
+  /// Values of 0 or 1 run every stage on the traffic manager thread.
+  virtual void SetWorkerThreads(const uint64_t number_of_threads) = 0;
+
+  /// Method to split the town in @a number_of_regions regions, each driven by
+  /// its own traffic manager, and drive @a region with this one. The traffic
+  /// manager of region i must listen on the port of region 0 plus i.
+  virtual void SetRegion(const uint64_t region, const uint64_t number_of_regions) = 0;
+
+  /// Method to set the level of detail tiers. Vehicles farther than radii[i]
+  /// from every hero vehicle are updated once every update_intervals[i] cycles,
+  /// checking only their lane leader for collisions.
+  virtual void SetLevelOfDetail(const std::vector<float> radii, const std::vector<uint64_t> update_intervals) = 0;
+
+  /// Method to get the number of vehicles in every level of detail tier in
+  /// the last cycle, starting by the vehicles updated every cycle.
+  virtual std::vector<uint64_t> GetLevelOfDetailCounts() = 0;
+
   /// Method to set our own imported path.
   virtual void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) = 0;
 
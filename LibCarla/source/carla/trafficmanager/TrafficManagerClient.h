@@ -8,6 +8,7 @@
 
 #include "carla/trafficmanager/Constants.h"
 #include "carla/rpc/Actor.h"
+#include "carla/rpc/Command.h"
 
 #include <rpc/client.h>
 
@@ -162,6 +163,13 @@ public:
     return _client->call("synchronous_tick").as<bool>();
   }
 
+  /// Method to provide synchronous tick to a shard of the town, returning
+  /// the commands of its cycle.
+  std::vector<carla::rpc::Command> SynchronousTickShard() {
+    DEBUG_ASSERT(_client != nullptr);
+    return _client->call("synchronous_tick_shard").as<std::vector<carla::rpc::Command>>();
+  }
+
   /// Check if remote traffic manager is alive
   void HealthCheckRemoteTM() {
     DEBUG_ASSERT(_client != nullptr);
@@ -217,6 +225,30 @@ public:
     _client->call("set_osm_mode", mode_switch);
   }
 
+  /// Method to set the number of threads used to run the per-vehicle stage updates.
+  void SetWorkerThreads(const uint64_t number_of_threads) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_worker_threads", number_of_threads);
+  }
+
+  /// Method to set the region of the town driven by the traffic manager.
+  void SetRegion(const uint64_t region, const uint64_t number_of_regions) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_region", region, number_of_regions);
+  }
+
+  /// Method to set the level of detail tiers.
+  void SetLevelOfDetail(const std::vector<float> &radii, const std::vector<uint64_t> &update_intervals) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_level_of_detail", radii, update_intervals);
+  }
+
+  /// Method to get the number of vehicles in every level of detail tier.
+  std::vector<uint64_t> GetLevelOfDetailCounts() {
+    DEBUG_ASSERT(_client != nullptr);
+    return _client->call("get_level_of_detail_counts").as<std::vector<uint64_t>>();
+  }
+
   /// Method to set our own imported path.
   void SetCustomPath(const carla::rpc::Actor &actor, const Path path, const bool empty_buffer) {
     DEBUG_ASSERT(_client != nullptr);
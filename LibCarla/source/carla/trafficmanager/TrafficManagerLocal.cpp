@@ -5,17 +5,23 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include <algorithm>
+#include <stdexcept>
 
+#include "carla/Exception.h"
 #include "carla/Logging.h"
 
+#include "carla/client/FileTransfer.h"
 #include "carla/client/detail/Simulator.h"
+#include "carla/profiler/Tracer.h"
 
+#include "carla/trafficmanager/TrafficManagerClient.h"
 #include "carla/trafficmanager/TrafficManagerLocal.h"
 
 namespace carla {
 namespace traffic_manager {
 
 using namespace constants::FrameMemory;
+using constants::Sharding::REGION_HAND_OFF_MARGIN;
 
 TrafficManagerLocal::TrafficManagerLocal(
   std::vector<float> longitudinal_PID_parameters,
@@ -44,13 +50,14 @@ TrafficManagerLocal::TrafficManagerLocal(
                                          localization_frame,
                                          random_devices)),
 
-    collision_stage(CollisionStage(vehicle_id_list,
-                                   simulation_state,
-                                   buffer_map,
-                                   track_traffic,
-                                   parameters,
-                                   collision_frame,
-                                   random_devices)),
+    collision_stage(vehicle_id_list,
+                    simulation_state,
+                    buffer_map,
+                    track_traffic,
+                    parameters,
+                    level_of_detail,
+                    collision_frame,
+                    random_devices),
 
     traffic_light_stage(TrafficLightStage(vehicle_id_list,
                                           simulation_state,
@@ -60,22 +67,23 @@ TrafficManagerLocal::TrafficManagerLocal(
                                           tl_frame,
                                           random_devices)),
 
-    motion_plan_stage(MotionPlanStage(vehicle_id_list,
-                                      simulation_state,
-                                      parameters,
-                                      buffer_map,
-                                      track_traffic,
-                                      longitudinal_PID_parameters,
-                                      longitudinal_highway_PID_parameters,
-                                      lateral_PID_parameters,
-                                      lateral_highway_PID_parameters,
-                                      localization_frame,
-                                      collision_frame,
-                                      tl_frame,
-                                      world,
-                                      control_frame,
-                                      random_devices,
-                                      local_map)),
+    motion_plan_stage(vehicle_id_list,
+                      simulation_state,
+                      parameters,
+                      level_of_detail,
+                      buffer_map,
+                      track_traffic,
+                      longitudinal_PID_parameters,
+                      longitudinal_highway_PID_parameters,
+                      lateral_PID_parameters,
+                      lateral_highway_PID_parameters,
+                      localization_frame,
+                      collision_frame,
+                      tl_frame,
+                      world,
+                      control_frame,
+                      random_devices,
+                      local_map),
 
     vehicle_light_stage(VehicleLightStage(vehicle_id_list,
                                           buffer_map,
@@ -112,25 +120,27 @@ TrafficManagerLocal::TrafficManagerLocal(
 TrafficManagerLocal::~TrafficManagerLocal() {
   episode_proxy.Lock()->DestroyTrafficManager(server.port());
   Release();
+  LeaveShardBatch();
 }
 
 void TrafficManagerLocal::SetupLocalMap() {
   const carla::SharedPtr<const cc::Map> world_map = world.GetMap();
   local_map = std::make_shared<InMemoryMap>(world_map);
 
+  // Required files are downloaded to the cache folder if missing, so the
+  // cache can be memory-mapped from there instead of read into memory.
   auto files = episode_proxy.Lock()->GetRequiredFiles("TM");
-  if (!files.empty()) {
-    auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
-    if (content.size() != 0) {
-      local_map->Load(content);
-    } else {
-      log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
+  if (!files.empty() && cc::FileTransfer::FileExists(files[0])) {
+    if (!local_map->Load(cc::FileTransfer::GetFullPath(files[0]))) {
+      log_warning("Could not load the InMemoryMap cache. Setting up local map. This may take a while...");
       local_map->SetUp();
     }
   } else {
     log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
     local_map->SetUp();
   }
+
+  region_partition = RegionPartition(local_map->GetWaypointGraph(), number_of_regions);
 }
 
 void TrafficManagerLocal::Start() {
@@ -180,9 +190,16 @@ void TrafficManagerLocal::Run() {
       last_frame = timestamp.frame;
     }
 
+    CARLA_TRACE_SCOPE(trafficmanager, cycle);
+
+    UpdateStageThreadPool();
+
     std::unique_lock<std::mutex> registration_lock(registration_mutex);
     // Updating simulation state, actor life cycle and performing necessary cleanup.
-    alsm.Update();
+    {
+      CARLA_TRACE_SCOPE(trafficmanager, alsm);
+      alsm.Update();
+    }
 
 
     // Re-allocating inter-stage communication frames based on changed number of registered vehicles.
@@ -224,38 +241,232 @@ void TrafficManagerLocal::Run() {
     // that will be inserted by the motion_plan_stage stage.
     control_frame.resize(number_of_vehicles);
 
+    // Publish the parameters set since the last cycle, the stages read them
+    // from the snapshot without locking.
+    parameters.UpdateSnapshot(vehicle_id_list);
+
+    // Vehicles far from the heroes are only updated in some cycles. The
+    // collision and motion planning stages handle the vehicles skipped in
+    // this cycle, the other stages leave them as they are.
+    level_of_detail.Update(parameters.GetLevelOfDetail(), vehicle_id_list,
+                           simulation_state, alsm.GetHeroLocations());
+
     // Run core operation stages.
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      localization_stage.Update(index);
+    // Localization updates the path tracking of every vehicle and reads the
+    // buffers of its neighbours, so it is always run sequentially.
+    {
+      CARLA_TRACE_SCOPE(trafficmanager, localization_stage);
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        if (level_of_detail.IsScheduled(index)) {
+          localization_stage.Update(index);
+        }
+      }
     }
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      collision_stage.Update(index);
+    {
+      CARLA_TRACE_SCOPE(trafficmanager, collision_stage);
+      collision_stage.PrepareCycle();
+      RunStage([this](const unsigned long index) { collision_stage.Update(index); });
+      collision_stage.CommitCollisionLocks();
+      collision_stage.ClearCycleCache();
     }
-    collision_stage.ClearCycleCache();
     vehicle_light_stage.UpdateWorldInfo();
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      traffic_light_stage.Update(index);
-      motion_plan_stage.Update(index);
-      vehicle_light_stage.Update(index);
+    motion_plan_stage.UpdateWorldInfo();
+    // Junction tickets are handed out in vehicle order, so the traffic light
+    // response is run sequentially.
+    {
+      CARLA_TRACE_SCOPE(trafficmanager, traffic_light_stage);
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        if (level_of_detail.IsScheduled(index)) {
+          traffic_light_stage.Update(index);
+        }
+      }
+    }
+    {
+      CARLA_TRACE_SCOPE(trafficmanager, motion_plan_stage);
+      RunStage([this](const unsigned long index) { motion_plan_stage.Update(index); });
+      motion_plan_stage.ResolveTeleportation();
     }
+    {
+      CARLA_TRACE_SCOPE(trafficmanager, vehicle_light_stage);
+      for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        if (level_of_detail.IsScheduled(index)) {
+          vehicle_light_stage.Update(index);
+        }
+      }
+    }
+
+    const auto vehicles_leaving_region = GetVehiclesLeavingRegion();
+    std::shared_ptr<ShardBatch> batch = shard_batch;
+    const uint64_t batch_region = region;
+    const uint16_t first_region_port = static_cast<uint16_t>(server.port() - region);
 
     registration_lock.unlock();
 
     // Sending the current cycle's batch command to the simulator.
+    {
+      CARLA_TRACE_SCOPE(trafficmanager, apply_batch);
+      if (synchronous_mode && return_control_frame.load()) {
+        // The process ticking this shard sends them with the commands of
+        // the shards running there.
+        returned_control_frame = control_frame;
+      } else {
+        ApplyControlFrame(batch, batch_region, synchronous_mode);
+      }
+    }
     if (synchronous_mode) {
-      episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
       step_end.store(true);
       step_end_trigger.notify_one();
-    } else {
-      if (control_frame.size() > 0){
-        episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+    }
+
+    // The vehicles keep the commands of this cycle, and are driven by the
+    // traffic manager of their new region from the next one.
+    if (!vehicles_leaving_region.empty()) {
+      CARLA_TRACE_SCOPE(trafficmanager, hand_off);
+      HandOffVehicles(vehicles_leaving_region, first_region_port);
+    }
+  }
+}
+
+std::unordered_map<uint64_t, std::vector<ActorPtr>> TrafficManagerLocal::GetVehiclesLeavingRegion() {
+  std::unordered_map<uint64_t, std::vector<ActorPtr>> vehicles_per_region;
+  if (number_of_regions < 2u) {
+    return vehicles_per_region;
+  }
+  for (const ActorPtr &vehicle : registered_vehicles.GetList()) {
+    const ActorId actor_id = vehicle->GetId();
+    if (!simulation_state.ContainsActor(actor_id)) {
+      continue;
+    }
+    const cg::Location location = simulation_state.GetLocation(actor_id);
+    // Vehicles close to the border stay in this region, so that a vehicle
+    // driving along it is not handed back and forth.
+    if (!region_partition.IsInRegion(location, region, REGION_HAND_OFF_MARGIN)) {
+      vehicles_per_region[region_partition.GetRegion(location)].push_back(vehicle);
+    }
+  }
+  return vehicles_per_region;
+}
+
+void TrafficManagerLocal::HandOffVehicles(
+    const std::unordered_map<uint64_t, std::vector<ActorPtr>> &vehicles_per_region,
+    const uint16_t first_region_port) {
+  for (const auto &entry : vehicles_per_region) {
+    const uint16_t port = static_cast<uint16_t>(first_region_port + entry.first);
+    try {
+      if (!episode_proxy.Lock()->IsTrafficManagerRunning(port)) {
+        log_warning("No traffic manager running on port", port, "for region", entry.first);
+        continue;
+      }
+      const std::pair<std::string, uint16_t> server_info = episode_proxy.Lock()->GetTrafficManagerRunning(port);
+      std::vector<carla::rpc::Actor> actor_list;
+      for (const ActorPtr &vehicle : entry.second) {
+        actor_list.emplace_back(vehicle->Serialize());
       }
+      TrafficManagerClient client(server_info.first, server_info.second);
+      client.RegisterVehicle(actor_list);
+    } catch (const std::exception &e) {
+      log_warning("Could not hand off vehicles to the traffic manager of region", entry.first, ":", e.what());
+      continue;
     }
+    // Vehicles of other regions are still tracked as unregistered actors,
+    // so they are taken into account for collision avoidance.
+    UnregisterVehicles(entry.second);
+  }
+}
+
+void TrafficManagerLocal::LeaveShardBatch() {
+  if (shard_batch == nullptr) {
+    return;
+  }
+  // The other shards may be waiting for this one to send their commands.
+  ShardBatch::CommandList commands;
+  if (shard_batch->Leave(region, commands)) {
+    try {
+      episode_proxy.Lock()->ApplyBatchSync(commands, false);
+    } catch (const std::exception &e) {
+      log_warning("Could not send the commands of the traffic manager shards:", e.what());
+    }
+  }
+  shard_batch.reset();
+}
+
+void TrafficManagerLocal::ApplyControlFrame(
+    std::shared_ptr<ShardBatch> batch,
+    const uint64_t batch_region,
+    const bool apply_empty) {
+  const ControlFrame *commands = &control_frame;
+  if (batch != nullptr) {
+    if (!batch->Add(batch_region, control_frame, shard_commands)) {
+      // The last shard of the town to finish its cycle sends the batch.
+      return;
+    }
+    commands = &shard_commands;
+  }
+  if (apply_empty || !commands->empty()) {
+    episode_proxy.Lock()->ApplyBatchSync(*commands, false);
+  }
+}
+
+void TrafficManagerLocal::UpdateStageThreadPool() {
+  const uint64_t worker_threads = parameters.GetWorkerThreads();
+  if (worker_threads != stage_worker_threads) {
+    stage_thread_pool.reset();
+    // The traffic manager thread takes part in every stage,
+    // so the pool only needs the remaining threads.
+    if (worker_threads > 1u) {
+      stage_thread_pool = std::make_unique<ThreadPool>();
+      stage_thread_pool->AsyncRun(worker_threads - 1u);
+    }
+    stage_worker_threads = worker_threads;
+  }
+}
+
+void TrafficManagerLocal::RunStage(const std::function<void(const unsigned long)> &stage_update) {
+  const unsigned long number_of_vehicles = vehicle_id_list.size();
+
+  if (stage_thread_pool == nullptr || number_of_vehicles < 2u) {
+    for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+      stage_update(index);
+    }
+    return;
+  }
+
+  const unsigned long number_of_chunks = std::min<unsigned long>(stage_worker_threads, number_of_vehicles);
+  const unsigned long chunk_size = (number_of_vehicles + number_of_chunks - 1u) / number_of_chunks;
+
+  std::vector<std::future<void>> chunks;
+  chunks.reserve(number_of_chunks);
+  for (unsigned long begin = chunk_size; begin < number_of_vehicles; begin += chunk_size) {
+    const unsigned long end = std::min(begin + chunk_size, number_of_vehicles);
+    chunks.emplace_back(stage_thread_pool->Post([&stage_update, begin, end]() {
+      CARLA_TRACE_SCOPE(trafficmanager, stage_chunk);
+      for (unsigned long index = begin; index < end; ++index) {
+        stage_update(index);
+      }
+    }));
+  }
+
+  // The first chunk is run on the traffic manager thread.
+  try {
+    for (unsigned long index = 0u; index < chunk_size; ++index) {
+      stage_update(index);
+    }
+  } catch (...) {
+    for (auto &chunk : chunks) {
+      chunk.wait();
+    }
+    throw;
+  }
+
+  // Waiting for every chunk acts as the barrier between stages.
+  for (auto &chunk : chunks) {
+    chunk.get();
   }
 }
 
 bool TrafficManagerLocal::SynchronousTick() {
   if (parameters.GetSynchronousMode()) {
+    CARLA_TRACE_SCOPE(trafficmanager, synchronous_tick);
     step_begin.store(true);
     step_begin_trigger.notify_one();
 
@@ -266,6 +477,18 @@ bool TrafficManagerLocal::SynchronousTick() {
   return true;
 }
 
+std::vector<carla::rpc::Command> TrafficManagerLocal::SynchronousTickShard() {
+  ControlFrame commands;
+  if (parameters.GetSynchronousMode()) {
+    return_control_frame.store(true);
+    SynchronousTick();
+    return_control_frame.store(false);
+    commands = std::move(returned_control_frame);
+    returned_control_frame.clear();
+  }
+  return commands;
+}
+
 void TrafficManagerLocal::Stop() {
 
   run_traffic_manger.store(false);
@@ -280,6 +503,9 @@ void TrafficManagerLocal::Stop() {
     worker_thread.release();
   }
 
+  stage_thread_pool.reset();
+  stage_worker_threads = 0u;
+
   vehicle_id_list.clear();
   registered_vehicles.Clear();
   registered_vehicles_state = -1;
@@ -293,6 +519,7 @@ void TrafficManagerLocal::Stop() {
   collision_stage.Reset();
   traffic_light_stage.Reset();
   motion_plan_stage.Reset();
+  level_of_detail.Reset();
 
   buffer_map.clear();
   localization_frame.clear();
@@ -415,6 +642,36 @@ void TrafficManagerLocal::SetOSMMode(const bool mode_switch) {
   parameters.SetOSMMode(mode_switch);
 }
 
+void TrafficManagerLocal::SetWorkerThreads(const uint64_t number_of_threads) {
+  parameters.SetWorkerThreads(number_of_threads);
+}
+
+void TrafficManagerLocal::SetRegion(const uint64_t _region, const uint64_t _number_of_regions) {
+  RegionPartition::CheckRegion(_region, _number_of_regions);
+  if (_region > server.port()) {
+    throw_exception(std::invalid_argument("the traffic manager of the first region would not have a valid port"));
+  }
+  std::lock_guard<std::mutex> registration_lock(registration_mutex);
+  LeaveShardBatch();
+  number_of_regions = _number_of_regions;
+  region = _region;
+  if (local_map != nullptr) {
+    region_partition = RegionPartition(local_map->GetWaypointGraph(), number_of_regions);
+  }
+  if (number_of_regions > 1u) {
+    shard_batch = ShardBatch::Get(static_cast<uint16_t>(server.port() - region));
+    shard_batch->Join(region);
+  }
+}
+
+void TrafficManagerLocal::SetLevelOfDetail(const std::vector<float> radii, const std::vector<uint64_t> update_intervals) {
+  parameters.SetLevelOfDetail(radii, update_intervals);
+}
+
+std::vector<uint64_t> TrafficManagerLocal::GetLevelOfDetailCounts() {
+  return level_of_detail.GetTierCounts();
+}
+
 void TrafficManagerLocal::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   parameters.SetCustomPath(actor, path, empty_buffer);
 }
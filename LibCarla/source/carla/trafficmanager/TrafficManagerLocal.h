@@ -8,6 +8,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <functional>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -17,11 +18,15 @@
 #include "carla/client/World.h"
 #include "carla/Memory.h"
 #include "carla/rpc/Command.h"
+#include "carla/ThreadPool.h"
 
 #include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/InMemoryMap.h"
+#include "carla/trafficmanager/LevelOfDetail.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
+#include "carla/trafficmanager/RegionPartition.h"
+#include "carla/trafficmanager/ShardBatch.h"
 #include "carla/trafficmanager/SimulationState.h"
 #include "carla/trafficmanager/TrackTraffic.h"
 #include "carla/trafficmanager/TrafficManagerBase.h"
@@ -88,6 +93,8 @@ private:
   ControlFrame control_frame;
   /// Variable to keep track of currently reserved array space for frames.
   uint64_t current_reserved_capacity {0u};
+  /// Level of detail of every vehicle in the current cycle.
+  LevelOfDetail level_of_detail;
   /// Various stages representing core operations of traffic manager.
   LocalizationStage localization_stage;
   CollisionStage collision_stage;
@@ -102,6 +109,11 @@ private:
   /// Flags to signal step begin and end.
   std::atomic<bool> step_begin{false};
   std::atomic<bool> step_end{false};
+  /// Flag to return the commands of the synchronous step to the process
+  /// ticking this shard instead of sending them.
+  std::atomic<bool> return_control_frame{false};
+  /// Commands of the last synchronous step returned to that process.
+  ControlFrame returned_control_frame;
   /// Mutex for progressing synchronous execution.
   std::mutex step_execution_mutex;
   /// Condition variables for progressing synchronous execution.
@@ -109,6 +121,10 @@ private:
   std::condition_variable step_end_trigger;
   /// Single worker thread for sequential execution of sub-components.
   std::unique_ptr<std::thread> worker_thread;
+  /// Thread pool used to run the per-vehicle stage updates in parallel.
+  std::unique_ptr<ThreadPool> stage_thread_pool;
+  /// Number of threads currently running the per-vehicle stage updates.
+  uint64_t stage_worker_threads {0u};
   /// Structure holding random devices per vehicle.
   RandomGeneratorMap random_devices;
   /// Randomization seed.
@@ -117,10 +133,46 @@ private:
   std::vector<ActorId> marked_for_removal;
   /// Mutex to prevent vehicle registration during frame array re-allocation.
   std::mutex registration_mutex;
+  /// Region of the town driven by this traffic manager, out of
+  /// number_of_regions traffic managers sharing the town.
+  uint64_t region {0u};
+  uint64_t number_of_regions {1u};
+  /// Partition of the local map in the regions of the town.
+  RegionPartition region_partition;
+  /// Commands shared with the other shards of the town running in this process.
+  std::shared_ptr<ShardBatch> shard_batch;
+  /// Combined commands of the shards sent by this traffic manager.
+  ShardBatch::CommandList shard_commands;
 
   /// Method to check if all traffic lights are frozen in a group.
   bool CheckAllFrozen(TLGroup tl_to_freeze);
 
+  /// Method to resize the stage thread pool to the requested number of threads.
+  void UpdateStageThreadPool();
+
+  /// Method to run a stage update for every registered vehicle. Vehicles are
+  /// split in contiguous chunks across the stage thread pool, and the method
+  /// returns once all of them have been updated.
+  void RunStage(const std::function<void(const unsigned long)> &stage_update);
+
+  /// Method to find the vehicles that left the region of this traffic manager,
+  /// grouped by their new region.
+  std::unordered_map<uint64_t, std::vector<ActorPtr>> GetVehiclesLeavingRegion();
+
+  /// Method to register vehicles with the traffic manager of their new region
+  /// and unregister them from this one. The traffic manager of region i
+  /// listens on @a first_region_port plus i.
+  void HandOffVehicles(const std::unordered_map<uint64_t, std::vector<ActorPtr>> &vehicles_per_region,
+                       const uint16_t first_region_port);
+
+  /// Method to leave the shards of the town running in this process, sending
+  /// the commands of the others if they were only waiting for this one.
+  void LeaveShardBatch();
+
+  /// Method to send the commands of the cycle to the simulator, combined with
+  /// the commands of the other shards of the town running in this process.
+  void ApplyControlFrame(std::shared_ptr<ShardBatch> batch, const uint64_t batch_region, const bool apply_empty);
+
 public:
   /// Private constructor for singleton lifecycle management.
   TrafficManagerLocal(std::vector<float> longitudinal_PID_parameters,
@@ -204,6 +256,11 @@ public:
   /// Method to provide synchronous tick.
   bool SynchronousTick();
 
+  /// Method to provide synchronous tick to this shard from another process,
+  /// returning the commands of the cycle. In asynchronous mode the shard
+  /// sends its commands itself, and none are returned.
+  std::vector<carla::rpc::Command> SynchronousTickShard();
+
   /// Get CARLA episode information.
   carla::client::detail::EpisodeProxy &GetEpisodeProxy();
 
@@ -235,6 +292,24 @@ public:
   /// Method to set Open Street Map mode.
   void SetOSMMode(const bool mode_switch);
 
+  /// Method to set the number of threads used to run the per-vehicle stage updates.
+  /// Values of 0 or 1 run every stage on the traffic manager thread.
+  void SetWorkerThreads(const uint64_t number_of_threads);
+
+  /// Method to split the town in @a number_of_regions regions, each driven by
+  /// its own traffic manager, and drive @a region with this one. The traffic
+  /// manager of region i must listen on the port of region 0 plus i.
+  void SetRegion(const uint64_t region, const uint64_t number_of_regions);
+
+  /// Method to set the level of detail tiers. Vehicles farther than radii[i]
+  /// from every hero vehicle are updated once every update_intervals[i] cycles,
+  /// checking only their lane leader for collisions.
+  void SetLevelOfDetail(const std::vector<float> radii, const std::vector<uint64_t> update_intervals);
+
+  /// Method to get the number of vehicles in every level of detail tier in
+  /// the last cycle, starting by the vehicles updated every cycle.
+  std::vector<uint64_t> GetLevelOfDetailCounts();
+
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer);
 
@@ -6,8 +6,10 @@
 
 #include <thread>
 
+#include "carla/Logging.h"
 #include "carla/client/detail/Simulator.h"
 
+#include "carla/trafficmanager/RegionPartition.h"
 #include "carla/trafficmanager/TrafficManagerRemote.h"
 
 namespace carla {
@@ -78,6 +80,24 @@ void TrafficManagerRemote::Stop() {
 
 void TrafficManagerRemote::Release() {
   Stop();
+
+  std::lock_guard<std::mutex> lock(shard_mutex);
+  LeaveShardBatch();
+}
+
+void TrafficManagerRemote::LeaveShardBatch() {
+  if (shard_batch == nullptr) {
+    return;
+  }
+  ShardBatch::CommandList commands;
+  if (shard_batch->Leave(region, commands)) {
+    try {
+      episodeProxyTM.Lock()->ApplyBatchSync(commands, false);
+    } catch (const std::exception &e) {
+      log_warning("Could not send the commands of the traffic manager shards:", e.what());
+    }
+  }
+  shard_batch.reset();
 }
 
 void TrafficManagerRemote::Reset() {
@@ -205,6 +225,36 @@ void TrafficManagerRemote::SetOSMMode(const bool mode_switch) {
   client.SetOSMMode(mode_switch);
 }
 
+void TrafficManagerRemote::SetWorkerThreads(const uint64_t number_of_threads) {
+  client.SetWorkerThreads(number_of_threads);
+}
+
+void TrafficManagerRemote::SetRegion(const uint64_t region, const uint64_t number_of_regions) {
+  RegionPartition::CheckRegion(region, number_of_regions);
+  client.SetRegion(region, number_of_regions);
+
+  std::lock_guard<std::mutex> lock(shard_mutex);
+  LeaveShardBatch();
+  this->region = region;
+  if (number_of_regions > 1u) {
+    // The commands of the remote shard are sent with the ones of the shards
+    // of the town ticked by this process.
+    std::string host;
+    uint16_t port = 0u;
+    client.getServerDetails(host, port);
+    shard_batch = ShardBatch::Get(static_cast<uint16_t>(port - region));
+    shard_batch->Join(region);
+  }
+}
+
+void TrafficManagerRemote::SetLevelOfDetail(const std::vector<float> radii, const std::vector<uint64_t> update_intervals) {
+  client.SetLevelOfDetail(radii, update_intervals);
+}
+
+std::vector<uint64_t> TrafficManagerRemote::GetLevelOfDetailCounts() {
+  return client.GetLevelOfDetailCounts();
+}
+
 void TrafficManagerRemote::SetCustomPath(const ActorPtr &_actor, const Path path, const bool empty_buffer) {
   carla::rpc::Actor actor(_actor->Serialize());
 
@@ -266,7 +316,32 @@ ActionBuffer TrafficManagerRemote::GetActionBuffer(const ActorId &actor_id) {
 }
 
 bool TrafficManagerRemote::SynchronousTick() {
-  return false;
+  // The traffic manager of another process is ticked by that process, unless
+  // it drives a region of the town set from this one.
+  std::lock_guard<std::mutex> lock(shard_mutex);
+  if (shard_batch == nullptr) {
+    return false;
+  }
+  ShardBatch::CommandList commands;
+  try {
+    commands = client.SynchronousTickShard();
+  } catch (const std::exception &e) {
+    log_warning("Could not tick the remote traffic manager:", e.what());
+    return false;
+  }
+  // The last shard of the town to be ticked sends the batch.
+  if (shard_batch->Add(region, commands, shard_commands)) {
+    try {
+      episodeProxyTM.Lock()->ApplyBatchSync(shard_commands, false);
+    } catch (const std::exception &e) {
+      log_warning("Could not send the commands of the traffic manager shards:", e.what());
+    }
+  }
+  return true;
+}
+
+std::vector<carla::rpc::Command> TrafficManagerRemote::SynchronousTickShard() {
+  return client.SynchronousTickShard();
 }
 
 void TrafficManagerRemote::HealthCheckRemoteTM() {
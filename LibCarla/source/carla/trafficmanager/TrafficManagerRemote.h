@@ -12,6 +12,7 @@
 
 #include "carla/client/Actor.h"
 #include "carla/client/detail/EpisodeProxy.h"
+#include "carla/trafficmanager/ShardBatch.h"
 #include "carla/trafficmanager/TrafficManagerBase.h"
 #include "carla/trafficmanager/TrafficManagerClient.h"
 
@@ -117,6 +118,24 @@ public:
   /// Method to set Open Street Map mode.
   void SetOSMMode(const bool mode_switch);
 
+  /// Method to set the number of threads used to run the per-vehicle stage updates.
+  /// Values of 0 or 1 run every stage on the traffic manager thread.
+  void SetWorkerThreads(const uint64_t number_of_threads);
+
+  /// Method to split the town in @a number_of_regions regions, each driven by
+  /// its own traffic manager, and drive @a region with this one. The traffic
+  /// manager of region i must listen on the port of region 0 plus i.
+  void SetRegion(const uint64_t region, const uint64_t number_of_regions);
+
+  /// Method to set the level of detail tiers. Vehicles farther than radii[i]
+  /// from every hero vehicle are updated once every update_intervals[i] cycles,
+  /// checking only their lane leader for collisions.
+  void SetLevelOfDetail(const std::vector<float> radii, const std::vector<uint64_t> update_intervals);
+
+  /// Method to get the number of vehicles in every level of detail tier in
+  /// the last cycle, starting by the vehicles updated every cycle.
+  std::vector<uint64_t> GetLevelOfDetailCounts();
+
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer);
 
@@ -152,9 +171,14 @@ public:
   /// Method to get the vehicle's action buffer.
   ActionBuffer GetActionBuffer(const ActorId &actor_id);
 
-  /// Method to provide synchronous tick
+  /// Method to provide synchronous tick. Only a remote traffic manager
+  /// driving a region of the town is ticked from this process.
   bool SynchronousTick();
 
+  /// Method to provide synchronous tick to the remote shard of the town,
+  /// returning the commands of its cycle.
+  std::vector<carla::rpc::Command> SynchronousTickShard();
+
   /// Get CARLA episode information.
   carla::client::detail::EpisodeProxy& GetEpisodeProxy();
 
@@ -178,6 +202,20 @@ private:
   std::mutex _mutex;
 
   bool _keep_alive = true;
+
+  /// Method to leave the shards of the town ticked by this process, sending
+  /// the commands of the others if they were only waiting for this one.
+  void LeaveShardBatch();
+
+  /// Mutex to protect the shard state from the ticking thread.
+  std::mutex shard_mutex;
+  /// Region of the town driven by the remote traffic manager.
+  uint64_t region {0u};
+  /// Commands shared with the other shards of the town ticked by this
+  /// process, only set if the town is split in regions.
+  std::shared_ptr<ShardBatch> shard_batch;
+  /// Combined commands of the shards sent through this traffic manager.
+  ShardBatch::CommandList shard_commands;
 };
 
 } // namespace traffic_manager
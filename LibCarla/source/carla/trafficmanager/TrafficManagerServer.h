@@ -185,6 +185,26 @@ public:
         tm->SetOSMMode(mode_switch);
       });
 
+      /// Method to set the number of threads used to run the per-vehicle stage updates.
+      server->bind("set_worker_threads", [=](const uint64_t number_of_threads) {
+        tm->SetWorkerThreads(number_of_threads);
+      });
+
+      /// Method to set the region of the town driven by the traffic manager.
+      server->bind("set_region", [=](const uint64_t region, const uint64_t number_of_regions) {
+        tm->SetRegion(region, number_of_regions);
+      });
+
+      /// Method to set the level of detail tiers.
+      server->bind("set_level_of_detail", [=](const std::vector<float> radii, const std::vector<uint64_t> update_intervals) {
+        tm->SetLevelOfDetail(radii, update_intervals);
+      });
+
+      /// Method to get the number of vehicles in every level of detail tier.
+      server->bind("get_level_of_detail_counts", [=]() -> std::vector<uint64_t> {
+        return tm->GetLevelOfDetailCounts();
+      });
+
       /// Method to set our own imported path.
       server->bind("set_path", [=](carla::rpc::Actor actor, const Path path, const bool empty_buffer) {
         tm->SetCustomPath(carla::client::detail::ActorVariant(actor).Get(tm->GetEpisodeProxy()), path, empty_buffer);
@@ -259,6 +279,11 @@ public:
         return tm->SynchronousTick();
       });
 
+      /// Method to provide synchronous tick to a shard of the town.
+      server->bind("synchronous_tick_shard", [=]() -> std::vector<carla::rpc::Command> {
+        return tm->SynchronousTickShard();
+      });
+
       /// Method to check server is alive or not.
       server->bind("health_check_remote_TM", [=](){});
 
@@ -30,7 +30,7 @@ void VehicleLightStage::UpdateWorldInfo() {
 void VehicleLightStage::Update(const unsigned long index) {
   ActorId actor_id = vehicle_id_list.at(index);
 
-  if (!parameters.GetUpdateVehicleLights(actor_id))
+  if (!parameters.GetSnapshot()[index].update_vehicle_lights)
     return; // this vehicle is not set to have automatic lights update
 
   rpc::VehicleLightState::flag_type light_states = uint32_t(-1);
@@ -53,16 +53,17 @@ void VehicleLightStage::Update(const unsigned long index) {
   // Determine if the vehicle is truning left or right by checking the close waypoints
 
   const Buffer& waypoint_buffer = buffer_map.at(actor_id);
-  cg::Location front_location = waypoint_buffer.front()->GetLocation();
+  const WaypointGraph &graph = waypoint_buffer.GetGraph();
+  const cg::Location &front_location = graph.GetLocation(waypoint_buffer.front());
 
-  for (const SimpleWaypointPtr& waypoint : waypoint_buffer) {
-    if (waypoint->CheckJunction()) {
-      RoadOption target_ro = waypoint->GetRoadOption();
+  for (const WaypointIndex waypoint : waypoint_buffer) {
+    if (graph.IsJunction(waypoint)) {
+      RoadOption target_ro = graph.GetRoadOption(waypoint);
       if (target_ro == RoadOption::Left) left_turn_indicator = true;
       else if (target_ro == RoadOption::Right) right_turn_indicator = true;
       break;
     }
-    if (cg::Math::DistanceSquared(front_location, waypoint->GetLocation()) > MAX_DISTANCE_LIGHT_CHECK) {
+    if (graph.DistanceSquared(waypoint, front_location) > MAX_DISTANCE_LIGHT_CHECK) {
       break;
     }
   }
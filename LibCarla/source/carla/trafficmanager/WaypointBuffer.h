@@ -0,0 +1,155 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "carla/Debug.h"
+
+#include "carla/trafficmanager/WaypointGraph.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /// Path of waypoints ahead of a vehicle, stored as a ring buffer of
+  /// indices into the local map's WaypointGraph.
+  ///
+  /// The storage only grows, so once a vehicle's horizon has been reached
+  /// pushing and popping waypoints does not allocate.
+  class WaypointBuffer {
+  public:
+
+    class const_iterator {
+    public:
+
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = WaypointIndex;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const WaypointIndex *;
+      using reference = WaypointIndex;
+
+      const_iterator(const WaypointBuffer *buffer, size_t position)
+        : _buffer(buffer),
+          _position(position) {}
+
+      WaypointIndex operator*() const {
+        return _buffer->at(_position);
+      }
+
+      const_iterator &operator++() {
+        ++_position;
+        return *this;
+      }
+
+      bool operator==(const const_iterator &rhs) const {
+        return _position == rhs._position;
+      }
+
+      bool operator!=(const const_iterator &rhs) const {
+        return _position != rhs._position;
+      }
+
+    private:
+
+      const WaypointBuffer *_buffer;
+
+      size_t _position;
+    };
+
+    explicit WaypointBuffer(const WaypointGraph &graph)
+      : _graph(&graph) {}
+
+    /// Graph the indices of this buffer refer to.
+    const WaypointGraph &GetGraph() const {
+      return *_graph;
+    }
+
+    bool empty() const {
+      return _size == 0u;
+    }
+
+    size_t size() const {
+      return _size;
+    }
+
+    WaypointIndex front() const {
+      DEBUG_ASSERT(!empty());
+      return _data[_head];
+    }
+
+    WaypointIndex back() const {
+      DEBUG_ASSERT(!empty());
+      return _data[(_head + _size - 1u) & _mask];
+    }
+
+    WaypointIndex at(size_t position) const {
+      DEBUG_ASSERT(position < _size);
+      return _data[(_head + position) & _mask];
+    }
+
+    void push_back(WaypointIndex index) {
+      if (_size == _data.size()) {
+        Grow();
+      }
+      _data[(_head + _size) & _mask] = index;
+      ++_size;
+    }
+
+    void pop_front() {
+      DEBUG_ASSERT(!empty());
+      _head = (_head + 1u) & _mask;
+      --_size;
+    }
+
+    void pop_back() {
+      DEBUG_ASSERT(!empty());
+      --_size;
+    }
+
+    void clear() {
+      _head = 0u;
+      _size = 0u;
+    }
+
+    const_iterator begin() const {
+      return {this, 0u};
+    }
+
+    const_iterator end() const {
+      return {this, _size};
+    }
+
+  private:
+
+    /// Doubles the capacity, keeping it a power of two so positions can be
+    /// wrapped with a mask.
+    void Grow() {
+      const size_t capacity = _data.empty() ? 16u : 2u * _data.size();
+      std::vector<WaypointIndex> data(capacity);
+      for (size_t i = 0u; i < _size; ++i) {
+        data[i] = at(i);
+      }
+      _data.swap(data);
+      _mask = capacity - 1u;
+      _head = 0u;
+    }
+
+    const WaypointGraph *_graph;
+
+    std::vector<WaypointIndex> _data;
+
+    size_t _mask = 0u;
+
+    size_t _head = 0u;
+
+    size_t _size = 0u;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,201 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/WaypointGraph.h"
+
+#include "carla/Exception.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace carla {
+namespace traffic_manager {
+
+  constexpr WaypointIndex WaypointGraph::NO_WAYPOINT;
+
+  void WaypointGraph::Build(const NodeList &dense_topology) {
+    const size_t total = dense_topology.size();
+
+    for (size_t i = 0u; i < total; ++i) {
+      dense_topology[i]->SetIndex(static_cast<WaypointIndex>(i));
+    }
+
+    _locations.clear();
+    _forward_vectors.clear();
+    _ids.clear();
+    _geodesic_grid_ids.clear();
+    _is_junction.clear();
+    _road_options.clear();
+    _left_waypoints.clear();
+    _right_waypoints.clear();
+    _next_offsets.assign(1u, 0u);
+    _next_indices.clear();
+    _previous_offsets.assign(1u, 0u);
+    _previous_indices.clear();
+    _world_map = nullptr;
+    _road_ids.clear();
+    _lane_ids.clear();
+    _distances.clear();
+
+    _locations.reserve(total);
+    _forward_vectors.reserve(total);
+    _ids.reserve(total);
+    _geodesic_grid_ids.reserve(total);
+    _is_junction.reserve(total);
+    _road_options.reserve(total);
+    _left_waypoints.reserve(total);
+    _right_waypoints.reserve(total);
+    _next_offsets.reserve(total + 1u);
+    _previous_offsets.reserve(total + 1u);
+
+    for (const SimpleWaypointPtr &simple_waypoint : dense_topology) {
+      const cg::Transform transform = simple_waypoint->GetTransform();
+      _locations.push_back(transform.location);
+      _forward_vectors.push_back(transform.GetForwardVector());
+      _ids.push_back(simple_waypoint->GetId());
+      _geodesic_grid_ids.push_back(simple_waypoint->GetGeodesicGridId());
+      _is_junction.push_back(simple_waypoint->CheckJunction() ? 1u : 0u);
+      _road_options.push_back(simple_waypoint->GetRoadOption());
+
+      const SimpleWaypointPtr left = simple_waypoint->GetLeftWaypoint();
+      const SimpleWaypointPtr right = simple_waypoint->GetRightWaypoint();
+      _left_waypoints.push_back(left != nullptr ? left->GetIndex() : NO_WAYPOINT);
+      _right_waypoints.push_back(right != nullptr ? right->GetIndex() : NO_WAYPOINT);
+
+      for (const SimpleWaypointPtr &next : simple_waypoint->GetNextWaypoint()) {
+        _next_indices.push_back(next->GetIndex());
+      }
+      _next_offsets.push_back(static_cast<uint32_t>(_next_indices.size()));
+
+      for (const SimpleWaypointPtr &previous : simple_waypoint->GetPreviousWaypoint()) {
+        _previous_indices.push_back(previous->GetIndex());
+      }
+      _previous_offsets.push_back(static_cast<uint32_t>(_previous_indices.size()));
+    }
+
+    std::lock_guard<std::mutex> lock(_nodes_mutex);
+    _nodes = dense_topology;
+    _linked_nodes = true;
+  }
+
+  void WaypointGraph::Build(const InMemoryMapCache &cache, WorldMap world_map) {
+    const uint32_t total = cache.GetNumberOfWaypoints();
+
+    _locations.resize(total);
+    _forward_vectors.resize(total);
+    _ids.resize(total);
+    _geodesic_grid_ids.resize(total);
+    _is_junction.resize(total);
+    _road_options.resize(total);
+    _left_waypoints.resize(total);
+    _right_waypoints.resize(total);
+    _road_ids.resize(total);
+    _lane_ids.resize(total);
+    _distances.resize(total);
+    _next_offsets.assign(1u, 0u);
+    _next_indices.clear();
+    _previous_offsets.assign(1u, 0u);
+    _previous_indices.clear();
+    _next_offsets.reserve(total + 1u);
+    _previous_offsets.reserve(total + 1u);
+
+    // The cache links are already indices into the waypoint table, and the
+    // lane change indices of the cache use the same NO_WAYPOINT value.
+    for (uint32_t i = 0u; i < total; ++i) {
+      const InMemoryMapCache::WaypointRecord &record = cache.GetWaypoint(i);
+      _locations[i] = cg::Location(record.location[0], record.location[1], record.location[2]);
+      _forward_vectors[i] = cg::Vector3D(record.forward[0], record.forward[1], record.forward[2]);
+      _ids[i] = record.waypoint_id;
+      _geodesic_grid_ids[i] = record.geodesic_grid_id;
+      _is_junction[i] = record.is_junction;
+      _road_options[i] = static_cast<RoadOption>(record.road_option);
+      _left_waypoints[i] = record.left_index;
+      _right_waypoints[i] = record.right_index;
+      _road_ids[i] = record.road_id;
+      _lane_ids[i] = record.lane_id;
+      _distances[i] = record.s;
+
+      const InMemoryMapCache::LinkRange next = cache.GetNextWaypoints(i);
+      _next_indices.insert(_next_indices.end(), next.begin, next.end);
+      _next_offsets.push_back(static_cast<uint32_t>(_next_indices.size()));
+
+      const InMemoryMapCache::LinkRange previous = cache.GetPreviousWaypoints(i);
+      _previous_indices.insert(_previous_indices.end(), previous.begin, previous.end);
+      _previous_offsets.push_back(static_cast<uint32_t>(_previous_indices.size()));
+    }
+
+    _world_map = std::move(world_map);
+    std::lock_guard<std::mutex> lock(_nodes_mutex);
+    _nodes.assign(total, nullptr);
+    _linked_nodes = false;
+  }
+
+  SimpleWaypointPtr WaypointGraph::MakeSimpleWaypoint(WaypointIndex index) const {
+    WaypointPtr waypoint = _world_map->GetWaypointXODR(_road_ids[index], _lane_ids[index], _distances[index]);
+    if (waypoint == nullptr) {
+      throw_exception(std::runtime_error(
+          "waypoint " + std::to_string(index) + " of the traffic manager graph is not on any lane"));
+    }
+    SimpleWaypointPtr simple_waypoint = std::make_shared<SimpleWaypoint>(waypoint);
+    simple_waypoint->SetIndex(index);
+    simple_waypoint->SetGeodesicGridId(_geodesic_grid_ids[index]);
+    simple_waypoint->SetIsJunction(_is_junction[index] != 0u);
+    simple_waypoint->SetRoadOption(_road_options[index]);
+    return simple_waypoint;
+  }
+
+  SimpleWaypointPtr WaypointGraph::GetSimpleWaypoint(WaypointIndex index) const {
+    std::lock_guard<std::mutex> lock(_nodes_mutex);
+    SimpleWaypointPtr &simple_waypoint = _nodes[index];
+    if (simple_waypoint == nullptr) {
+      simple_waypoint = MakeSimpleWaypoint(index);
+    }
+    return simple_waypoint;
+  }
+
+  NodeList WaypointGraph::GetSimpleWaypoints() const {
+    std::lock_guard<std::mutex> lock(_nodes_mutex);
+    if (_linked_nodes) {
+      return _nodes;
+    }
+
+    const size_t total = _nodes.size();
+    for (size_t i = 0u; i < total; ++i) {
+      if (_nodes[i] == nullptr) {
+        _nodes[i] = MakeSimpleWaypoint(static_cast<WaypointIndex>(i));
+      }
+    }
+
+    NodeList links;
+    for (size_t i = 0u; i < total; ++i) {
+      const WaypointIndex index = static_cast<WaypointIndex>(i);
+      SimpleWaypointPtr &simple_waypoint = _nodes[i];
+
+      links.clear();
+      for (const WaypointIndex next : GetNextWaypoints(index)) {
+        links.push_back(_nodes[next]);
+      }
+      simple_waypoint->SetNextWaypoint(links);
+
+      links.clear();
+      for (const WaypointIndex previous : GetPreviousWaypoints(index)) {
+        links.push_back(_nodes[previous]);
+      }
+      simple_waypoint->SetPreviousWaypoint(links);
+
+      if (_left_waypoints[i] != NO_WAYPOINT) {
+        simple_waypoint->SetLeftWaypoint(_nodes[_left_waypoints[i]]);
+      }
+      if (_right_waypoints[i] != NO_WAYPOINT) {
+        simple_waypoint->SetRightWaypoint(_nodes[_right_waypoints[i]]);
+      }
+    }
+    _linked_nodes = true;
+    return _nodes;
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,209 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "carla/client/Map.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Math.h"
+#include "carla/geom/Vector3D.h"
+
+#include "carla/trafficmanager/InMemoryMapCache.h"
+#include "carla/trafficmanager/SimpleWaypoint.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+  namespace crd = carla::road;
+  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
+  using NodeList = std::vector<SimpleWaypointPtr>;
+  using WorldMap = carla::SharedPtr<const cc::Map>;
+
+  /// Index-addressed, read-only view of the local map waypoints.
+  ///
+  /// The attributes read by the stages every cycle are stored in one array
+  /// per attribute, and the next and previous links in compressed sparse
+  /// row form, so the stages can walk the map by index without touching the
+  /// SimpleWaypoint objects or their reference counts.
+  ///
+  /// A graph built from a map cache creates the SimpleWaypoint objects on
+  /// demand, as they need a query to the OpenDRIVE map each.
+  class WaypointGraph {
+  public:
+
+    /// Contiguous range of waypoint indices.
+    class WaypointRange {
+    public:
+
+      WaypointRange(const WaypointIndex *begin, const WaypointIndex *end)
+        : _begin(begin),
+          _end(end) {}
+
+      const WaypointIndex *begin() const {
+        return _begin;
+      }
+
+      const WaypointIndex *end() const {
+        return _end;
+      }
+
+      size_t size() const {
+        return static_cast<size_t>(_end - _begin);
+      }
+
+      bool empty() const {
+        return _begin == _end;
+      }
+
+      WaypointIndex front() const {
+        return *_begin;
+      }
+
+      WaypointIndex operator[](size_t i) const {
+        return _begin[i];
+      }
+
+    private:
+
+      const WaypointIndex *_begin;
+
+      const WaypointIndex *_end;
+    };
+
+    static constexpr WaypointIndex NO_WAYPOINT = 0xFFFFFFFFu;
+
+    /// Builds the graph from @a dense_topology. The index of each waypoint
+    /// is its position in @a dense_topology, and it is also stored in the
+    /// waypoint itself.
+    void Build(const NodeList &dense_topology);
+
+    /// Builds the graph from the records of @a cache, with the same indices.
+    /// The waypoint objects are created from @a world_map when first
+    /// requested.
+    void Build(const InMemoryMapCache &cache, WorldMap world_map);
+
+    size_t Size() const {
+      return _ids.size();
+    }
+
+    const cg::Location &GetLocation(WaypointIndex index) const {
+      return _locations[index];
+    }
+
+    const cg::Vector3D &GetForwardVector(WaypointIndex index) const {
+      return _forward_vectors[index];
+    }
+
+    uint64_t GetId(WaypointIndex index) const {
+      return _ids[index];
+    }
+
+    /// Geodesic grid of the waypoint, which is the junction id for
+    /// waypoints inside a junction.
+    GeoGridId GetGeodesicGridId(WaypointIndex index) const {
+      return _geodesic_grid_ids[index];
+    }
+
+    bool IsJunction(WaypointIndex index) const {
+      return _is_junction[index] != 0u;
+    }
+
+    RoadOption GetRoadOption(WaypointIndex index) const {
+      return _road_options[index];
+    }
+
+    WaypointIndex GetLeftWaypoint(WaypointIndex index) const {
+      return _left_waypoints[index];
+    }
+
+    WaypointIndex GetRightWaypoint(WaypointIndex index) const {
+      return _right_waypoints[index];
+    }
+
+    WaypointRange GetNextWaypoints(WaypointIndex index) const {
+      return {_next_indices.data() + _next_offsets[index],
+              _next_indices.data() + _next_offsets[index + 1u]};
+    }
+
+    WaypointRange GetPreviousWaypoints(WaypointIndex index) const {
+      return {_previous_indices.data() + _previous_offsets[index],
+              _previous_indices.data() + _previous_offsets[index + 1u]};
+    }
+
+    /// Returns the waypoint object at @a index, for the less frequent
+    /// queries that need the underlying carla::client::Waypoint. Waypoints
+    /// created on demand are not linked to other waypoints, use the graph
+    /// to follow the links.
+    SimpleWaypointPtr GetSimpleWaypoint(WaypointIndex index) const;
+
+    /// Returns every waypoint object, linked as in the graph.
+    NodeList GetSimpleWaypoints() const;
+
+    float DistanceSquared(WaypointIndex lhs, WaypointIndex rhs) const {
+      return cg::Math::DistanceSquared(_locations[lhs], _locations[rhs]);
+    }
+
+    float DistanceSquared(WaypointIndex index, const cg::Location &location) const {
+      return cg::Math::DistanceSquared(_locations[index], location);
+    }
+
+  private:
+
+    std::vector<cg::Location> _locations;
+
+    std::vector<cg::Vector3D> _forward_vectors;
+
+    std::vector<uint64_t> _ids;
+
+    std::vector<GeoGridId> _geodesic_grid_ids;
+
+    std::vector<uint8_t> _is_junction;
+
+    std::vector<RoadOption> _road_options;
+
+    std::vector<WaypointIndex> _left_waypoints;
+
+    std::vector<WaypointIndex> _right_waypoints;
+
+    std::vector<uint32_t> _next_offsets;
+
+    std::vector<WaypointIndex> _next_indices;
+
+    std::vector<uint32_t> _previous_offsets;
+
+    std::vector<WaypointIndex> _previous_indices;
+
+    /// Map the waypoint objects are created from, null if they were given
+    /// to Build().
+    WorldMap _world_map;
+
+    /// OpenDRIVE position of every waypoint, only kept to create the
+    /// waypoint objects on demand.
+    std::vector<crd::RoadId> _road_ids;
+
+    std::vector<crd::LaneId> _lane_ids;
+
+    std::vector<float> _distances;
+
+    /// Guards the waypoint objects created on demand.
+    mutable std::mutex _nodes_mutex;
+
+    mutable NodeList _nodes;
+
+    /// Whether the waypoint objects are linked to each other.
+    mutable bool _linked_nodes = true;
+
+    SimpleWaypointPtr MakeSimpleWaypoint(WaypointIndex index) const;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
@@ -13,6 +13,7 @@
 #include <carla/FileSystem.h>
 
 #include <fstream>
+#include <sstream>
 #include <streambuf>
 
 namespace util {
@@ -29,4 +30,59 @@ namespace util {
     return std::string{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
   }
 
+  std::string OpenDrive::MakeSynthetic(
+      const size_t number_of_roads,
+      const double road_length,
+      const size_t sections_per_road) {
+    // Distance between the width and elevation records, as in hand-made maps
+    // the road is described by many short records.
+    constexpr double record_length = 20.0;
+    const double section_length = road_length / static_cast<double>(sections_per_road);
+
+    std::ostringstream out;
+    auto lane = [&](int id, const char *type, double width) {
+      out << "          <lane id=\"" << id << "\" type=\"" << type << "\" level=\"false\"><link/>";
+      for (double s = 0.0; s < section_length; s += record_length) {
+        out << "<width sOffset=\"" << s << "\" a=\"" << width << "\" b=\"0\" c=\"0\" d=\"0\"/>";
+      }
+      out << "</lane>\n";
+    };
+
+    out << "<?xml version=\"1.0\" standalone=\"yes\"?>\n<OpenDRIVE>\n";
+    out << "  <header revMajor=\"1\" revMinor=\"4\" name=\"synthetic\" version=\"1\""
+        << " north=\"0\" south=\"0\" east=\"0\" west=\"0\">"
+        << "<geoReference><![CDATA[+proj=tmerc +lat_0=0 +lon_0=0]]></geoReference></header>\n";
+    for (size_t id = 0u; id < number_of_roads; ++id) {
+      out << "  <road name=\"Road " << id << "\" length=\"" << road_length
+          << "\" id=\"" << id << "\" junction=\"-1\">\n";
+      out << "    <link/>\n    <planView>\n";
+      out << "      <geometry s=\"0\" x=\"0\" y=\"" << (20.0 * static_cast<double>(id))
+          << "\" hdg=\"0\" length=\"" << road_length << "\">"
+          << "<arc curvature=\"0.0005\"/></geometry>\n";
+      out << "    </planView>\n";
+      out << "    <elevationProfile>";
+      for (double s = 0.0; s < road_length; s += record_length) {
+        out << "<elevation s=\"" << s << "\" a=\"0\" b=\"0\" c=\"0\" d=\"0\"/>";
+      }
+      out << "</elevationProfile>\n";
+      out << "    <lateralProfile/>\n    <lanes>\n";
+      for (size_t section = 0u; section < sections_per_road; ++section) {
+        out << "      <laneSection s=\"" << (section_length * static_cast<double>(section)) << "\">\n";
+        out << "        <left>\n";
+        lane(2, "sidewalk", 2.0);
+        lane(1, "driving", 3.5);
+        out << "        </left>\n";
+        out << "        <center><lane id=\"0\" type=\"none\" level=\"false\"><link/></lane></center>\n";
+        out << "        <right>\n";
+        lane(-1, "driving", 3.5);
+        lane(-2, "sidewalk", 2.0);
+        out << "        </right>\n";
+        out << "      </laneSection>\n";
+      }
+      out << "    </lanes>\n  </road>\n";
+    }
+    out << "</OpenDRIVE>\n";
+    return out.str();
+  }
+
 } // namespace util
@@ -18,6 +18,13 @@ namespace util {
     static std::vector<std::string> GetAvailableFiles();
 
     static std::string Load(const std::string &filename);
+
+    /// Make an OpenDRIVE of parallel curved roads, each with a driving lane
+    /// and a sidewalk to each side.
+    static std::string MakeSynthetic(
+        size_t number_of_roads,
+        double road_length,
+        size_t sections_per_road);
   };
 
 } // namespace util
@@ -0,0 +1,126 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/Map.h>
+#include <carla/geom/Math.h>
+#include <carla/trafficmanager/CollisionStage.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/LevelOfDetail.h>
+#include <carla/trafficmanager/Parameters.h>
+#include <carla/trafficmanager/SimulationState.h>
+#include <carla/trafficmanager/TrackTraffic.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace cc = carla::client;
+namespace cg = carla::geom;
+namespace ctm = carla::traffic_manager;
+
+namespace {
+
+  constexpr size_t HORIZON = 40u;
+  /// Waypoints between consecutive vehicles, dense traffic along the lanes.
+  constexpr size_t SPACING = 5u;
+  constexpr size_t NUMBER_OF_CYCLES = 20u;
+  /// Level of detail tier of the vehicles farther than LOD_RADIUS from the
+  /// hero, placed on the first vehicle.
+  constexpr float LOD_RADIUS = 100.0f;
+  constexpr uint64_t LOD_UPDATE_INTERVAL = 4u;
+
+  /// Time the collision stage over @a number_of_vehicles vehicles placed
+  /// every SPACING waypoints of @a graph. With @a use_lod the vehicles far
+  /// from the hero get the level of detail tier.
+  void Benchmark(const std::string &name, const ctm::WaypointGraph &graph, size_t number_of_vehicles, bool use_lod) {
+    std::vector<carla::ActorId> vehicle_ids;
+    ctm::SimulationState simulation_state;
+    ctm::BufferMap buffer_map;
+    ctm::TrackTraffic track_traffic;
+    ctm::Parameters parameters;
+    ctm::RandomGeneratorMap random_devices;
+
+    for (size_t i = 0u; i < number_of_vehicles; ++i) {
+      const auto actor_id = static_cast<carla::ActorId>(i + 1u);
+      auto start = static_cast<ctm::WaypointIndex>((i * SPACING) % graph.Size());
+
+      ctm::WaypointBuffer buffer(graph);
+      buffer.push_back(start);
+      while (buffer.size() < HORIZON) {
+        const auto next = graph.GetNextWaypoints(buffer.back());
+        if (next.empty()) {
+          break;
+        }
+        buffer.push_back(next.front());
+      }
+
+      const cg::Vector3D forward = graph.GetForwardVector(start);
+      const float yaw = std::atan2(forward.y, forward.x) * 180.0f / cg::Math::Pi<float>();
+      simulation_state.AddActor(
+          actor_id,
+          {graph.GetLocation(start), cg::Rotation(0.0f, yaw, 0.0f), forward * 8.0f, 30.0f, true, false},
+          {ctm::ActorType::Vehicle, 2.4f, 1.0f, 0.8f},
+          {carla::rpc::TrafficLightState::Green, false});
+      track_traffic.UpdateGridPosition(actor_id, buffer);
+      buffer_map.emplace(actor_id, std::move(buffer));
+      random_devices.emplace(actor_id, ctm::RandomGenerator(actor_id));
+      vehicle_ids.push_back(actor_id);
+    }
+
+    parameters.UpdateSnapshot(vehicle_ids);
+    if (use_lod) {
+      parameters.SetLevelOfDetail({LOD_RADIUS}, {LOD_UPDATE_INTERVAL});
+    }
+    const std::vector<cg::Location> hero_locations = {simulation_state.GetLocation(vehicle_ids.front())};
+
+    ctm::LevelOfDetail level_of_detail;
+    ctm::CollisionFrame output(number_of_vehicles);
+    ctm::CollisionStage stage(
+        vehicle_ids, simulation_state, buffer_map, track_traffic, parameters, level_of_detail, output, random_devices);
+
+    size_t hazards = 0u;
+    carla::StopWatch timer;
+    for (size_t cycle = 0u; cycle < NUMBER_OF_CYCLES; ++cycle) {
+      level_of_detail.Update(parameters.GetLevelOfDetail(), vehicle_ids, simulation_state, hero_locations);
+      stage.PrepareCycle();
+      for (unsigned long index = 0u; index < vehicle_ids.size(); ++index) {
+        stage.Update(index);
+      }
+      stage.CommitCollisionLocks();
+      stage.ClearCycleCache();
+      for (const auto &element : output) {
+        hazards += element.hazard ? 1u : 0u;
+      }
+    }
+    timer.Stop();
+
+    carla::logging::log(
+        name, ":", number_of_vehicles, "vehicles,", use_lod ? "level of detail," : "full detail,",
+        static_cast<double>(timer.GetElapsedTime()) / NUMBER_OF_CYCLES, "ms per cycle,",
+        hazards / NUMBER_OF_CYCLES, "hazards per cycle");
+  }
+
+} // namespace
+
+TEST(traffic_manager, benchmark_collision_stage) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<cc::Map>(file, util::OpenDrive::Load(file));
+    ctm::InMemoryMap local_map(world_map);
+    local_map.SetUp();
+    const ctm::WaypointGraph &graph = local_map.GetWaypointGraph();
+    if (graph.Size() == 0u) {
+      continue;
+    }
+    for (const size_t number_of_vehicles : {200u, 500u, 1000u}) {
+      Benchmark(file, graph, number_of_vehicles, false);
+      Benchmark(file, graph, number_of_vehicles, true);
+    }
+  }
+}
@@ -0,0 +1,276 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/Memory.h>
+#include <carla/StopWatch.h>
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+#include <carla/sensor/s11n/EpisodeStateDeltaEncoder.h>
+#include <carla/sensor/s11n/EpisodeStateSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using carla::sensor::data::ActorDynamicState;
+using carla::sensor::data::RawEpisodeState;
+using carla::sensor::s11n::EpisodeStateDeltaEncoder;
+using carla::sensor::s11n::EpisodeStateSerializer;
+using EpisodeState = carla::client::detail::EpisodeState;
+
+namespace {
+
+  /// Synthetic episode made of mostly static props and parked cars, with a
+  /// few moving vehicles and a slow turnover of spawned and destroyed actors.
+  class SyntheticEpisode {
+  public:
+
+    SyntheticEpisode(size_t number_of_actors, size_t number_of_moving_actors)
+      : _number_of_moving_actors(number_of_moving_actors) {
+      _actors.reserve(number_of_actors);
+      for (size_t i = 0u; i < number_of_actors; ++i) {
+        _actors.emplace_back(MakeActor());
+      }
+    }
+
+    void Tick() {
+      ++_frame;
+      for (size_t i = 0u; i < _number_of_moving_actors && i < _actors.size(); ++i) {
+        auto &actor = _actors[i];
+        actor.velocity = {10.0f, 0.5f * static_cast<float>(_frame % 3u), 0.0f};
+        actor.transform.location += actor.velocity * 0.05f;
+        actor.transform.rotation.yaw += 0.1f;
+      }
+      // Destroy an actor and spawn a new one every ten frames.
+      if (_frame % 10u == 0u) {
+        _actors.pop_back();
+        _actors.emplace_back(MakeActor());
+      }
+    }
+
+    uint64_t GetFrame() const {
+      return _frame;
+    }
+
+    /// Full message as written by the server, sensor header included.
+    carla::Buffer MakeMessage() const {
+      EpisodeStateSerializer::Header header;
+      header.episode_id = 1u;
+      header.platform_timestamp = 0.05 * static_cast<double>(_frame);
+      header.delta_seconds = 0.05f;
+      header.map_origin = carla::geom::Vector3DInt{};
+      carla::Buffer message(sizeof(header) + sizeof(ActorDynamicState) * _actors.size());
+      std::memcpy(message.data(), &header, sizeof(header));
+      std::memcpy(
+          message.data() + sizeof(header),
+          _actors.data(),
+          sizeof(ActorDynamicState) * _actors.size());
+      return message;
+    }
+
+    const std::vector<ActorDynamicState> &GetActors() const {
+      return _actors;
+    }
+
+  private:
+
+    ActorDynamicState MakeActor() {
+      ActorDynamicState actor{};
+      actor.id = ++_last_id;
+      actor.actor_state = carla::rpc::ActorState::Active;
+      actor.transform.location = {static_cast<float>(_last_id % 200u), static_cast<float>(_last_id / 200u), 0.0f};
+      return actor;
+    }
+
+    const size_t _number_of_moving_actors;
+
+    uint64_t _frame = 0u;
+
+    carla::ActorId _last_id = 0u;
+
+    std::vector<ActorDynamicState> _actors;
+  };
+
+} // namespace
+
+static carla::SharedPtr<const RawEpisodeState> Deserialize(uint64_t frame, carla::Buffer &&message) {
+  using namespace carla::sensor;
+  constexpr auto index = SensorRegistry::get<FWorldObserver *>::index;
+  auto header = s11n::SensorHeaderSerializer::Serialize(index, frame, 0.05 * static_cast<double>(frame), {});
+  carla::Buffer buffer(header.size() + message.size());
+  std::memcpy(buffer.data(), header.data(), header.size());
+  std::memcpy(buffer.data() + header.size(), message.data(), message.size());
+  auto data = Deserializer::Deserialize(std::move(buffer));
+  return boost::static_pointer_cast<const RawEpisodeState>(data);
+}
+
+TEST(episode_state, delta_encoder_has_changed) {
+  ActorDynamicState previous{};
+  previous.id = 1u;
+  ActorDynamicState current = previous;
+  ASSERT_FALSE(EpisodeStateDeltaEncoder::HasChanged(previous, current));
+  current.transform.location.x += 0.5f * EpisodeStateDeltaEncoder::location_tolerance;
+  ASSERT_FALSE(EpisodeStateDeltaEncoder::HasChanged(previous, current));
+  current.transform.location.x += EpisodeStateDeltaEncoder::location_tolerance;
+  ASSERT_TRUE(EpisodeStateDeltaEncoder::HasChanged(previous, current));
+  current = previous;
+  current.actor_state = carla::rpc::ActorState::Dormant;
+  ASSERT_TRUE(EpisodeStateDeltaEncoder::HasChanged(previous, current));
+}
+
+TEST(episode_state, view_over_unsorted_actors) {
+  constexpr carla::ActorId NUMBER_OF_ACTORS = 100u;
+  EpisodeStateSerializer::Header header;
+  header.episode_id = 1u;
+  header.platform_timestamp = 0.0;
+  header.delta_seconds = 0.05f;
+  header.map_origin = carla::geom::Vector3DInt{};
+  carla::Buffer message(sizeof(header) + sizeof(ActorDynamicState) * NUMBER_OF_ACTORS);
+  std::memcpy(message.data(), &header, sizeof(header));
+  for (carla::ActorId i = 0u; i < NUMBER_OF_ACTORS; ++i) {
+    ActorDynamicState actor{};
+    // Even ids only, in decreasing order.
+    actor.id = 2u * (NUMBER_OF_ACTORS - i);
+    actor.actor_state = carla::rpc::ActorState::Active;
+    actor.transform.location.x = static_cast<float>(actor.id);
+    std::memcpy(
+        message.data() + sizeof(header) + i * sizeof(ActorDynamicState),
+        &actor,
+        sizeof(actor));
+  }
+
+  const EpisodeState state(Deserialize(42u, std::move(message)));
+  ASSERT_EQ(state.GetFrame(), 42u);
+  ASSERT_EQ(state.size(), NUMBER_OF_ACTORS);
+  for (carla::ActorId id = 0u; id <= 2u * NUMBER_OF_ACTORS + 1u; ++id) {
+    const bool expected = (id > 0u) && (id % 2u == 0u);
+    ASSERT_EQ(state.ContainsActorSnapshot(id), expected);
+    if (expected) {
+      ASSERT_EQ(state.GetActorSnapshot(id).id, id);
+      ASSERT_EQ(state.GetActorSnapshot(id).transform.location.x, static_cast<float>(id));
+    } else {
+      ASSERT_FALSE(state.GetActorSnapshotIfPresent(id).has_value());
+    }
+  }
+
+  size_t count = 0u;
+  auto ids = state.GetActorIds();
+  auto id = ids.begin();
+  for (const auto &snapshot : state) {
+    ASSERT_EQ(snapshot.id, *id);
+    ASSERT_EQ(snapshot.transform.location.x, static_cast<float>(snapshot.id));
+    ++id;
+    ++count;
+  }
+  ASSERT_EQ(count, NUMBER_OF_ACTORS);
+}
+
+TEST(episode_state, delta_needs_matching_base_frame) {
+  SyntheticEpisode episode(100u, 10u);
+  EpisodeStateDeltaEncoder encoder(30u);
+
+  auto encode = [&]() {
+    episode.Tick();
+    auto message = episode.MakeMessage();
+    encoder.Encode(message, episode.GetFrame());
+    return Deserialize(episode.GetFrame(), std::move(message));
+  };
+
+  // The first message is a keyframe, deltas do not apply to an empty state.
+  auto keyframe = encode();
+  ASSERT_FALSE(keyframe->IsDelta());
+  auto delta = encode();
+  ASSERT_TRUE(delta->IsDelta());
+  ASSERT_EQ(delta->GetBaseFrame(), keyframe->GetFrame());
+  const EpisodeState empty_state(1u);
+  ASSERT_FALSE(empty_state.CanApplyDelta(*delta));
+
+  const EpisodeState state(keyframe);
+  ASSERT_TRUE(state.CanApplyDelta(*delta));
+  const EpisodeState patched_state(*delta, state);
+  ASSERT_TRUE(patched_state.CanApplyDelta(*encode()));
+
+  // A missed delta breaks the chain until the next keyframe.
+  auto next_delta = encode();
+  ASSERT_TRUE(next_delta->IsDelta());
+  ASSERT_FALSE(patched_state.CanApplyDelta(*next_delta));
+}
+
+TEST(episode_state, benchmark_delta_episode_state) {
+  constexpr size_t NUMBER_OF_ACTORS = 5000u;
+  constexpr size_t NUMBER_OF_MOVING_ACTORS = 250u;
+  constexpr size_t NUMBER_OF_FRAMES = 200u;
+  constexpr uint32_t KEYFRAME_INTERVAL = 30u;
+
+  SyntheticEpisode episode(NUMBER_OF_ACTORS, NUMBER_OF_MOVING_ACTORS);
+  EpisodeStateDeltaEncoder encoder(KEYFRAME_INTERVAL);
+
+  size_t full_bytes = 0u;
+  size_t delta_bytes = 0u;
+  size_t number_of_deltas = 0u;
+  size_t full_decode_us = 0u;
+  size_t delta_decode_us = 0u;
+  size_t encode_us = 0u;
+
+  std::shared_ptr<const EpisodeState> delta_state = std::make_shared<EpisodeState>(1u);
+  for (size_t i = 0u; i < NUMBER_OF_FRAMES; ++i) {
+    episode.Tick();
+
+    auto full_message = episode.MakeMessage();
+    full_bytes += full_message.size();
+    auto full_raw = Deserialize(episode.GetFrame(), std::move(full_message));
+    carla::StopWatch full_timer;
+    auto full_state = std::make_shared<const EpisodeState>(full_raw);
+    full_timer.Stop();
+    full_decode_us += full_timer.GetElapsedTime<std::chrono::microseconds>();
+
+    auto delta_message = episode.MakeMessage();
+    carla::StopWatch encode_timer;
+    const bool is_delta = encoder.Encode(delta_message, episode.GetFrame());
+    encode_timer.Stop();
+    encode_us += encode_timer.GetElapsedTime<std::chrono::microseconds>();
+    delta_bytes += delta_message.size();
+    auto delta_raw = Deserialize(episode.GetFrame(), std::move(delta_message));
+    ASSERT_EQ(delta_raw->IsDelta(), is_delta);
+    carla::StopWatch delta_timer;
+    if (is_delta) {
+      ++number_of_deltas;
+      ASSERT_TRUE(delta_state->CanApplyDelta(*delta_raw));
+      delta_state = std::make_shared<const EpisodeState>(*delta_raw, *delta_state);
+    } else {
+      delta_state = std::make_shared<const EpisodeState>(delta_raw);
+    }
+    delta_timer.Stop();
+    delta_decode_us += delta_timer.GetElapsedTime<std::chrono::microseconds>();
+
+    // The patched snapshot has to match the full one within tolerance.
+    ASSERT_EQ(delta_state->GetFrame(), full_state->GetFrame());
+    ASSERT_EQ(delta_state->size(), full_state->size());
+    for (const auto &actor : episode.GetActors()) {
+      ASSERT_TRUE(delta_state->ContainsActorSnapshot(actor.id));
+      const auto snapshot = delta_state->GetActorSnapshot(actor.id);
+      ASSERT_EQ(snapshot.actor_state, actor.actor_state);
+      ASSERT_NEAR(
+          snapshot.transform.location.Distance(actor.transform.location),
+          0.0f,
+          2.0f * EpisodeStateDeltaEncoder::location_tolerance);
+    }
+  }
+
+  carla::logging::log(
+      NUMBER_OF_ACTORS, "actors,", NUMBER_OF_MOVING_ACTORS, "moving,", NUMBER_OF_FRAMES, "frames:",
+      "full", full_bytes / 1024u, "KiB,", full_decode_us / 1000u, "ms to decode;",
+      "delta", delta_bytes / 1024u, "KiB,", encode_us / 1000u, "ms to encode,",
+      delta_decode_us / 1000u, "ms to decode");
+  ASSERT_GT(number_of_deltas, 0u);
+  ASSERT_LT(delta_bytes, full_bytes);
+}
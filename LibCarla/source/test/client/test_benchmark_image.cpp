@@ -0,0 +1,98 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/image/ImageConverter.h>
+#include <carla/image/ImageView.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+  constexpr size_t WIDTH = 1920u;
+  constexpr size_t HEIGHT = 1080u;
+  constexpr size_t NUMBER_OF_FRAMES = 20u;
+
+  /// A frame of random BGRA pixels, as received from a depth or semantic
+  /// segmentation camera.
+  std::vector<uint8_t> MakeFrame(const uint8_t max_tag) {
+    std::mt19937 rng(42u);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> tag(0, max_tag);
+    std::vector<uint8_t> frame(4u * WIDTH * HEIGHT);
+    for (size_t i = 0u; i < frame.size(); i += 4u) {
+      frame[i + 0u] = static_cast<uint8_t>(byte(rng));
+      frame[i + 1u] = static_cast<uint8_t>(byte(rng));
+      frame[i + 2u] = static_cast<uint8_t>(tag(rng));
+      frame[i + 3u] = 255u;
+    }
+    return frame;
+  }
+
+  auto MakeView(std::vector<uint8_t> &frame) {
+    return boost::gil::interleaved_view(
+        WIDTH,
+        HEIGHT,
+        reinterpret_cast<boost::gil::bgra8_pixel_t *>(frame.data()),
+        static_cast<long>(4u * WIDTH));
+  }
+
+  /// Time per frame of the pixel by pixel Boost.GIL conversion against
+  /// ImageConverter::ConvertInPlace, the outputs have to be identical.
+  template <typename ColorConverter>
+  void Benchmark(const char *name, const uint8_t max_tag) {
+    using namespace carla::image;
+    const auto source = MakeFrame(max_tag);
+    std::vector<uint8_t> gil_frame;
+    std::vector<uint8_t> fast_frame;
+    size_t gil_us = 0u;
+    size_t fast_us = 0u;
+
+    for (size_t i = 0u; i < NUMBER_OF_FRAMES; ++i) {
+      gil_frame = source;
+      auto gil_view = MakeView(gil_frame);
+      carla::StopWatch gil_timer;
+      ImageConverter::CopyPixels(
+          ImageView::MakeColorConvertedView<decltype(gil_view), boost::gil::bgra8_pixel_t>(
+              gil_view,
+              ColorConverter()),
+          gil_view);
+      gil_timer.Stop();
+      gil_us += gil_timer.GetElapsedTime<std::chrono::microseconds>();
+
+      fast_frame = source;
+      auto fast_view = MakeView(fast_frame);
+      carla::StopWatch fast_timer;
+      ImageConverter::ConvertInPlace(fast_view, ColorConverter());
+      fast_timer.Stop();
+      fast_us += fast_timer.GetElapsedTime<std::chrono::microseconds>();
+
+      ASSERT_EQ(std::memcmp(gil_frame.data(), fast_frame.data(), gil_frame.size()), 0);
+    }
+
+    carla::logging::log(
+        name, WIDTH, 'x', HEIGHT, "per frame:",
+        "Boost.GIL", gil_us / NUMBER_OF_FRAMES, "us,",
+        "ConvertInPlace", fast_us / NUMBER_OF_FRAMES, "us");
+  }
+
+} // namespace
+
+TEST(image, benchmark_depth) {
+  Benchmark<carla::image::ColorConverter::Depth>("depth", 255u);
+}
+
+TEST(image, benchmark_logarithmic_depth) {
+  Benchmark<carla::image::ColorConverter::LogarithmicDepth>("logarithmic depth", 255u);
+}
+
+TEST(image, benchmark_cityscapes_palette) {
+  Benchmark<carla::image::ColorConverter::CityScapesPalette>("cityscapes palette", 22u);
+}
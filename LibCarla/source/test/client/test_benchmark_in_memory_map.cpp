@@ -0,0 +1,161 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/Map.h>
+#include <carla/trafficmanager/CachedSimpleWaypoint.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/InMemoryMapCache.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace cc = carla::client;
+namespace ctm = carla::traffic_manager;
+
+static void WriteRecordsCache(const ctm::NodeList &dense_topology, const std::string &filename) {
+  std::ofstream out_file(filename, std::ios::binary);
+  uint32_t total = static_cast<uint32_t>(dense_topology.size());
+  out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
+  for (auto &wp : dense_topology) {
+    ctm::CachedSimpleWaypoint cached_wp(wp);
+    cached_wp.Write(out_file);
+  }
+}
+
+static void WriteFlatCache(const ctm::NodeList &dense_topology, const std::string &filename) {
+  std::ofstream out_file(filename, std::ios::binary);
+  ASSERT_TRUE(ctm::InMemoryMapCache::Write(dense_topology, out_file));
+}
+
+// The waypoints restored from a cache are looked up by road, lane and s, so
+// at a lane section boundary they may get the section, and thus the id, of
+// the next one. Their position and links are the cooked ones.
+static void CheckSameTopology(const ctm::NodeList &lhs, const ctm::NodeList &rhs) {
+  ASSERT_EQ(lhs.size(), rhs.size());
+  for (size_t i = 0u; i < lhs.size(); ++i) {
+    ASSERT_EQ(lhs[i]->GetIndex(), rhs[i]->GetIndex());
+    ASSERT_LT(lhs[i]->Distance(rhs[i]->GetLocation()), 0.01f);
+    ASSERT_EQ(lhs[i]->GetGeodesicGridId(), rhs[i]->GetGeodesicGridId());
+    ASSERT_EQ(lhs[i]->CheckJunction(), rhs[i]->CheckJunction());
+    const auto &lhs_next = lhs[i]->GetNextWaypoint();
+    const auto &rhs_next = rhs[i]->GetNextWaypoint();
+    ASSERT_EQ(lhs_next.size(), rhs_next.size());
+    for (size_t j = 0u; j < lhs_next.size(); ++j) {
+      ASSERT_EQ(lhs_next[j]->GetIndex(), rhs_next[j]->GetIndex());
+    }
+  }
+}
+
+TEST(traffic_manager, in_memory_map_cache_load) {
+  const std::string records_file = "in_memory_map_records.bin";
+  const std::string flat_file = "in_memory_map_flat.bin";
+
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<cc::Map>(file, util::OpenDrive::Load(file));
+
+    ctm::InMemoryMap reference(world_map);
+    reference.SetUp();
+    const ctm::NodeList dense_topology = reference.GetDenseTopology();
+    WriteRecordsCache(dense_topology, records_file);
+    WriteFlatCache(dense_topology, flat_file);
+
+    ctm::InMemoryMap records_map(world_map);
+    carla::StopWatch records_timer;
+    ASSERT_TRUE(records_map.Load(records_file));
+    records_timer.Stop();
+
+    ctm::InMemoryMap flat_map(world_map);
+    carla::StopWatch flat_timer;
+    ASSERT_TRUE(flat_map.Load(flat_file));
+    flat_timer.Stop();
+
+    carla::logging::log(
+        file, ":", dense_topology.size(), "waypoints, records cache",
+        records_timer.GetElapsedTime(), "ms, flat cache",
+        flat_timer.GetElapsedTime(), "ms");
+
+    // The graph of the flat cache is built from the records alone, and its
+    // waypoint objects are created on demand.
+    const ctm::WaypointGraph &reference_graph = reference.GetWaypointGraph();
+    const ctm::WaypointGraph &flat_graph = flat_map.GetWaypointGraph();
+    ASSERT_EQ(flat_graph.Size(), reference_graph.Size());
+    for (ctm::WaypointIndex index = 0u; index < reference_graph.Size(); ++index) {
+      ASSERT_EQ(flat_graph.GetId(index), reference_graph.GetId(index));
+      ASSERT_EQ(flat_graph.GetLocation(index), reference_graph.GetLocation(index));
+      ASSERT_EQ(flat_graph.GetForwardVector(index), reference_graph.GetForwardVector(index));
+      ASSERT_EQ(flat_graph.GetRoadOption(index), reference_graph.GetRoadOption(index));
+      ASSERT_EQ(flat_graph.GetLeftWaypoint(index), reference_graph.GetLeftWaypoint(index));
+      ASSERT_EQ(flat_graph.GetRightWaypoint(index), reference_graph.GetRightWaypoint(index));
+      ASSERT_EQ(flat_graph.GetNextWaypoints(index).size(), reference_graph.GetNextWaypoints(index).size());
+    }
+    if (!dense_topology.empty()) {
+      const auto index = static_cast<ctm::WaypointIndex>(dense_topology.size() - 1u);
+      const ctm::SimpleWaypointPtr simple_waypoint = flat_graph.GetSimpleWaypoint(index);
+      ASSERT_EQ(simple_waypoint->GetIndex(), index);
+      ASSERT_LT(simple_waypoint->Distance(dense_topology.back()->GetLocation()), 0.01f);
+      ASSERT_EQ(flat_graph.GetSimpleWaypoint(index), simple_waypoint);
+    }
+
+    CheckSameTopology(dense_topology, records_map.GetDenseTopology());
+    CheckSameTopology(dense_topology, flat_map.GetDenseTopology());
+
+    const auto location = dense_topology.front()->GetLocation();
+    ASSERT_EQ(
+        reference.GetWaypoint(location)->GetIndex(),
+        flat_map.GetWaypoint(location)->GetIndex());
+    ASSERT_EQ(reference.GetWaypointIndex(location), flat_map.GetWaypointIndex(location));
+  }
+
+  std::remove(records_file.c_str());
+  std::remove(flat_file.c_str());
+}
+
+TEST(traffic_manager, in_memory_map_cache_rejects_corrupted_file) {
+  ctm::InMemoryMapCache::Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, "CTMC", 4u);
+  header.version = ctm::InMemoryMapCache::VERSION;
+  header.number_of_waypoints = 10u;
+  const auto *data = reinterpret_cast<const uint8_t *>(&header);
+  ASSERT_TRUE(ctm::InMemoryMapCache::HasHeader(data, sizeof(header)));
+  ctm::InMemoryMapCache truncated(data, sizeof(header));
+  ASSERT_FALSE(truncated.IsValid());
+}
+
+TEST(traffic_manager, in_memory_map_cache_rejects_other_map) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<cc::Map>(file, util::OpenDrive::Load(file));
+
+    ctm::InMemoryMap reference(world_map);
+    reference.SetUp();
+    if (reference.GetDenseTopology().empty()) {
+      continue;
+    }
+    std::ostringstream out(std::ios::binary);
+    ASSERT_TRUE(ctm::InMemoryMapCache::Write(reference.GetDenseTopology(), out));
+    const std::string content = out.str();
+    std::vector<uint8_t> buffer(content.begin(), content.end());
+
+    // A record on a road that the map does not have.
+    const uint32_t missing_road = 0xFFFFFFFFu;
+    const size_t road_offset =
+        sizeof(ctm::InMemoryMapCache::Header) +
+        offsetof(ctm::InMemoryMapCache::WaypointRecord, road_id);
+    std::memcpy(&buffer[road_offset], &missing_road, sizeof(missing_road));
+
+    ctm::InMemoryMap cached_map(world_map);
+    ASSERT_FALSE(cached_map.Load(buffer));
+  }
+}
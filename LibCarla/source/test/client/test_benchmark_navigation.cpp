@@ -0,0 +1,205 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/nav/Navigation.h>
+
+#include <cstring>
+#include <vector>
+
+using carla::nav::Navigation;
+
+namespace {
+
+  /// Side of the synthetic map, in meters, made of square polygons.
+  constexpr int MAP_SIZE = 1000;
+  constexpr int POLYGON_SIZE = 50;
+  constexpr int POLYGONS_PER_SIDE = MAP_SIZE / POLYGON_SIZE;
+  constexpr float CELL_SIZE = 0.5f;
+  constexpr float CELL_HEIGHT = 0.2f;
+
+  constexpr size_t NUMBER_OF_WARMUP_UPDATES = 20u;
+  constexpr size_t NUMBER_OF_UPDATES = 100u;
+  constexpr double DELTA_SECONDS = 0.05;
+
+  /// Flat square sidewalk in the format of the binary sent by the server,
+  /// a single tile with a grid of polygons.
+  std::vector<uint8_t> MakeNavMesh() {
+    constexpr int VERTS_PER_SIDE = POLYGONS_PER_SIDE + 1;
+    constexpr int NVP = 6;
+    constexpr unsigned short NO_NEIGHBOUR = 0xffff;
+    constexpr unsigned short CELLS_PER_POLYGON = static_cast<unsigned short>(POLYGON_SIZE / CELL_SIZE);
+
+    std::vector<unsigned short> verts;
+    for (int z = 0; z < VERTS_PER_SIDE; ++z) {
+      for (int x = 0; x < VERTS_PER_SIDE; ++x) {
+        verts.push_back(static_cast<unsigned short>(x * CELLS_PER_POLYGON));
+        verts.push_back(0u);
+        verts.push_back(static_cast<unsigned short>(z * CELLS_PER_POLYGON));
+      }
+    }
+
+    auto vertex = [](int x, int z) {
+      return static_cast<unsigned short>(z * VERTS_PER_SIDE + x);
+    };
+    auto polygon = [](int x, int z) {
+      if (x < 0 || z < 0 || x >= POLYGONS_PER_SIDE || z >= POLYGONS_PER_SIDE) {
+        return NO_NEIGHBOUR;
+      }
+      return static_cast<unsigned short>(z * POLYGONS_PER_SIDE + x);
+    };
+
+    // each polygon has NVP vertices followed by NVP neighbours, the
+    // neighbour i shares the edge from the vertex i to the vertex i + 1
+    std::vector<unsigned short> polys;
+    for (int z = 0; z < POLYGONS_PER_SIDE; ++z) {
+      for (int x = 0; x < POLYGONS_PER_SIDE; ++x) {
+        const unsigned short poly[NVP * 2] = {
+            vertex(x, z), vertex(x, z + 1), vertex(x + 1, z + 1), vertex(x + 1, z),
+            NO_NEIGHBOUR, NO_NEIGHBOUR,
+            polygon(x - 1, z), polygon(x, z + 1), polygon(x + 1, z), polygon(x, z - 1),
+            NO_NEIGHBOUR, NO_NEIGHBOUR};
+        polys.insert(polys.end(), poly, poly + NVP * 2);
+      }
+    }
+    const int poly_count = POLYGONS_PER_SIDE * POLYGONS_PER_SIDE;
+    std::vector<unsigned short> flags(poly_count, carla::nav::CARLA_TYPE_SIDEWALK);
+    std::vector<unsigned char> areas(poly_count, carla::nav::CARLA_AREA_SIDEWALK);
+
+    dtNavMeshCreateParams params;
+    std::memset(&params, 0, sizeof(params));
+    params.verts = verts.data();
+    params.vertCount = static_cast<int>(verts.size() / 3u);
+    params.polys = polys.data();
+    params.polyFlags = flags.data();
+    params.polyAreas = areas.data();
+    params.polyCount = poly_count;
+    params.nvp = NVP;
+    params.walkableHeight = 1.8f;
+    params.walkableRadius = 0.3f;
+    params.walkableClimb = 0.5f;
+    params.bmin[0] = 0.0f;
+    params.bmin[1] = -1.0f;
+    params.bmin[2] = 0.0f;
+    params.bmax[0] = static_cast<float>(MAP_SIZE);
+    params.bmax[1] = 1.0f;
+    params.bmax[2] = static_cast<float>(MAP_SIZE);
+    params.cs = CELL_SIZE;
+    params.ch = CELL_HEIGHT;
+    params.buildBvTree = true;
+
+    unsigned char *data = nullptr;
+    int data_size = 0;
+    if (!dtCreateNavMeshData(&params, &data, &data_size)) {
+      return {};
+    }
+
+    // add the tile to a mesh to get its reference
+    dtNavMeshParams mesh_params;
+    std::memset(&mesh_params, 0, sizeof(mesh_params));
+    mesh_params.tileWidth = static_cast<float>(MAP_SIZE);
+    mesh_params.tileHeight = static_cast<float>(MAP_SIZE);
+    mesh_params.maxTiles = 1;
+    mesh_params.maxPolys = poly_count;
+    dtNavMesh *mesh = dtAllocNavMesh();
+    dtTileRef tile_ref = 0;
+    mesh->init(&mesh_params);
+    mesh->addTile(data, data_size, 0, 0, &tile_ref);
+    dtFreeNavMesh(mesh);
+
+#pragma pack(push, 1)
+    struct NavMeshSetHeader {
+      int magic;
+      int version;
+      int num_tiles;
+      dtNavMeshParams params;
+    } header { 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T', 1, 1, mesh_params };
+    struct NavMeshTileHeader {
+      dtTileRef tile_ref;
+      int data_size;
+    } tile_header { tile_ref, data_size };
+#pragma pack(pop)
+
+    std::vector<uint8_t> content(sizeof(header) + sizeof(tile_header) + static_cast<size_t>(data_size));
+    std::memcpy(content.data(), &header, sizeof(header));
+    std::memcpy(content.data() + sizeof(header), &tile_header, sizeof(tile_header));
+    std::memcpy(content.data() + sizeof(header) + sizeof(tile_header), data, static_cast<size_t>(data_size));
+    dtFree(data);
+    return content;
+  }
+
+  carla::geom::Location GetRandomLocation(const Navigation &nav) {
+    carla::geom::Location location;
+    EXPECT_TRUE(nav.GetRandomLocation(location));
+    return location;
+  }
+
+  /// Time per crowd update of @a number_of_walkers walking to random
+  /// locations.
+  void Benchmark(const std::vector<uint8_t> &content, const size_t number_of_walkers) {
+    Navigation nav;
+    nav.SetSeed(42u);
+    ASSERT_TRUE(nav.Load(content));
+    for (size_t i = 0u; i < number_of_walkers; ++i) {
+      auto location = GetRandomLocation(nav);
+      // the walker pivot is at its center
+      location.z += 0.9f;
+      ASSERT_TRUE(nav.AddWalker(static_cast<carla::rpc::ActorId>(i + 1u), location));
+    }
+    ASSERT_EQ(nav.GetNumberOfWalkers(), number_of_walkers);
+    for (size_t i = 0u; i < number_of_walkers; ++i) {
+      nav.SetWalkerTarget(static_cast<carla::rpc::ActorId>(i + 1u), GetRandomLocation(nav));
+    }
+
+    for (size_t i = 0u; i < NUMBER_OF_WARMUP_UPDATES; ++i) {
+      nav.UpdateCrowd(DELTA_SECONDS);
+    }
+    carla::StopWatch timer;
+    for (size_t i = 0u; i < NUMBER_OF_UPDATES; ++i) {
+      nav.UpdateCrowd(DELTA_SECONDS);
+    }
+    timer.Stop();
+
+    ASSERT_EQ(nav.GetNumberOfWalkers(), number_of_walkers);
+    carla::logging::log(
+        number_of_walkers, "walkers in",
+        nav.GetCrowds().size(), "tiles:",
+        timer.GetElapsedTime<std::chrono::microseconds>() / NUMBER_OF_UPDATES, "us per update");
+  }
+
+} // namespace
+
+TEST(navigation, walker_crosses_tiles) {
+  const auto content = MakeNavMesh();
+  ASSERT_FALSE(content.empty());
+  Navigation nav;
+  ASSERT_TRUE(nav.Load(content));
+  // 5 m before the border of the first tile, at 100 m
+  ASSERT_TRUE(nav.AddWalker(1u, carla::geom::Location(95.0f, 50.0f, 0.9f)));
+  ASSERT_TRUE(nav.SetWalkerDirectTarget(1u, carla::geom::Location(150.0f, 50.0f, 0.0f)));
+  ASSERT_EQ(nav.GetCrowds().size(), 1u);
+  for (size_t i = 0u; i < 200u; ++i) {
+    nav.UpdateCrowd(DELTA_SECONDS);
+  }
+  // handed off to the next tile, and still walking to its target, the
+  // first tile is freed once it has no walkers
+  carla::geom::Transform transform;
+  ASSERT_TRUE(nav.GetWalkerTransform(1u, transform));
+  ASSERT_EQ(nav.GetCrowds().size(), 1u);
+  ASSERT_EQ(nav.GetNumberOfWalkers(), 1u);
+  ASSERT_GT(transform.location.x, 105.0f);
+  ASSERT_NEAR(transform.location.y, 50.0f, 1.0f);
+}
+
+TEST(navigation, benchmark_crowd_update) {
+  const auto content = MakeNavMesh();
+  ASSERT_FALSE(content.empty());
+  for (size_t number_of_walkers : {250u, 500u, 1000u, 2000u, 4000u}) {
+    Benchmark(content, number_of_walkers);
+  }
+}
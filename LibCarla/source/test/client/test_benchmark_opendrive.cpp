@@ -0,0 +1,65 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/ParallelFor.h>
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/profiler/Tracer.h>
+
+#include <cstring>
+#include <map>
+#include <string>
+
+using carla::opendrive::OpenDriveParser;
+using carla::profiler::Tracer;
+
+namespace {
+
+  constexpr size_t NUMBER_OF_LOADS = 5u;
+
+  /// Load @a opendrive several times and print the mean time of each phase.
+  void Benchmark(const std::string &name, const std::string &opendrive) {
+    std::map<std::string, uint64_t> phases;
+    Tracer::Clear();
+    Tracer::Enable();
+    carla::StopWatch timer;
+    for (size_t i = 0u; i < NUMBER_OF_LOADS; ++i) {
+      auto map = OpenDriveParser::Load(opendrive);
+      ASSERT_TRUE(map.has_value());
+    }
+    timer.Stop();
+    Tracer::Disable();
+    for (const auto &event : Tracer::GetEvents()) {
+      if ((std::strcmp(event.context, "opendrive") == 0) ||
+          (std::strcmp(event.context, "road") == 0)) {
+        phases[std::string(event.context) + "." + event.name] += event.duration_ns;
+      }
+    }
+    Tracer::Clear();
+
+    carla::logging::log(
+        name, ":", timer.GetElapsedTime() / NUMBER_OF_LOADS, "ms per load with",
+        carla::GetDefaultNumberOfThreads(), "threads");
+    for (const auto &phase : phases) {
+      carla::logging::log(
+          "  ", phase.first, ":", 1e-6 * static_cast<double>(phase.second / NUMBER_OF_LOADS), "ms");
+    }
+  }
+
+} // namespace
+
+TEST(opendrive, benchmark_load) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    Benchmark(file, util::OpenDrive::Load(file));
+  }
+}
+
+TEST(opendrive, benchmark_load_synthetic) {
+  Benchmark("synthetic", util::OpenDrive::MakeSynthetic(400u, 1000.0, 4u));
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/StopWatch.h>
+#include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/data/LidarData.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+  /// Points per frame of a 128 channel lidar sending 2.6 million points per
+  /// second at 20 Hz.
+  constexpr size_t NUMBER_OF_POINTS = 2600000u / 20u;
+  constexpr size_t NUMBER_OF_FRAMES = 10u;
+
+  std::vector<carla::sensor::data::LidarDetection> MakeFrame() {
+    std::mt19937 rng(42u);
+    std::uniform_real_distribution<float> range(1.0f, 100.0f);
+    std::uniform_real_distribution<float> intensity(0.0f, 1.0f);
+    std::vector<carla::sensor::data::LidarDetection> frame;
+    frame.reserve(NUMBER_OF_POINTS);
+    for (size_t i = 0u; i < NUMBER_OF_POINTS; ++i) {
+      const float azimuth = 0.0001f * static_cast<float>(i);
+      const float distance = range(rng);
+      frame.emplace_back(
+          distance * std::cos(azimuth),
+          distance * std::sin(azimuth),
+          0.1f * static_cast<float>(i % 128u) - 2.0f,
+          intensity(rng));
+    }
+    return frame;
+  }
+
+  /// Time per frame and file size of saving a frame to disk in @a format.
+  void Benchmark(const char *name, const carla::pointcloud::PointCloudFormat format) {
+    namespace fs = boost::filesystem;
+    using carla::pointcloud::PointCloudIO;
+    const auto frame = MakeFrame();
+    const auto path = (fs::temp_directory_path() / fs::unique_path("carla-%%%%-%%%%")).string();
+    std::string file;
+    size_t total_us = 0u;
+    for (size_t i = 0u; i < NUMBER_OF_FRAMES; ++i) {
+      carla::StopWatch timer;
+      file = PointCloudIO::SaveToDisk(path, frame.data(), frame.data() + frame.size(), format);
+      timer.Stop();
+      total_us += timer.GetElapsedTime<std::chrono::microseconds>();
+    }
+    const auto size = fs::file_size(file);
+    fs::remove(file);
+    ASSERT_GT(size, 0u);
+    carla::logging::log(
+        name, NUMBER_OF_POINTS, "points per frame:",
+        total_us / NUMBER_OF_FRAMES, "us,",
+        size, "bytes");
+  }
+
+} // namespace
+
+TEST(pointcloud, benchmark_ply_ascii) {
+  Benchmark("PLY ascii", carla::pointcloud::PointCloudFormat::PlyAscii);
+}
+
+TEST(pointcloud, benchmark_ply_binary) {
+  Benchmark("PLY binary", carla::pointcloud::PointCloudFormat::PlyBinary);
+}
+
+TEST(pointcloud, benchmark_pcd_binary) {
+  Benchmark("PCD binary", carla::pointcloud::PointCloudFormat::PcdBinary);
+}
+
+TEST(pointcloud, benchmark_pcd_binary_compressed) {
+  Benchmark("PCD binary compressed", carla::pointcloud::PointCloudFormat::PcdBinaryCompressed);
+}
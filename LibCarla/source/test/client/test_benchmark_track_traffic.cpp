@@ -0,0 +1,86 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/Map.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/TrackTraffic.h>
+
+#include <string>
+#include <vector>
+
+namespace cc = carla::client;
+namespace ctm = carla::traffic_manager;
+
+namespace {
+
+  constexpr size_t NUMBER_OF_VEHICLES = 500u;
+  constexpr size_t HORIZON = 40u;
+  constexpr size_t NUMBER_OF_CYCLES = 50u;
+
+  /// Time the grid updates and overlap queries of NUMBER_OF_VEHICLES
+  /// vehicles placed every @a spacing waypoints of @a graph, each of them
+  /// advancing one waypoint per cycle.
+  void Benchmark(const std::string &name, const ctm::WaypointGraph &graph, size_t spacing) {
+    ctm::TrackTraffic track_traffic;
+    std::vector<ctm::WaypointBuffer> buffers;
+    buffers.reserve(NUMBER_OF_VEHICLES);
+
+    for (size_t i = 0u; i < NUMBER_OF_VEHICLES; ++i) {
+      ctm::WaypointBuffer buffer(graph);
+      buffer.push_back(static_cast<ctm::WaypointIndex>((i * spacing) % graph.Size()));
+      while (buffer.size() < HORIZON && !graph.GetNextWaypoints(buffer.back()).empty()) {
+        buffer.push_back(graph.GetNextWaypoints(buffer.back()).front());
+      }
+      buffers.emplace_back(std::move(buffer));
+    }
+
+    std::vector<carla::ActorId> overlapping;
+    size_t overlaps = 0u;
+    carla::StopWatch timer;
+    for (size_t cycle = 0u; cycle < NUMBER_OF_CYCLES; ++cycle) {
+      for (size_t i = 0u; i < NUMBER_OF_VEHICLES; ++i) {
+        ctm::WaypointBuffer &buffer = buffers[i];
+        const auto next = graph.GetNextWaypoints(buffer.back());
+        if (!next.empty()) {
+          buffer.pop_front();
+          buffer.push_back(next.front());
+        }
+        track_traffic.UpdateGridPosition(static_cast<carla::ActorId>(i + 1u), buffer);
+      }
+      for (size_t i = 0u; i < NUMBER_OF_VEHICLES; ++i) {
+        track_traffic.GetOverlappingVehicles(static_cast<carla::ActorId>(i + 1u), overlapping);
+        overlaps += overlapping.size();
+      }
+    }
+    timer.Stop();
+
+    carla::logging::log(
+        name, ": spacing", spacing, "waypoints,",
+        static_cast<double>(timer.GetElapsedTime<std::chrono::microseconds>()) / NUMBER_OF_CYCLES, "us per cycle,",
+        static_cast<double>(overlaps) / (NUMBER_OF_CYCLES * NUMBER_OF_VEHICLES), "overlapping vehicles on average");
+  }
+
+} // namespace
+
+TEST(traffic_manager, benchmark_track_traffic) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<cc::Map>(file, util::OpenDrive::Load(file));
+    ctm::InMemoryMap local_map(world_map);
+    local_map.SetUp();
+    const ctm::WaypointGraph &graph = local_map.GetWaypointGraph();
+    if (graph.Size() == 0u) {
+      continue;
+    }
+    // Same number of vehicles packed in less road, denser traffic.
+    for (const size_t spacing : {20u, 10u, 5u, 2u, 1u}) {
+      Benchmark(file, graph, spacing);
+    }
+  }
+}
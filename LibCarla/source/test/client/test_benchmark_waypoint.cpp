@@ -0,0 +1,113 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/ParallelFor.h>
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+
+#include <string>
+#include <vector>
+
+using carla::road::Map;
+using carla::road::element::Waypoint;
+
+namespace {
+
+  constexpr size_t NUMBER_OF_QUERIES = 100000u;
+
+  template <typename FunctionT>
+  void Measure(const char *name, FunctionT &&function) {
+    carla::StopWatch timer;
+    for (size_t i = 0u; i < NUMBER_OF_QUERIES; ++i) {
+      function(i);
+    }
+    timer.Stop();
+    carla::logging::log(
+        "  ", name, ":",
+        1e3 * static_cast<double>(timer.GetElapsedTime<std::chrono::microseconds>()) / NUMBER_OF_QUERIES,
+        "ns per query");
+  }
+
+  template <typename FunctionT>
+  void MeasureBatch(const char *name, FunctionT &&function) {
+    carla::StopWatch timer;
+    function();
+    timer.Stop();
+    carla::logging::log(
+        "  ", name, ":",
+        1e3 * static_cast<double>(timer.GetElapsedTime<std::chrono::microseconds>()) / NUMBER_OF_QUERIES,
+        "ns per query with", carla::GetDefaultNumberOfThreads(), "threads");
+  }
+
+  /// Throughput of the waypoint queries on random points of the roads.
+  void Benchmark(const std::string &name, const std::string &opendrive) {
+    const auto map = carla::opendrive::OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(map.has_value());
+
+    auto waypoints = map->GenerateWaypoints(2.0);
+    ASSERT_FALSE(waypoints.empty());
+    util::Random::Shuffle(waypoints);
+    std::vector<carla::geom::Location> locations;
+    locations.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      locations.emplace_back(map->ComputeTransform(waypoint).location);
+    }
+
+    carla::logging::log(name, ":", waypoints.size(), "waypoints");
+    size_t found = 0u;
+    Measure("ComputeTransform", [&](size_t i) {
+      found += map->ComputeTransform(waypoints[i % waypoints.size()]).location.z > -1e6f ? 1u : 0u;
+    });
+    Measure("GetWaypoint", [&](size_t i) {
+      found += map->GetWaypoint(locations[i % locations.size()]).has_value() ? 1u : 0u;
+    });
+    Measure("GetClosestWaypointOnRoad", [&](size_t i) {
+      found += map->GetClosestWaypointOnRoad(locations[i % locations.size()]).has_value() ? 1u : 0u;
+    });
+    Measure("GetNext", [&](size_t i) {
+      found += map->GetNext(waypoints[i % waypoints.size()], 2.0).size();
+    });
+    Measure("GetLaneWidth", [&](size_t i) {
+      found += map->GetLaneWidth(waypoints[i % waypoints.size()]) > 0.0 ? 1u : 0u;
+    });
+
+    // Batched queries, one call for all the queries.
+    std::vector<Waypoint> waypoint_batch;
+    std::vector<carla::geom::Location> location_batch;
+    for (size_t i = 0u; i < NUMBER_OF_QUERIES; ++i) {
+      waypoint_batch.emplace_back(waypoints[i % waypoints.size()]);
+      location_batch.emplace_back(locations[i % locations.size()]);
+    }
+    MeasureBatch("ComputeTransforms", [&]() {
+      found += map->ComputeTransforms(waypoint_batch).size();
+    });
+    MeasureBatch("GetWaypoints", [&]() {
+      found += map->GetWaypoints(location_batch).size();
+    });
+    MeasureBatch("GetClosestWaypointsOnRoad", [&]() {
+      found += map->GetClosestWaypointsOnRoad(location_batch).size();
+    });
+    MeasureBatch("GetNextWaypoints", [&]() {
+      found += map->GetNextWaypoints(waypoint_batch, 2.0).size();
+    });
+    MeasureBatch("GetLaneWidths", [&]() {
+      found += map->GetLaneWidths(waypoint_batch).size();
+    });
+    ASSERT_GT(found, 0u);
+  }
+
+} // namespace
+
+TEST(road, benchmark_waypoint_queries) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    Benchmark(file, util::OpenDrive::Load(file));
+  }
+  Benchmark("synthetic", util::OpenDrive::MakeSynthetic(100u, 1000.0, 4u));
+}
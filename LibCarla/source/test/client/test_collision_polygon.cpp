@@ -0,0 +1,95 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/geom/Math.h>
+#include <carla/trafficmanager/CollisionPolygon.h>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/point_xy.hpp>
+#include <boost/geometry/geometries/polygon.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace bg = boost::geometry;
+namespace cg = carla::geom;
+namespace ctm = carla::traffic_manager;
+
+using BoostPolygon = bg::model::polygon<bg::model::d2::point_xy<double>>;
+
+/// Star shaped polygon around @a center, not convex in general, like the
+/// boundary of the path of a vehicle along a curve.
+static std::vector<cg::Location> MakeBoundary(const cg::Location &center, size_t number_of_points) {
+  std::vector<cg::Location> boundary;
+  for (size_t i = 0u; i < number_of_points; ++i) {
+    const float angle = -2.0f * cg::Math::Pi<float>() * static_cast<float>(i) / static_cast<float>(number_of_points);
+    const auto radius = static_cast<float>(util::Random::Uniform(1.0, 6.0));
+    boundary.emplace_back(center.x + radius * std::cos(angle), center.y + radius * std::sin(angle), 0.0f);
+  }
+  return boundary;
+}
+
+static BoostPolygon MakeBoostPolygon(const std::vector<cg::Location> &boundary) {
+  BoostPolygon polygon;
+  for (const auto &location : boundary) {
+    bg::append(polygon.outer(), bg::model::d2::point_xy<double>(location.x, location.y));
+  }
+  bg::append(polygon.outer(), bg::model::d2::point_xy<double>(boundary.front().x, boundary.front().y));
+  bg::correct(polygon);
+  return polygon;
+}
+
+TEST(traffic_manager, collision_polygon_distance) {
+  constexpr size_t NUMBER_OF_PAIRS = 5000u;
+  std::vector<ctm::CollisionPolygon> polygons;
+  std::vector<BoostPolygon> boost_polygons;
+  for (size_t i = 0u; i < 2u * NUMBER_OF_PAIRS; ++i) {
+    const auto boundary = MakeBoundary(util::Random::Location(-20.0f, 20.0f), i % 2u == 0u ? 4u : 16u);
+    polygons.emplace_back(boundary);
+    boost_polygons.emplace_back(MakeBoostPolygon(boundary));
+  }
+
+  size_t overlapping = 0u;
+  std::vector<double> distances(NUMBER_OF_PAIRS);
+  carla::StopWatch timer;
+  for (size_t i = 0u; i < NUMBER_OF_PAIRS; ++i) {
+    distances[i] = ctm::CollisionPolygon::Distance(polygons[2u * i], polygons[2u * i + 1u]);
+  }
+  timer.Stop();
+
+  std::vector<double> expected(NUMBER_OF_PAIRS);
+  carla::StopWatch boost_timer;
+  for (size_t i = 0u; i < NUMBER_OF_PAIRS; ++i) {
+    expected[i] = bg::distance(boost_polygons[2u * i], boost_polygons[2u * i + 1u]);
+  }
+  boost_timer.Stop();
+
+  for (size_t i = 0u; i < NUMBER_OF_PAIRS; ++i) {
+    ASSERT_NEAR(distances[i], expected[i], 1e-6);
+    ASSERT_EQ(distances[i], ctm::CollisionPolygon::Distance(polygons[2u * i + 1u], polygons[2u * i]));
+    overlapping += distances[i] == 0.0 ? 1u : 0u;
+  }
+  ASSERT_GT(overlapping, 0u);
+  ASSERT_LT(overlapping, NUMBER_OF_PAIRS);
+
+  carla::logging::log(
+      NUMBER_OF_PAIRS, "pairs,", overlapping, "overlapping, CollisionPolygon",
+      timer.GetElapsedTime<std::chrono::microseconds>(), "us, boost::geometry",
+      boost_timer.GetElapsedTime<std::chrono::microseconds>(), "us");
+}
+
+TEST(traffic_manager, collision_polygon_contained) {
+  const std::vector<cg::Location> outer = {{-10.0f, -10.0f, 0.0f}, {-10.0f, 10.0f, 0.0f}, {10.0f, 10.0f, 0.0f}, {10.0f, -10.0f, 0.0f}};
+  const std::vector<cg::Location> inner = {{-1.0f, -1.0f, 0.0f}, {-1.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {1.0f, -1.0f, 0.0f}};
+  const std::vector<cg::Location> apart = {{20.0f, -1.0f, 0.0f}, {20.0f, 1.0f, 0.0f}, {22.0f, 1.0f, 0.0f}, {22.0f, -1.0f, 0.0f}};
+  ASSERT_EQ(ctm::CollisionPolygon::Distance(ctm::CollisionPolygon(outer), ctm::CollisionPolygon(inner)), 0.0);
+  ASSERT_EQ(ctm::CollisionPolygon::Distance(ctm::CollisionPolygon(inner), ctm::CollisionPolygon(outer)), 0.0);
+  ASSERT_NEAR(ctm::CollisionPolygon::Distance(ctm::CollisionPolygon(outer), ctm::CollisionPolygon(apart)), 10.0, 1e-9);
+}
@@ -95,27 +95,38 @@ TEST(image, depth) {
   ImageConverter::CopyPixels(img_bgra8.view, img_copy.view);
   ImageConverter::ConvertInPlace(img_copy.view, ColorConverter::LogarithmicDepth());
 
+  auto img_depth_copy = MakeTestImage<bgra8_pixel_t>(width, height);
+  ImageConverter::CopyPixels(img_bgra8.view, img_depth_copy.view);
+  ImageConverter::ConvertInPlace(img_depth_copy.view, ColorConverter::Depth());
+
   {
     auto it_gray8 = img_gray8.view.begin();
     auto it_depth = depth_view.begin();
     auto it_ldepth = ldepth_view.begin();
     auto it_copy = img_copy.view.begin();
+    auto it_depth_copy = img_depth_copy.view.begin();
 
     for (auto i = 0u; i < width; ++i) {
       auto p_gray8 = *it_gray8;
       auto p_depth = *it_depth;
       auto p_ldepth = *it_ldepth;
       auto p_copy = *it_copy;
+      auto p_depth_copy = *it_depth_copy;
       ASSERT_NEAR(int(p_depth[0]), int(p_gray8[0]), 1)
           << "at XY(" << i << ",0)";
       decltype(p_copy) ld;
       color_convert(p_ldepth, ld);
       ASSERT_EQ(ld, p_copy)
           << "at XY(" << i << ",0)";
+      decltype(p_depth_copy) d;
+      color_convert(p_depth, d);
+      ASSERT_EQ(d, p_depth_copy)
+          << "at XY(" << i << ",0)";
       ++it_gray8;
       ++it_depth;
       ++it_ldepth;
       ++it_copy;
+      ++it_depth_copy;
     }
   }
 #endif // NDEBUG
@@ -186,3 +197,37 @@ TEST(image, semantic_segmentation) {
     }
   }
 }
+
+TEST(image, semantic_segmentation_bgra8) {
+  using namespace boost::gil;
+  using namespace carla::image;
+
+  constexpr auto width = 256u;
+  constexpr auto height = 2u;
+
+  auto img_bgra8 = MakeTestImage<bgra8_pixel_t>(width, height);
+  for (auto y = 0u; y < height; ++y) {
+    for (auto x = 0u; x < width; ++x) {
+      auto &p = img_bgra8.view(x, y);
+      get_color(p, red_t()) = static_cast<uint8_t>(x);
+      get_color(p, green_t()) = static_cast<uint8_t>(y);
+      get_color(p, blue_t()) = 7u;
+      get_color(p, alpha_t()) = 0u;
+    }
+  }
+
+  auto semseg_view = ImageView::MakeColorConvertedView(
+      img_bgra8.view,
+      ColorConverter::CityScapesPalette());
+
+  auto img_copy = MakeTestImage<bgra8_pixel_t>(width, height);
+  ImageConverter::CopyPixels(img_bgra8.view, img_copy.view);
+  ImageConverter::ConvertInPlace(img_copy.view, ColorConverter::CityScapesPalette());
+
+  for (auto y = 0u; y < height; ++y) {
+    for (auto x = 0u; x < width; ++x) {
+      ASSERT_EQ(semseg_view(x, y), img_copy.view(x, y))
+          << "at XY(" << x << "," << y << ")";
+    }
+  }
+}
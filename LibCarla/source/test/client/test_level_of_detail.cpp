@@ -0,0 +1,88 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/LevelOfDetail.h>
+#include <carla/trafficmanager/Parameters.h>
+#include <carla/trafficmanager/SimulationState.h>
+
+#include <vector>
+
+namespace cg = carla::geom;
+namespace ctm = carla::traffic_manager;
+
+static void AddVehicle(ctm::SimulationState &simulation_state, carla::ActorId actor_id, float x) {
+  simulation_state.AddActor(
+      actor_id,
+      {cg::Location(x, 0.0f, 0.0f), cg::Rotation(), cg::Vector3D(), 30.0f, true, false},
+      {ctm::ActorType::Vehicle, 2.4f, 1.0f, 0.8f},
+      {carla::rpc::TrafficLightState::Green, false});
+}
+
+TEST(traffic_manager, level_of_detail_tiers) {
+  ctm::SimulationState simulation_state;
+  AddVehicle(simulation_state, 1u, 10.0f);
+  AddVehicle(simulation_state, 2u, 60.0f);
+  AddVehicle(simulation_state, 3u, 200.0f);
+  const std::vector<carla::ActorId> vehicle_ids = {1u, 2u, 3u};
+  const std::vector<cg::Location> hero_locations = {cg::Location(0.0f, 0.0f, 0.0f)};
+
+  // Tiers are sorted by radius, extra radii are ignored.
+  ctm::Parameters parameters;
+  parameters.SetLevelOfDetail({150.0f, 50.0f, 500.0f}, {3u, 2u});
+  const ctm::LODTierList tiers = parameters.GetLevelOfDetail();
+  ASSERT_EQ(tiers.size(), 2u);
+  ASSERT_EQ(tiers[0].radius, 50.0f);
+  ASSERT_EQ(tiers[0].update_interval, 2u);
+  ASSERT_EQ(tiers[1].update_interval, 3u);
+
+  ctm::LevelOfDetail level_of_detail;
+  level_of_detail.Update(tiers, vehicle_ids, simulation_state, hero_locations);
+  ASSERT_EQ(level_of_detail.GetTier(0u), 0u);
+  ASSERT_EQ(level_of_detail.GetTier(1u), 1u);
+  ASSERT_EQ(level_of_detail.GetTier(2u), 2u);
+  ASSERT_EQ(level_of_detail.GetTierCounts(), (std::vector<uint64_t>{1u, 1u, 1u}));
+  // Vehicles new to a tier are updated right away.
+  for (unsigned long index = 0u; index < vehicle_ids.size(); ++index) {
+    ASSERT_TRUE(level_of_detail.IsScheduled(index));
+  }
+
+  std::vector<size_t> updates(vehicle_ids.size(), 0u);
+  constexpr size_t NUMBER_OF_CYCLES = 12u;
+  for (size_t cycle = 0u; cycle < NUMBER_OF_CYCLES; ++cycle) {
+    level_of_detail.Update(tiers, vehicle_ids, simulation_state, hero_locations);
+    for (unsigned long index = 0u; index < vehicle_ids.size(); ++index) {
+      updates[index] += level_of_detail.IsScheduled(index) ? 1u : 0u;
+    }
+  }
+  ASSERT_EQ(updates[0], NUMBER_OF_CYCLES);
+  ASSERT_EQ(updates[1], NUMBER_OF_CYCLES / 2u);
+  ASSERT_EQ(updates[2], NUMBER_OF_CYCLES / 3u);
+}
+
+TEST(traffic_manager, level_of_detail_without_heroes) {
+  ctm::SimulationState simulation_state;
+  AddVehicle(simulation_state, 1u, 10.0f);
+  AddVehicle(simulation_state, 2u, 1000.0f);
+  const std::vector<carla::ActorId> vehicle_ids = {1u, 2u};
+
+  ctm::LevelOfDetail level_of_detail;
+  const ctm::LODTierList tiers = {{50.0f, 4u}};
+  for (size_t cycle = 0u; cycle < 4u; ++cycle) {
+    level_of_detail.Update(tiers, vehicle_ids, simulation_state, {});
+    for (unsigned long index = 0u; index < vehicle_ids.size(); ++index) {
+      ASSERT_EQ(level_of_detail.GetTier(index), 0u);
+      ASSERT_TRUE(level_of_detail.IsScheduled(index));
+    }
+  }
+  ASSERT_EQ(level_of_detail.GetTierCounts(), (std::vector<uint64_t>{2u, 0u}));
+
+  // Without tiers every vehicle is updated every cycle.
+  level_of_detail.Update({}, vehicle_ids, simulation_state, {cg::Location()});
+  ASSERT_EQ(level_of_detail.GetTierCounts(), (std::vector<uint64_t>{2u}));
+  ASSERT_TRUE(level_of_detail.IsScheduled(1u));
+}
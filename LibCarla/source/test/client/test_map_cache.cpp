@@ -0,0 +1,128 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/geom/Math.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/MapCache.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using carla::opendrive::OpenDriveParser;
+using carla::road::Map;
+using carla::road::MapCache;
+
+/// Copy of the cache in a buffer aligned as a memory-mapped file.
+static std::vector<uint64_t> WriteCache(const Map &map, const std::string &opendrive) {
+  std::ostringstream out;
+  EXPECT_TRUE(MapCache::Write(map, opendrive, out));
+  const auto content = out.str();
+  std::vector<uint64_t> buffer((content.size() + sizeof(uint64_t) - 1u) / sizeof(uint64_t));
+  std::memcpy(buffer.data(), content.data(), content.size());
+  return buffer;
+}
+
+static void CheckSameJunctions(Map &lhs, Map &rhs) {
+  const auto &junctions = lhs.GetMap().GetJunctions();
+  ASSERT_EQ(junctions.size(), rhs.GetMap().GetJunctions().size());
+  for (const auto &pair : junctions) {
+    const auto &junction = pair.second;
+    const auto *other = rhs.GetJunction(pair.first);
+    ASSERT_NE(other, nullptr);
+    ASSERT_EQ(junction.GetBoundingBox().location, other->GetBoundingBox().location);
+    ASSERT_EQ(junction.GetBoundingBox().extent, other->GetBoundingBox().extent);
+    for (const auto &road : lhs.GetMap().GetRoads()) {
+      const auto road_id = road.first;
+      ASSERT_EQ(junction.RoadHasConflicts(road_id), other->RoadHasConflicts(road_id));
+      if (junction.RoadHasConflicts(road_id)) {
+        ASSERT_EQ(junction.GetConflictsOfRoad(road_id), other->GetConflictsOfRoad(road_id));
+      }
+    }
+  }
+}
+
+static void CheckSameWaypoints(const Map &lhs, const Map &rhs) {
+  for (auto i = 0u; i < 1000u; ++i) {
+    const auto location = util::Random::Location(-500.0f, 500.0f);
+    const auto waypoint = lhs.GetClosestWaypointOnRoad(location);
+    const auto other = rhs.GetClosestWaypointOnRoad(location);
+    ASSERT_EQ(waypoint.has_value(), other.has_value());
+    if (waypoint.has_value()) {
+      const auto transform = lhs.ComputeTransform(*waypoint);
+      const auto other_transform = rhs.ComputeTransform(*other);
+      // A point at the same distance of two segments may match either one.
+      ASSERT_NEAR(
+          carla::geom::Math::Distance(location, transform.location),
+          carla::geom::Math::Distance(location, other_transform.location),
+          1e-3);
+    }
+  }
+}
+
+TEST(road, map_cache_load) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    carla::StopWatch parse_timer;
+    auto map = OpenDriveParser::Load(opendrive);
+    parse_timer.Stop();
+    ASSERT_TRUE(map.has_value());
+
+    const auto buffer = WriteCache(*map, opendrive);
+    const MapCache cache(
+        reinterpret_cast<const uint8_t *>(buffer.data()),
+        buffer.size() * sizeof(uint64_t));
+    ASSERT_TRUE(cache.IsValid());
+    ASSERT_TRUE(cache.IsCacheOf(opendrive));
+    ASSERT_FALSE(cache.IsCacheOf(opendrive + " "));
+
+    carla::StopWatch cache_timer;
+    auto cached_map = OpenDriveParser::Load(opendrive, cache);
+    cache_timer.Stop();
+    ASSERT_TRUE(cached_map.has_value());
+
+    CheckSameJunctions(*map, *cached_map);
+    CheckSameWaypoints(*map, *cached_map);
+
+    carla::logging::log(
+        file, ": parsed in", parse_timer.GetElapsedTime(),
+        "ms, loaded with cache in", cache_timer.GetElapsedTime(), "ms");
+  }
+}
+
+TEST(road, map_cache_rejects_corrupted) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    auto map = OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(map.has_value());
+    auto buffer = WriteCache(*map, opendrive);
+    const auto *data = reinterpret_cast<const uint8_t *>(buffer.data());
+    const auto size = buffer.size() * sizeof(uint64_t);
+
+    ASSERT_FALSE(MapCache(data, sizeof(MapCache::Header) - 1u).IsValid());
+    if (MapCache(data, size).GetNumberOfSegments() > 0u) {
+      ASSERT_FALSE(MapCache(data, sizeof(MapCache::Header)).IsValid());
+    }
+
+    auto &header = *reinterpret_cast<MapCache::Header *>(buffer.data());
+    ++header.version;
+    ASSERT_FALSE(MapCache(data, size).IsValid());
+    --header.version;
+
+    // A cache of another OpenDRIVE is ignored.
+    const MapCache cache(data, size);
+    ASSERT_TRUE(cache.IsValid());
+    ++header.opendrive_hash;
+    ASSERT_FALSE(cache.IsCacheOf(opendrive));
+    ASSERT_TRUE(OpenDriveParser::Load(opendrive, cache).has_value());
+  }
+}
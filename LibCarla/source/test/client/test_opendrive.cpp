@@ -424,3 +424,38 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+TEST(road, get_waypoint_batched) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+    std::vector<Location> locations;
+    for (auto i = 0u; i < 2'000u; ++i) {
+      locations.emplace_back(Random::Location(-500.0f, 500.0f));
+    }
+    const auto closest = map.GetClosestWaypointsOnRoad(locations);
+    const auto exact = map.GetWaypoints(locations);
+    ASSERT_EQ(closest.size(), locations.size());
+    ASSERT_EQ(exact.size(), locations.size());
+    std::vector<Waypoint> waypoints;
+    for (auto i = 0u; i < locations.size(); ++i) {
+      ASSERT_TRUE(closest[i] == map.GetClosestWaypointOnRoad(locations[i]));
+      ASSERT_TRUE(exact[i] == map.GetWaypoint(locations[i]));
+      if (closest[i].has_value()) {
+        waypoints.emplace_back(*closest[i]);
+      }
+    }
+    const auto transforms = map.ComputeTransforms(waypoints);
+    const auto widths = map.GetLaneWidths(waypoints);
+    const auto next = map.GetNextWaypoints(waypoints, 2.0);
+    ASSERT_EQ(transforms.size(), waypoints.size());
+    ASSERT_EQ(widths.size(), waypoints.size());
+    ASSERT_EQ(next.size(), waypoints.size());
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      ASSERT_EQ(transforms[i], map.ComputeTransform(waypoints[i]));
+      ASSERT_EQ(widths[i], map.GetLaneWidth(waypoints[i]));
+      ASSERT_EQ(next[i], map.GetNext(waypoints[i], 2.0));
+    }
+  }
+}
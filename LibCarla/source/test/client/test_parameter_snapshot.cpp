@@ -0,0 +1,52 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/Parameters.h>
+
+#include <vector>
+
+namespace ctm = carla::traffic_manager;
+
+TEST(traffic_manager, parameter_snapshot) {
+  ctm::Parameters parameters;
+  parameters.SetGlobalDistanceToLeadingVehicle(4.0f);
+  parameters.SetGlobalPercentageSpeedDifference(20.0f);
+
+  const std::vector<carla::ActorId> vehicle_ids = {7u, 3u, 5u};
+  parameters.UpdateSnapshot(vehicle_ids);
+
+  const ctm::ParameterSnapshot &snapshot = parameters.GetSnapshot();
+  ASSERT_EQ(snapshot.size(), vehicle_ids.size());
+  for (unsigned long index = 0u; index < vehicle_ids.size(); ++index) {
+    const ctm::VehicleParameters &vehicle = snapshot[index];
+    ASSERT_EQ(&vehicle, &snapshot.Find(vehicle_ids[index]));
+    ASSERT_FLOAT_EQ(vehicle.distance_to_leading_vehicle, 4.0f);
+    ASSERT_FLOAT_EQ(vehicle.GetTargetVelocity(50.0f), 40.0f);
+    ASSERT_EQ(vehicle.distance_to_leading_vehicle, parameters.GetDistanceToLeadingVehicle(vehicle_ids[index]));
+    ASSERT_EQ(vehicle.auto_lane_change, parameters.GetAutoLaneChange(vehicle_ids[index]));
+    ASSERT_TRUE(vehicle.GetCollisionDetection(vehicle_ids[0u]));
+  }
+
+  // Actors that are not registered vehicles get the global settings.
+  const ctm::VehicleParameters &walker = snapshot.Find(42u);
+  ASSERT_FLOAT_EQ(walker.distance_to_leading_vehicle, 4.0f);
+  ASSERT_FLOAT_EQ(walker.perc_ignore_vehicles, 0.0f);
+
+  // Changes are only visible once the snapshot is updated.
+  parameters.SetGlobalDistanceToLeadingVehicle(1.0f);
+  ASSERT_FLOAT_EQ(snapshot[0u].distance_to_leading_vehicle, 4.0f);
+  parameters.UpdateSnapshot(vehicle_ids);
+  ASSERT_FLOAT_EQ(snapshot[0u].distance_to_leading_vehicle, 1.0f);
+  ASSERT_FLOAT_EQ(snapshot.Find(42u).distance_to_leading_vehicle, 1.0f);
+
+  // A different vehicle list rebuilds the table.
+  parameters.UpdateSnapshot({3u});
+  ASSERT_EQ(snapshot.size(), 1u);
+  ASSERT_EQ(&snapshot[0u], &snapshot.Find(3u));
+  ASSERT_NE(&snapshot[0u], &snapshot.Find(7u));
+}
@@ -0,0 +1,190 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/pointcloud/Lzf.h>
+#include <carla/pointcloud/PointCloudChunkWriter.h>
+#include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/data/LidarData.h>
+#include <carla/sensor/data/SemanticLidarData.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <list>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using carla::pointcloud::Lzf;
+using carla::pointcloud::PointCloudChunkWriter;
+using carla::pointcloud::PointCloudFormat;
+using carla::pointcloud::PointCloudIO;
+using carla::sensor::data::LidarDetection;
+using carla::sensor::data::SemanticLidarDetection;
+
+static std::vector<LidarDetection> MakeDetections(size_t count) {
+  std::mt19937 rng(7u);
+  std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+  std::vector<LidarDetection> detections;
+  for (size_t i = 0u; i < count; ++i) {
+    detections.emplace_back(coordinate(rng), coordinate(rng), 0.25f * float(i % 4u), 0.5f);
+  }
+  return detections;
+}
+
+/// Split a PLY or PCD file at the end of its header.
+static std::pair<std::string, std::string> SplitHeader(const std::string &file, const std::string &last_line) {
+  const auto end_of_header = file.find(last_line);
+  EXPECT_NE(end_of_header, std::string::npos);
+  const auto body = end_of_header + last_line.size();
+  return {file.substr(0u, body), file.substr(body)};
+}
+
+template <typename T>
+static std::string AsBytes(const std::vector<T> &points) {
+  return {reinterpret_cast<const char *>(points.data()), points.size() * sizeof(T)};
+}
+
+TEST(pointcloud, lzf) {
+  std::mt19937 rng(3u);
+  std::uniform_int_distribution<int> byte(0, 255);
+  for (const size_t size : {0u, 1u, 2u, 3u, 100u, 10000u, 100000u}) {
+    for (const bool repetitive : {false, true}) {
+      std::vector<uint8_t> data(size);
+      for (size_t i = 0u; i < size; ++i) {
+        data[i] = (repetitive && (i >= 64u)) ? data[i - 64u] : static_cast<uint8_t>(byte(rng));
+      }
+      std::vector<uint8_t> compressed;
+      Lzf::Compress(data.data(), data.size(), compressed);
+      if (repetitive && (size >= 10000u)) {
+        ASSERT_LT(compressed.size(), size / 10u);
+      }
+      std::vector<uint8_t> decompressed(size);
+      ASSERT_TRUE(Lzf::Decompress(compressed.data(), compressed.size(), decompressed));
+      ASSERT_EQ(decompressed, data);
+    }
+  }
+  std::vector<uint8_t> too_small(10u);
+  const std::vector<uint8_t> literal = {3u, 'a', 'b', 'c', 'd'};
+  ASSERT_TRUE(Lzf::Decompress(literal.data(), literal.size(), too_small) == false);
+}
+
+TEST(pointcloud, binary_ply) {
+  const auto detections = MakeDetections(1000u);
+  std::ostringstream out;
+  PointCloudIO::Dump(out, detections.data(), detections.data() + detections.size(), PointCloudFormat::PlyBinary);
+  const auto file = SplitHeader(out.str(), "end_header\n");
+  ASSERT_EQ(
+      file.first,
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex 1000\n"
+      "property float32 x\n"
+      "property float32 y\n"
+      "property float32 z\n"
+      "property float32 I\n"
+      "end_header\n");
+  ASSERT_EQ(file.second, AsBytes(detections));
+
+  // Non-contiguous points are copied first.
+  const std::list<LidarDetection> list(detections.begin(), detections.end());
+  std::ostringstream list_out;
+  PointCloudIO::Dump(list_out, list.begin(), list.end(), PointCloudFormat::PlyBinary);
+  ASSERT_EQ(list_out.str(), out.str());
+}
+
+TEST(pointcloud, binary_pcd) {
+  std::vector<SemanticLidarDetection> detections;
+  for (uint32_t i = 0u; i < 500u; ++i) {
+    detections.emplace_back(float(i), -float(i), 1.0f, 0.5f, i, i % 23u);
+  }
+  const auto *begin = detections.data();
+  const auto *end = begin + detections.size();
+
+  std::ostringstream binary;
+  PointCloudIO::Dump(binary, begin, end, PointCloudFormat::PcdBinary);
+  const auto binary_file = SplitHeader(binary.str(), "DATA binary\n");
+  ASSERT_NE(binary_file.first.find("FIELDS x y z CosAngle ObjIdx ObjTag\n"), std::string::npos);
+  ASSERT_NE(binary_file.first.find("POINTS 500\n"), std::string::npos);
+  ASSERT_EQ(binary_file.second, AsBytes(detections));
+
+  std::ostringstream compressed;
+  PointCloudIO::Dump(compressed, begin, end, PointCloudFormat::PcdBinaryCompressed);
+  const auto compressed_file = SplitHeader(compressed.str(), "DATA binary_compressed\n");
+  ASSERT_EQ(compressed_file.first.substr(0u, compressed_file.first.find("DATA")),
+            binary_file.first.substr(0u, binary_file.first.find("DATA")));
+  const auto &data = compressed_file.second;
+  uint32_t sizes[2u];
+  std::memcpy(sizes, data.data(), sizeof(sizes));
+  ASSERT_EQ(sizes[0u], data.size() - sizeof(sizes));
+  ASSERT_EQ(sizes[1u], detections.size() * sizeof(SemanticLidarDetection));
+  ASSERT_LT(sizes[0u], sizes[1u]);
+  std::vector<uint8_t> fields(sizes[1u]);
+  ASSERT_TRUE(Lzf::Decompress(
+      reinterpret_cast<const uint8_t *>(data.data()) + sizeof(sizes),
+      sizes[0u],
+      fields));
+  // Each field of all the points is stored together.
+  for (size_t i = 0u; i < detections.size(); ++i) {
+    float x;
+    uint32_t tag;
+    std::memcpy(&x, fields.data() + i * 4u, 4u);
+    std::memcpy(&tag, fields.data() + (5u * detections.size() + i) * 4u, 4u);
+    ASSERT_EQ(x, detections[i].point.x);
+    ASSERT_EQ(tag, detections[i].object_tag);
+  }
+}
+
+TEST(pointcloud, chunk_writer) {
+  namespace fs = boost::filesystem;
+  const auto path = (fs::temp_directory_path() / fs::unique_path("carla-%%%%-%%%%.pcl")).string();
+  const auto detections = MakeDetections(100u);
+  const auto *begin = detections.data();
+
+  {
+    PointCloudChunkWriter writer(path);
+    writer.Append(10u, 0.5, begin, begin + 100u);
+    writer.Append(11u, 0.55, begin, begin + 50u);
+  }
+  {
+    // Appending continues the same file.
+    PointCloudChunkWriter writer(path);
+    writer.Append(12u, 0.6, begin, begin);
+  }
+
+  std::ifstream in(path, std::ios::binary);
+  char magic[8u];
+  uint32_t version;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), sizeof(version));
+  ASSERT_EQ(std::string(magic, 8u), "CARLAPCL");
+  ASSERT_EQ(version, PointCloudChunkWriter::version);
+
+  const std::vector<std::pair<uint64_t, size_t>> expected = {{10u, 100u}, {11u, 50u}, {12u, 0u}};
+  for (const auto &chunk : expected) {
+    uint64_t frame;
+    double timestamp;
+    uint8_t format;
+    uint64_t size;
+    in.read(reinterpret_cast<char *>(&frame), sizeof(frame));
+    in.read(reinterpret_cast<char *>(&timestamp), sizeof(timestamp));
+    in.read(reinterpret_cast<char *>(&format), sizeof(format));
+    in.read(reinterpret_cast<char *>(&size), sizeof(size));
+    std::string payload(size, '\0');
+    in.read(&payload[0u], static_cast<std::streamsize>(size));
+    ASSERT_TRUE(in.good());
+    ASSERT_EQ(frame, chunk.first);
+    ASSERT_EQ(format, static_cast<uint8_t>(PointCloudFormat::PlyBinary));
+    const auto file = SplitHeader(payload, "end_header\n");
+    ASSERT_NE(file.first.find("element vertex " + std::to_string(chunk.second) + "\n"), std::string::npos);
+    ASSERT_EQ(file.second, AsBytes(std::vector<LidarDetection>(begin, begin + chunk.second)));
+  }
+  ASSERT_EQ(in.peek(), std::char_traits<char>::eof());
+  in.close();
+  fs::remove(path);
+}
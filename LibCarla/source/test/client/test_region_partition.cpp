@@ -0,0 +1,107 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/client/Map.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/RegionPartition.h>
+#include <carla/trafficmanager/ShardBatch.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace cc = carla::client;
+namespace ctm = carla::traffic_manager;
+
+TEST(traffic_manager, region_partition) {
+  constexpr uint64_t NUMBER_OF_REGIONS = 4u;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<cc::Map>(file, util::OpenDrive::Load(file));
+    ctm::InMemoryMap local_map(world_map);
+    local_map.SetUp();
+    const ctm::WaypointGraph &graph = local_map.GetWaypointGraph();
+    if (graph.Size() < NUMBER_OF_REGIONS) {
+      continue;
+    }
+
+    const ctm::RegionPartition partition(graph, NUMBER_OF_REGIONS);
+    ASSERT_EQ(partition.GetNumberOfRegions(), NUMBER_OF_REGIONS);
+
+    std::vector<size_t> waypoints_per_region(NUMBER_OF_REGIONS, 0u);
+    for (ctm::WaypointIndex index = 0u; index < graph.Size(); ++index) {
+      const carla::geom::Location &location = graph.GetLocation(index);
+      const uint64_t region = partition.GetRegion(location);
+      ASSERT_LT(region, NUMBER_OF_REGIONS);
+      ++waypoints_per_region[region];
+      for (uint64_t other = 0u; other < NUMBER_OF_REGIONS; ++other) {
+        ASSERT_EQ(partition.IsInRegion(location, other), other == region);
+      }
+      // A margin only grows the region.
+      ASSERT_TRUE(partition.IsInRegion(location, region, 10.0f));
+    }
+
+    // Regions get a similar share of the waypoints.
+    for (const size_t count : waypoints_per_region) {
+      ASSERT_GT(count, graph.Size() / (2u * NUMBER_OF_REGIONS));
+    }
+
+    // A single region covers the whole map.
+    const ctm::RegionPartition whole(graph, 1u);
+    ASSERT_EQ(whole.GetNumberOfRegions(), 1u);
+    ASSERT_EQ(whole.GetRegion(graph.GetLocation(0u)), 0u);
+  }
+}
+
+TEST(traffic_manager, region_check) {
+  ctm::RegionPartition::CheckRegion(0u, 1u);
+  ctm::RegionPartition::CheckRegion(3u, 4u);
+  ASSERT_THROW(ctm::RegionPartition::CheckRegion(4u, 4u), std::invalid_argument);
+  ASSERT_THROW(ctm::RegionPartition::CheckRegion(0u, 0u), std::invalid_argument);
+}
+
+TEST(traffic_manager, shard_batch) {
+  using CommandList = ctm::ShardBatch::CommandList;
+  auto batch = ctm::ShardBatch::Get(9000u);
+  ASSERT_EQ(batch, ctm::ShardBatch::Get(9000u));
+  ASSERT_NE(batch, ctm::ShardBatch::Get(9010u));
+  batch->Join(0u);
+  batch->Join(1u);
+  batch->Join(2u);
+
+  const CommandList commands(2u, carla::rpc::Command::ApplyVehicleControl(1u, {}));
+  CommandList combined;
+
+  // The last shard of the tick sends the commands of all of them.
+  ASSERT_FALSE(batch->Add(0u, commands, combined));
+  ASSERT_FALSE(batch->Add(2u, commands, combined));
+  ASSERT_TRUE(batch->Add(1u, commands, combined));
+  ASSERT_EQ(combined.size(), 6u);
+
+  // A shard adding its commands again does not wait for the ones behind.
+  ASSERT_FALSE(batch->Add(1u, commands, combined));
+  ASSERT_TRUE(batch->Add(1u, commands, combined));
+  ASSERT_EQ(combined.size(), 4u);
+
+  // Shards leaving the town are not waited for.
+  ASSERT_FALSE(batch->Leave(2u, combined));
+  ASSERT_FALSE(batch->Add(0u, commands, combined));
+  ASSERT_TRUE(batch->Add(1u, commands, combined));
+  ASSERT_EQ(combined.size(), 4u);
+
+  // A shard leaving in the middle of a tick sends the commands of the rest
+  // if they are all in.
+  batch->Join(2u);
+  ASSERT_FALSE(batch->Add(0u, commands, combined));
+  ASSERT_FALSE(batch->Add(1u, commands, combined));
+  ASSERT_TRUE(batch->Leave(2u, combined));
+  ASSERT_EQ(combined.size(), 4u);
+  ASSERT_FALSE(batch->Add(0u, commands, combined));
+  ASSERT_FALSE(batch->Leave(0u, combined));
+  ASSERT_TRUE(batch->Add(1u, commands, combined));
+  ASSERT_EQ(combined.size(), 4u);
+}
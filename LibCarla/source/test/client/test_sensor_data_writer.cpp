@@ -0,0 +1,102 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/SensorDataWriter.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+using carla::client::SensorDataWriter;
+
+TEST(sensor_data_writer, make_path) {
+  ASSERT_EQ(SensorDataWriter::MakePath("_out/rgb/{frame}.png", 42u, 1.5), "_out/rgb/00000042.png");
+  ASSERT_EQ(
+      SensorDataWriter::MakePath("{frame}_{timestamp}_{frame}", 123456789u, 0.25),
+      "123456789_0.250000_123456789");
+  ASSERT_EQ(SensorDataWriter::MakePath("lidar", 1u, 0.0), "lidar");
+}
+
+TEST(sensor_data_writer, flush) {
+  std::atomic_size_t count{0u};
+  {
+    SensorDataWriter writer(4u, 8u);
+    for (size_t i = 0u; i < 100u; ++i) {
+      // Blocks when 8 writes are queued.
+      ASSERT_TRUE(writer.Post([&count]() {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        ++count;
+        return size_t(10u);
+      }));
+    }
+    writer.Flush();
+    ASSERT_EQ(count, 100u);
+    ASSERT_EQ(writer.GetBacklog(), 0u);
+    const auto statistics = writer.GetStatistics();
+    ASSERT_EQ(statistics.written, 100u);
+    ASSERT_EQ(statistics.written_bytes, 1000u);
+    ASSERT_EQ(statistics.dropped, 0u);
+    ASSERT_EQ(statistics.failed, 0u);
+
+    // The destructor finishes the queued writes.
+    for (size_t i = 0u; i < 10u; ++i) {
+      writer.Post([&count]() { ++count; return size_t(0u); });
+    }
+  }
+  ASSERT_EQ(count, 110u);
+}
+
+TEST(sensor_data_writer, drop_when_full) {
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool release = false;
+  auto blocked_write = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&]() { return release; });
+    return size_t(1u);
+  };
+
+  SensorDataWriter writer(1u, 2u, true);
+  ASSERT_TRUE(writer.Post(blocked_write));
+  // Wait for the worker to take the first write.
+  while (writer.GetStatistics().in_progress == 0u) {
+    std::this_thread::yield();
+  }
+  ASSERT_TRUE(writer.Post(blocked_write));
+  ASSERT_TRUE(writer.Post(blocked_write));
+  ASSERT_FALSE(writer.Post(blocked_write));
+  ASSERT_EQ(writer.GetBacklog(), 3u);
+  ASSERT_FALSE(writer.Flush(carla::time_duration::milliseconds(10u)));
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  condition.notify_all();
+  ASSERT_TRUE(writer.Flush(carla::time_duration::seconds(10u)));
+  const auto statistics = writer.GetStatistics();
+  ASSERT_EQ(statistics.written, 3u);
+  ASSERT_EQ(statistics.dropped, 1u);
+}
+
+TEST(sensor_data_writer, failed_writes) {
+  SensorDataWriter writer(2u);
+  for (size_t i = 0u; i < 10u; ++i) {
+    writer.Post([i]() -> size_t {
+      if (i % 2u == 0u) {
+        throw std::runtime_error("write failed");
+      }
+      return 1u;
+    });
+  }
+  writer.Flush();
+  const auto statistics = writer.GetStatistics();
+  ASSERT_EQ(statistics.written, 5u);
+  ASSERT_EQ(statistics.failed, 5u);
+}
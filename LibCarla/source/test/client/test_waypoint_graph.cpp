@@ -0,0 +1,165 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/Map.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/WaypointBuffer.h>
+#include <carla/trafficmanager/WaypointGraph.h>
+
+#include <deque>
+
+namespace cc = carla::client;
+namespace ctm = carla::traffic_manager;
+
+TEST(traffic_manager, waypoint_buffer) {
+  ctm::WaypointGraph graph;
+  ctm::WaypointBuffer buffer(graph);
+  std::deque<ctm::WaypointIndex> expected;
+  ASSERT_TRUE(buffer.empty());
+
+  // Interleave pushes and pops so the ring wraps around while growing.
+  ctm::WaypointIndex next = 0u;
+  for (int cycle = 0; cycle < 200; ++cycle) {
+    for (int i = 0; i < cycle % 7 + 3; ++i) {
+      buffer.push_back(next);
+      expected.push_back(next);
+      ++next;
+    }
+    for (int i = 0; i < cycle % 5 && !expected.empty(); ++i) {
+      if (i % 2 == 0) {
+        buffer.pop_front();
+        expected.pop_front();
+      } else {
+        buffer.pop_back();
+        expected.pop_back();
+      }
+    }
+    ASSERT_EQ(buffer.size(), expected.size());
+    ASSERT_EQ(buffer.front(), expected.front());
+    ASSERT_EQ(buffer.back(), expected.back());
+    size_t position = 0u;
+    for (const ctm::WaypointIndex index : buffer) {
+      ASSERT_EQ(index, expected.at(position));
+      ASSERT_EQ(buffer.at(position), index);
+      ++position;
+    }
+  }
+
+  buffer.clear();
+  ASSERT_TRUE(buffer.empty());
+}
+
+TEST(traffic_manager, waypoint_graph) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<cc::Map>(file, util::OpenDrive::Load(file));
+    ctm::InMemoryMap local_map(world_map);
+    local_map.SetUp();
+
+    const ctm::NodeList dense_topology = local_map.GetDenseTopology();
+    const ctm::WaypointGraph &graph = local_map.GetWaypointGraph();
+    ASSERT_EQ(graph.Size(), dense_topology.size());
+
+    for (size_t i = 0u; i < dense_topology.size(); ++i) {
+      const ctm::SimpleWaypointPtr &simple_waypoint = dense_topology[i];
+      const auto index = static_cast<ctm::WaypointIndex>(i);
+      ASSERT_EQ(simple_waypoint->GetIndex(), index);
+      ASSERT_EQ(graph.GetSimpleWaypoint(index), simple_waypoint);
+      ASSERT_EQ(graph.GetId(index), simple_waypoint->GetId());
+      ASSERT_EQ(graph.GetLocation(index), simple_waypoint->GetLocation());
+      ASSERT_EQ(graph.IsJunction(index), simple_waypoint->CheckJunction());
+      ASSERT_EQ(graph.GetGeodesicGridId(index), simple_waypoint->GetGeodesicGridId());
+      ASSERT_EQ(graph.GetRoadOption(index), simple_waypoint->GetRoadOption());
+
+      const auto next = simple_waypoint->GetNextWaypoint();
+      const auto next_range = graph.GetNextWaypoints(index);
+      ASSERT_EQ(next_range.size(), next.size());
+      for (size_t j = 0u; j < next.size(); ++j) {
+        ASSERT_EQ(next_range[j], next[j]->GetIndex());
+      }
+
+      const auto left = simple_waypoint->GetLeftWaypoint();
+      ASSERT_EQ(graph.GetLeftWaypoint(index),
+                left != nullptr ? left->GetIndex() : ctm::WaypointGraph::NO_WAYPOINT);
+    }
+  }
+}
+
+// Walks a horizon of waypoints ahead of many simulated vehicles, the same
+// way the localization stage keeps the vehicle buffers populated.
+TEST(traffic_manager, benchmark_waypoint_graph_horizon) {
+  constexpr size_t NUMBER_OF_VEHICLES = 1000u;
+  constexpr size_t HORIZON = 60u;
+  constexpr size_t STEPS = 50u;
+
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto world_map = carla::MakeShared<cc::Map>(file, util::OpenDrive::Load(file));
+    ctm::InMemoryMap local_map(world_map);
+    local_map.SetUp();
+    const ctm::NodeList dense_topology = local_map.GetDenseTopology();
+    const ctm::WaypointGraph &graph = local_map.GetWaypointGraph();
+    if (dense_topology.empty()) {
+      continue;
+    }
+
+    // Pointer-based buffers.
+    std::vector<std::deque<ctm::SimpleWaypointPtr>> pointer_buffers(NUMBER_OF_VEHICLES);
+    for (size_t i = 0u; i < NUMBER_OF_VEHICLES; ++i) {
+      pointer_buffers[i].push_back(dense_topology[(i * 7919u) % dense_topology.size()]);
+    }
+    float pointer_checksum = 0.0f;
+    carla::StopWatch pointer_timer;
+    for (size_t step = 0u; step < STEPS; ++step) {
+      for (auto &buffer : pointer_buffers) {
+        if (buffer.size() > 1u) {
+          buffer.pop_front();
+        }
+        while (buffer.size() < HORIZON) {
+          const auto next = buffer.back()->GetNextWaypoint();
+          if (next.empty()) {
+            break;
+          }
+          buffer.push_back(next.front());
+        }
+        pointer_checksum += buffer.back()->GetLocation().x;
+      }
+    }
+    pointer_timer.Stop();
+
+    // Index-based buffers.
+    std::vector<ctm::WaypointBuffer> index_buffers(NUMBER_OF_VEHICLES, ctm::WaypointBuffer(graph));
+    for (size_t i = 0u; i < NUMBER_OF_VEHICLES; ++i) {
+      index_buffers[i].push_back(static_cast<ctm::WaypointIndex>((i * 7919u) % dense_topology.size()));
+    }
+    float index_checksum = 0.0f;
+    carla::StopWatch index_timer;
+    for (size_t step = 0u; step < STEPS; ++step) {
+      for (auto &buffer : index_buffers) {
+        if (buffer.size() > 1u) {
+          buffer.pop_front();
+        }
+        while (buffer.size() < HORIZON) {
+          const auto next = graph.GetNextWaypoints(buffer.back());
+          if (next.empty()) {
+            break;
+          }
+          buffer.push_back(next.front());
+        }
+        index_checksum += graph.GetLocation(buffer.back()).x;
+      }
+    }
+    index_timer.Stop();
+
+    carla::logging::log(
+        file, ":", NUMBER_OF_VEHICLES, "vehicles,", STEPS, "steps, shared_ptr buffers",
+        pointer_timer.GetElapsedTime(), "ms, index buffers",
+        index_timer.GetElapsedTime(), "ms");
+    ASSERT_FLOAT_EQ(pointer_checksum, index_checksum);
+  }
+}
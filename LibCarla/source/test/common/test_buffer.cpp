@@ -8,6 +8,7 @@
 
 #include <carla/Buffer.h>
 #include <carla/BufferPool.h>
+#include <carla/ThreadGroup.h>
 
 #include <array>
 #include <list>
@@ -112,6 +113,27 @@ TEST(buffer, memcpy) {
   ASSERT_EQ(*cpy, *msg);
 }
 
+TEST(buffer, view) {
+  std::string memory = "Hello view!";
+  bool released = false;
+  std::shared_ptr<Buffer::value_type> view(
+      reinterpret_cast<Buffer::value_type *>(&memory[0]),
+      [&](Buffer::value_type *) { released = true; });
+  Buffer buffer(std::move(view), static_cast<Buffer::size_type>(memory.size()));
+  ASSERT_TRUE(buffer.is_view());
+  ASSERT_EQ(as_string(buffer), memory);
+  // Moving keeps the view.
+  Buffer moved = std::move(buffer);
+  ASSERT_FALSE(released);
+  moved[0u] = 'h';
+  ASSERT_EQ(memory, "hello view!");
+  // Growing copies the contents and releases the view.
+  moved.resize(memory.size() + 1u);
+  ASSERT_TRUE(released);
+  ASSERT_FALSE(moved.is_view());
+  ASSERT_EQ(as_string(moved).substr(0u, memory.size()), memory);
+}
+
 #ifndef LIBCARLA_NO_EXCEPTIONS
 TEST(buffer, message_too_big) {
   ASSERT_THROW(Buffer(4294967296ul), std::invalid_argument);
@@ -134,3 +156,73 @@ TEST(buffer, buffer_pool) {
   // Now delete the pool to test the weak reference inside the buffers.
   pool.reset();
 }
+
+TEST(buffer, buffer_pool_size_classes) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  const unsigned char *small_data = nullptr;
+  const unsigned char *big_data = nullptr;
+  {
+    auto small = pool->Pop(100u);
+    ASSERT_EQ(small.size(), 100u);
+    ASSERT_EQ(small.capacity(), 128u);
+    small_data = small.data();
+    auto big = pool->Pop(100000u);
+    ASSERT_EQ(big.size(), 100000u);
+    ASSERT_EQ(big.capacity(), 131072u);
+    big_data = big.data();
+  }
+  auto statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.misses, 2u);
+  ASSERT_EQ(statistics.buffers_held, 2u);
+  ASSERT_EQ(statistics.bytes_held, 128u + 131072u);
+
+  // Each request gets the buffer of its size class.
+  auto small = pool->Pop(128u);
+  ASSERT_EQ(small.data(), small_data);
+  auto big = pool->Pop(70000u);
+  ASSERT_EQ(big.data(), big_data);
+  ASSERT_EQ(big.size(), 70000u);
+  statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.hits, 2u);
+  ASSERT_EQ(statistics.buffers_held, 0u);
+  ASSERT_EQ(statistics.bytes_held, 0u);
+}
+
+TEST(buffer, buffer_pool_max_bytes) {
+  auto pool = std::make_shared<carla::BufferPool>(1024u);
+  {
+    auto buffer0 = pool->Pop(512u);
+    auto buffer1 = pool->Pop(512u);
+    auto buffer2 = pool->Pop(512u);
+  }
+  auto statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.buffers_held, 2u);
+  ASSERT_EQ(statistics.bytes_held, 1024u);
+  ASSERT_EQ(statistics.trimmed, 1u);
+
+  pool->SetMaxBytes(512u);
+  statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.buffers_held, 1u);
+  ASSERT_EQ(statistics.bytes_held, 512u);
+  ASSERT_EQ(statistics.trimmed, 2u);
+
+  pool->Trim();
+  ASSERT_EQ(pool->GetStatistics().bytes_held, 0u);
+}
+
+TEST(buffer, buffer_pool_threads) {
+  constexpr auto number_of_threads = 4u;
+  constexpr auto iterations = 1000u;
+  auto pool = std::make_shared<carla::BufferPool>();
+  carla::ThreadGroup threads;
+  threads.CreateThreads(number_of_threads, [&]() {
+    for (auto i = 0u; i < iterations; ++i) {
+      auto buffer = pool->Pop(64u << (i % 8u));
+      buffer.data()[0u] = 42u;
+    }
+  });
+  threads.JoinAll();
+  auto statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.hits + statistics.misses, number_of_threads * iterations);
+  ASSERT_LT(statistics.misses, statistics.hits);
+}
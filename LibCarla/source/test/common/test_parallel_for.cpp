@@ -0,0 +1,53 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ParallelFor.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using carla::ParallelFor;
+
+TEST(parallel_for, visits_each_index_once) {
+  for (size_t size : {0u, 1u, 7u, 100u, 1001u}) {
+    for (size_t chunk_size : {0u, 1u, 3u, 64u}) {
+      std::vector<std::atomic_int> visits(size);
+      for (auto &count : visits) {
+        count = 0;
+      }
+      ParallelFor(size, chunk_size, 4u, [&](size_t begin, size_t end) {
+        ASSERT_LT(begin, end);
+        ASSERT_LE(end, size);
+        for (auto i = begin; i < end; ++i) {
+          ++visits[i];
+        }
+      });
+      for (auto &count : visits) {
+        ASSERT_EQ(count.load(), 1);
+      }
+    }
+  }
+}
+
+TEST(parallel_for, rethrows_exception) {
+  std::atomic_size_t calls{0u};
+  ASSERT_THROW(
+      ParallelFor(100u, 1u, 4u, [&](size_t begin, size_t) {
+        ++calls;
+        if (begin == 0u) {
+          throw std::runtime_error("ParallelFor test");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }),
+      std::runtime_error);
+  // The chunks not started yet are skipped.
+  ASSERT_LT(calls.load(), 100u);
+}
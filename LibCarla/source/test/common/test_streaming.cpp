@@ -11,10 +11,16 @@
 #include <carla/streaming/Server.h>
 #include <carla/streaming/detail/Dispatcher.h>
 #include <carla/streaming/detail/tcp/Client.h>
+#include <carla/streaming/detail/tcp/SendQueue.h>
 #include <carla/streaming/detail/tcp/Server.h>
+#include <carla/streaming/detail/tcp/SharedMemoryRing.h>
 #include <carla/streaming/low_level/Client.h>
 #include <carla/streaming/low_level/Server.h>
 
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <array>
 #include <atomic>
 
 using namespace std::chrono_literals;
@@ -259,3 +265,365 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+TEST(streaming, multiplexed_streams) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 100u;
+  constexpr size_t number_of_streams = 8u;
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+
+  std::vector<Stream> streams;
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    streams.emplace_back(srv.MakeStream());
+  }
+
+  Client c(TransportMode::Multiplexed);
+  c.AsyncRun(1u);
+
+  std::vector<std::atomic_size_t> received(number_of_streams);
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    received[i] = 0u;
+    const std::string expected = "stream " + std::to_string(i);
+    c.Subscribe(streams[i].token(), [&received, i, expected](auto buffer) {
+      // Each stream only receives its own messages.
+      ASSERT_EQ(as_string(buffer), expected);
+      ++received[i];
+    });
+  }
+
+  std::this_thread::sleep_for(20ms);
+  for (auto j = 0u; j < number_of_messages; ++j) {
+    std::this_thread::sleep_for(1ms);
+    for (auto i = 0u; i < number_of_streams; ++i) {
+      streams[i] << ("stream " + std::to_string(i));
+    }
+  }
+  std::this_thread::sleep_for(20ms);
+
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    ASSERT_GE(received[i], number_of_messages - 3u);
+  }
+
+  // Unsubscribing from a stream does not affect the others.
+  c.UnSubscribe(streams[0u].token());
+  std::this_thread::sleep_for(20ms);
+  const size_t unsubscribed_count = received[0u];
+  const size_t subscribed_count = received[1u];
+  for (auto j = 0u; j < number_of_messages; ++j) {
+    std::this_thread::sleep_for(1ms);
+    streams[0u] << std::string("stream 0");
+    streams[1u] << std::string("stream 1");
+  }
+  std::this_thread::sleep_for(20ms);
+  ASSERT_EQ(received[0u], unsubscribed_count);
+  ASSERT_GE(received[1u], subscribed_count + number_of_messages - 3u);
+}
+
+TEST(streaming, shared_memory_ring) {
+  using namespace carla::streaming::detail::tcp;
+  constexpr size_t capacity = 100u;
+  const std::string name = "carla-test-shared-memory-ring";
+
+  auto producer = SharedMemoryRing::Create(name, capacity);
+  ASSERT_NE(producer, nullptr);
+  auto consumer = SharedMemoryRing::Open(name);
+  ASSERT_NE(consumer, nullptr);
+  ASSERT_EQ(consumer->GetCapacity(), capacity);
+
+  auto write = [&](const std::string &message) {
+    const std::array<boost::asio::const_buffer, 1u> buffers = {
+        boost::asio::buffer(message.data(), message.size())};
+    return producer->TryWrite(buffers, message.size());
+  };
+
+  // Messages of varying sizes so the end of the ring is skipped in the middle
+  // of a message.
+  for (size_t i = 1u; i < 200u; ++i) {
+    const std::string message(i % 37u + 1u, static_cast<char>('a' + i % 26u));
+    ASSERT_TRUE(write(message));
+    const auto received = consumer->Read(message.size());
+    ASSERT_TRUE(received.is_view());
+    ASSERT_EQ(util::buffer::as_string(received), message);
+  }
+
+  // A full ring rejects the message until the consumer releases its views,
+  // released out of order only once the older ones are released too.
+  producer = nullptr;
+  consumer = nullptr;
+  producer = SharedMemoryRing::Create(name, capacity);
+  consumer = SharedMemoryRing::Open(name);
+  ASSERT_NE(consumer, nullptr);
+  const std::string message(30u, 'x');
+  ASSERT_TRUE(write(message));
+  ASSERT_TRUE(write(message));
+  auto first = consumer->Read(message.size());
+  auto second = consumer->Read(message.size());
+  ASSERT_TRUE(write(message));
+  ASSERT_FALSE(write(message));
+  second = carla::Buffer();
+  ASSERT_FALSE(write(message));
+  first = carla::Buffer();
+  ASSERT_TRUE(write(message));
+  ASSERT_EQ(util::buffer::as_string(consumer->Read(message.size())), message);
+  ASSERT_EQ(util::buffer::as_string(consumer->Read(message.size())), message);
+
+  // Views keep the segment mapped after the rings are gone.
+  ASSERT_TRUE(write(message));
+  auto view = consumer->Read(message.size());
+  consumer = nullptr;
+  producer = nullptr;
+  ASSERT_EQ(SharedMemoryRing::Open(name), nullptr);
+  ASSERT_EQ(util::buffer::as_string(view), message);
+}
+
+TEST(streaming, shared_memory_transport) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 100u;
+
+  Server srv(TESTING_PORT);
+  srv.SetSharedMemoryEnabled(true);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+
+  Client c;
+  c.AsyncRun(1u);
+  std::atomic_size_t received{0u};
+  std::atomic_size_t views{0u};
+  c.Subscribe(stream.token(), [&](auto buffer) {
+    // The size of each message depends on its position.
+    const auto size = buffer.size();
+    ASSERT_GT(size, 0u);
+    ASSERT_EQ(as_string(buffer), std::string(size, static_cast<char>('a' + size % 26u)));
+    views += buffer.is_view() ? 1u : 0u;
+    ++received;
+  });
+
+  std::this_thread::sleep_for(20ms);
+  for (auto i = 1u; i <= number_of_messages; ++i) {
+    std::this_thread::sleep_for(1ms);
+    const size_t size = 1000u * i;
+    stream << std::string(size, static_cast<char>('a' + size % 26u));
+  }
+  std::this_thread::sleep_for(20ms);
+  ASSERT_GE(received, number_of_messages - 3u);
+  // Read in place from the ring, without copies.
+  ASSERT_EQ(views, received);
+}
+
+TEST(streaming, shared_memory_legacy_client) {
+  using namespace carla::streaming;
+  // Clients that do not know about the transport send the plain stream id
+  // and read every message from the socket.
+  Server srv(TESTING_PORT);
+  srv.SetSharedMemoryEnabled(true);
+  srv.AsyncRun(2u);
+  auto stream = srv.MakeStream();
+  const detail::token_type token{stream.token()};
+
+  boost::asio::io_context io_context;
+  boost::asio::ip::tcp::socket socket(io_context);
+  socket.connect({boost::asio::ip::address_v4::loopback(), token.get_port()});
+  const auto stream_id = token.get_stream_id();
+  boost::asio::write(socket, boost::asio::buffer(&stream_id, sizeof(stream_id)));
+
+  std::this_thread::sleep_for(20ms);
+  const std::string message = "Hello legacy client!";
+  stream << message;
+
+  detail::message_size_type size = 0u;
+  boost::asio::read(socket, boost::asio::buffer(&size, sizeof(size)));
+  ASSERT_EQ(size, message.size());
+  std::string received(size, '\0');
+  boost::asio::read(socket, boost::asio::buffer(&received[0], size));
+  ASSERT_EQ(received, message);
+}
+
+TEST(streaming, send_queue_policies) {
+  using namespace carla::streaming::detail::tcp;
+  using Item = SendQueue::Item;
+  auto make_message = [](size_t size) {
+    return ServerSession::MakeMessage(carla::Buffer(std::string(size, 'x')));
+  };
+  auto pop_all = [](SendQueue &queue) {
+    std::vector<Item> batch;
+    queue.PopBatch(batch, 100u);
+    return batch;
+  };
+
+  SendQueueSettings settings;
+  settings.max_queued_messages = 2u;
+
+  // The first message starts the consumer and is popped right away, the rest
+  // queue behind it.
+  auto fill = [&](SendQueue &queue) {
+    ASSERT_TRUE(queue.Push({1u, make_message(10u)}, settings));
+    std::vector<Item> batch;
+    ASSERT_TRUE(queue.PopBatch(batch, 1u));
+    ASSERT_FALSE(queue.Push({1u, make_message(1u)}, settings));
+    ASSERT_FALSE(queue.Push({2u, make_message(2u)}, settings));
+  };
+
+  {
+    settings.policy = SendQueuePolicy::DropOldest;
+    SendQueue queue;
+    fill(queue);
+    ASSERT_FALSE(queue.Push({3u, make_message(3u)}, settings));
+    auto batch = pop_all(queue);
+    ASSERT_EQ(batch.size(), 2u);
+    ASSERT_EQ(batch[0u].stream_id, 2u);
+    ASSERT_EQ(batch[1u].stream_id, 3u);
+    auto statistics = queue.GetStatistics();
+    ASSERT_EQ(statistics.dropped_messages, 1u);
+    ASSERT_EQ(statistics.dropped_bytes, 1u);
+    ASSERT_EQ(statistics.queued_bytes, 0u);
+  }
+
+  {
+    settings.policy = SendQueuePolicy::DropNewest;
+    SendQueue queue;
+    fill(queue);
+    ASSERT_FALSE(queue.Push({3u, make_message(3u)}, settings));
+    auto batch = pop_all(queue);
+    ASSERT_EQ(batch.size(), 2u);
+    ASSERT_EQ(batch[0u].stream_id, 1u);
+    ASSERT_EQ(batch[1u].stream_id, 2u);
+    ASSERT_EQ(queue.GetStatistics().dropped_bytes, 3u);
+  }
+
+  {
+    settings.policy = SendQueuePolicy::CoalesceLatest;
+    SendQueue queue;
+    fill(queue);
+    ASSERT_FALSE(queue.Push({1u, make_message(4u)}, settings));
+    ASSERT_EQ(queue.GetStatistics().queued_messages, 2u);
+    ASSERT_EQ(queue.GetStatistics().queued_bytes, 6u);
+    auto batch = pop_all(queue);
+    ASSERT_EQ(batch.size(), 2u);
+    ASSERT_EQ(batch[0u].stream_id, 1u);
+    ASSERT_EQ(batch[0u].message->size(), 4u);
+    ASSERT_EQ(batch[1u].stream_id, 2u);
+    ASSERT_EQ(queue.GetStatistics().dropped_bytes, 1u);
+  }
+
+  {
+    // Messages are not coalesced while there is room, and lossless messages
+    // are never replaced.
+    settings.policy = SendQueuePolicy::CoalesceLatest;
+    SendQueue queue;
+    ASSERT_TRUE(queue.Push({1u, make_message(10u)}, settings));
+    std::vector<Item> batch;
+    ASSERT_TRUE(queue.PopBatch(batch, 1u));
+    ASSERT_FALSE(queue.Push({1u, make_message(1u)}, settings));
+    ASSERT_FALSE(queue.Push({1u, make_message(2u)}, settings));
+    ASSERT_EQ(queue.GetStatistics().queued_messages, 2u);
+    ASSERT_EQ(pop_all(queue).size(), 2u);
+    for (auto i = 0u; i < 3u; ++i) {
+      ASSERT_FALSE(queue.Push({1u, make_message(3u), true}, settings));
+    }
+    ASSERT_EQ(queue.GetStatistics().queued_messages, 3u);
+    ASSERT_FALSE(queue.Push({1u, make_message(4u)}, settings));
+    auto statistics = queue.GetStatistics();
+    ASSERT_EQ(statistics.queued_messages, 3u);
+    ASSERT_EQ(statistics.dropped_messages, 1u);
+    ASSERT_EQ(statistics.dropped_bytes, 4u);
+  }
+
+  {
+    settings.policy = SendQueuePolicy::Block;
+    settings.block_timeout = carla::time_duration::milliseconds(10u);
+    SendQueue queue;
+    fill(queue);
+    // Times out.
+    ASSERT_FALSE(queue.Push({3u, make_message(3u)}, settings));
+    ASSERT_EQ(queue.GetStatistics().dropped_messages, 1u);
+    // Unblocked by the consumer.
+    settings.block_timeout = carla::time_duration::seconds(10u);
+    std::thread consumer([&]() {
+      std::this_thread::sleep_for(10ms);
+      pop_all(queue);
+    });
+    ASSERT_FALSE(queue.Push({3u, make_message(3u)}, settings));
+    consumer.join();
+    ASSERT_EQ(queue.GetStatistics().dropped_messages, 1u);
+    ASSERT_EQ(queue.GetStatistics().queued_messages, 1u);
+    // Unblocked by closing the queue.
+    ASSERT_FALSE(queue.Push({4u, make_message(4u)}, settings));
+    std::thread closer([&]() {
+      std::this_thread::sleep_for(10ms);
+      queue.Close();
+    });
+    ASSERT_FALSE(queue.Push({5u, make_message(5u)}, settings));
+    closer.join();
+    ASSERT_EQ(queue.GetStatistics().queued_messages, 0u);
+  }
+
+  {
+    // Writers that may not block queue past the limit.
+    settings.policy = SendQueuePolicy::Block;
+    settings.block_timeout = carla::time_duration::seconds(10u);
+    SendQueue queue;
+    fill(queue);
+    ASSERT_FALSE(queue.Push({3u, make_message(3u)}, settings, false));
+    auto statistics = queue.GetStatistics();
+    ASSERT_EQ(statistics.queued_messages, 3u);
+    ASSERT_EQ(statistics.dropped_messages, 0u);
+  }
+
+  {
+    // Draining the queue makes the consumer idle.
+    SendQueue queue;
+    fill(queue);
+    pop_all(queue);
+    queue.OnSent(3u, 13u);
+    std::vector<Item> batch;
+    ASSERT_FALSE(queue.PopBatch(batch, 1u));
+    ASSERT_TRUE(queue.Push({1u, make_message(1u)}, settings));
+    auto statistics = queue.GetStatistics();
+    ASSERT_EQ(statistics.sent_messages, 3u);
+    ASSERT_EQ(statistics.sent_bytes, 13u);
+  }
+}
+
+TEST(streaming, session_statistics) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr auto number_of_messages = 50u;
+  const std::string message_text = "Hello client!";
+
+  Server srv(TESTING_PORT);
+  srv.SetSendQueueSettings({detail::tcp::SendQueuePolicy::Block, 4u, carla::time_duration::seconds(10u)});
+  srv.AsyncRun(2u);
+
+  auto stream = srv.MakeStream();
+
+  std::atomic_size_t message_count{0u};
+  Client c;
+  c.AsyncRun(2u);
+  c.Subscribe(stream.token(), [&](auto message) {
+    ++message_count;
+    ASSERT_EQ(as_string(message), message_text);
+  });
+
+  // Wait for the session to open.
+  std::this_thread::sleep_for(20ms);
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(2ms);
+    stream << message_text;
+  }
+
+  for (auto i = 0u; (i < 500u) && (message_count < number_of_messages); ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(message_count, number_of_messages);
+
+  auto statistics = srv.GetSessionStatistics();
+  ASSERT_EQ(statistics.size(), 1u);
+  ASSERT_NE(statistics[0u].stream_id, 0u);
+  ASSERT_EQ(statistics[0u].sent_messages, number_of_messages);
+  ASSERT_EQ(statistics[0u].sent_bytes, number_of_messages * message_text.size());
+  ASSERT_EQ(statistics[0u].dropped_messages, 0u);
+}
@@ -0,0 +1,143 @@
+// Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ThreadGroup.h>
+#include <carla/profiler/Tracer.h>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <cstring>
+#include <set>
+#include <sstream>
+
+using carla::profiler::TraceEvent;
+using carla::profiler::Tracer;
+
+static void TracedFunction(int levels) {
+  CARLA_TRACE_SCOPE(test, traced_function);
+  if (levels > 1) {
+    TracedFunction(levels - 1);
+  }
+}
+
+static size_t Count(const std::vector<TraceEvent> &events, const char *name) {
+  size_t count = 0u;
+  for (const auto &event : events) {
+    count += (std::strcmp(event.name, name) == 0) ? 1u : 0u;
+  }
+  return count;
+}
+
+TEST(tracer, disabled) {
+  Tracer::Disable();
+  Tracer::Clear();
+  TracedFunction(3);
+  ASSERT_EQ(Count(Tracer::GetEvents(), "traced_function"), 0u);
+}
+
+TEST(tracer, nested_scopes) {
+  Tracer::Clear();
+  Tracer::Enable();
+  TracedFunction(3);
+  Tracer::Disable();
+  TracedFunction(3);
+
+  const auto events = Tracer::GetEvents();
+  ASSERT_EQ(events.size(), 3u);
+  for (uint32_t i = 0u; i < 3u; ++i) {
+    // Sorted by begin time, from the outermost scope.
+    ASSERT_STREQ(events[i].context, "test");
+    ASSERT_STREQ(events[i].name, "traced_function");
+    ASSERT_EQ(events[i].depth, i);
+    if (i > 0u) {
+      const auto &parent = events[i - 1u];
+      ASSERT_GE(events[i].begin_ns, parent.begin_ns);
+      ASSERT_LE(events[i].begin_ns + events[i].duration_ns, parent.begin_ns + parent.duration_ns);
+      ASSERT_EQ(events[i].thread_index, parent.thread_index);
+    }
+  }
+
+  Tracer::Clear();
+  ASSERT_TRUE(Tracer::GetEvents().empty());
+}
+
+TEST(tracer, threads) {
+  constexpr size_t number_of_threads = 4u;
+  constexpr size_t scopes_per_thread = 1000u;
+  Tracer::Clear();
+  Tracer::Enable();
+  {
+    carla::ThreadGroup threads;
+    threads.CreateThreads(number_of_threads, []() {
+      for (size_t i = 0u; i < scopes_per_thread; ++i) {
+        TracedFunction(2);
+      }
+    });
+    // Read while the threads are writing.
+    Tracer::GetEvents();
+  }
+  Tracer::Disable();
+
+  const auto events = Tracer::GetEvents();
+  ASSERT_EQ(Count(events, "traced_function"), 2u * number_of_threads * scopes_per_thread);
+  std::set<uint32_t> threads;
+  for (const auto &event : events) {
+    threads.insert(event.thread_index);
+  }
+  ASSERT_EQ(threads.size(), number_of_threads);
+  // The buffers of the exited threads are freed once exported.
+  std::stringstream json;
+  Tracer::ExportChromeTrace(json);
+  ASSERT_EQ(Count(Tracer::GetEvents(), "traced_function"), 0u);
+  Tracer::Clear();
+}
+
+TEST(tracer, ring_buffer) {
+  Tracer::Clear();
+  Tracer::Enable();
+  for (size_t i = 0u; i < Tracer::events_per_thread + 100u; ++i) {
+    CARLA_TRACE_SCOPE(test, ring_buffer);
+  }
+  Tracer::Disable();
+  // Only the latest events are kept.
+  ASSERT_EQ(Count(Tracer::GetEvents(), "ring_buffer"), Tracer::events_per_thread);
+  Tracer::Clear();
+}
+
+TEST(tracer, chrome_trace) {
+  Tracer::Clear();
+  Tracer::SetThreadName("test \"thread\"");
+  Tracer::Enable();
+  TracedFunction(2);
+  Tracer::Disable();
+
+  std::stringstream json;
+  Tracer::ExportChromeTrace(json);
+  boost::property_tree::ptree trace;
+  boost::property_tree::read_json(json, trace);
+  size_t complete_events = 0u;
+  size_t thread_names = 0u;
+  for (const auto &item : trace.get_child("traceEvents")) {
+    const auto &event = item.second;
+    const auto phase = event.get<std::string>("ph");
+    if (phase == "X") {
+      ++complete_events;
+      ASSERT_EQ(event.get<std::string>("name"), "traced_function");
+      ASSERT_EQ(event.get<std::string>("cat"), "test");
+      ASSERT_GE(event.get<double>("dur"), 0.0);
+    } else if (phase == "M") {
+      if (event.get<std::string>("args.name") == "test \"thread\"") {
+        ++thread_names;
+      }
+    }
+  }
+  ASSERT_EQ(complete_events, 2u);
+  ASSERT_EQ(thread_names, 1u);
+  Tracer::Clear();
+}
@@ -6,6 +6,7 @@
 
 #include "test.h"
 
+#include <carla/StopWatch.h>
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
 
@@ -26,13 +27,21 @@ static auto make_special_message(size_t size) {
 class Benchmark {
 public:
 
-  Benchmark(uint16_t port, size_t message_size, double success_ratio)
+  Benchmark(
+      uint16_t port,
+      size_t message_size,
+      double success_ratio,
+      TransportMode mode = TransportMode::PerStream,
+      bool shared_memory = false)
     : _server(port),
-      _client(),
+      _client(mode),
       _message(make_special_message(message_size)),
       _client_callback(),
       _work_to_do(_client_callback),
-      _success_ratio(success_ratio) {}
+      _success_ratio(success_ratio),
+      _shared_memory(shared_memory) {
+    _server.SetSharedMemoryEnabled(shared_memory);
+  }
 
   void AddStream() {
     Stream stream = _server.MakeStream();
@@ -42,7 +51,9 @@ public:
       DEBUG_ASSERT(msg == _message);
       boost::asio::post(_client_callback, [this]() {
         CARLA_PROFILE_FPS(client, listen_callback);
-        ++_number_of_messages_received;
+        if (++_number_of_messages_received == _number_of_messages_expected) {
+          _timer.Stop();
+        }
       });
     });
 
@@ -63,6 +74,10 @@ public:
     std::this_thread::sleep_for(1s); // the client needs to be ready so we make
                                      // sure we get all the messages.
 
+    const auto expected_number_of_messages = _streams.size() * number_of_messages;
+    _number_of_messages_expected = expected_number_of_messages;
+    _timer.Restart();
+
     for (auto &&stream : _streams) {
       _threads.CreateThread([=]() mutable {
         for (auto i = 0u; i < number_of_messages; ++i) {
@@ -75,7 +90,6 @@ public:
       });
     }
 
-    const auto expected_number_of_messages = _streams.size() * number_of_messages;
     const auto threshold =
         static_cast<size_t>(_success_ratio * static_cast<double>(expected_number_of_messages));
 
@@ -93,6 +107,10 @@ public:
     _client_callback.stop();
     _threads.JoinAll();
     std::cout << " done." << std::endl;
+    carla::logging::log(
+        _client.GetTransportMode() == TransportMode::Multiplexed ? "multiplexed" : "per-stream",
+        _shared_memory ? "shared memory:" : "socket:",
+        _number_of_messages_received, "messages received in", _timer.GetElapsedTime(), "ms");
 
 #ifdef NDEBUG
     ASSERT_GE(_number_of_messages_received, threshold);
@@ -119,9 +137,17 @@ private:
 
   const double _success_ratio;
 
+  const bool _shared_memory;
+
   std::vector<Stream> _streams;
 
   std::atomic_size_t _number_of_messages_received{0u};
+
+  std::atomic_size_t _number_of_messages_expected{0u};
+
+  /// Time until the last message is received, only accessed by the
+  /// _client_callback thread once running.
+  carla::StopWatch _timer;
 };
 
 static size_t get_max_concurrency() {
@@ -132,10 +158,12 @@ static size_t get_max_concurrency() {
 static void benchmark_image(
     const size_t dimensions,
     const size_t number_of_streams = 1u,
-    const double success_ratio = 1.0) {
+    const double success_ratio = 1.0,
+    const TransportMode mode = TransportMode::PerStream,
+    const bool shared_memory = false) {
   constexpr auto number_of_messages = 100u;
   carla::logging::log("Benchmark:", number_of_streams, "streams at 90FPS.");
-  Benchmark benchmark(TESTING_PORT, 4u * dimensions, success_ratio);
+  Benchmark benchmark(TESTING_PORT, 4u * dimensions, success_ratio, mode, shared_memory);
   benchmark.AddStreams(number_of_streams);
   benchmark.Run(number_of_messages);
 }
@@ -163,3 +191,104 @@ TEST(benchmark_streaming, image_800x600_mt) {
 TEST(benchmark_streaming, image_1920x1080_mt) {
   benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9);
 }
+
+// Per-stream connections against a single multiplexed connection carrying
+// every stream, e.g. a vehicle with many small sensors attached.
+
+static size_t get_many_streams() {
+  return 8u * get_max_concurrency();
+}
+
+TEST(benchmark_streaming, image_200x200_many_streams) {
+  benchmark_image(200u * 200u, get_many_streams(), 0.9);
+}
+
+TEST(benchmark_streaming, image_200x200_many_streams_multiplexed) {
+  benchmark_image(200u * 200u, get_many_streams(), 0.9, TransportMode::Multiplexed);
+}
+
+TEST(benchmark_streaming, image_200x200_mt_multiplexed) {
+  benchmark_image(200u * 200u, get_max_concurrency(), 1.0, TransportMode::Multiplexed);
+}
+
+TEST(benchmark_streaming, image_800x600_mt_multiplexed) {
+  benchmark_image(800u * 600u, get_max_concurrency(), 0.9, TransportMode::Multiplexed);
+}
+
+// Same host clients reading the images from shared memory instead of the
+// loopback socket.
+
+TEST(benchmark_streaming, image_1920x1080_shared_memory) {
+  benchmark_image(1920u * 1080u, 1u, 0.9, TransportMode::PerStream, true);
+}
+
+TEST(benchmark_streaming, image_1920x1080_mt_shared_memory) {
+  benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9, TransportMode::PerStream, true);
+}
+
+// Time spent by the simulator thread writing to a stream with many
+// subscribers, while another client keeps subscribing and unsubscribing.
+
+static void benchmark_subscribers(const size_t number_of_subscribers) {
+  constexpr auto number_of_messages = 1000u;
+  const auto message = make_special_message(4u * 1024u);
+
+  Server server(TESTING_PORT);
+  server.AsyncRun(2u);
+  auto stream = server.MakeStream();
+
+  std::vector<std::unique_ptr<Client>> clients;
+  std::atomic_size_t number_of_messages_received{0u};
+  for (auto i = 0u; i < number_of_subscribers; ++i) {
+    clients.emplace_back(std::make_unique<Client>());
+    clients.back()->AsyncRun(1u);
+    clients.back()->Subscribe(stream.token(), [&](carla::Buffer) {
+      ++number_of_messages_received;
+    });
+  }
+  std::this_thread::sleep_for(500ms);
+
+  std::atomic_bool done{false};
+  carla::ThreadGroup churn;
+  churn.CreateThread([&]() {
+    while (!done) {
+      Client client;
+      client.AsyncRun(1u);
+      client.Subscribe(stream.token(), [](carla::Buffer) {});
+      std::this_thread::sleep_for(1ms);
+    }
+  });
+
+  carla::StopWatch timer;
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream << message.buffer();
+  }
+  timer.Stop();
+
+  done = true;
+  churn.JoinAll();
+  std::this_thread::sleep_for(100ms);
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(timer.GetDuration());
+  carla::logging::log(
+      number_of_subscribers, "subscribers:",
+      elapsed.count() / number_of_messages, "ns per write,",
+      number_of_messages_received, "messages received");
+  ASSERT_GT(number_of_messages_received, 0u);
+}
+
+TEST(benchmark_streaming, write_1_subscriber) {
+  benchmark_subscribers(1u);
+}
+
+TEST(benchmark_streaming, write_4_subscribers) {
+  benchmark_subscribers(4u);
+}
+
+TEST(benchmark_streaming, write_16_subscribers) {
+  benchmark_subscribers(16u);
+}
+
+TEST(benchmark_streaming, write_64_subscribers) {
+  benchmark_subscribers(64u);
+}
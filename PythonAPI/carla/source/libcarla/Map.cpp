@@ -13,8 +13,16 @@
 #include <carla/client/Landmark.h>
 #include <carla/road/SignalType.h>
 
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <ostream>
 #include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -78,6 +86,228 @@ static carla::geom::GeoLocation ToGeolocation(
   return self.GetGeoReference().Transform(location);
 }
 
+// =============================================================================
+// -- Batched queries on numpy arrays ------------------------------------------
+// =============================================================================
+
+static bool IsLittleEndian() {
+  const uint16_t value = 1u;
+  uint8_t first_byte;
+  std::memcpy(&first_byte, &value, 1u);
+  return first_byte == 1u;
+}
+
+/// Item format of a buffer without its byte order prefix, if the prefix is
+/// the native byte order, like the "<f" of numpy on little-endian machines.
+static std::string GetNativeFormat(const char *format) {
+  std::string result = format != nullptr ? format : "B";
+  if (!result.empty()) {
+    const char native = IsLittleEndian() ? '<' : '>';
+    const bool is_network = !IsLittleEndian() && (result[0] == '!');
+    if ((result[0] == '@') || (result[0] == '=') || (result[0] == native) || is_network) {
+      result.erase(0u, 1u);
+    }
+  }
+  return result;
+}
+
+/// Whether @a value converts to T without overflow. False for NaN.
+template <typename T>
+static bool IsInRange(double value) {
+  return (value >= static_cast<double>(std::numeric_limits<T>::lowest())) &&
+         (value <= static_cast<double>(std::numeric_limits<T>::max()));
+}
+
+/// Read the rows of @a object, any C-contiguous array of float32 or float64
+/// in native byte order supporting the buffer protocol, like a numpy array of
+/// shape (N, Columns), or (Columns,) for a single row.
+template <size_t Columns>
+static std::vector<std::array<double, Columns>> ReadRows(const boost::python::object &object) {
+  Py_buffer view;
+  const int flags = PyBUF_C_CONTIGUOUS | PyBUF_STRIDES | PyBUF_FORMAT;
+  if (PyObject_GetBuffer(object.ptr(), &view, flags) != 0) {
+    boost::python::throw_error_already_set();
+  }
+  const std::string format = GetNativeFormat(view.format);
+  const auto item_size = static_cast<size_t>(view.itemsize);
+  const bool is_float = (format == "f") && (item_size == sizeof(float));
+  const bool is_double = (format == "d") && (item_size == sizeof(double));
+  const auto columns = static_cast<Py_ssize_t>(Columns);
+  const bool is_single_row = (view.ndim == 1) && (view.shape[0] == columns);
+  const bool is_rows = (view.ndim == 2) && (view.shape[1] == columns);
+  if ((!is_float && !is_double) || (!is_single_row && !is_rows)) {
+    PyBuffer_Release(&view);
+    throw std::invalid_argument(
+        "expected an array of float32 or float64 of shape (N, " +
+        std::to_string(Columns) + ") or (" + std::to_string(Columns) + ",)");
+  }
+  const auto number_of_rows = is_rows ? static_cast<size_t>(view.shape[0]) : 1u;
+  const size_t size = number_of_rows * Columns;
+  std::vector<std::array<double, Columns>> rows(number_of_rows);
+  for (size_t i = 0u; i < size; ++i) {
+    rows[i / Columns][i % Columns] = is_float ?
+        static_cast<double>(reinterpret_cast<const float *>(view.buf)[i]) :
+        reinterpret_cast<const double *>(view.buf)[i];
+  }
+  PyBuffer_Release(&view);
+  return rows;
+}
+
+/// Make a writable numpy array of @a columns columns with a copy of @a values.
+template <typename T>
+static boost::python::object MakeArray(const std::vector<T> &values, const char *dtype, size_t columns) {
+  namespace py = boost::python;
+  const auto *data = reinterpret_cast<const char *>(values.data());
+  const auto size = static_cast<Py_ssize_t>(sizeof(T) * values.size());
+  // Unlike bytes, the memory of a bytearray is mutable, and so is the array.
+  py::object bytes(py::handle<>(PyByteArray_FromStringAndSize(data, size)));
+  auto array = py::import("numpy").attr("frombuffer")(bytes, dtype);
+  return columns > 1u ? array.attr("reshape")(-1, columns) : array;
+}
+
+/// Waypoints are passed from and to Python as rows of (road_id, lane_id, s),
+/// the same values accepted by get_waypoint_xodr. Rows of invalid or missing
+/// waypoints are NaN.
+static constexpr size_t WAYPOINT_COLUMNS = 3u;
+
+static void WriteWaypoint(
+    const boost::optional<carla::road::element::Waypoint> &waypoint,
+    std::vector<double> &out) {
+  if (waypoint.has_value()) {
+    out.emplace_back(static_cast<double>(waypoint->road_id));
+    out.emplace_back(static_cast<double>(waypoint->lane_id));
+    out.emplace_back(waypoint->s);
+  } else {
+    out.insert(out.end(), WAYPOINT_COLUMNS, std::numeric_limits<double>::quiet_NaN());
+  }
+}
+
+/// Waypoints of the valid rows of @a object, and the row of each of them.
+struct WaypointRows {
+  std::vector<carla::road::element::Waypoint> waypoints;
+  std::vector<size_t> rows;
+  size_t number_of_rows;
+};
+
+static WaypointRows ReadWaypoints(const carla::road::Map &map, const boost::python::object &object) {
+  const auto input = ReadRows<WAYPOINT_COLUMNS>(object);
+  carla::PythonUtil::ReleaseGIL unlock;
+  WaypointRows result;
+  result.number_of_rows = input.size();
+  result.waypoints.reserve(input.size());
+  result.rows.reserve(input.size());
+  for (size_t i = 0u; i < input.size(); ++i) {
+    const auto &row = input[i];
+    // Converting a value out of range of the target type is undefined.
+    if (!IsInRange<carla::road::RoadId>(row[0]) ||
+        !IsInRange<carla::road::LaneId>(row[1]) ||
+        !IsInRange<float>(row[2])) {
+      continue;
+    }
+    const auto waypoint = map.GetWaypoint(
+        static_cast<carla::road::RoadId>(row[0]),
+        static_cast<carla::road::LaneId>(row[1]),
+        static_cast<float>(row[2]));
+    if (waypoint.has_value()) {
+      result.waypoints.emplace_back(*waypoint);
+      result.rows.emplace_back(i);
+    }
+  }
+  return result;
+}
+
+static boost::python::object GetWaypointBatch(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road,
+    carla::road::Lane::LaneType lane_type) {
+  const auto input = ReadRows<3u>(locations);
+  std::vector<double> result;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    std::vector<carla::geom::Location> points;
+    points.reserve(input.size());
+    for (const auto &row : input) {
+      points.emplace_back(
+          static_cast<float>(row[0]),
+          static_cast<float>(row[1]),
+          static_cast<float>(row[2]));
+    }
+    const auto &map = self.GetMap();
+    const auto waypoints = project_to_road ?
+        map.GetClosestWaypointsOnRoad(points, static_cast<int32_t>(lane_type)) :
+        map.GetWaypoints(points, static_cast<int32_t>(lane_type));
+    result.reserve(WAYPOINT_COLUMNS * waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      WriteWaypoint(waypoint, result);
+    }
+  }
+  return MakeArray(result, "float64", WAYPOINT_COLUMNS);
+}
+
+static boost::python::object GetTransformBatch(
+    const carla::client::Map &self,
+    const boost::python::object &waypoints) {
+  constexpr size_t columns = 6u;
+  const auto input = ReadWaypoints(self.GetMap(), waypoints);
+  std::vector<float> result(columns * input.number_of_rows, std::numeric_limits<float>::quiet_NaN());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto transforms = self.GetMap().ComputeTransforms(input.waypoints);
+    for (size_t i = 0u; i < transforms.size(); ++i) {
+      const auto &transform = transforms[i];
+      auto *row = result.data() + columns * input.rows[i];
+      row[0] = transform.location.x;
+      row[1] = transform.location.y;
+      row[2] = transform.location.z;
+      row[3] = transform.rotation.pitch;
+      row[4] = transform.rotation.yaw;
+      row[5] = transform.rotation.roll;
+    }
+  }
+  return MakeArray(result, "float32", columns);
+}
+
+static boost::python::object GetLaneWidthBatch(
+    const carla::client::Map &self,
+    const boost::python::object &waypoints) {
+  const auto input = ReadWaypoints(self.GetMap(), waypoints);
+  std::vector<double> result(input.number_of_rows, std::numeric_limits<double>::quiet_NaN());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto widths = self.GetMap().GetLaneWidths(input.waypoints);
+    for (size_t i = 0u; i < widths.size(); ++i) {
+      result[input.rows[i]] = widths[i];
+    }
+  }
+  return MakeArray(result, "float64", 1u);
+}
+
+static boost::python::object GetNextBatch(
+    const carla::client::Map &self,
+    const boost::python::object &waypoints,
+    double distance) {
+  if (distance <= 0.0) {
+    throw std::invalid_argument("distance must be positive");
+  }
+  const auto input = ReadWaypoints(self.GetMap(), waypoints);
+  std::vector<double> result;
+  std::vector<int64_t> rows;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto next = self.GetMap().GetNextWaypoints(input.waypoints, distance);
+    for (size_t i = 0u; i < next.size(); ++i) {
+      for (const auto &waypoint : next[i]) {
+        WriteWaypoint(waypoint, result);
+        rows.emplace_back(static_cast<int64_t>(input.rows[i]));
+      }
+    }
+  }
+  return boost::python::make_tuple(
+      MakeArray(result, "float64", WAYPOINT_COLUMNS),
+      MakeArray(rows, "int64", 1u));
+}
+
 void export_map() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -160,6 +390,10 @@ void export_map() {
     .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
+    .def("get_waypoint_batch", &GetWaypointBatch, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_transform_batch", &GetTransformBatch, (arg("waypoints")))
+    .def("get_lane_width_batch", &GetLaneWidthBatch, (arg("waypoints")))
+    .def("get_next_batch", &GetNextBatch, (arg("waypoints"), arg("distance")))
     .def("get_topology", &GetTopology)
     .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
     .def("transform_to_geolocation", &ToGeolocation, (arg("location")))
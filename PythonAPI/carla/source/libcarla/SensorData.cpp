@@ -5,6 +5,7 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include <carla/PythonUtil.h>
+#include <carla/client/SensorDataWriter.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
@@ -351,9 +352,61 @@ static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc
 }
 
 template <typename T>
-static std::string SavePointCloudToDisk(T &self, std::string path) {
+static std::string SavePointCloudToDisk(T &self, std::string path, carla::pointcloud::PointCloudFormat format) {
   carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+  using carla::pointcloud::PointCloudIO;
+  if (format == carla::pointcloud::PointCloudFormat::PlyAscii) {
+    return PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+  }
+  return PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end(), format);
+}
+
+template <typename T>
+static auto GetSharedPtr(T &self) {
+  // Use the pointer owned by C++, the one converted from Python can only be
+  // released holding the GIL.
+  return boost::static_pointer_cast<T>(self.shared_from_this());
+}
+
+static bool WriterSaveImage(
+    carla::client::SensorDataWriter &self,
+    carla::sensor::data::Image &image,
+    const std::string &path,
+    EColorConverter cc) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  using namespace carla::image;
+  auto data = GetSharedPtr(image);
+  switch (cc) {
+    case EColorConverter::Raw:
+      return self.SaveImage(std::move(data), path);
+    case EColorConverter::Depth:
+      return self.SaveImage(std::move(data), path, ColorConverter::Depth());
+    case EColorConverter::LogarithmicDepth:
+      return self.SaveImage(std::move(data), path, ColorConverter::LogarithmicDepth());
+    case EColorConverter::CityScapesPalette:
+      return self.SaveImage(std::move(data), path, ColorConverter::CityScapesPalette());
+    default:
+      throw std::invalid_argument("invalid color converter!");
+  }
+}
+
+template <typename T>
+static bool WriterSavePointCloud(
+    carla::client::SensorDataWriter &self,
+    T &measurement,
+    const std::string &path,
+    carla::pointcloud::PointCloudFormat format) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return self.SavePointCloud(GetSharedPtr(measurement), path, format);
+}
+
+static bool WriterFlush(carla::client::SensorDataWriter &self, double seconds) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  if (seconds > 0.0) {
+    return self.Flush(TimeDurationFromSeconds(seconds));
+  }
+  self.Flush();
+  return true;
 }
 
 void export_sensor_data() {
@@ -387,6 +440,13 @@ void export_sensor_data() {
     .value("CityScapesPalette", EColorConverter::CityScapesPalette)
   ;
 
+  enum_<carla::pointcloud::PointCloudFormat>("PointCloudFormat")
+    .value("PlyAscii", carla::pointcloud::PointCloudFormat::PlyAscii)
+    .value("PlyBinary", carla::pointcloud::PointCloudFormat::PlyBinary)
+    .value("PcdBinary", carla::pointcloud::PointCloudFormat::PcdBinary)
+    .value("PcdBinaryCompressed", carla::pointcloud::PointCloudFormat::PcdBinaryCompressed)
+  ;
+
   class_<csd::Image, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::Image>>("Image", no_init)
     .add_property("width", &csd::Image::GetWidth)
     .add_property("height", &csd::Image::GetHeight)
@@ -427,7 +487,7 @@ void export_sensor_data() {
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path"), arg("format")=carla::pointcloud::PointCloudFormat::PlyAscii))
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> csd::LidarDetection {
@@ -444,7 +504,7 @@ void export_sensor_data() {
     .add_property("channels", &csd::SemanticLidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::SemanticLidarMeasurement>)
     .def("get_point_count", &csd::SemanticLidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path"), arg("format")=carla::pointcloud::PointCloudFormat::PlyAscii))
     .def("__len__", &csd::SemanticLidarMeasurement::size)
     .def("__iter__", iterator<csd::SemanticLidarMeasurement>())
     .def("__getitem__", +[](const csd::SemanticLidarMeasurement &self, size_t pos) -> csd::SemanticLidarDetection {
@@ -456,6 +516,25 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<cc::SensorDataWriter::Statistics>("SensorDataWriterStatistics", no_init)
+    .def_readonly("queued", &cc::SensorDataWriter::Statistics::queued)
+    .def_readonly("in_progress", &cc::SensorDataWriter::Statistics::in_progress)
+    .def_readonly("written", &cc::SensorDataWriter::Statistics::written)
+    .def_readonly("written_bytes", &cc::SensorDataWriter::Statistics::written_bytes)
+    .def_readonly("dropped", &cc::SensorDataWriter::Statistics::dropped)
+    .def_readonly("failed", &cc::SensorDataWriter::Statistics::failed)
+  ;
+
+  class_<cc::SensorDataWriter, boost::noncopyable, boost::shared_ptr<cc::SensorDataWriter>>("SensorDataWriter",
+      init<size_t, size_t, bool>((arg("worker_threads")=0u, arg("max_queued_writes")=256u, arg("drop_when_full")=false)))
+    .add_property("backlog", &cc::SensorDataWriter::GetBacklog)
+    .def("save_image", &WriterSaveImage, (arg("image"), arg("path"), arg("color_converter")=EColorConverter::Raw))
+    .def("save_point_cloud", &WriterSavePointCloud<csd::LidarMeasurement>, (arg("measurement"), arg("path"), arg("format")=carla::pointcloud::PointCloudFormat::PlyBinary))
+    .def("save_point_cloud", &WriterSavePointCloud<csd::SemanticLidarMeasurement>, (arg("measurement"), arg("path"), arg("format")=carla::pointcloud::PointCloudFormat::PlyBinary))
+    .def("flush", &WriterFlush, (arg("seconds")=0.0))
+    .def("get_statistics", &cc::SensorDataWriter::GetStatistics)
+  ;
+
   class_<csd::CollisionEvent, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::CollisionEvent>>("CollisionEvent", no_init)
     .add_property("actor", &csd::CollisionEvent::GetActor)
     .add_property("other_actor", &csd::CollisionEvent::GetOtherActor)
@@ -58,6 +58,18 @@ void InterSetImportedRoute(carla::traffic_manager::TrafficManager& self, const A
   self.SetImportedRoute(actor, RoadOptionToUint(input), empty_buffer);
 }
 
+void InterSetLevelOfDetail(carla::traffic_manager::TrafficManager& self, boost::python::list radii, boost::python::list update_intervals) {
+  self.SetLevelOfDetail(PythonLitstToVector<float>(radii), PythonLitstToVector<uint64_t>(update_intervals));
+}
+
+boost::python::list InterGetLevelOfDetailCounts(carla::traffic_manager::TrafficManager& self) {
+  boost::python::list l;
+  for (const uint64_t count : self.GetLevelOfDetailCounts()) {
+    l.append(count);
+  }
+  return l;
+}
+
 boost::python::list InterGetNextAction(carla::traffic_manager::TrafficManager& self, const ActorPtr &actor_ptr) {
   boost::python::list l;
   auto next_action = self.GetNextAction(actor_ptr->GetId());
@@ -106,6 +118,10 @@ void export_trafficmanager() {
     .def("set_hybrid_physics_radius", &ctm::TrafficManager::SetHybridPhysicsRadius)
     .def("set_random_device_seed", &ctm::TrafficManager::SetRandomDeviceSeed)
     .def("set_osm_mode", &carla::traffic_manager::TrafficManager::SetOSMMode)
+    .def("set_worker_threads", &carla::traffic_manager::TrafficManager::SetWorkerThreads)
+    .def("set_region", &carla::traffic_manager::TrafficManager::SetRegion)
+    .def("set_level_of_detail", &InterSetLevelOfDetail)
+    .def("get_level_of_detail_counts", &InterGetLevelOfDetailCounts)
     .def("set_path", &InterSetCustomPath, (arg("empty_buffer") = true))
     .def("set_route", &InterSetImportedRoute, (arg("empty_buffer") = true))
     .def("set_respawn_dormant_vehicles", &carla::traffic_manager::TrafficManager::SetRespawnDormantVehicles)
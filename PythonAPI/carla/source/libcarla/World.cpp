@@ -40,7 +40,8 @@ namespace rpc {
         << ",max_substep_delta_time=" << settings.max_substep_delta_time
         << ",max_substeps=" << settings.max_substeps
         << ",max_culling_distance=" << settings.max_culling_distance
-        << ",deterministic_ragdolls=" << BoolToStr(settings.deterministic_ragdolls) << ')';
+        << ",deterministic_ragdolls=" << BoolToStr(settings.deterministic_ragdolls)
+        << ",episode_state_keyframe_interval=" << settings.episode_state_keyframe_interval << ')';
     return out;
   }
 
@@ -153,7 +154,7 @@ void export_world() {
   ;
 
   class_<cr::EpisodeSettings>("WorldSettings")
-    .def(init<bool, bool, double, bool, double, int, float, bool, float, float>(
+    .def(init<bool, bool, double, bool, double, int, float, bool, float, float, uint32_t>(
         (arg("synchronous_mode")=false,
          arg("no_rendering_mode")=false,
          arg("fixed_delta_seconds")=0.0,
@@ -163,7 +164,8 @@ void export_world() {
          arg("max_culling_distance")=0.0f,
          arg("deterministic_ragdolls")=false,
          arg("tile_stream_distance")=3000.f,
-         arg("actor_active_distance")=2000.f)))
+         arg("actor_active_distance")=2000.f,
+         arg("episode_state_keyframe_interval")=0u)))
     .def_readwrite("synchronous_mode", &cr::EpisodeSettings::synchronous_mode)
     .def_readwrite("no_rendering_mode", &cr::EpisodeSettings::no_rendering_mode)
     .def_readwrite("substepping", &cr::EpisodeSettings::substepping)
@@ -181,6 +183,7 @@ void export_world() {
         })
     .def_readwrite("tile_stream_distance", &cr::EpisodeSettings::tile_stream_distance)
     .def_readwrite("actor_active_distance", &cr::EpisodeSettings::actor_active_distance)
+    .def_readwrite("episode_state_keyframe_interval", &cr::EpisodeSettings::episode_state_keyframe_interval)
     .def("__eq__", &cr::EpisodeSettings::operator==)
     .def("__ne__", &cr::EpisodeSettings::operator!=)
     .def(self_ns::str(self_ns::self))
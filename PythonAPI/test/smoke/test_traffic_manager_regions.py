@@ -0,0 +1,87 @@
+# Copyright (c) 2021 Computer Vision Center (CVC) at the Universitat Autonoma de
+# Barcelona (UAB).
+#
+# This work is licensed under the terms of the MIT license.
+# For a copy, see <https://opensource.org/licenses/MIT>.
+
+from . import SyncSmokeTest
+
+import carla
+import os
+import subprocess
+import sys
+
+TM_PORT = 7060
+NUM_VEHICLES = 50
+NUM_TICKS = 200
+
+# Traffic manager run in its own process until a line is read. Its region is
+# set from the process ticking the world, so that it is ticked from there.
+SHARD_SCRIPT = """
+import sys
+import carla
+client = carla.Client(sys.argv[1], int(sys.argv[2]))
+client.set_timeout(120.0)
+traffic_manager = client.get_trafficmanager(int(sys.argv[3]))
+traffic_manager.set_synchronous_mode(True)
+print('ready')
+sys.stdout.flush()
+sys.stdin.readline()
+traffic_manager.shut_down()
+"""
+
+
+class TestTrafficManagerRegions(SyncSmokeTest):
+    def test_invalid_region(self):
+        print("TestTrafficManagerRegions.test_invalid_region")
+        traffic_manager = self.client.get_trafficmanager(TM_PORT)
+        with self.assertRaises(Exception):
+            traffic_manager.set_region(2, 2)
+        with self.assertRaises(Exception):
+            traffic_manager.set_region(0, 0)
+        traffic_manager.shut_down()
+
+    def test_hand_off_between_processes(self):
+        print("TestTrafficManagerRegions.test_hand_off_between_processes")
+        traffic_manager = self.client.get_trafficmanager(TM_PORT)
+        traffic_manager.set_synchronous_mode(True)
+        traffic_manager.set_region(0, 2)
+
+        env = dict(os.environ)
+        env['PYTHONPATH'] = os.pathsep.join(sys.path)
+        shard = subprocess.Popen(
+            [sys.executable, '-c', SHARD_SCRIPT,
+             self.testing_address[0], str(self.testing_address[1]), str(TM_PORT + 1)],
+            stdin=subprocess.PIPE, stdout=subprocess.PIPE, env=env, universal_newlines=True)
+        vehicles = []
+        try:
+            self.assertEqual(shard.stdout.readline().strip(), 'ready')
+            # The world ticks of this process tick the traffic manager of the
+            # other one through its port, and send the commands of both.
+            shard_traffic_manager = self.client.get_trafficmanager(TM_PORT + 1)
+            shard_traffic_manager.set_region(1, 2)
+
+            blueprints = self.world.get_blueprint_library().filter('vehicle.*')
+            blueprints = [x for x in blueprints if int(x.get_attribute('number_of_wheels')) == 4]
+            spawn_points = self.world.get_map().get_spawn_points()
+            spawn_points = spawn_points[::max(1, len(spawn_points) // NUM_VEHICLES)]
+            batch = []
+            for n, transform in enumerate(spawn_points[:NUM_VEHICLES]):
+                batch.append(carla.command.SpawnActor(blueprints[n % len(blueprints)], transform)
+                    .then(carla.command.SetAutopilot(carla.command.FutureActor, True, TM_PORT)))
+            vehicles = [x.actor_id for x in self.client.apply_batch_sync(batch, True) if not x.error]
+            self.assertGreater(len(vehicles), 0)
+
+            for _ in range(NUM_TICKS):
+                self.world.tick()
+
+            # Every vehicle registered with region 0 is driven by one of the
+            # traffic managers, and those of region 1 were handed off.
+            driven = sum(traffic_manager.get_level_of_detail_counts())
+            shard_driven = sum(shard_traffic_manager.get_level_of_detail_counts())
+            self.assertGreater(shard_driven, 0)
+            self.assertGreaterEqual(driven + shard_driven, len(vehicles))
+        finally:
+            self.client.apply_batch_sync([carla.command.DestroyActor(x) for x in vehicles], True)
+            shard.communicate('\n')
+            traffic_manager.shut_down()
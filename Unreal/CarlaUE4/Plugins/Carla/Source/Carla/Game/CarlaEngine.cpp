@@ -179,6 +179,8 @@ void FCarlaEngine::OnEpisodeSettingsChanged(const FEpisodeSettings &Settings)
 
   FCarlaEngine_SetFixedDeltaSeconds(Settings.FixedDeltaSeconds);
 
+  WorldObserver.SetKeyframeInterval(Settings.EpisodeStateKeyframeInterval);
+
   // Setting parameters for physics substepping
   UPhysicsSettings* PhysSett = UPhysicsSettings::Get();
   PhysSett->bSubstepping = Settings.bSubstepping;
@@ -43,6 +43,14 @@ public:
     return FAsyncDataStreamTmpl<T>{Sensor, Timestamp, *Stream};
   }
 
+  /// Never drop nor coalesce the messages of this stream, see
+  /// carla::streaming::Stream::SetLossless.
+  void SetLossless(bool bLossless)
+  {
+    check(Stream.has_value());
+    (*Stream).SetLossless(bLossless);
+  }
+
   /// Return the token that allows subscribing to this stream.
   auto GetToken() const
   {
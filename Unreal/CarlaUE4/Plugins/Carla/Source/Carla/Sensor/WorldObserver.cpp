@@ -7,6 +7,7 @@
 #include "Carla.h"
 #include "Carla/Sensor/WorldObserver.h"
 #include "Carla/Actor/ActorData.h"
+#include "Carla/Game/CarlaEngine.h"
 
 #include "Carla/Traffic/TrafficLightBase.h"
 #include "Carla/Traffic/TrafficLightComponent.h"
@@ -374,5 +375,8 @@ void FWorldObserver::BroadcastTick(
       MapChange,
       PendingLightUpdates);
 
+  // Same frame the stream header carries, clients check deltas against it.
+  DeltaEncoder.Encode(buffer, FCarlaEngine::GetFrameCounter());
+
   AsyncStream.Send(*this, std::move(buffer));
 }
@@ -8,6 +8,10 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/s11n/EpisodeStateDeltaEncoder.h>
+#include <compiler/enable-ue4-macros.h>
+
 class UCarlaEpisode;
 
 /// Serializes and sends all the actors in the current UCarlaEpisode.
@@ -22,6 +26,7 @@ public:
   void SetStream(FDataMultiStream InStream)
   {
     Stream = std::move(InStream);
+    Stream.SetLossless(DeltaEncoder.GetKeyframeInterval() > 0u);
   }
 
   /// Return the token that allows subscribing to this sensor's stream.
@@ -30,6 +35,14 @@ public:
     return Stream.GetToken();
   }
 
+  /// Send only the actors that changed between keyframes, zero disables it.
+  /// Deltas depend on the previous message, so the stream becomes lossless.
+  void SetKeyframeInterval(uint32 KeyframeInterval)
+  {
+    DeltaEncoder.SetKeyframeInterval(KeyframeInterval);
+    Stream.SetLossless(KeyframeInterval > 0u);
+  }
+
   /// Send a message to every connected client with the info about the given @a
   /// Episode.
   void BroadcastTick(
@@ -47,4 +60,6 @@ public:
 private:
 
   FDataMultiStream Stream;
+
+  carla::sensor::s11n::EpisodeStateDeltaEncoder DeltaEncoder;
 };
@@ -66,6 +66,7 @@
 
 #include <vector>
 #include <map>
+#include <thread>
 #include <tuple>
 
 template <typename T>
@@ -2178,12 +2179,20 @@ FDataMultiStream FCarlaServer::Start(uint16_t RPCPort, uint16_t StreamingPort)
 {
   Pimpl = MakeUnique<FPimpl>(RPCPort, StreamingPort);
   StreamingPort = Pimpl->StreamingServer.GetLocalEndpoint().port();
+  // If enabled, clients on the same host read the sensor data from shared
+  // memory, the remote ones keep using TCP.
+  const bool bSharedMemory = FParse::Param(FCommandLine::Get(), TEXT("carla-shared-memory"));
+  Pimpl->StreamingServer.SetSharedMemoryEnabled(bSharedMemory);
+  // Sensors write from the game thread, it must never wait for a slow client.
+  check(IsInGameThread());
+  Pimpl->StreamingServer.SetNonBlockingThread(std::this_thread::get_id());
   UE_LOG(
       LogCarlaServer,
       Log,
-      TEXT("Initialized CarlaServer: Ports(rpc=%d, streaming=%d)"),
+      TEXT("Initialized CarlaServer: Ports(rpc=%d, streaming=%d), shared memory %s"),
       RPCPort,
-      StreamingPort);
+      StreamingPort,
+      bSharedMemory ? TEXT("enabled") : TEXT("disabled"));
   return Pimpl->BroadcastStream;
 }
 
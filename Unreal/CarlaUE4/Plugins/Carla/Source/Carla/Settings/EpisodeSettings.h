@@ -37,4 +37,7 @@ struct CARLA_API FEpisodeSettings
 
   float ActorActiveDistance = 200000.f; // 3km
 
+  /// Frames between two full world snapshots, zero disables the delta mode.
+  uint32 EpisodeStateKeyframeInterval = 0u;
+
 };